@@ -1,4 +1,16 @@
 #include <iostream>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <atomic>
+#include <exception>
+#include <random>
+#include <cstdio>
+
+#ifdef _WIN32
+#include <direct.h>
+#endif
+#include <sys/stat.h>
 
 #define CLI11_HAS_FILESYSTEM 0
 #include <bin/CLI11.hpp>
@@ -13,6 +25,8 @@
 #include <libasr/config.h>
 #include <libasr/string_utils.h>
 #include <libasr/codegen/evaluator.h>
+#include <libasr/time_report.h>
+#include <libasr/modfile.h>
 
 namespace {
 
@@ -125,6 +139,45 @@ int emit_asr(const std::string &infile, CompilerOptions &compiler_options)
     return 0;
 }
 
+// Compiles the module `infile` and saves its ASR together with its source
+// into the modfile `outfile`. Used for precompiling the runtime modules.
+int emit_modfile(const std::string &infile, const std::string &outfile,
+    CompilerOptions &compiler_options)
+{
+    Allocator al(4*1024);
+    LFortran::diag::Diagnostics diagnostics;
+    LFortran::LocationManager lm;
+    lm.in_filename = infile;
+    std::string input = LFortran::read_file(infile);
+    lm.init_simple(input);
+    LFortran::Result<LFortran::ASR::TranslationUnit_t*>
+        r = LFortran::ComPy::compile_module(al, infile, diagnostics);
+    std::cerr << diagnostics.render(input, lm, compiler_options);
+    if (!r.ok) {
+        return 2;
+    }
+    LFortran::ASR::TranslationUnit_t* asr = r.result;
+
+    std::string modfile = LFortran::save_modfile(*asr, input);
+    std::ofstream out;
+    out.open(outfile, std::ofstream::out | std::ofstream::binary);
+    out << modfile;
+    out.close();
+    if (!out) {
+        std::cerr << "Could not write the modfile '" << outfile << "'"
+            << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+// The C compiler used as the linker driver
+std::string c_compiler()
+{
+    char *env_CC = std::getenv("LFORTRAN_CC");
+    return env_CC ? env_CC : "cc";
+}
+
 #ifdef HAVE_LFORTRAN_LLVM
 
 int emit_llvm(const std::string &infile,
@@ -171,20 +224,252 @@ int emit_llvm(const std::string &infile,
     return 0;
 }
 
+// Compiles `infile` and runs it in the JIT (`compy run` or `--jit`)
+int run_jit(const std::string &infile, CompilerOptions &compiler_options,
+    LFortran::TimeReport *time_report=nullptr)
+{
+    using LFortran::time_phase;
+    Allocator al(4*1024);
+    LFortran::diag::Diagnostics diagnostics;
+    LFortran::LocationManager lm;
+    lm.in_filename = infile;
+    std::string input = LFortran::read_file(infile);
+    lm.init_simple(input);
+    LFortran::Result<LFortran::ComPy::AST::ast_t*> r = time_phase(
+        time_report, "Src -> AST", 0, &al, [&]() {
+            return parse_file(al, infile, diagnostics);
+        });
+    std::cerr << diagnostics.render(input, lm, compiler_options);
+    if (!r.ok) {
+        return 1;
+    }
+    LFortran::ComPy::AST::ast_t* ast = r.result;
+    diagnostics.diagnostics.clear();
+
+    // Src -> AST -> ASR
+    LFortran::Result<LFortran::ASR::TranslationUnit_t*> r1 = time_phase(
+        time_report, "AST -> ASR", 0, &al, [&]() {
+            return LFortran::ComPy::ast_to_asr(al, *ast, diagnostics, true,
+                compiler_options.symtab_only);
+        });
+    std::cerr << diagnostics.render(input, lm, compiler_options);
+    if (!r1.ok) {
+        LFORTRAN_ASSERT(diagnostics.has_error())
+        return 2;
+    }
+    LFortran::ASR::TranslationUnit_t* asr = r1.result;
+    diagnostics.diagnostics.clear();
+
+    // ASR -> LLVM -> JIT
+    LFortran::ComPyCompiler fe(compiler_options);
+    LFortran::Result<int> res = fe.run(*asr, diagnostics, time_report);
+    std::cerr << diagnostics.render(input, lm, compiler_options);
+    if (!res.ok) {
+        LFORTRAN_ASSERT(diagnostics.has_error())
+        return 3;
+    }
+    return res.result;
+}
+
+// Object file cache (`--cache-dir` or the COMPY_CACHE_DIR environment variable)
+//
+// Each entry is stored as `<hash>.o` together with `<hash>.key`. The key file
+// holds everything that determines the object file: the compiler version, the
+// target, the compiler options and the hashes of the source file and of every
+// module it (transitively) imports. A hit requires the stored key to match
+// exactly, so a collision of the file name hash only causes a miss.
+
+uint64_t fnv1a_hash(const std::string &s)
+{
+    uint64_t h = 14695981039346656037ULL;
+    for (unsigned char c : s) {
+        h ^= c;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+std::string hash_hex(const std::string &s)
+{
+    char buf[17];
+    snprintf(buf, sizeof(buf), "%016llx", (unsigned long long)fnv1a_hash(s));
+    return buf;
+}
+
+// Identifies the build of the compiler by the size and the modification
+// time of the executable, or returns an empty string
+std::string compiler_build_id()
+{
+    std::string path;
+    int dirname_length;
+    LFortran::get_executable_path(path, dirname_length);
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) return "";
+    return std::to_string(st.st_size) + " "
+        + std::to_string((long long)st.st_mtime);
+}
+
+// Returns the cache key, or an empty string if the file cannot be cached
+std::string object_cache_key(const std::string &input,
+        LFortran::ASR::TranslationUnit_t &asr,
+        const CompilerOptions &compiler_options, bool main_program)
+{
+    std::string target = compiler_options.target;
+    if (target == "") {
+        target = LFortran::LLVMEvaluator::get_default_target_triple();
+    }
+    std::stringstream key;
+    key << "compy " << LFORTRAN_VERSION << "\n";
+    std::string build_id = compiler_build_id();
+    if (build_id.empty()) return "";
+    key << "build " << build_id << "\n";
+    key << "target " << target << "\n";
+    key << "platform " << compiler_options.platform << "\n";
+    std::string target_cpu = compiler_options.target_cpu;
+    std::string target_features = compiler_options.target_features;
+    if (target_cpu == "native") {
+        // The key must change when the cache is used on a different CPU
+        target_cpu = LFortran::LLVMEvaluator::get_host_cpu_name();
+        target_features = LFortran::LLVMEvaluator::get_host_cpu_features()
+            + "," + target_features;
+    }
+    key << "target_cpu " << target_cpu << "\n";
+    key << "target_features " << target_features << "\n";
+    key << "opt_level " << compiler_options.opt_level << "\n";
+    key << "opt_size " << compiler_options.opt_size << "\n";
+    key << "fast_math " << compiler_options.fast_math << "\n";
+    key << "llvm_passes " << compiler_options.llvm_passes << "\n";
+    key << "codegen_threads " << compiler_options.codegen_threads << "\n";
+    key << "profile_generate " << compiler_options.profile_generate << "\n";
+    if (compiler_options.profile_use.size() > 0) {
+        std::string profile;
+        if (!LFortran::read_file(compiler_options.profile_use, profile)) {
+            return "";
+        }
+        key << "profile_use " << hash_hex(profile) << "\n";
+    }
+    key << "stack_array_limit " << compiler_options.stack_array_limit << "\n";
+    std::string rl_path = LFortran::get_runtime_library_dir();
+    if (compiler_options.opt_level > 0
+            || compiler_options.llvm_passes.size() > 0
+            || compiler_options.profile_generate.size() > 0
+            || compiler_options.profile_use.size() > 0) {
+        // The runtime bitcode is linked into the object (it is skipped if
+        // it is missing)
+        std::string bitcode;
+        if (LFortran::read_file(rl_path + "/compy_runtime.bc", bitcode)) {
+            key << "runtime_bitcode " << hash_hex(bitcode) << "\n";
+        } else {
+            key << "runtime_bitcode none\n";
+        }
+    }
+    key << "symtab_only " << compiler_options.symtab_only << "\n";
+    key << "main_program " << main_program << "\n";
+    key << "source " << hash_hex(input) << "\n";
+    // All modules, including the transitively imported ones, are loaded
+    // into the global scope (a std::map, so the order is deterministic)
+    for (auto &item : asr.m_global_scope->get_scope()) {
+        if (!LFortran::ASR::is_a<LFortran::ASR::Module_t>(*item.second)) {
+            continue;
+        }
+        bool ltypes, numpy;
+        LFortran::Result<std::string> path = LFortran::ComPy::get_full_path(
+            item.first + ".cp", rl_path, ltypes, numpy);
+        std::string text;
+        if (!path.ok || !LFortran::read_file(path.result, text)) return "";
+        key << "module " << item.first << " " << path.result << " "
+            << hash_hex(text) << "\n";
+    }
+    return key.str();
+}
+
+bool copy_file(const std::string &src, const std::string &dest)
+{
+    std::ifstream in(src, std::ios::binary);
+    if (!in) return false;
+    std::ofstream out(dest, std::ios::binary);
+    out << in.rdbuf();
+    return in.good() && out.good();
+}
+
+bool object_cache_get(const std::string &cache_dir, const std::string &key,
+        const std::string &outfile)
+{
+    std::string base = cache_dir + "/" + hash_hex(key);
+    std::string stored_key;
+    if (!LFortran::read_file(base + ".key", stored_key)) return false;
+    if (stored_key != key) return false;
+    return copy_file(base + ".o", outfile);
+}
+
+void object_cache_put(const std::string &cache_dir, const std::string &key,
+        const std::string &outfile)
+{
+#ifdef _WIN32
+    _mkdir(cache_dir.c_str());
+#else
+    mkdir(cache_dir.c_str(), 0755);
+#endif
+    // Write to unique temporary files first and rename them, so that
+    // concurrent compilations never see a partially written entry. The
+    // object is renamed before the key, so a valid key implies a valid object.
+    std::string base = cache_dir + "/" + hash_hex(key);
+    std::string tmp = base + ".tmp" + std::to_string(std::random_device{}());
+    if (!copy_file(outfile, tmp + ".o")) {
+        std::remove((tmp + ".o").c_str());
+        return;
+    }
+    std::ofstream out(tmp + ".key", std::ios::binary);
+    out << key;
+    out.close();
+    if (!out.good() || std::rename((tmp + ".o").c_str(), (base + ".o").c_str())
+            || std::rename((tmp + ".key").c_str(), (base + ".key").c_str())) {
+        std::remove((tmp + ".o").c_str());
+        std::remove((tmp + ".key").c_str());
+    }
+}
+
+// Combines the object files `parts` into one relocatable object `outfile`
+// and removes the parts
+bool merge_object_files(const std::vector<std::string> &parts,
+        const std::string &outfile)
+{
+    std::string cmd = c_compiler() + " -r -nostdlib -o \"" + outfile + "\"";
+    for (auto &part : parts) {
+        cmd += " \"" + part + "\"";
+    }
+    int err = system(cmd.c_str());
+    for (auto &part : parts) {
+        std::remove(part.c_str());
+    }
+    if (err) {
+        std::cerr << "The command '" + cmd + "' failed." << std::endl;
+        return false;
+    }
+    return true;
+}
+
 int compile_to_object_file(
         const std::string &infile,
         const std::string &outfile,
-        CompilerOptions &compiler_options)
+        CompilerOptions &compiler_options,
+        bool main_program=true,
+        LFortran::TimeReport *time_report=nullptr,
+        const std::string &cache_dir="",
+        std::ostream &err=std::cerr)
 {
+    using LFortran::time_phase;
     Allocator al(4*1024);
     LFortran::diag::Diagnostics diagnostics;
     LFortran::LocationManager lm;
     lm.in_filename = infile;
     std::string input = LFortran::read_file(infile);
     lm.init_simple(input);
-    LFortran::Result<LFortran::ComPy::AST::ast_t*> r = parse_file(
-        al, infile, diagnostics);
-    std::cerr << diagnostics.render(input, lm, compiler_options);
+    LFortran::Result<LFortran::ComPy::AST::ast_t*> r = time_phase(
+        time_report, "Src -> AST", 0, &al, [&]() {
+            return parse_file(al, infile, diagnostics);
+        });
+    err << diagnostics.render(input, lm, compiler_options);
     if (!r.ok) {
         return 1;
     }
@@ -192,30 +477,124 @@ int compile_to_object_file(
     // Src -> AST -> ASR
     LFortran::ComPy::AST::ast_t* ast = r.result;
     diagnostics.diagnostics.clear();
-    LFortran::Result<LFortran::ASR::TranslationUnit_t*>
-        r1 = LFortran::ComPy::ast_to_asr(al, *ast, diagnostics, true,
-            compiler_options.symtab_only);
-    std::cerr << diagnostics.render(input, lm, compiler_options);
+    LFortran::Result<LFortran::ASR::TranslationUnit_t*> r1 = time_phase(
+        time_report, "AST -> ASR", 0, &al, [&]() {
+            return LFortran::ComPy::ast_to_asr(al, *ast, diagnostics, true,
+                compiler_options.symtab_only);
+        });
+    err << diagnostics.render(input, lm, compiler_options);
     if (!r1.ok) {
         LFORTRAN_ASSERT(diagnostics.has_error())
         return 2;
     }
     LFortran::ASR::TranslationUnit_t* asr = r1.result;
     diagnostics.diagnostics.clear();
+    if (!main_program) {
+        // Only the first source file provides the program, the other files
+        // just contribute their procedures
+        if (asr->m_global_scope->get_symbol("_compy_main_program")) {
+            err << infile << ": global statements are only allowed in the "
+                "first source file" << std::endl;
+            return 2;
+        }
+        asr->m_global_scope->erase_symbol("main_program");
+    }
+
+    std::string cache_key;
+    if (cache_dir.size() > 0) {
+        bool hit = time_phase(time_report, "Object cache lookup", 0, nullptr,
+            [&]() {
+                cache_key = object_cache_key(input, *asr, compiler_options,
+                    main_program);
+                return cache_key.size() > 0
+                    && object_cache_get(cache_dir, cache_key, outfile);
+            });
+        if (hit) return 0;
+    }
 
     // ASR -> LLVM
     LFortran::ComPyCompiler fe(compiler_options);
-    LFortran::LLVMEvaluator e(compiler_options.target);
+    LFortran::LLVMEvaluator e(compiler_options.target,
+        compiler_options.target_cpu, compiler_options.target_features);
     std::unique_ptr<LFortran::LLVMModule> m;
     LFortran::Result<std::unique_ptr<LFortran::LLVMModule>>
-        res = fe.get_llvm3(*asr, diagnostics);
-    std::cerr << diagnostics.render(input, lm, compiler_options);
+        res = fe.get_llvm3(*asr, diagnostics, time_report);
+    err << diagnostics.render(input, lm, compiler_options);
     if (!res.ok) {
         LFORTRAN_ASSERT(diagnostics.has_error())
         return 3;
     }
     m = std::move(res.result);
-    e.save_object_file(*(m->m_m), outfile);
+    if (compiler_options.codegen_threads > 1) {
+        std::vector<std::string> parts;
+        for (int i = 0; i < compiler_options.codegen_threads; i++) {
+            parts.push_back(outfile + ".part" + std::to_string(i) + ".o");
+        }
+        bool ok = time_phase(time_report, "LLVM -> object file", 0, nullptr,
+            [&]() {
+                e.save_object_files(*(m->m_m), parts);
+                return merge_object_files(parts, outfile);
+            });
+        if (!ok) return 10;
+    } else {
+        time_phase(time_report, "LLVM -> object file", 0, nullptr, [&]() {
+            e.save_object_file(*(m->m_m), outfile);
+        });
+    }
+    if (cache_key.size() > 0) {
+        object_cache_put(cache_dir, cache_key, outfile);
+    }
+    return 0;
+}
+
+// Compiles each `infiles[i]` to `outfiles[i]` using up to `n_jobs` threads.
+// The first file is compiled as the main program, the rest as library units.
+// Diagnostics are buffered per file and printed in the input order, so the
+// output does not depend on the scheduling of the jobs.
+int compile_to_object_files(
+        const std::vector<std::string> &infiles,
+        const std::vector<std::string> &outfiles,
+        size_t n_jobs,
+        CompilerOptions &compiler_options,
+        const std::string &cache_dir,
+        std::vector<LFortran::TimeReport> *time_reports=nullptr)
+{
+    size_t n = infiles.size();
+    if (time_reports) {
+        for (auto &f : infiles) time_reports->emplace_back(f);
+    }
+    std::vector<int> errs(n, 0);
+    std::vector<std::string> outputs(n);
+    std::vector<std::exception_ptr> exceptions(n);
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+        for (size_t i = next++; i < n; i = next++) {
+            CompilerOptions co = compiler_options;
+            std::ostringstream err;
+            try {
+                errs[i] = compile_to_object_file(infiles[i], outfiles[i], co,
+                    i == 0, time_reports ? &(*time_reports)[i] : nullptr,
+                    cache_dir, err);
+            } catch (...) {
+                exceptions[i] = std::current_exception();
+            }
+            outputs[i] = err.str();
+        }
+    };
+    n_jobs = std::max<size_t>(1, std::min(n_jobs, n));
+    std::vector<std::thread> threads;
+    for (size_t t = 1; t < n_jobs; t++) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto &t : threads) {
+        t.join();
+    }
+    for (size_t i = 0; i < n; i++) {
+        std::cerr << outputs[i];
+        if (exceptions[i]) std::rethrow_exception(exceptions[i]);
+        if (errs[i]) return errs[i];
+    }
     return 0;
 }
 
@@ -232,9 +611,7 @@ int link_executable(const std::vector<std::string> &infiles,
 #endif
 
     if (backend == Backend::llvm) {
-        std::string CC = "cc";
-        char *env_CC = std::getenv("LFORTRAN_CC");
-        if (env_CC) CC = env_CC;
+        std::string CC = c_compiler();
         std::string base_path = "\"" + runtime_library_dir + "\"";
         std::string options;
         std::string runtime_lib = "compy_runtime";
@@ -243,6 +620,14 @@ int link_executable(const std::vector<std::string> &infiles,
         for (auto &s : infiles) {
             cmd += s + " ";
         }
+        if (compiler_options.profile_generate.size() > 0) {
+#ifdef COMPY_PROFILE_RUNTIME
+            cmd += std::string("\"") + COMPY_PROFILE_RUNTIME + "\" ";
+#else
+            std::cerr << "--profile-generate requires the LLVM profile runtime (libclang_rt.profile), configure ComPy with -DCOMPY_PROFILE_RUNTIME=<path>" << std::endl;
+            return 10;
+#endif
+        }
         cmd += + " -L"
             + base_path + " -Wl,-rpath," + base_path + " -l" + runtime_lib + " -lm";
         int err = system(cmd.c_str());
@@ -258,6 +643,25 @@ int link_executable(const std::vector<std::string> &infiles,
 }
 
 
+// The report goes to stderr, so that it is not mixed into the output of
+// `compy run`
+void print_time_report(const std::vector<LFortran::TimeReport> &reports,
+    const std::string &format)
+{
+    if (format == "json") {
+        std::cerr << "[";
+        for (size_t i = 0; i < reports.size(); i++) {
+            if (i > 0) std::cerr << ", ";
+            std::cerr << reports[i].json();
+        }
+        std::cerr << "]" << std::endl;
+    } else {
+        for (auto &r : reports) {
+            std::cerr << r.table() << std::endl;
+        }
+    }
+}
+
 } // anonymous namespace
 
 int main(int argc, char *argv[])
@@ -274,6 +678,13 @@ int main(int argc, char *argv[])
         bool show_ast = false;
         bool show_asr = false;
         bool show_llvm = false;
+        bool generate_modfile = false;
+        bool jit = false;
+        bool fast = false;
+        std::string opt_level = "0";
+        size_t n_jobs = std::max(1u, std::thread::hardware_concurrency());
+        std::string time_report;
+        std::string cache_dir;
 
         CompilerOptions compiler_options;
 
@@ -290,8 +701,21 @@ int main(int argc, char *argv[])
         app.add_flag("--show-ast", show_ast, "Show AST for the given file and exit");
         app.add_flag("--show-asr", show_asr, "Show ASR for the given file and exit");
         app.add_flag("--show-llvm", show_llvm, "Show LLVM IR for the given file and exit");
+        app.add_flag("--generate-modfile", generate_modfile, "Precompile the given module to a modfile and exit");
         app.add_flag("--indent", compiler_options.indent, "Indented print ASR/AST");
-        app.add_flag("--fast", compiler_options.fast, "Use this to get best performance");
+        app.add_flag("--fast", fast, "Use this to get best performance (-O3 and less accurate arithmetic)");
+        app.add_option("-O", opt_level, "Optimization level: 0 (default), 1, 2, 3 or s")->check(CLI::IsMember({"0", "1", "2", "3", "s"}));
+        app.add_option("--llvm-passes", compiler_options.llvm_passes, "Run this LLVM pass pipeline (`opt -passes=` syntax) instead of the -O one");
+        app.add_option("--target-cpu", compiler_options.target_cpu, "Generate code for this CPU, `native` for the host CPU (default: generic)");
+        app.add_option("--target-features", compiler_options.target_features, "Enable or disable target features, e.g. +avx2,-fma");
+        app.add_flag("--profile-generate{default.profraw}", compiler_options.profile_generate, "Instrument the program to write its execution profile to a file (default: default.profraw)");
+        app.add_option("--profile-use", compiler_options.profile_use, "Optimize using the profile in this file (merge the .profraw files with `llvm-profdata merge`, use the same -O level as with --profile-generate)");
+        app.add_flag("--jit", jit, "Run the program in the JIT instead of compiling it (same as `compy run`)");
+        app.add_option("-j", n_jobs, "Number of files to compile in parallel (default: number of cores)");
+        app.add_option("--codegen-threads", compiler_options.codegen_threads, "Split each file into this many parts and generate their code in parallel (default: 1)")->check(CLI::Range(1, 256));
+        app.add_option("--stack-array-limit", compiler_options.stack_array_limit, "Allocate local arrays larger than this many bytes on the heap instead of the stack (default: 65536)");
+        app.add_option("--cache-dir", cache_dir, "Cache compiled object files in this directory (default: $COMPY_CACHE_DIR)");
+        app.add_flag("--time-report{table}", time_report, "Show compilation time of each phase as a table or json (--time-report=json)")->check(CLI::IsMember({"table", "json"}));
 
         app.get_formatter()->column_width(25);
         CLI11_PARSE(app, argc, argv);
@@ -311,12 +735,62 @@ int main(int argc, char *argv[])
             return 0;
         }
 
+        if (fast) {
+            compiler_options.opt_level = 3;
+            compiler_options.fast_math = true;
+        } else if (opt_level == "s") {
+            compiler_options.opt_level = 2;
+            compiler_options.opt_size = true;
+        } else {
+            compiler_options.opt_level = std::stoi(opt_level);
+        }
+
+        if (compiler_options.profile_generate.size() > 0
+                && compiler_options.profile_use.size() > 0) {
+            std::cerr << "--profile-generate and --profile-use cannot be used together" << std::endl;
+            return 1;
+        }
+        if (compiler_options.profile_generate.size() > 0 && jit) {
+            std::cerr << "--profile-generate is not supported in the JIT" << std::endl;
+            return 1;
+        }
+
+#ifdef HAVE_LFORTRAN_LLVM
+        if (compiler_options.profile_use.size() > 0) {
+            std::string msg = LFortran::LLVMEvaluator::check_profile(
+                compiler_options.profile_use);
+            if (msg.size() > 0) {
+                std::cerr << "Cannot use the profile: " << msg << std::endl;
+                return 1;
+            }
+        }
+        if (compiler_options.target_cpu.size() > 0
+                && compiler_options.target_cpu != "native"
+                && !LFortran::LLVMEvaluator::is_cpu_supported(
+                    compiler_options.target, compiler_options.target_cpu)) {
+            std::cerr << "The target CPU '" << compiler_options.target_cpu
+                << "' is not supported by the target" << std::endl;
+            return 1;
+        }
+#endif
+
+        if (cache_dir.size() == 0) {
+            char *env_cache_dir = std::getenv("COMPY_CACHE_DIR");
+            if (env_cache_dir) cache_dir = env_cache_dir;
+        }
+
+        // `compy run file.cp [args]`
+        if (arg_files.size() > 0 && arg_files[0] == "run") {
+            jit = true;
+            arg_files.erase(arg_files.begin());
+        }
+
         if (arg_files.size() == 0) {
             std::cerr << "ComPy interactive prompt is not implemented yet." << std::endl;
             return 1;
         }
 
-        // TODO: for now we ignore the other filenames, only handle the first:
+        // The --show-* options only look at the first file
         std::string arg_file = arg_files[0];
 
         std::string outfile;
@@ -333,6 +807,8 @@ int main(int argc, char *argv[])
             outfile = basename + ".asr";
         } else if (show_llvm) {
             outfile = basename + ".ll";
+        } else if (generate_modfile) {
+            outfile = basename + ".mod";
         } else {
             outfile = "a.out";
         }
@@ -346,6 +822,26 @@ int main(int argc, char *argv[])
         if (show_asr) {
             return emit_asr(arg_file, compiler_options);
         }
+        if (generate_modfile) {
+            return emit_modfile(arg_file, outfile, compiler_options);
+        }
+
+        if (jit) {
+            // Only the first file is the program, the rest are its arguments
+#ifdef HAVE_LFORTRAN_LLVM
+            if (time_report.size() > 0) {
+                std::vector<LFortran::TimeReport> reports;
+                reports.emplace_back(arg_file);
+                int err = run_jit(arg_file, compiler_options, &reports[0]);
+                print_time_report(reports, time_report);
+                return err;
+            }
+            return run_jit(arg_file, compiler_options);
+#else
+            std::cerr << "The --jit option requires the LLVM backend to be enabled. Recompile with `WITH_LLVM=yes`." << std::endl;
+            return 1;
+#endif
+        }
 
         if (show_llvm) {
 #ifdef HAVE_LFORTRAN_LLVM
@@ -356,23 +852,52 @@ int main(int argc, char *argv[])
 #endif
         }
 
-        if (endswith(arg_file, ".cp"))
-        {
-            std::string tmp_o = outfile + ".tmp.o";
+        // Compile every ComPy source to its own object file, pass all other
+        // inputs (objects, C sources, libraries) through to the linker.
+        std::vector<std::string> cp_files, obj_files, link_files;
+        for (auto &f : arg_files) {
+            if (endswith(f, ".cp")) {
+                std::string tmp_o;
+                if (cp_files.empty()) {
+                    tmp_o = outfile + ".tmp.o";
+                } else {
+                    tmp_o = outfile + "." + std::to_string(cp_files.size())
+                        + ".tmp.o";
+                }
+                cp_files.push_back(f);
+                obj_files.push_back(tmp_o);
+                link_files.push_back(tmp_o);
+            } else {
+                link_files.push_back(f);
+            }
+        }
+        std::vector<LFortran::TimeReport> time_reports;
+        std::vector<LFortran::TimeReport> *reports = nullptr;
+        if (time_report.size() > 0) reports = &time_reports;
+        if (cp_files.size() > 0) {
             int err;
 #ifdef HAVE_LFORTRAN_LLVM
-                err = compile_to_object_file(arg_file, tmp_o, compiler_options);
+                err = compile_to_object_files(cp_files, obj_files, n_jobs,
+                    compiler_options, cache_dir, reports);
 #else
                 std::cerr << "Compiling Python files to object files requires the LLVM backend to be enabled. Recompile with `WITH_LLVM=yes`." << std::endl;
                 return 1;
 #endif
             if (err) return err;
-            return link_executable({tmp_o}, outfile, runtime_library_dir,
-                    Backend::llvm, compiler_options);
+        }
+        int err;
+        if (reports) {
+            reports->emplace_back(outfile);
+            err = reports->back().measure("Link", 0, nullptr, [&]() {
+                return link_executable(link_files, outfile,
+                    runtime_library_dir, Backend::llvm, compiler_options);
+            });
+            print_time_report(*reports, time_report);
         } else {
-            return link_executable(arg_files, outfile, runtime_library_dir,
+            err = link_executable(link_files, outfile, runtime_library_dir,
                     Backend::llvm, compiler_options);
         }
+        return err;
 
     } catch(const LFortran::LFortranException &e) {
         std::cerr << "Internal Compiler Error: Unhandled exception" << std::endl;
@@ -25,7 +25,8 @@ ComPyCompiler::ComPyCompiler(CompilerOptions compiler_options)
     :
     al{1024*1024},
 #ifdef HAVE_LFORTRAN_LLVM
-    e{std::make_unique<LLVMEvaluator>()},
+    e{std::make_unique<LLVMEvaluator>(compiler_options.target,
+        compiler_options.target_cpu, compiler_options.target_features)},
     eval_count{0},
 #endif
     compiler_options{compiler_options}
@@ -38,9 +39,11 @@ ComPyCompiler::~ComPyCompiler() = default;
 
 Result<std::unique_ptr<LLVMModule>> ComPyCompiler::get_llvm3(
 #ifdef HAVE_LFORTRAN_LLVM
-    ASR::TranslationUnit_t &asr, diag::Diagnostics &diagnostics
+    ASR::TranslationUnit_t &asr, diag::Diagnostics &diagnostics,
+    TimeReport *time_report
 #else
-    ASR::TranslationUnit_t &/*asr*/, diag::Diagnostics &/*diagnostics*/
+    ASR::TranslationUnit_t &/*asr*/, diag::Diagnostics &/*diagnostics*/,
+    TimeReport */*time_report*/
 #endif
     )
 {
@@ -50,11 +53,13 @@ Result<std::unique_ptr<LLVMModule>> ComPyCompiler::get_llvm3(
 
     // ASR -> LLVM
     std::unique_ptr<LFortran::LLVMModule> m;
-    Result<std::unique_ptr<LFortran::LLVMModule>> res
-        = asr_to_llvm(asr, diagnostics,
-            e->get_context(), al, compiler_options.platform,
-            compiler_options.fast, get_runtime_library_dir(),
-            run_fn);
+    Result<std::unique_ptr<LFortran::LLVMModule>> res = time_phase(
+        time_report, "ASR -> LLVM", 0, &al, [&]() {
+            return asr_to_llvm(asr, diagnostics,
+                e->get_context(), al, compiler_options,
+                get_runtime_library_dir(),
+                run_fn, time_report);
+        });
     if (res.ok) {
         m = std::move(res.result);
     } else {
@@ -62,8 +67,28 @@ Result<std::unique_ptr<LLVMModule>> ComPyCompiler::get_llvm3(
         return res.error;
     }
 
-    if (compiler_options.fast) {
-        e->opt(*m->m_m);
+    if (compiler_options.opt_level > 0
+            || compiler_options.llvm_passes.size() > 0
+            || compiler_options.profile_generate.size() > 0
+            || compiler_options.profile_use.size() > 0) {
+        // Make the runtime library functions available for inlining
+        time_phase(time_report, "Link runtime bitcode", 0, nullptr, [&]() {
+            e->link_bitcode(*m->m_m,
+                get_runtime_library_dir() + "/compy_runtime.bc");
+        });
+        try {
+            time_phase(time_report, "LLVM opt", 0, nullptr, [&]() {
+                e->opt(*m->m_m, compiler_options.opt_level,
+                    compiler_options.opt_size, compiler_options.llvm_passes,
+                    compiler_options.profile_generate,
+                    compiler_options.profile_use);
+            });
+        } catch (const LFortranException &ex) {
+            diagnostics.diagnostics.push_back(diag::Diagnostic(ex.msg(),
+                diag::Level::Error, diag::Stage::CodeGen));
+            Error error;
+            return error;
+        }
     }
 
     return m;
@@ -72,4 +97,41 @@ Result<std::unique_ptr<LLVMModule>> ComPyCompiler::get_llvm3(
 #endif
 }
 
+Result<int> ComPyCompiler::run(
+#ifdef HAVE_LFORTRAN_LLVM
+    ASR::TranslationUnit_t &asr, diag::Diagnostics &diagnostics,
+    TimeReport *time_report
+#else
+    ASR::TranslationUnit_t &/*asr*/, diag::Diagnostics &/*diagnostics*/,
+    TimeReport */*time_report*/
+#endif
+    )
+{
+#ifdef HAVE_LFORTRAN_LLVM
+    Result<std::unique_ptr<LLVMModule>> res = get_llvm3(asr, diagnostics,
+        time_report);
+    if (!res.ok) {
+        return res.error;
+    }
+    std::unique_ptr<LLVMModule> m = std::move(res.result);
+    // A program without global statements has nothing to execute
+    bool has_main = m->get_return_type("_compy_main_program") != "none";
+    time_phase(time_report, "JIT compile", 0, nullptr, [&]() {
+        e->add_module(std::move(m));
+        if (has_main) e->get_symbol_address("_compy_main_program");
+    });
+    if (has_main) {
+        time_phase(time_report, "Run", 0, nullptr, [&]() {
+            e->voidfn("_compy_main_program");
+            // The output is buffered in the runtime library, which lives as
+            // long as the compiler, so write it out before returning
+            e->voidfn("_compy_flush");
+        });
+    }
+    return 0;
+#else
+    throw LFortranException("LLVM is not enabled");
+#endif
+}
+
 } // namespace LFortran
@@ -10,6 +10,7 @@
 #include <compy/utils.h>
 #include <libasr/config.h>
 #include <libasr/diagnostics.h>
+#include <libasr/time_report.h>
 
 namespace LFortran {
 
@@ -25,7 +26,7 @@ class LLVMEvaluator;
    Diagnostic::render to render them.
 
    One can use get_asr2() to obtain the ASR and then hand it over to other
-   backends by hand.
+   backends by hand. The run() method executes a whole program in the JIT.
 */
 class ComPyCompiler
 {
@@ -51,7 +52,13 @@ public:
     };
 
     Result<std::unique_ptr<LLVMModule>> get_llvm3(ASR::TranslationUnit_t &asr,
-        diag::Diagnostics &diagnostics);
+        diag::Diagnostics &diagnostics, TimeReport *time_report=nullptr);
+
+    // Compiles `asr` and executes its global statements in the JIT, without
+    // writing an object file or linking. The runtime library symbols are
+    // resolved from the current process.
+    Result<int> run(ASR::TranslationUnit_t &asr,
+        diag::Diagnostics &diagnostics, TimeReport *time_report=nullptr);
 
 private:
     Allocator al;
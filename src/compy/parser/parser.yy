@@ -176,6 +176,7 @@ void yyerror(YYLTYPE *yyloc, LFortran::Parser &p, const std::string &msg)
 %type <ast> expr
 %type <vec_ast> expr_list
 %type <vec_ast> expr_list_opt
+%type <vec_ast> dict_list
 %type <ast> script_unit
 %type <ast> statement
 %type <vec_ast> statements
@@ -185,7 +186,9 @@ void yyerror(YYLTYPE *yyloc, LFortran::Parser &p, const std::string &msg)
 %type <ast> assignment_statement
 %type <ast> ann_assignment_statement
 %type <vec_ast> target_list
+%type <vec_ast> tuple_target
 %type <ast> target
+%type <ast> id_target
 %type <ast> augassign_statement
 %type <operator_type> augassign_op
 %type <ast> break_statement
@@ -216,13 +219,17 @@ void yyerror(YYLTYPE *yyloc, LFortran::Parser &p, const std::string &msg)
 
 %left "or"
 %left "and"
-%precedence "not"
-%left "==" "!=" ">=" ">" "<=" "<"
+%right "not"
+%left "==" "!=" ">=" ">" "<=" "<" KW_IN
+%left "|"
+%left "^"
+%left "&"
+%left "<<" ">>"
 %left "-" "+"
-%left "%" "/" "*"
+%left "%" "/" "//" "*"
 %precedence UNARY
 %right "**"
-%precedence "."
+%precedence "." "["
 
 %start units
 
@@ -303,7 +310,7 @@ raise_statement
 
 target
     : id { $$ = TARGET_ID($1, @$); }
-    | id "[" tuple_list "]" { $$ = TARGET_SUBSCRIPT($1, $3, @$); }
+    | expr "[" tuple_list "]" { $$ = TARGET_SUBSCRIPT($1, $3, @$); }
     ;
 
 target_list
@@ -311,8 +318,16 @@ target_list
     | target "=" { LIST_NEW($$); LIST_ADD($$, $1); }
     ;
 
+// `a, b = ...`, only as the first target to keep `a = b, c` unambiguous
+tuple_target
+    : tuple_target "," id_target { $$ = $1; LIST_ADD($$, $3); }
+    | id_target "," id_target { LIST_NEW($$); LIST_ADD($$, $1); LIST_ADD($$, $3); }
+    ;
+
 assignment_statement
-    : target_list expr { $$ = ASSIGNMENT($1, $2, @$); }
+    : target_list expr_list { $$ = ASSIGNMENT($1, TUPLE_01($2, @2), @$); }
+    | tuple_target "=" expr_list {
+        $$ = ASSIGNMENT_TUPLE($1, TUPLE_01($3, @3), @$); }
     ;
 
 ann_assignment_statement
@@ -330,6 +345,12 @@ augassign_op
     | "*=" { $$ = OPERATOR(Mult, @$); }
     | "/=" { $$ = OPERATOR(Div, @$); }
     | "%=" { $$ = OPERATOR(Mod, @$); }
+    | "//=" { $$ = OPERATOR(FloorDiv, @$); }
+    | "&=" { $$ = OPERATOR(BitAnd, @$); }
+    | "|=" { $$ = OPERATOR(BitOr, @$); }
+    | "^=" { $$ = OPERATOR(BitXor, @$); }
+    | "<<=" { $$ = OPERATOR(LShift, @$); }
+    | ">>=" { $$ = OPERATOR(RShift, @$); }
     | "**=" { $$ = OPERATOR(Pow, @$); }
     ;
 
@@ -359,7 +380,7 @@ import_statement
 
 return_statement
     : KW_RETURN { $$ = RETURN_01(@$); }
-    | KW_RETURN expr { $$ = RETURN_02($2, @$); }
+    | KW_RETURN expr_list { $$ = RETURN_02(TUPLE_01($2, @2), @$); }
     ;
 
 
@@ -380,11 +401,18 @@ if_statement
     ;
 
 for_statement
-    : KW_FOR target KW_IN expr ":" sep statements { $$ = FOR_01($2, $4, $7, @$); }
-    | KW_FOR target KW_IN expr ":" sep statements KW_ELSE ":" sep statements {
+    : KW_FOR id_target KW_IN expr ":" sep statements {
+        $$ = FOR_01($2, $4, $7, @$); }
+    | KW_FOR id_target KW_IN expr ":" sep statements KW_ELSE ":" sep statements {
         $$ = FOR_02($2, $4, $7, $11, @$); }
     ;
 
+// Only a name: in a `for` an expression would be ambiguous with
+// `expr in expr`, in a tuple target with the value of an assignment
+id_target
+    : id { $$ = TARGET_ID($1, @$); }
+    ;
+
 decorators
     : decorators "@" expr sep { $$ = $1; LIST_ADD($$, $3); }
     | "@" expr sep { LIST_NEW($$); LIST_ADD($$, $2); }
@@ -452,6 +480,12 @@ expr_list
     | expr { LIST_NEW($$); LIST_ADD($$, $1); }
     ;
 
+// Keys and values alternate, `DICT` splits them
+dict_list
+    : dict_list "," expr ":" expr { $$ = $1; LIST_ADD($$, $3); LIST_ADD($$, $5); }
+    | expr ":" expr { LIST_NEW($$); LIST_ADD($$, $1); LIST_ADD($$, $3); }
+    ;
+
 expr
     : id { $$ = $1; }
     | TK_INTEGER { $$ = INTEGER($1, @$); }
@@ -459,12 +493,18 @@ expr
     | TK_FLOAT { $$ = FLOAT($1, @$); }
     | TK_TRUE { $$ = BOOL(true, @$); }
     | TK_FALSE { $$ = BOOL(false, @$); }
-    | "(" expr ")" { $$ = $2; }
+    | "(" expr_list ")" { $$ = TUPLE_01($2, @$); }
+    | "(" expr_list "," ")" { $$ = TUPLE($2, @$); }
     | "[" expr_list_opt "]" { $$ = LIST($2, @$); }
+    | "{" "}" { $$ = DICT_EMPTY(@$); }
+    | "{" dict_list "}" { $$ = DICT($2, @$); }
+    | "{" dict_list "," "}" { $$ = DICT($2, @$); }
+    | "{" expr_list "}" { $$ = SET($2, @$); }
+    | "{" expr_list "," "}" { $$ = SET($2, @$); }
     | id "(" expr_list_opt ")" { $$ = CALL_01($1, $3, @$); }
     | expr "." id "(" expr_list_opt ")" {
         $$ = CALL_01(ATTRIBUTE_REF($1, $3, @$), $5, @$); }
-    | id "[" tuple_list "]" { $$ = SUBSCRIPT_01($1, $3, @$); }
+    | expr "[" tuple_list "]" { $$ = SUBSCRIPT_01($1, $3, @$); }
     | expr "." id { $$ = ATTRIBUTE_REF($1, $3, @$); }
 
     | expr "+" expr { $$ = BINOP($1, Add, $3, @$); }
@@ -472,7 +512,13 @@ expr
     | expr "*" expr { $$ = BINOP($1, Mult, $3, @$); }
     | expr "/" expr { $$ = BINOP($1, Div, $3, @$); }
     | expr "%" expr { $$ = BINOP($1, Mod, $3, @$); }
+    | expr "//" expr { $$ = BINOP($1, FloorDiv, $3, @$); }
     | expr "**" expr { $$ = BINOP($1, Pow, $3, @$); }
+    | expr "&" expr { $$ = BINOP($1, BitAnd, $3, @$); }
+    | expr "|" expr { $$ = BINOP($1, BitOr, $3, @$); }
+    | expr "^" expr { $$ = BINOP($1, BitXor, $3, @$); }
+    | expr "<<" expr { $$ = BINOP($1, LShift, $3, @$); }
+    | expr ">>" expr { $$ = BINOP($1, RShift, $3, @$); }
 
     | "-" expr %prec UNARY { $$ = UNARY($2, USub, @$); }
     | "+" expr %prec UNARY { $$ = UNARY($2, UAdd, @$); }
@@ -483,6 +529,8 @@ expr
     | expr "<=" expr { $$ = COMPARE($1, LtE, $3, @$); }
     | expr ">" expr { $$ = COMPARE($1, Gt, $3, @$); }
     | expr ">=" expr { $$ = COMPARE($1, GtE, $3, @$); }
+    | expr KW_IN expr { $$ = COMPARE($1, In, $3, @$); }
+    | expr "not" KW_IN expr %prec KW_IN { $$ = COMPARE($1, NotIn, $4, @$); }
 
     | expr "and" expr { $$ = BOOLOP($1, And, $3, @$); }
     | expr "or" expr { $$ = BOOLOP($1, Or, $3, @$); }
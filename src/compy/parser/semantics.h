@@ -228,6 +228,20 @@ static inline expr_t* CHECK_TUPLE(expr_t *x) {
 }
 #define TUPLE(elts, l) make_Tuple_t(p.m_a, l, \
         EXPRS(elts), elts.size(), expr_contextType::Load)
+// A single expression is only parenthesized, more make a tuple
+#define TUPLE_01(elts, l) (elts.size() == 1 ? elts[0] : TUPLE(elts, l))
+#define TARGET_TUPLE(elts, l) make_Tuple_t(p.m_a, l, \
+        EXPRS(elts), elts.size(), expr_contextType::Store)
+
+static inline ast_t* ASSIGNMENT_TUPLE0(Allocator &al, ast_t *target,
+        ast_t *value, const Location &l) {
+    Vec<expr_t*> targets;
+    targets.reserve(al, 1);
+    targets.push_back(al, EXPR(target));
+    return make_Assign_t(al, l, targets.p, 1, EXPR(value));
+}
+#define ASSIGNMENT_TUPLE(targets, val, l) ASSIGNMENT_TUPLE0(p.m_a, \
+        TARGET_TUPLE(targets, l), val, l)
 #define SUBSCRIPT_01(value, slice, l) make_Subscript_t(p.m_a, l, \
         EXPR(value), CHECK_TUPLE(EXPR(slice)), expr_contextType::Load)
 #define ATTRIBUTE_REF(val, attr, l) make_Attribute_t(p.m_a, l, \
@@ -235,4 +249,20 @@ static inline expr_t* CHECK_TUPLE(expr_t *x) {
 #define LIST(e, l) make_List_t(p.m_a, l, \
         EXPRS(e), e.size(), expr_contextType::Load)
 
+static inline ast_t* DICT0(Allocator &al, const Location &l,
+        const Vec<ast_t*> &items) {
+    size_t n = items.size() / 2;
+    Vec<expr_t*> keys, values;
+    keys.reserve(al, n);
+    values.reserve(al, n);
+    for (size_t i = 0; i < n; i++) {
+        keys.push_back(al, EXPR(items[2*i]));
+        values.push_back(al, EXPR(items[2*i+1]));
+    }
+    return make_Dict_t(al, l, keys.p, n, values.p, n);
+}
+#define DICT(items, l) DICT0(p.m_a, l, items)
+#define DICT_EMPTY(l) make_Dict_t(p.m_a, l, nullptr, 0, nullptr, 0)
+#define SET(e, l) make_Set_t(p.m_a, l, EXPRS(e), e.size())
+
 #endif
@@ -16,6 +16,9 @@
 #include <libasr/string_utils.h>
 #include <libasr/utils.h>
 #include <libasr/pass/global_stmts_program.h>
+#include <libasr/pass/pass_utils.h>
+#include <libasr/modfile.h>
+#include <libasr/serialization.h>
 
 #include <compy/ast.h>
 #include <compy/semantics/ast_to_asr.h>
@@ -27,25 +30,26 @@
 
 namespace LFortran::ComPy {
 
+bool file_exists(const std::string &filename) {
+    std::ifstream f(filename);
+    return f.good();
+}
+
 LFortran::Result<std::string> get_full_path(const std::string &filename,
         const std::string &runtime_library_dir, bool &ltypes, bool &numpy) {
     ltypes = false;
     numpy = false;
-    std::string input;
-    bool status = read_file(filename, input);
-    if (status) {
+    if (file_exists(filename)) {
         return filename;
     } else {
         std::string filename_intrinsic = runtime_library_dir + "/" + filename;
-        status = read_file(filename_intrinsic, input);
-        if (status) {
+        if (file_exists(filename_intrinsic)) {
             return filename_intrinsic;
         } else {
             // If this is `ltypes`, do a special lookup
             if (filename == "ltypes.py") {
                 filename_intrinsic = runtime_library_dir + "/ltypes/" + filename;
-                status = read_file(filename_intrinsic, input);
-                if (status) {
+                if (file_exists(filename_intrinsic)) {
                     ltypes = true;
                     return filename_intrinsic;
                 } else {
@@ -58,6 +62,44 @@ LFortran::Result<std::string> get_full_path(const std::string &filename,
     }
 }
 
+// Loads the modfile `rl_path/<module_name>.mod` that the build generates for
+// the runtime modules. Returns nullptr if there is no modfile or if it is
+// stale, i.e., it was not generated from the current content of `infile`
+// (which is empty if the module source is not available).
+ASR::TranslationUnit_t* load_precompiled_module(Allocator &al,
+        SymbolTable &symtab, const std::string &module_name,
+        const std::string &rl_path, const std::string &infile) {
+    std::string modfile;
+    if (!read_file(rl_path + "/" + module_name + ".mod", modfile)) {
+        return nullptr;
+    }
+    try {
+        if (infile.size() > 0) {
+            std::string source;
+            if (!read_file(infile, source)) return nullptr;
+            if (source != modfile_source(modfile)) return nullptr;
+        }
+        ASR::TranslationUnit_t *tu = load_modfile(al, modfile, false, symtab);
+        fix_external_symbols(*tu, symtab);
+        return tu;
+    } catch (const LFortranException &) {
+        // Modfile from a different compiler version, or corrupted
+        return nullptr;
+    }
+}
+
+Result<ASR::TranslationUnit_t*> compile_module(Allocator &al,
+        const std::string &infile, diag::Diagnostics &diagnostics) {
+    Result<AST::ast_t*> r = parse_file(al, infile, diagnostics);
+    if (!r.ok) {
+        return r.error;
+    }
+    LFortran::ComPy::AST::ast_t* ast = r.result;
+
+    // Convert the module from AST to ASR
+    return ast_to_asr(al, *ast, diagnostics, false, false);
+}
+
 ASR::Module_t* load_module(Allocator &al, SymbolTable *symtab,
                             const std::string &module_name,
                             const Location &loc, bool intrinsic,
@@ -86,33 +128,35 @@ ASR::Module_t* load_module(Allocator &al, SymbolTable *symtab,
     }
     Result<std::string> rinfile = get_full_path(infile0, rl_path, ltypes,
         numpy);
-    if (!rinfile.ok) {
-        err("Could not find the module '" + infile0 + "'", loc);
-    }
     if (ltypes) return nullptr;
     if (numpy) return nullptr;
-    std::string infile = rinfile.result;
-    // TODO: diagnostic should be an argument to this function
-    diag::Diagnostics diagnostics;
-    Result<AST::ast_t*> r = parse_file(al, infile, diagnostics);
-    if (!r.ok) {
-        err("The file '" + infile + "' failed to parse", loc);
+    std::string infile = rinfile.ok ? rinfile.result : "";
+
+    // Use the precompiled modfile if it is up to date
+    ASR::TranslationUnit_t* mod1 = load_precompiled_module(al, *symtab,
+        module_name, rl_path, infile);
+    if (!mod1) {
+        if (!rinfile.ok) {
+            err("Could not find the module '" + infile0 + "'", loc);
+        }
+        // TODO: diagnostic should be an argument to this function
+        diag::Diagnostics diagnostics;
+        Result<ASR::TranslationUnit_t*> r2 = compile_module(al, infile,
+            diagnostics);
+        std::string input;
+        read_file(infile, input);
+        LFortran::LocationManager lm;
+        lm.in_filename = infile;
+        CompilerOptions compiler_options;
+        std::cerr << diagnostics.render(input, lm, compiler_options);
+        if (!r2.ok) {
+            if (!diagnostics.has_error()) {
+                err("The file '" + infile + "' failed to parse", loc);
+            }
+            return nullptr; // Error
+        }
+        mod1 = r2.result;
     }
-    LFortran::ComPy::AST::ast_t* ast = r.result;
-
-    // Convert the module from AST to ASR
-    LFortran::LocationManager lm;
-    lm.in_filename = infile;
-    Result<ASR::TranslationUnit_t*> r2 = ast_to_asr(al, *ast, diagnostics, false, false);
-    std::string input;
-    read_file(infile, input);
-    CompilerOptions compiler_options;
-    std::cerr << diagnostics.render(input, lm, compiler_options);
-    if (!r2.ok) {
-        LFORTRAN_ASSERT(diagnostics.has_error())
-        return nullptr; // Error
-    }
-    ASR::TranslationUnit_t* mod1 = r2.result;
 
     // insert into `symtab`
     ASR::Module_t *mod2 = ASRUtils::extract_module(*mod1);
@@ -435,12 +479,16 @@ public:
                     throw SemanticError("Only Name or Tuple in Subscript supported for now in `tuple` annotation",
                         loc);
                 }
+                for (size_t i=0; i<types.size(); i++) {
+                    check_tuple_element(types[i], loc);
+                }
                 ASR::ttype_t *type = ASRUtils::TYPE(ASR::make_Tuple_t(al, loc,
                     types.p, types.size()));
                 return type;
             } else if (var_annotation == "set") {
                 if (AST::is_a<AST::Name_t>(*s->m_slice)) {
                     ASR::ttype_t *type = ast_expr_to_asr_type(loc, *s->m_slice);
+                    check_hashable(type, loc);
                     return ASRUtils::TYPE(ASR::make_Set_t(al, loc, type));
                 } else {
                     throw SemanticError("Only Name in Subscript supported for now in `set`"
@@ -463,6 +511,7 @@ public:
                             " of both keys and values", loc);
                     }
                     ASR::ttype_t *key_type = ast_expr_to_asr_type(loc, *t->m_elts[0]);
+                    check_hashable(key_type, loc);
                     ASR::ttype_t *value_type = ast_expr_to_asr_type(loc, *t->m_elts[1]);
                     return ASRUtils::TYPE(ASR::make_Dict_t(al, loc, key_type, value_type));
                 } else {
@@ -546,6 +595,71 @@ public:
             comptime_value, overloaded));
     }
 
+    // Returns the 1-based array index for the bound `idx` of a slice of the
+    // array `arr`, computed by `_compy_slice_bound` of the runtime library
+    // (or at compile time if `idx` and the size of `arr` are constants)
+    ASR::expr_t *slice_bound(ASR::expr_t *arr, ASR::expr_t *idx, int64_t step,
+            int64_t offset) {
+        const Location &loc = idx->base.loc;
+        ASR::ttype_t *idx_type = ASRUtils::expr_type(idx);
+        if (!ASRUtils::is_integer(*idx_type)) {
+            throw SemanticError("slice indices must be integers or None", loc);
+        }
+        ASR::ttype_t *int_type = ASRUtils::TYPE(ASR::make_Integer_t(al, loc,
+            4, nullptr, 0));
+        if (ASRUtils::extract_kind_from_ttype_t(idx_type) != 4) {
+            idx = ASRUtils::EXPR(ASR::make_Cast_t(al, loc, idx,
+                ASR::cast_kindType::IntegerToInteger, int_type, nullptr));
+        }
+        ASR::expr_t *size_value = nullptr;
+        ASR::dimension_t *dims = nullptr;
+        int n_dims = 0;
+        PassUtils::get_dim_rank(ASRUtils::expr_type(arr), dims, n_dims);
+        if (n_dims == 1 && dims[0].m_start && dims[0].m_end) {
+            ASR::expr_t *start = ASRUtils::expr_value(dims[0].m_start);
+            ASR::expr_t *end = ASRUtils::expr_value(dims[0].m_end);
+            if (start && end && ASR::is_a<ASR::IntegerConstant_t>(*start) &&
+                    ASR::is_a<ASR::IntegerConstant_t>(*end)) {
+                size_value = ASRUtils::EXPR(ASR::make_IntegerConstant_t(al, loc,
+                    ASR::down_cast<ASR::IntegerConstant_t>(end)->m_n -
+                    ASR::down_cast<ASR::IntegerConstant_t>(start)->m_n + 1,
+                    int_type));
+            }
+        }
+        ASR::expr_t *arg_values[4] = {
+            idx,
+            ASRUtils::EXPR(ASR::make_ArraySize_t(al, loc, arr, nullptr,
+                int_type, size_value)),
+            ASRUtils::EXPR(ASR::make_IntegerConstant_t(al, loc, step, int_type)),
+            ASRUtils::EXPR(ASR::make_IntegerConstant_t(al, loc, offset, int_type))
+        };
+        Vec<ASR::expr_t*> values;
+        values.reserve(al, 4);
+        for (size_t i = 0; i < 4; i++) {
+            ASR::expr_t *value = ASRUtils::expr_value(arg_values[i]);
+            if (value) values.push_back(al, value);
+        }
+        if (values.size() == 4) {
+            return PythonIntrinsicProcedures::eval__compy_slice_bound(al, loc,
+                values);
+        }
+        Vec<ASR::call_arg_t> args;
+        args.reserve(al, 4);
+        for (size_t i = 0; i < 4; i++) {
+            ASR::call_arg_t arg;
+            arg.loc = loc;
+            arg.m_value = arg_values[i];
+            args.push_back(al, arg);
+        }
+        std::string fn_name = "_compy_slice_bound";
+        ASR::symbol_t *fn = current_scope->resolve_symbol(fn_name);
+        if (!fn) {
+            fn = resolve_intrinsic_function(loc, fn_name);
+        }
+        return ASRUtils::EXPR(make_call_helper(al, fn, current_scope, args,
+            fn_name, loc));
+    }
+
     // Casts `right` if needed to the type of `left`
     // (to be used during assignment, BinOp, or compare)
     ASR::expr_t* cast_helper(ASR::ttype_t *left_type, ASR::expr_t *right,
@@ -647,6 +761,46 @@ public:
         return right;
     }
 
+    // Calls the runtime library function `fn_name(left, right)`
+    void make_runtime_call(const std::string &fn_name, ASR::expr_t *left,
+            ASR::expr_t *right, const Location &loc) {
+        ASR::symbol_t *fn = resolve_intrinsic_function(loc, fn_name);
+        Vec<ASR::call_arg_t> args;
+        args.reserve(al, 2);
+        ASR::call_arg_t arg1, arg2;
+        arg1.loc = left->base.loc;
+        arg1.m_value = left;
+        args.push_back(al, arg1);
+        arg2.loc = right->base.loc;
+        arg2.m_value = right;
+        args.push_back(al, arg2);
+        tmp = make_call_helper(al, fn, current_scope, args, fn_name, loc);
+    }
+
+    // Bitwise operators are calls of the `_bitwise_*` builtins, which the
+    // backend emits as instructions. Returns false if `op` is not bitwise.
+    bool make_bitwise_helper(ASR::expr_t *left, ASR::expr_t *right,
+                            AST::operatorType op, const Location &loc) {
+        std::string fn_name;
+        switch (op) {
+            case (AST::operatorType::BitAnd) : { fn_name = "_bitwise_and"; break; }
+            case (AST::operatorType::BitOr) : { fn_name = "_bitwise_or"; break; }
+            case (AST::operatorType::BitXor) : { fn_name = "_bitwise_xor"; break; }
+            case (AST::operatorType::LShift) : { fn_name = "_bitwise_lshift"; break; }
+            case (AST::operatorType::RShift) : { fn_name = "_bitwise_rshift"; break; }
+            default : return false;
+        }
+        if (!ASRUtils::is_integer(*ASRUtils::expr_type(left)) ||
+                !ASRUtils::is_integer(*ASRUtils::expr_type(right))) {
+            throw SemanticError("Bitwise operators are only supported for integers",
+                loc);
+        }
+        left = cast_helper(ASRUtils::expr_type(right), left);
+        right = cast_helper(ASRUtils::expr_type(left), right);
+        make_runtime_call(fn_name, left, right, loc);
+        return true;
+    }
+
     void make_BinOp_helper(ASR::expr_t *left, ASR::expr_t *right,
                             ASR::binopType op, const Location &loc, bool floordiv) {
         ASR::ttype_t *left_type = ASRUtils::expr_type(left);
@@ -693,7 +847,7 @@ public:
                 }
                 if (ASRUtils::expr_value(right) != nullptr) {
                     if (ASRUtils::is_integer(*right_type)) {
-                        int8_t value = ASR::down_cast<ASR::IntegerConstant_t>(ASRUtils::expr_value(right))->m_n;
+                        int64_t value = ASR::down_cast<ASR::IntegerConstant_t>(ASRUtils::expr_value(right))->m_n;
                         if (value == 0) {
                             diag.add(diag::Diagnostic(
                                 "integer division by zero is not allowed",
@@ -718,19 +872,17 @@ public:
                         }
                     }
                 }
-                ASR::symbol_t *fn_div = resolve_intrinsic_function(loc, "_compy_floordiv");
-                Vec<ASR::call_arg_t> args;
-                args.reserve(al, 1);
-                ASR::call_arg_t arg1, arg2;
-                arg1.loc = left->base.loc;
-                arg2.loc = right->base.loc;
-                arg1.m_value = left;
-                arg2.m_value = right;
-                args.push_back(al, arg1);
-                args.push_back(al, arg2);
-                tmp = make_call_helper(al, fn_div, current_scope, args, "_compy_floordiv", loc);
-                return;
-
+                if (!both_int) {
+                    make_runtime_call("_compy_floordiv", left, right, loc);
+                    return;
+                }
+                // The integer floor division is lowered by the backend
+                op = ASR::binopType::FloorDiv;
+            } else if (ASRUtils::is_complex(*left_type) || ASRUtils::is_complex(*right_type)) {
+                // complex division keeps the complex type
+                left = cast_helper(ASRUtils::expr_type(right), left);
+                right = cast_helper(ASRUtils::expr_type(left), right);
+                dest_type = ASRUtils::expr_type(left);
             } else { // real divison in python using (`/`)
                 dest_type = ASRUtils::TYPE(ASR::make_Real_t(al, loc,
                     8, nullptr, 0));
@@ -770,6 +922,29 @@ public:
                     }
                 }
             }
+        } else if (op == ASR::binopType::Mod) {
+            if (!ASRUtils::is_integer(*left_type) || !ASRUtils::is_integer(*right_type)) {
+                // The modulo of reals is implemented in the runtime library
+                left = cast_helper(ASRUtils::expr_type(right), left);
+                right = cast_helper(ASRUtils::expr_type(left), right);
+                make_runtime_call("_mod", left, right, loc);
+                return;
+            }
+            left = cast_helper(right_type, left);
+            right = cast_helper(ASRUtils::expr_type(left), right);
+            dest_type = ASRUtils::expr_type(left);
+            ASR::expr_t *right_value = ASRUtils::expr_value(right);
+            if (right_value != nullptr && ASR::down_cast<ASR::IntegerConstant_t>(
+                    right_value)->m_n == 0) {
+                diag.add(diag::Diagnostic(
+                    "integer modulo by zero is not allowed",
+                    diag::Level::Error, diag::Stage::Semantic, {
+                        diag::Label("integer modulo by zero",
+                                {right->base.loc})
+                    })
+                );
+                throw SemanticAbort();
+            }
         } else if((ASRUtils::is_integer(*left_type) || ASRUtils::is_real(*left_type) ||
                     ASRUtils::is_complex(*left_type) || ASRUtils::is_logical(*left_type)) &&
                 (ASRUtils::is_integer(*right_type) || ASRUtils::is_real(*right_type) ||
@@ -778,25 +953,26 @@ public:
             right = cast_helper(ASRUtils::expr_type(left), right);
             dest_type = ASRUtils::expr_type(left);
         } else if ((right_is_int || left_is_int) && op == ASR::binopType::Mul) {
-            // string repeat
-            int64_t left_int = 0, right_int = 0, dest_len = 0;
+            // string repeat, the length is not known at compile time (-2)
+            // unless the count and the length are constant
+            int64_t left_int = 0, right_int = 0, dest_len = -2;
             if (right_is_int) {
                 ASR::Character_t *left_type2 = ASR::down_cast<ASR::Character_t>(left_type);
                 LFORTRAN_ASSERT(left_type2->n_dims == 0);
-                right_int = ASR::down_cast<ASR::IntegerConstant_t>(
-                                                   ASRUtils::expr_value(right))->m_n;
-                dest_len = left_type2->m_len * right_int;
-                if (dest_len < 0) dest_len = 0;
+                if (get_constant_index(right, right_int) && left_type2->m_len >= 0) {
+                    dest_len = left_type2->m_len * right_int;
+                    if (dest_len < 0) dest_len = 0;
+                }
                 dest_type = ASR::down_cast<ASR::ttype_t>(
                         ASR::make_Character_t(al, loc, left_type2->m_kind,
                         dest_len, nullptr, nullptr, 0));
             } else if (left_is_int) {
                 ASR::Character_t *right_type2 = ASR::down_cast<ASR::Character_t>(right_type);
                 LFORTRAN_ASSERT(right_type2->n_dims == 0);
-                left_int = ASR::down_cast<ASR::IntegerConstant_t>(
-                                                   ASRUtils::expr_value(left))->m_n;
-                dest_len = right_type2->m_len * left_int;
-                if (dest_len < 0) dest_len = 0;
+                if (get_constant_index(left, left_int) && right_type2->m_len >= 0) {
+                    dest_len = right_type2->m_len * left_int;
+                    if (dest_len < 0) dest_len = 0;
+                }
                 dest_type = ASR::down_cast<ASR::ttype_t>(
                         ASR::make_Character_t(al, loc, right_type2->m_kind,
                         dest_len, nullptr, nullptr, 0));
@@ -831,9 +1007,13 @@ public:
             ASR::Character_t *right_type2 = ASR::down_cast<ASR::Character_t>(right_type);
             LFORTRAN_ASSERT(left_type2->n_dims == 0);
             LFORTRAN_ASSERT(right_type2->n_dims == 0);
+            int64_t dest_len = -2;
+            if (left_type2->m_len >= 0 && right_type2->m_len >= 0) {
+                dest_len = left_type2->m_len + right_type2->m_len;
+            }
             dest_type = ASR::down_cast<ASR::ttype_t>(
                     ASR::make_Character_t(al, loc, left_type2->m_kind,
-                    left_type2->m_len + right_type2->m_len, nullptr, nullptr, 0));
+                    dest_len, nullptr, nullptr, 0));
             if (ASRUtils::expr_value(left) != nullptr && ASRUtils::expr_value(right) != nullptr) {
                 char* left_value = ASR::down_cast<ASR::StringConstant_t>(
                                         ASRUtils::expr_value(left))->m_s;
@@ -851,6 +1031,13 @@ public:
 
         } else if (ASR::is_a<ASR::List_t>(*left_type) && ASR::is_a<ASR::List_t>(*right_type)
                    && op == ASR::binopType::Add) {
+            if (ASR::is_a<ASR::ListConstant_t>(*right)) {
+                right = retype_constant(right, left_type);
+            } else {
+                left = retype_constant(left, right_type);
+            }
+            left_type = ASRUtils::expr_type(left);
+            right_type = ASRUtils::expr_type(right);
             dest_type = left_type;
             std::string ltype = ASRUtils::type_to_str_python(left_type);
             std::string rtype = ASRUtils::type_to_str_python(right_type);
@@ -910,6 +1097,18 @@ public:
                     case (ASR::binopType::Mul): { result = left_value * right_value; break; }
                     case (ASR::binopType::Div): { result = left_value / right_value; break; }
                     case (ASR::binopType::Pow): { result = std::pow(left_value, right_value); break; }
+                    case (ASR::binopType::FloorDiv):
+                    case (ASR::binopType::Mod): {
+                        // Python rounds the quotient towards negative infinity
+                        int64_t q = left_value / right_value;
+                        int64_t r = left_value % right_value;
+                        if (r != 0 && (r < 0) != (right_value < 0)) {
+                            q--;
+                            r += right_value;
+                        }
+                        result = (op == ASR::binopType::Mod) ? r : q;
+                        break;
+                    }
                     default: { LFORTRAN_ASSERT(false); } // should never happen
                 }
                 value = ASR::down_cast<ASR::expr_t>(ASR::make_IntegerConstant_t(
@@ -1072,15 +1271,23 @@ public:
         ASR::expr_t *left = ASRUtils::EXPR(tmp);
         this->visit_expr(*x.m_right);
         ASR::expr_t *right = ASRUtils::EXPR(tmp);
+        if (make_bitwise_helper(left, right, x.m_op, x.base.base.loc)) {
+            return;
+        }
         ASR::binopType op;
-        std::string op_name = "";
+        bool floordiv = false;
         switch (x.m_op) {
             case (AST::operatorType::Add) : { op = ASR::binopType::Add; break; }
             case (AST::operatorType::Sub) : { op = ASR::binopType::Sub; break; }
             case (AST::operatorType::Mult) : { op = ASR::binopType::Mul; break; }
             case (AST::operatorType::Div) : { op = ASR::binopType::Div; break; }
             case (AST::operatorType::Pow) : { op = ASR::binopType::Pow; break; }
-            case (AST::operatorType::Mod) : { op_name = "_mod"; break; }
+            case (AST::operatorType::Mod) : { op = ASR::binopType::Mod; break; }
+            case (AST::operatorType::FloorDiv) : {
+                op = ASR::binopType::Div;
+                floordiv = true;
+                break;
+            }
             default : {
                 throw SemanticError("Binary operator type not supported",
                     x.base.base.loc);
@@ -1088,21 +1295,7 @@ public:
         }
         left = cast_helper(ASRUtils::expr_type(right), left);
         right = cast_helper(ASRUtils::expr_type(left), right);
-        Vec<ASR::call_arg_t> args;
-        args.reserve(al, 2);
-        ASR::call_arg_t arg1, arg2;
-        arg1.loc = left->base.loc;
-        arg1.m_value = left;
-        args.push_back(al, arg1);
-        arg2.loc = right->base.loc;
-        arg2.m_value = right;
-        args.push_back(al, arg2);
-        if (op_name != "") {
-            ASR::symbol_t *fn_mod = resolve_intrinsic_function(x.base.base.loc, op_name);
-            tmp = make_call_helper(al, fn_mod, current_scope, args, op_name, x.base.base.loc);
-            return;
-        }
-        make_BinOp_helper(left, right, op, x.base.base.loc, false);
+        make_BinOp_helper(left, right, op, x.base.base.loc, floordiv);
     }
 
     void visit_UnaryOp(const AST::UnaryOp_t &x) {
@@ -1232,9 +1425,282 @@ public:
                                 ASRUtils::expr_type(body));
     }
 
+    // The type of a list, dict or set literal is the type of its first
+    // element, or `i32` if it is empty; `retype_constant` converts the
+    // elements to the type that the literal is used as, e.g.
+    // `x: list[i64] = [1, 2]` or `d: dict[str, f64] = {}`. The elements of
+    // a tuple literal are converted one by one, `t: tuple[f64, i64] = (1.0, 2)`
+    ASR::expr_t* retype_constant(ASR::expr_t *value, ASR::ttype_t *type) {
+        auto retype = [&](ASR::expr_t *x, ASR::ttype_t *el_type) {
+            return cast_helper(el_type, retype_constant(x, el_type), true);
+        };
+        if (ASR::is_a<ASR::ListConstant_t>(*value) &&
+                ASR::is_a<ASR::List_t>(*type)) {
+            ASR::ListConstant_t *l = ASR::down_cast<ASR::ListConstant_t>(value);
+            ASR::ttype_t *el_type = ASR::down_cast<ASR::List_t>(type)->m_type;
+            Vec<ASR::expr_t*> args;
+            args.reserve(al, l->n_args);
+            for (size_t i = 0; i < l->n_args; i++) {
+                args.push_back(al, retype(l->m_args[i], el_type));
+            }
+            return ASRUtils::EXPR(ASR::make_ListConstant_t(al, value->base.loc,
+                args.p, args.size(), type));
+        } else if (ASR::is_a<ASR::DictConstant_t>(*value) &&
+                ASR::is_a<ASR::Dict_t>(*type)) {
+            ASR::DictConstant_t *d = ASR::down_cast<ASR::DictConstant_t>(value);
+            ASR::Dict_t *t = ASR::down_cast<ASR::Dict_t>(type);
+            Vec<ASR::expr_t*> keys, values;
+            keys.reserve(al, d->n_keys);
+            values.reserve(al, d->n_values);
+            for (size_t i = 0; i < d->n_keys; i++) {
+                keys.push_back(al, retype(d->m_keys[i], t->m_key_type));
+                values.push_back(al, retype(d->m_values[i], t->m_value_type));
+            }
+            return ASRUtils::EXPR(ASR::make_DictConstant_t(al, value->base.loc,
+                keys.p, keys.size(), values.p, values.size(), type));
+        } else if (ASR::is_a<ASR::SetConstant_t>(*value) &&
+                ASR::is_a<ASR::Set_t>(*type)) {
+            ASR::SetConstant_t *s = ASR::down_cast<ASR::SetConstant_t>(value);
+            ASR::ttype_t *el_type = ASR::down_cast<ASR::Set_t>(type)->m_type;
+            Vec<ASR::expr_t*> elements;
+            elements.reserve(al, s->n_elements);
+            for (size_t i = 0; i < s->n_elements; i++) {
+                elements.push_back(al, retype(s->m_elements[i], el_type));
+            }
+            return ASRUtils::EXPR(ASR::make_SetConstant_t(al, value->base.loc,
+                elements.p, elements.size(), type));
+        } else if (ASR::is_a<ASR::TupleConstant_t>(*value) &&
+                ASR::is_a<ASR::Tuple_t>(*type)) {
+            ASR::TupleConstant_t *t = ASR::down_cast<ASR::TupleConstant_t>(value);
+            ASR::Tuple_t *tuple_type = ASR::down_cast<ASR::Tuple_t>(type);
+            if (t->n_elements != tuple_type->n_type) return value;
+            Vec<ASR::expr_t*> elements;
+            elements.reserve(al, t->n_elements);
+            for (size_t i = 0; i < t->n_elements; i++) {
+                elements.push_back(al, retype(t->m_elements[i],
+                    tuple_type->m_type[i]));
+            }
+            return ASRUtils::EXPR(ASR::make_TupleConstant_t(al, value->base.loc,
+                elements.p, elements.size(), type));
+        }
+        return value;
+    }
+
+    // Dict keys and set elements are hashed by value, which is not
+    // supported for lists, dicts and sets
+    void check_hashable(ASR::ttype_t *type, const Location &loc) {
+        if (ASR::is_a<ASR::List_t>(*type) || ASR::is_a<ASR::Dict_t>(*type) ||
+                ASR::is_a<ASR::Set_t>(*type)) {
+            throw SemanticError("unhashable type: '" +
+                ASRUtils::type_to_str_python(type) + "'", loc);
+        }
+    }
+
+    // Tuples are values that are copied as a whole, so they cannot own
+    // lists, dicts or sets
+    void check_tuple_element(ASR::ttype_t *type, const Location &loc) {
+        if (ASR::is_a<ASR::List_t>(*type) || ASR::is_a<ASR::Dict_t>(*type) ||
+                ASR::is_a<ASR::Set_t>(*type)) {
+            throw SemanticError("Tuple elements of type '" +
+                ASRUtils::type_to_str_python(type) + "' are not supported yet", loc);
+        }
+    }
+
+    ASR::asr_t* make_tuple_subscript(ASR::expr_t *tuple, const AST::Subscript_t &x) {
+        ASR::Tuple_t *type = ASR::down_cast<ASR::Tuple_t>(ASRUtils::expr_type(tuple));
+        if (AST::is_a<AST::Slice_t>(*x.m_slice)) {
+            throw SemanticError("Tuple slices are not supported yet", x.base.base.loc);
+        }
+        // The index selects a field of the tuple, so it must be known at
+        // compile time
+        this->visit_expr(*x.m_slice);
+        ASR::expr_t *index = ASRUtils::EXPR(tmp);
+        ASR::expr_t *index_value = ASRUtils::expr_value(index);
+        if (!index_value || !ASR::is_a<ASR::IntegerConstant_t>(*index_value)) {
+            throw SemanticError("tuple indices must be integer constants",
+                index->base.loc);
+        }
+        int64_t i = ASR::down_cast<ASR::IntegerConstant_t>(index_value)->m_n;
+        int64_t n = type->n_type;
+        if (i < 0) i += n;
+        if (i < 0 || i >= n) {
+            throw SemanticError("tuple index out of range", index->base.loc);
+        }
+        ASR::ttype_t *int32_type = ASRUtils::TYPE(ASR::make_Integer_t(al,
+            x.base.base.loc, 4, nullptr, 0));
+        ASR::expr_t *pos = ASRUtils::EXPR(ASR::make_IntegerConstant_t(al,
+            index->base.loc, i, int32_type));
+        ASR::expr_t *value = nullptr;
+        if (ASR::is_a<ASR::TupleConstant_t>(*tuple)) {
+            value = ASRUtils::expr_value(
+                ASR::down_cast<ASR::TupleConstant_t>(tuple)->m_elements[i]);
+        }
+        return ASR::make_TupleItem_t(al, x.base.base.loc, tuple, pos,
+            type->m_type[i], value);
+    }
+
+    // `x` converted to `type`, the key type of a dict or the element type
+    // of a set
+    ASR::expr_t* make_key(ASR::expr_t *x, ASR::ttype_t *type,
+            const std::string &kind) {
+        x = cast_helper(type, retype_constant(x, type), true);
+        if (!ASRUtils::check_equal_type(type, ASRUtils::expr_type(x))) {
+            throw SemanticError("Type mismatch: the " + kind + " are of type '"
+                + ASRUtils::type_to_str_python(type) + "'", x->base.loc);
+        }
+        return x;
+    }
+
+    // Lists and strings are indexed from 0 and negative indices count from
+    // the end, the backend adjusts them by the length
+    ASR::expr_t* list_index(ASR::expr_t *index, const std::string &kind="list") {
+        ASR::ttype_t *index_type = ASRUtils::expr_type(index);
+        if (!ASRUtils::is_integer(*index_type)) {
+            throw SemanticError(kind + " indices must be integers", index->base.loc);
+        }
+        ASR::ttype_t *int32_type = ASRUtils::TYPE(ASR::make_Integer_t(al,
+            index->base.loc, 4, nullptr, 0));
+        return cast_helper(int32_type, index, true);
+    }
+
+    ASR::asr_t* make_list_subscript(ASR::expr_t *list, const AST::Subscript_t &x) {
+        ASR::ttype_t *type = ASRUtils::expr_type(list);
+        if (AST::is_a<AST::Slice_t>(*x.m_slice)) {
+            AST::Slice_t *s = AST::down_cast<AST::Slice_t>(x.m_slice);
+            ASR::array_index_t ai;
+            ai.loc = x.base.base.loc;
+            ai.m_left = nullptr;
+            ai.m_right = nullptr;
+            ai.m_step = nullptr;
+            if (s->m_lower != nullptr) {
+                this->visit_expr(*s->m_lower);
+                ai.m_left = list_index(ASRUtils::EXPR(tmp));
+            }
+            if (s->m_upper != nullptr) {
+                this->visit_expr(*s->m_upper);
+                ai.m_right = list_index(ASRUtils::EXPR(tmp));
+            }
+            if (s->m_step != nullptr) {
+                this->visit_expr(*s->m_step);
+                ai.m_step = list_index(ASRUtils::EXPR(tmp));
+                ASR::expr_t *step_value = ASRUtils::expr_value(ai.m_step);
+                if (step_value && ASR::is_a<ASR::IntegerConstant_t>(*step_value) &&
+                        ASR::down_cast<ASR::IntegerConstant_t>(step_value)->m_n == 0) {
+                    throw SemanticError("slice step cannot be zero", ai.m_step->base.loc);
+                }
+            }
+            return ASR::make_ListSection_t(al, x.base.base.loc, list, ai,
+                type, nullptr);
+        }
+        this->visit_expr(*x.m_slice);
+        ASR::expr_t *pos = list_index(ASRUtils::EXPR(tmp));
+        return ASR::make_ListItem_t(al, x.base.base.loc, list, pos,
+            ASR::down_cast<ASR::List_t>(type)->m_type, nullptr);
+    }
+
+    // Whether `index` is an integer constant, its value is stored in `i`
+    static bool get_constant_index(ASR::expr_t *index, int64_t &i) {
+        ASR::expr_t *value = index ? ASRUtils::expr_value(index) : nullptr;
+        if (!value || !ASR::is_a<ASR::IntegerConstant_t>(*value)) return false;
+        i = ASR::down_cast<ASR::IntegerConstant_t>(value)->m_n;
+        return true;
+    }
+
+    // `s[i]` and `s[start:end:step]`, the value is computed for a constant
+    // string and constant indices
+    ASR::asr_t* make_string_subscript(ASR::expr_t *str, const AST::Subscript_t &x) {
+        const Location &loc = x.base.base.loc;
+        ASR::expr_t *str_value = ASRUtils::expr_value(str);
+        std::string s;
+        bool is_constant = str_value && ASR::is_a<ASR::StringConstant_t>(*str_value);
+        if (is_constant) s = ASR::down_cast<ASR::StringConstant_t>(str_value)->m_s;
+        int64_t n = s.size();
+        if (AST::is_a<AST::Slice_t>(*x.m_slice)) {
+            AST::Slice_t *slice = AST::down_cast<AST::Slice_t>(x.m_slice);
+            AST::expr_t *ast_bounds[3] = {slice->m_lower, slice->m_upper,
+                slice->m_step};
+            ASR::expr_t *bounds[3] = {nullptr, nullptr, nullptr};
+            int64_t b[3] = {0, 0, 1};
+            for (int i = 0; i < 3; i++) {
+                if (ast_bounds[i]) {
+                    this->visit_expr(*ast_bounds[i]);
+                    bounds[i] = list_index(ASRUtils::EXPR(tmp), "slice");
+                    is_constant = get_constant_index(bounds[i], b[i]) && is_constant;
+                }
+            }
+            int64_t step = 1;
+            if (get_constant_index(bounds[2], step) && step == 0) {
+                throw SemanticError("slice step cannot be zero", bounds[2]->base.loc);
+            }
+            ASR::expr_t *value = nullptr;
+            int64_t len = -2;
+            if (is_constant) {
+                // Adjusted like the slices of Python
+                for (int i = 0; i < 2; i++) {
+                    if (b[i] < 0) b[i] += n;
+                    if (b[i] < 0) b[i] = step < 0 ? -1 : 0;
+                    if (b[i] >= n) b[i] = step < 0 ? n - 1 : n;
+                }
+                if (!bounds[0]) b[0] = step < 0 ? n - 1 : 0;
+                if (!bounds[1]) b[1] = step < 0 ? -1 : n;
+                std::string r;
+                for (int64_t i = b[0]; step > 0 ? i < b[1] : i > b[1]; i += step) {
+                    r += s[i];
+                }
+                len = r.size();
+                value = ASRUtils::EXPR(ASR::make_StringConstant_t(al, loc,
+                    s2c(al, r), ASRUtils::TYPE(ASR::make_Character_t(al, loc, 1,
+                    len, nullptr, nullptr, 0))));
+            }
+            ASR::ttype_t *type = ASRUtils::TYPE(ASR::make_Character_t(al, loc,
+                1, len, nullptr, nullptr, 0));
+            return ASR::make_StringSection_t(al, loc, str, bounds[0], bounds[1],
+                bounds[2], type, value);
+        }
+        this->visit_expr(*x.m_slice);
+        ASR::expr_t *index = list_index(ASRUtils::EXPR(tmp), "string");
+        ASR::ttype_t *type = ASRUtils::TYPE(ASR::make_Character_t(al, loc,
+            1, 1, nullptr, nullptr, 0));
+        ASR::expr_t *value = nullptr;
+        int64_t i;
+        if (is_constant && get_constant_index(index, i)) {
+            if (i < 0) i += n;
+            if (i < 0 || i >= n) {
+                throw SemanticError("string index out of range", index->base.loc);
+            }
+            value = ASRUtils::EXPR(ASR::make_StringConstant_t(al, loc,
+                s2c(al, std::string(1, s[i])), type));
+        }
+        return ASR::make_StringItem_t(al, loc, str, index, type, value);
+    }
+
     void visit_Subscript(const AST::Subscript_t &x) {
         this->visit_expr(*x.m_value);
         ASR::expr_t *value = ASRUtils::EXPR(tmp);
+        ASR::ttype_t *value_type = ASRUtils::expr_type(value);
+        if (ASR::is_a<ASR::List_t>(*value_type)) {
+            tmp = make_list_subscript(value, x);
+            return;
+        } else if (ASR::is_a<ASR::Dict_t>(*value_type)) {
+            if (AST::is_a<AST::Slice_t>(*x.m_slice)) {
+                throw SemanticError("unhashable type: 'slice'", x.base.base.loc);
+            }
+            ASR::Dict_t *t = ASR::down_cast<ASR::Dict_t>(value_type);
+            this->visit_expr(*x.m_slice);
+            ASR::expr_t *key = make_key(ASRUtils::EXPR(tmp), t->m_key_type, "keys");
+            tmp = ASR::make_DictItem_t(al, x.base.base.loc, value, key, nullptr,
+                t->m_value_type);
+            return;
+        } else if (ASR::is_a<ASR::Set_t>(*value_type)) {
+            throw SemanticError("'set' object is not subscriptable", x.base.base.loc);
+        } else if (ASR::is_a<ASR::Tuple_t>(*value_type)) {
+            tmp = make_tuple_subscript(value, x);
+            return;
+        } else if (ASR::is_a<ASR::Character_t>(*value_type) &&
+                ASR::down_cast<ASR::Character_t>(value_type)->n_dims == 0) {
+            tmp = make_string_subscript(value, x);
+            return;
+        }
         Vec<ASR::array_index_t> args;
         args.reserve(al, 1);
         ASR::array_index_t ai;
@@ -1242,58 +1708,58 @@ public:
         ai.m_left = nullptr;
         ai.m_right = nullptr;
         ai.m_step = nullptr;
+        if (!ASR::is_a<ASR::Var_t>(*value)) {
+            throw SemanticError("Only variables and lists can be subscripted",
+                x.base.base.loc);
+        }
         ASR::symbol_t *s = ASR::down_cast<ASR::Var_t>(value)->m_v;
         ASR::Variable_t *v = ASR::down_cast<ASR::Variable_t>(s);
         ASR::ttype_t *type = v->m_type;
         if (AST::is_a<AST::Slice_t>(*x.m_slice)) {
+            // `a[lower:upper:step]` is the section `lower+1:upper:step` of
+            // the 1-based array, `lower+1:upper+2:step` for a negative step
             AST::Slice_t *s = AST::down_cast<AST::Slice_t>(x.m_slice);
+            ASR::ttype_t *int_type = ASRUtils::TYPE(ASR::make_Integer_t(al,
+                x.base.base.loc, 4, nullptr, 0));
+            int64_t step = 1;
+            if (s->m_step != nullptr) {
+                this->visit_expr(*s->m_step);
+                ASR::expr_t *step_value = ASRUtils::expr_value(ASRUtils::EXPR(tmp));
+                if (step_value == nullptr ||
+                        !ASR::is_a<ASR::IntegerConstant_t>(*step_value)) {
+                    throw SemanticError("Only constant integer array slice steps "
+                        "are supported", tmp->loc);
+                }
+                step = ASR::down_cast<ASR::IntegerConstant_t>(step_value)->m_n;
+                if (step == 0) {
+                    throw SemanticError("slice step cannot be zero", tmp->loc);
+                }
+            }
+            ai.m_step = ASRUtils::EXPR(ASR::make_IntegerConstant_t(al,
+                x.base.base.loc, step, int_type));
             if (s->m_lower != nullptr) {
                 this->visit_expr(*s->m_lower);
-                ai.m_left = index_add_one(x.base.base.loc, ASRUtils::EXPR(tmp));
+                ai.m_left = slice_bound(value, ASRUtils::EXPR(tmp), step, 1);
+            } else if (step < 0) {
+                ai.m_left = ASRUtils::EXPR(ASR::make_ArraySize_t(al,
+                    x.base.base.loc, value, nullptr, int_type, nullptr));
             }
             if (s->m_upper != nullptr) {
                 this->visit_expr(*s->m_upper);
-                if (!ASRUtils::is_integer(*ASRUtils::expr_type(ASRUtils::EXPR(tmp)))) {
-                    throw SemanticError("slice indices must be integers or None", tmp->loc);
-                }
-                ai.m_right = index_add_one(x.base.base.loc, ASRUtils::EXPR(tmp));
-            }
-            if (s->m_step != nullptr) {
-                this->visit_expr(*s->m_step);
-                ai.m_step = index_add_one(x.base.base.loc, ASRUtils::EXPR(tmp));
+                ai.m_right = slice_bound(value, ASRUtils::EXPR(tmp), step,
+                    step > 0 ? 0 : 2);
+            } else if (step < 0) {
+                ai.m_right = ASRUtils::EXPR(ASR::make_IntegerConstant_t(al,
+                    x.base.base.loc, 1, int_type));
             }
         } else {
             this->visit_expr(*x.m_slice);
-            if (!ASR::is_a<ASR::Dict_t>(*type) &&
-                    !ASRUtils::is_integer(*ASRUtils::expr_type(ASRUtils::EXPR(tmp)))) {
+            if (!ASRUtils::is_integer(*ASRUtils::expr_type(ASRUtils::EXPR(tmp)))) {
                 throw SemanticError("string indices must be integers", tmp->loc);
             }
-            ASR::expr_t *index = nullptr;
-            if (ASR::is_a<ASR::Dict_t>(*type)) {
-                index = ASRUtils::EXPR(tmp);
-                ASR::ttype_t *key_type = ASR::down_cast<ASR::Dict_t>(type)->m_key_type;
-                if (!ASRUtils::check_equal_type(ASRUtils::expr_type(index), key_type)) {
-                    throw SemanticError("Key type must be: " + ASRUtils::type_to_str_python(key_type),
-                            x.base.base.loc);
-                }
-            } else {
-                index = index_add_one(x.base.base.loc, ASRUtils::EXPR(tmp));
-            }
-            ai.m_right = index;
+            ai.m_right = index_add_one(x.base.base.loc, ASRUtils::EXPR(tmp));
         }
 
-        if (ASR::is_a<ASR::Character_t>(*type)) {
-            if (!ai.m_left && ai.m_right) {
-                // String indexing is done using "a(3:3)" style
-                ai.m_left = ai.m_right;
-            }
-        } else if (ASR::is_a<ASR::List_t>(*type)) {
-            type = ASR::down_cast<ASR::List_t>(type)->m_type;
-        } else if (ASR::is_a<ASR::Set_t>(*type)) {
-            throw SemanticError("'set' object is not subscriptable", x.base.base.loc);
-        } else if (ASR::is_a<ASR::Dict_t>(*type)) {
-            type = ASR::down_cast<ASR::Dict_t>(type)->m_value_type;
-        }
         args.push_back(al, ai);
         tmp = ASR::make_ArrayRef_t(al, x.base.base.loc, s, args.p,
             args.size(), type, nullptr);
@@ -1391,6 +1857,7 @@ public:
         args.reserve(al, x.m_args.n_args);
         current_procedure_abi_type = ASR::abiType::Source;
         bool overload = false;
+        bool restrict = false;
         if (x.n_decorator_list > 0) {
             for(size_t i=0; i<x.n_decorator_list; i++) {
                 AST::expr_t *dec = x.m_decorator_list[i];
@@ -1400,6 +1867,9 @@ public:
                         current_procedure_abi_type = ASR::abiType::BindC;
                     } else if (name == "overload") {
                         overload = true;
+                    } else if (name == "restrict") {
+                        // The array arguments do not share elements
+                        restrict = true;
                     } else if (name == "interface") {
                         // TODO: Implement @interface
                     } else {
@@ -1492,7 +1962,7 @@ public:
                     /* n_body */ 0,
                     /* a_return_var */ ASRUtils::EXPR(return_var_ref),
                     current_procedure_abi_type,
-                    s_access, deftype, bindc_name);
+                    s_access, deftype, bindc_name, restrict);
 
             } else {
                 throw SemanticError("Return variable must be an identifier (Name AST node) or an array (Subscript AST node)",
@@ -1510,7 +1980,7 @@ public:
                 /* n_body */ 0,
                 current_procedure_abi_type,
                 s_access, deftype, bindc_name,
-                is_pure, is_module);
+                is_pure, is_module, restrict);
         }
         ASR::symbol_t * t = ASR::down_cast<ASR::symbol_t>(tmp);
         parent_scope->add_symbol(sym_name, t);
@@ -1645,6 +2115,7 @@ private:
 public:
     ASR::asr_t *asr;
     Vec<ASR::stmt_t*> *current_body;
+    int discard_counter = 0;
 
     BodyVisitor(Allocator &al, ASR::asr_t *unit, diag::Diagnostics &diagnostics,
          bool main_module, std::map<int, ASR::symbol_t*> &ast_overload)
@@ -1769,7 +2240,7 @@ public:
         ASR::expr_t *value = nullptr;
         if (x.m_value) {
             this->visit_expr(*x.m_value);
-            value = ASRUtils::EXPR(tmp);
+            value = retype_constant(ASRUtils::EXPR(tmp), type);
             value = cast_helper(type, value, true);
             if (!ASRUtils::check_equal_type(type, ASRUtils::expr_type(value))) {
                 std::string ltype = ASRUtils::type_to_str_python(type);
@@ -1792,13 +2263,28 @@ public:
         ASR::accessType s_access = ASR::accessType::Public;
         ASR::presenceType s_presence = ASR::presenceType::Required;
         bool value_attr = false;
+        // Only module level constants are kept as the value of the variable,
+        // otherwise the value is assigned where the variable is declared
+        bool in_procedure = current_scope->asr_owner &&
+            ASR::is_a<ASR::symbol_t>(*current_scope->asr_owner) &&
+            (ASR::is_a<ASR::Function_t>(*ASR::down_cast<ASR::symbol_t>(current_scope->asr_owner)) ||
+             ASR::is_a<ASR::Subroutine_t>(*ASR::down_cast<ASR::symbol_t>(current_scope->asr_owner)));
+        bool assign_value = value && (in_procedure ||
+            ASRUtils::expr_value(value) == nullptr || ASR::is_a<ASR::List_t>(*type) ||
+            ASR::is_a<ASR::Dict_t>(*type) || ASR::is_a<ASR::Set_t>(*type) ||
+            ASR::is_a<ASR::Tuple_t>(*type));
         ASR::asr_t *v = ASR::make_Variable_t(al, x.base.base.loc, current_scope,
-                s2c(al, var_name), s_intent, init_expr, value, storage_type, type,
-                current_procedure_abi_type, s_access, s_presence,
+                s2c(al, var_name), s_intent, init_expr, assign_value ? nullptr : value,
+                storage_type, type, current_procedure_abi_type, s_access, s_presence,
                 value_attr);
         current_scope->add_symbol(var_name, ASR::down_cast<ASR::symbol_t>(v));
 
         tmp = nullptr;
+        if (assign_value) {
+            ASR::expr_t *target = ASRUtils::EXPR(ASR::make_Var_t(al,
+                x.m_target->base.loc, ASR::down_cast<ASR::symbol_t>(v)));
+            tmp = ASR::make_Assignment_t(al, x.base.base.loc, target, value, nullptr);
+        }
     }
 
     void visit_Assign(const AST::Assign_t &x) {
@@ -1820,7 +2306,8 @@ public:
             // for every declaration.
             tmp = nullptr;
         } else {
-            ASR::expr_t *value = ASRUtils::EXPR(tmp);
+            ASR::expr_t *value = retype_constant(ASRUtils::EXPR(tmp),
+                ASRUtils::expr_type(target));
             if (!ASRUtils::check_equal_type(ASRUtils::expr_type(target),
                                         ASRUtils::expr_type(value))) {
                 std::string ltype = ASRUtils::type_to_str_python(ASRUtils::expr_type(target));
@@ -1835,16 +2322,62 @@ public:
                 throw SemanticAbort();
             }
             value = cast_helper(ASRUtils::expr_type(target), value, true);
-            ASR::stmt_t *overloaded=nullptr;
-            tmp = ASR::make_Assignment_t(al, x.base.base.loc, target, value,
-                                    overloaded);
+            tmp = make_assignment(target, value, x.base.base.loc);
         }
     }
 
+    // `d[key] = value` inserts into the dict `d`
+    ASR::asr_t* make_assignment(ASR::expr_t *target, ASR::expr_t *value,
+            const Location &loc) {
+        if (ASR::is_a<ASR::DictItem_t>(*target)) {
+            ASR::DictItem_t *item = ASR::down_cast<ASR::DictItem_t>(target);
+            return ASR::make_DictInsert_t(al, loc, item->m_a, item->m_key, value);
+        }
+        if (ASR::is_a<ASR::StringItem_t>(*target) ||
+                ASR::is_a<ASR::StringSection_t>(*target)) {
+            throw SemanticError("'str' object does not support item assignment",
+                target->base.loc);
+        }
+        ASR::stmt_t *overloaded = nullptr;
+        return ASR::make_Assignment_t(al, loc, target, value, overloaded);
+    }
+
+    // `x in container` for dicts and sets, `not in` negates the result
+    ASR::asr_t* make_membership_test(ASR::expr_t *x, ASR::expr_t *container,
+            bool negate, const Location &loc) {
+        ASR::ttype_t *type = ASRUtils::expr_type(container);
+        ASR::ttype_t *logical_type = ASRUtils::TYPE(
+            ASR::make_Logical_t(al, loc, 4, nullptr, 0));
+        ASR::asr_t *test;
+        if (ASR::is_a<ASR::Dict_t>(*type)) {
+            ASR::expr_t *key = make_key(x,
+                ASR::down_cast<ASR::Dict_t>(type)->m_key_type, "keys");
+            test = ASR::make_DictContains_t(al, loc, container, key,
+                logical_type, nullptr);
+        } else if (ASR::is_a<ASR::Set_t>(*type)) {
+            ASR::expr_t *ele = make_key(x,
+                ASR::down_cast<ASR::Set_t>(type)->m_type, "elements");
+            test = ASR::make_SetContains_t(al, loc, container, ele,
+                logical_type, nullptr);
+        } else {
+            throw SemanticError("'in' is only supported for dict and set, not '"
+                + ASRUtils::type_to_str_python(type) + "'", loc);
+        }
+        if (negate) {
+            test = ASR::make_UnaryOp_t(al, loc, ASR::unaryopType::Not,
+                ASRUtils::EXPR(test), logical_type, nullptr);
+        }
+        return test;
+    }
+
     void visit_List(const AST::List_t &x) {
         Vec<ASR::expr_t*> list;
         list.reserve(al, x.n_elts);
         ASR::ttype_t *type = nullptr;
+        if (x.n_elts == 0) {
+            type = ASRUtils::TYPE(ASR::make_Integer_t(al, x.base.base.loc,
+                4, nullptr, 0));
+        }
         for (size_t i=0; i<x.n_elts; i++) {
             this->visit_expr(*x.m_elts[i]);
             ASR::expr_t *expr = ASRUtils::EXPR(tmp);
@@ -1871,6 +2404,7 @@ public:
         for (size_t i=0; i<x.n_elts; i++) {
             this->visit_expr(*x.m_elts[i]);
             ASR::expr_t *expr = ASRUtils::EXPR(tmp);
+            check_tuple_element(ASRUtils::expr_type(expr), expr->base.loc);
             elements.push_back(al, expr);
             tuple_type_vec.push_back(al, ASRUtils::expr_type(expr));
         }
@@ -1932,7 +2466,12 @@ public:
             4, nullptr, 0));
         ASR::expr_t *constant_one = ASR::down_cast<ASR::expr_t>(ASR::make_IntegerConstant_t(
                                             al, x.base.base.loc, 1, a_type));
-        make_BinOp_helper(loop_end, constant_one, ASR::binopType::Sub,
+        // The last value of a `DoLoop` is included, `range(a, b, -1)` ends
+        // at `b + 1`
+        int64_t inc_value = 1;
+        bool negative_inc = inc && get_constant_index(inc, inc_value) && inc_value < 0;
+        make_BinOp_helper(loop_end, constant_one, negative_inc ?
+                            ASR::binopType::Add : ASR::binopType::Sub,
                             x.base.base.loc, false);
         loop_end = ASRUtils::EXPR(tmp);
         ASR::do_loop_head_t head;
@@ -1958,23 +2497,31 @@ public:
         ASR::expr_t *left = ASRUtils::EXPR(tmp);
         this->visit_expr(*x.m_value);
         ASR::expr_t *right = ASRUtils::EXPR(tmp);
-        ASR::binopType op;
-        switch (x.m_op) {
-            case (AST::operatorType::Add) : { op = ASR::binopType::Add; break; }
-            case (AST::operatorType::Sub) : { op = ASR::binopType::Sub; break; }
-            case (AST::operatorType::Mult) : { op = ASR::binopType::Mul; break; }
-            case (AST::operatorType::Div) : { op = ASR::binopType::Div; break; }
-            case (AST::operatorType::Pow) : { op = ASR::binopType::Pow; break; }
-            default : {
-                throw SemanticError("Binary operator type not supported",
-                    x.base.base.loc);
+        if (!make_bitwise_helper(left, right, x.m_op, x.base.base.loc)) {
+            ASR::binopType op;
+            bool floordiv = false;
+            switch (x.m_op) {
+                case (AST::operatorType::Add) : { op = ASR::binopType::Add; break; }
+                case (AST::operatorType::Sub) : { op = ASR::binopType::Sub; break; }
+                case (AST::operatorType::Mult) : { op = ASR::binopType::Mul; break; }
+                case (AST::operatorType::Div) : { op = ASR::binopType::Div; break; }
+                case (AST::operatorType::Pow) : { op = ASR::binopType::Pow; break; }
+                case (AST::operatorType::Mod) : { op = ASR::binopType::Mod; break; }
+                case (AST::operatorType::FloorDiv) : {
+                    op = ASR::binopType::Div;
+                    floordiv = true;
+                    break;
+                }
+                default : {
+                    throw SemanticError("Binary operator type not supported",
+                        x.base.base.loc);
+                }
             }
-        }
 
-        make_BinOp_helper(left, right, op, x.base.base.loc, false);
-        ASR::stmt_t* a_overloaded = nullptr;
+            make_BinOp_helper(left, right, op, x.base.base.loc, floordiv);
+        }
         ASR::expr_t *tmp2 = ASR::down_cast<ASR::expr_t>(tmp);
-        tmp = ASR::make_Assignment_t(al, x.base.base.loc, left, tmp2, a_overloaded);
+        tmp = make_assignment(left, tmp2, x.base.base.loc);
 
     }
 
@@ -2057,6 +2604,12 @@ public:
             }
             keys.push_back(al, key);
         }
+        if (key_type == nullptr) {
+            // `{}`, the type is taken from its use
+            key_type = ASRUtils::TYPE(ASR::make_Integer_t(al, x.base.base.loc,
+                4, nullptr, 0));
+        }
+        check_hashable(key_type, x.base.base.loc);
         Vec<ASR::expr_t*> values;
         values.reserve(al, x.n_values);
         ASR::ttype_t* value_type = nullptr;
@@ -2073,6 +2626,7 @@ public:
             }
             values.push_back(al, value);
         }
+        if (value_type == nullptr) value_type = key_type;
         ASR::ttype_t* type = ASRUtils::TYPE(ASR::make_Dict_t(al, x.base.base.loc,
                                              key_type, value_type));
         tmp = ASR::make_DictConstant_t(al, x.base.base.loc, keys.p, keys.size(),
@@ -2104,6 +2658,11 @@ public:
         }
         this->visit_expr(*x.m_comparators[0]);
         ASR::expr_t *right = ASRUtils::EXPR(tmp);
+        if (x.m_ops == AST::cmpopType::In || x.m_ops == AST::cmpopType::NotIn) {
+            tmp = make_membership_test(left, right, x.m_ops == AST::cmpopType::NotIn,
+                x.base.base.loc);
+            return;
+        }
 
         ASR::cmpopType asr_op;
         switch (x.m_ops) {
@@ -2122,6 +2681,25 @@ public:
         ASR::ttype_t *left_type = ASRUtils::expr_type(left);
         ASR::ttype_t *right_type = ASRUtils::expr_type(right);
         ASR::expr_t *overloaded = nullptr;
+        if (ASR::is_a<ASR::Tuple_t>(*left_type) && ASR::is_a<ASR::Tuple_t>(*right_type)) {
+            // Tuples are compared element by element
+            if (asr_op != ASR::cmpopType::Eq && asr_op != ASR::cmpopType::NotEq) {
+                throw SemanticError("Only '==' and '!=' are supported for tuples",
+                    x.base.base.loc);
+            }
+            left = retype_constant(left, right_type);
+            right = retype_constant(right, ASRUtils::expr_type(left));
+            if (!ASRUtils::check_equal_type(ASRUtils::expr_type(left),
+                    ASRUtils::expr_type(right))) {
+                throw SemanticError("Type mismatch in comparison operator, the types"
+                    " must be compatible", x.base.base.loc);
+            }
+            ASR::ttype_t *type = ASRUtils::TYPE(
+                ASR::make_Logical_t(al, x.base.base.loc, 4, nullptr, 0));
+            tmp = ASR::make_Compare_t(al, x.base.base.loc, left, asr_op, right,
+                type, nullptr, overloaded);
+            return;
+        }
         if (((left_type->type != ASR::ttypeType::Real &&
             left_type->type != ASR::ttypeType::Integer) &&
             (right_type->type != ASR::ttypeType::Real &&
@@ -2324,6 +2902,7 @@ public:
         ASR::asr_t *return_var_ref = ASR::make_Var_t(al, x.base.base.loc, return_var);
         ASR::expr_t *target = ASRUtils::EXPR(return_var_ref);
         ASR::ttype_t *target_type = ASRUtils::expr_type(target);
+        value = retype_constant(value, target_type);
         ASR::ttype_t *value_type = ASRUtils::expr_type(value);
         if (!ASRUtils::check_equal_type(target_type, value_type)) {
             std::string ltype = ASRUtils::type_to_str_python(target_type);
@@ -2381,6 +2960,7 @@ public:
             }
             elements.push_back(al, value);
         }
+        check_hashable(type, x.base.base.loc);
         ASR::ttype_t* set_type = ASRUtils::TYPE(ASR::make_Set_t(al, x.base.base.loc, type));
         tmp = ASR::make_SetConstant_t(al, x.base.base.loc, elements.p, elements.size(), set_type);
     }
@@ -2392,6 +2972,14 @@ public:
             if (AST::is_a<AST::Name_t>(*c->m_func)) {
                 AST::Name_t *n = AST::down_cast<AST::Name_t>(c->m_func);
                 call_name = n->m_id;
+            } else if (AST::is_a<AST::Attribute_t>(*c->m_func)) {
+                // A call of a module procedure, e.g. `random.seed(1)`, or of
+                // a method, e.g. `x.append(1)`
+                visit_Call(*c);
+                if (tmp && ASR::is_a<ASR::expr_t>(*tmp)) {
+                    tmp = make_discarded_value(ASRUtils::EXPR(tmp));
+                }
+                return;
             } else {
                 throw SemanticError("Only Name is supported in Call",
                     x.base.base.loc);
@@ -2441,6 +3029,22 @@ public:
         tmp = nullptr;
     }
 
+    // The value of an expression statement with side effects, e.g.
+    // `x.pop()`, is assigned to a temporary that is never read
+    ASR::asr_t* make_discarded_value(ASR::expr_t *value) {
+        const Location &loc = value->base.loc;
+        std::string name = "__compy_discard_" + std::to_string(discard_counter++);
+        ASR::asr_t *v = ASR::make_Variable_t(al, loc, current_scope,
+            s2c(al, name), ASR::intentType::Local, nullptr, nullptr,
+            ASR::storage_typeType::Default, ASRUtils::expr_type(value),
+            ASR::abiType::Source, ASR::accessType::Public,
+            ASR::presenceType::Required, false);
+        current_scope->add_symbol(name, ASR::down_cast<ASR::symbol_t>(v));
+        ASR::expr_t *target = ASRUtils::EXPR(ASR::make_Var_t(al, loc,
+            ASR::down_cast<ASR::symbol_t>(v)));
+        return ASR::make_Assignment_t(al, loc, target, value, nullptr);
+    }
+
     ASR::asr_t* handle_intrinsic_int(Allocator &al, Vec<ASR::call_arg_t> args,
                                         const Location &loc) {
         ASR::expr_t *arg = nullptr, *value = nullptr;
@@ -2534,6 +3138,96 @@ public:
         return nullptr;
     }
 
+    ASR::asr_t* handle_list_method(ASR::expr_t *list, const std::string &attr,
+            Vec<ASR::call_arg_t> &args, const Location &loc) {
+        ASR::ttype_t *el_type = ASR::down_cast<ASR::List_t>(
+            ASRUtils::expr_type(list))->m_type;
+        auto check_n_args = [&](size_t min_args, size_t max_args) {
+            if (args.size() < min_args || args.size() > max_args) {
+                throw SemanticError(attr + "() takes " + std::to_string(max_args)
+                    + " argument(s) (" + std::to_string(args.size())
+                    + " given)", loc);
+            }
+        };
+        auto element = [&](size_t i) {
+            ASR::expr_t *ele = retype_constant(args[i].m_value, el_type);
+            ele = cast_helper(el_type, ele, true);
+            if (!ASRUtils::check_equal_type(el_type, ASRUtils::expr_type(ele))) {
+                throw SemanticError("Type mismatch: the list elements are of type '"
+                    + ASRUtils::type_to_str_python(el_type) + "'", ele->base.loc);
+            }
+            return ele;
+        };
+        if (attr == "append") {
+            check_n_args(1, 1);
+            return ASR::make_ListAppend_t(al, loc, list, element(0));
+        } else if (attr == "insert") {
+            check_n_args(2, 2);
+            return ASR::make_ListInsert_t(al, loc, list,
+                list_index(args[0].m_value), element(1));
+        } else if (attr == "remove") {
+            check_n_args(1, 1);
+            return ASR::make_ListRemove_t(al, loc, list, element(0));
+        } else if (attr == "pop") {
+            check_n_args(0, 1);
+            ASR::expr_t *index = nullptr;
+            if (args.size() == 1) index = list_index(args[0].m_value);
+            return ASR::make_ListPop_t(al, loc, list, index, el_type, nullptr);
+        }
+        throw SemanticError("'list' object has no attribute '" + attr + "'", loc);
+    }
+
+    ASR::asr_t* handle_dict_method(ASR::expr_t *dict, const std::string &attr,
+            Vec<ASR::call_arg_t> &args, const Location &loc) {
+        ASR::Dict_t *t = ASR::down_cast<ASR::Dict_t>(ASRUtils::expr_type(dict));
+        if (attr == "get") {
+            // `None` is not supported, so the default value is required
+            if (args.size() != 2) {
+                throw SemanticError("get() takes 2 arguments (" +
+                    std::to_string(args.size()) + " given), the default "
+                    "value is required", loc);
+            }
+            ASR::expr_t *def = cast_helper(t->m_value_type,
+                retype_constant(args[1].m_value, t->m_value_type), true);
+            if (!ASRUtils::check_equal_type(t->m_value_type, ASRUtils::expr_type(def))) {
+                throw SemanticError("Type mismatch: the values are of type '"
+                    + ASRUtils::type_to_str_python(t->m_value_type) + "'",
+                    def->base.loc);
+            }
+            return ASR::make_DictItem_t(al, loc, dict, make_key(args[0].m_value,
+                t->m_key_type, "keys"), def, t->m_value_type);
+        } else if (attr == "pop") {
+            if (args.size() != 1) {
+                throw SemanticError("pop() takes 1 argument (" +
+                    std::to_string(args.size()) + " given)", loc);
+            }
+            return ASR::make_DictPop_t(al, loc, dict, make_key(args[0].m_value,
+                t->m_key_type, "keys"), t->m_value_type, nullptr);
+        }
+        throw SemanticError("'dict' object has no attribute '" + attr + "'", loc);
+    }
+
+    ASR::asr_t* handle_set_method(ASR::expr_t *set, const std::string &attr,
+            Vec<ASR::call_arg_t> &args, const Location &loc) {
+        ASR::ttype_t *el_type = ASR::down_cast<ASR::Set_t>(
+            ASRUtils::expr_type(set))->m_type;
+        size_t n_args = attr == "pop" ? 0 : 1;
+        if (args.size() != n_args) {
+            throw SemanticError(attr + "() takes " + std::to_string(n_args) +
+                " argument(s) (" + std::to_string(args.size()) + " given)", loc);
+        }
+        if (attr == "add") {
+            return ASR::make_SetInsert_t(al, loc, set, make_key(args[0].m_value,
+                el_type, "elements"));
+        } else if (attr == "remove") {
+            return ASR::make_SetRemove_t(al, loc, set, make_key(args[0].m_value,
+                el_type, "elements"));
+        } else if (attr == "pop") {
+            return ASR::make_SetPop_t(al, loc, set, el_type, nullptr);
+        }
+        throw SemanticError("'set' object has no attribute '" + attr + "'", loc);
+    }
+
     void visit_Call(const AST::Call_t &x) {
         std::string call_name;
         Vec<ASR::call_arg_t> args;
@@ -2551,7 +3245,34 @@ public:
             call_name = n->m_id;
         } else if (AST::is_a<AST::Attribute_t>(*x.m_func)) {
             AST::Attribute_t *at = AST::down_cast<AST::Attribute_t>(x.m_func);
+            ASR::symbol_t *obj_sym = nullptr;
             if (AST::is_a<AST::Name_t>(*at->m_value)) {
+                obj_sym = current_scope->resolve_symbol(
+                    AST::down_cast<AST::Name_t>(at->m_value)->m_id);
+            }
+            if (!AST::is_a<AST::Name_t>(*at->m_value) ||
+                    (obj_sym && ASR::is_a<ASR::Variable_t>(*obj_sym))) {
+                // A method call, e.g. `x.append(1)` or `x[0].pop()`
+                this->visit_expr(*at->m_value);
+                ASR::expr_t *obj = ASRUtils::EXPR(tmp);
+                ASR::ttype_t *obj_type = ASRUtils::expr_type(obj);
+                if (ASR::is_a<ASR::List_t>(*obj_type)) {
+                    tmp = handle_list_method(obj, at->m_attr, args,
+                        x.base.base.loc);
+                    return;
+                } else if (ASR::is_a<ASR::Dict_t>(*obj_type)) {
+                    tmp = handle_dict_method(obj, at->m_attr, args,
+                        x.base.base.loc);
+                    return;
+                } else if (ASR::is_a<ASR::Set_t>(*obj_type)) {
+                    tmp = handle_set_method(obj, at->m_attr, args,
+                        x.base.base.loc);
+                    return;
+                }
+                throw SemanticError("'" + ASRUtils::type_to_str_python(
+                    ASRUtils::expr_type(obj)) + "' object has no attribute '" +
+                    std::string(at->m_attr) + "'", x.base.base.loc);
+            } else {
                 AST::Name_t *n = AST::down_cast<AST::Name_t>(at->m_value);
                 std::string mod_name = n->m_id;
                 call_name = at->m_attr;
@@ -2563,18 +3284,6 @@ public:
                     SymbolTable *symtab = current_scope;
                     while (symtab->parent != nullptr) symtab = symtab->parent;
                     if (symtab->get_scope().find(mod_name) == symtab->get_scope().end()) {
-                        if (current_scope->get_scope().find(mod_name) != current_scope->get_scope().end()) {
-                            // this case when we have variable and attribute
-                            st = current_scope->get_symbol(mod_name);
-                            Vec<ASR::expr_t*> eles;
-                            eles.reserve(al, x.n_args);
-                            for (size_t i=0; i<x.n_args; i++) {
-                                eles.push_back(al, args[i].m_value);
-                            }
-                            // TODO
-                            // handle_attribute(st, at->m_attr, x.base.base.loc, eles);
-                            return;
-                        }
                         throw SemanticError("module '" + mod_name + "' is not imported",
                             x.base.base.loc);
                     }
@@ -2586,9 +3295,6 @@ public:
                 }
                 tmp = make_call_helper(al, st, current_scope, args, call_name, x.base.base.loc);
                 return;
-            } else {
-                throw SemanticError("Only Name type supported in Call",
-                    x.base.base.loc);
             }
         } else {
             throw SemanticError("Only Name or Attribute type supported in Call",
@@ -2597,6 +3303,68 @@ public:
 
         ASR::symbol_t *s = current_scope->resolve_symbol(call_name);
 
+        if (!s && call_name == "len" && args.size() == 1 &&
+                ASRUtils::is_array(ASRUtils::expr_type(args[0].m_value))) {
+            // The number of elements of an array
+            ASR::ttype_t *a_type = ASRUtils::TYPE(ASR::make_Integer_t(al,
+                x.base.base.loc, 4, nullptr, 0));
+            tmp = ASR::make_ArraySize_t(al, x.base.base.loc, args[0].m_value,
+                nullptr, a_type, nullptr);
+            return;
+        }
+
+        if (!s && call_name == "len" && args.size() == 1 &&
+                ASR::is_a<ASR::List_t>(*ASRUtils::expr_type(args[0].m_value))) {
+            ASR::ttype_t *a_type = ASRUtils::TYPE(ASR::make_Integer_t(al,
+                x.base.base.loc, 4, nullptr, 0));
+            ASR::expr_t *value = nullptr;
+            if (ASR::is_a<ASR::ListConstant_t>(*args[0].m_value)) {
+                value = ASRUtils::EXPR(ASR::make_IntegerConstant_t(al,
+                    x.base.base.loc, ASR::down_cast<ASR::ListConstant_t>(
+                    args[0].m_value)->n_args, a_type));
+            }
+            tmp = ASR::make_ListLen_t(al, x.base.base.loc, args[0].m_value,
+                a_type, value);
+            return;
+        }
+
+        if (!s && call_name == "len" && args.size() == 1 &&
+                !ASRUtils::expr_value(args[0].m_value)) {
+            ASR::ttype_t *arg_type = ASRUtils::expr_type(args[0].m_value);
+            ASR::ttype_t *a_type = ASRUtils::TYPE(ASR::make_Integer_t(al,
+                x.base.base.loc, 4, nullptr, 0));
+            if (ASR::is_a<ASR::Dict_t>(*arg_type)) {
+                tmp = ASR::make_DictLen_t(al, x.base.base.loc, args[0].m_value,
+                    a_type, nullptr);
+                return;
+            } else if (ASR::is_a<ASR::Set_t>(*arg_type)) {
+                tmp = ASR::make_SetLen_t(al, x.base.base.loc, args[0].m_value,
+                    a_type, nullptr);
+                return;
+            } else if (ASR::is_a<ASR::Character_t>(*arg_type) &&
+                    ASR::down_cast<ASR::Character_t>(arg_type)->n_dims == 0) {
+                tmp = ASR::make_StringLen_t(al, x.base.base.loc, args[0].m_value,
+                    a_type, nullptr);
+                return;
+            } else if (ASR::is_a<ASR::Tuple_t>(*arg_type)) {
+                ASR::expr_t *value = ASRUtils::EXPR(ASR::make_IntegerConstant_t(al,
+                    x.base.base.loc, ASR::down_cast<ASR::Tuple_t>(arg_type)->n_type,
+                    a_type));
+                tmp = ASR::make_TupleLen_t(al, x.base.base.loc, args[0].m_value,
+                    a_type, value);
+                return;
+            }
+        }
+
+        if (!s && call_name == "set" && args.size() == 0) {
+            // The empty set, the element type is taken from its use
+            ASR::ttype_t *el_type = ASRUtils::TYPE(ASR::make_Integer_t(al,
+                x.base.base.loc, 4, nullptr, 0));
+            tmp = ASR::make_SetConstant_t(al, x.base.base.loc, nullptr, 0,
+                ASRUtils::TYPE(ASR::make_Set_t(al, x.base.base.loc, el_type)));
+            return;
+        }
+
         if (!s) {
             if (intrinsic_procedures.is_intrinsic(call_name)) {
                 s = resolve_intrinsic_function(x.base.base.loc, call_name);
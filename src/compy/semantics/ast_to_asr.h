@@ -7,6 +7,12 @@
 namespace LFortran::ComPy {
 
     std::string pickle_ast(AST::ast_t &ast, bool colors=false, bool indent=false);
+    Result<std::string> get_full_path(const std::string &filename,
+        const std::string &runtime_library_dir, bool &ltypes, bool &numpy);
+    // Parses the module `infile` and converts it to ASR (a TranslationUnit
+    // with a single Module)
+    Result<ASR::TranslationUnit_t*> compile_module(Allocator &al,
+        const std::string &infile, diag::Diagnostics &diagnostics);
     Result<ASR::TranslationUnit_t*> ast_to_asr(Allocator &al,
     ComPy::AST::ast_t &ast, diag::Diagnostics &diagnostics, bool main_module,
     bool symtab_only);
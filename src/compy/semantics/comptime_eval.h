@@ -37,6 +37,14 @@ struct PythonIntrinsicProcedures {
             {"pow", {m_builtin, &eval_pow}},
             {"round", {m_builtin, &eval_round}},
             {"_mod", {m_builtin, &eval__mod}},
+            {"_compy_floordiv", {m_builtin, &eval__compy_floordiv}},
+            {"_compy_slice_bound", {m_builtin, &eval__compy_slice_bound}},
+            {"divmod", {m_builtin, &eval_divmod}},
+            {"_bitwise_and", {m_builtin, &eval__bitwise_and}},
+            {"_bitwise_or", {m_builtin, &eval__bitwise_or}},
+            {"_bitwise_xor", {m_builtin, &eval__bitwise_xor}},
+            {"_bitwise_lshift", {m_builtin, &eval__bitwise_lshift}},
+            {"_bitwise_rshift", {m_builtin, &eval__bitwise_rshift}},
             {"max" , {m_builtin , &eval_max}},
             {"min" , {m_builtin , &eval_min}}
         };
@@ -104,11 +112,11 @@ struct PythonIntrinsicProcedures {
         if (ASRUtils::is_real(*t)) {
             double rv = ASR::down_cast<ASR::RealConstant_t>(arg)->m_r;
             double val = std::abs(rv);
-            return ASR::down_cast<ASR::expr_t>(ASR::make_RealConstant_t(al, loc, val, real_type));
+            return ASR::down_cast<ASR::expr_t>(ASR::make_RealConstant_t(al, loc, val, t));
         } else if (ASRUtils::is_integer(*t)) {
             int64_t rv = ASR::down_cast<ASR::IntegerConstant_t>(arg)->m_n;
             int64_t val = std::abs(rv);
-            return ASR::down_cast<ASR::expr_t>(ASR::make_IntegerConstant_t(al, loc, val, int_type));
+            return ASR::down_cast<ASR::expr_t>(ASR::make_IntegerConstant_t(al, loc, val, t));
         } else if (ASRUtils::is_logical(*t)) {
             int8_t val = ASR::down_cast<ASR::LogicalConstant_t>(arg)->m_value;
             return ASR::down_cast<ASR::expr_t>(ASR::make_IntegerConstant_t(al, loc, val, int_type));
@@ -198,18 +206,168 @@ struct PythonIntrinsicProcedures {
         if (ASRUtils::is_integer(*type)) {
             int64_t a = ASR::down_cast<ASR::IntegerConstant_t>(arg1)->m_n;
             int64_t b = ASR::down_cast<ASR::IntegerConstant_t>(arg2)->m_n;
+            if (b == 0) {
+                throw SemanticError("integer modulo by zero", loc);
+            }
+            int64_t r = a % b;
+            if (r != 0 && ((r < 0) != (b < 0))) r += b;
             return ASR::down_cast<ASR::expr_t>(
-                ASR::make_IntegerConstant_t(al, loc, a%b, type));
+                ASR::make_IntegerConstant_t(al, loc, r, type));
         } else if (ASRUtils::is_real(*type)) {
             double a = ASR::down_cast<ASR::RealConstant_t>(arg1)->m_r;
             double b = ASR::down_cast<ASR::RealConstant_t>(arg2)->m_r;
+            if (b == 0) {
+                throw SemanticError("float modulo by zero", loc);
+            }
+            // The result has the sign of the divisor, as in Python
+            double r = std::fmod(a, b);
+            if (r != 0 && ((r < 0) != (b < 0))) r += b;
             return ASR::down_cast<ASR::expr_t>(
-                ASR::make_RealConstant_t(al, loc, std::fmod(a, b), type));
+                ASR::make_RealConstant_t(al, loc, r, type));
         } else {
             throw SemanticError("_mod() must have both integer or both real arguments.", loc);
         }
     }
 
+    static ASR::expr_t *eval__compy_floordiv(Allocator &al, const Location &loc, Vec<ASR::expr_t*> &args) {
+        LFORTRAN_ASSERT(ASRUtils::all_args_evaluated(args));
+        if (args.size() != 2) {
+            throw SemanticError("_compy_floordiv() must have two arguments.", loc);
+        }
+        ASR::expr_t* arg1 = args[0], *arg2 = args[1];
+        ASR::ttype_t* type = ASRUtils::expr_type(arg1);
+        if (ASRUtils::is_real(*type) && ASRUtils::is_real(*ASRUtils::expr_type(arg2))) {
+            double a = ASR::down_cast<ASR::RealConstant_t>(arg1)->m_r;
+            double b = ASR::down_cast<ASR::RealConstant_t>(arg2)->m_r;
+            if (b == 0) {
+                throw SemanticError("float floor division by zero", loc);
+            }
+            return ASR::down_cast<ASR::expr_t>(
+                ASR::make_RealConstant_t(al, loc, std::floor(a / b), type));
+        }
+        // Mixed and integer arguments are evaluated at runtime
+        return nullptr;
+    }
+
+    static ASR::expr_t *eval__compy_slice_bound(Allocator &al, const Location &loc, Vec<ASR::expr_t*> &args) {
+        LFORTRAN_ASSERT(ASRUtils::all_args_evaluated(args));
+        if (args.size() != 4) {
+            throw SemanticError("_compy_slice_bound() must have four arguments.", loc);
+        }
+        int64_t v[4];
+        for (size_t i = 0; i < 4; i++) {
+            if (!ASR::is_a<ASR::IntegerConstant_t>(*args[i])) {
+                throw SemanticError("_compy_slice_bound() must have integer arguments.", loc);
+            }
+            v[i] = ASR::down_cast<ASR::IntegerConstant_t>(args[i])->m_n;
+        }
+        int64_t j = v[0], n = v[1];
+        if (j < 0) j += n;
+        if (v[2] > 0) {
+            j = std::max<int64_t>(0, std::min(j, n));
+        } else {
+            j = std::max<int64_t>(-1, std::min(j, n - 1));
+        }
+        return ASR::down_cast<ASR::expr_t>(ASR::make_IntegerConstant_t(al, loc,
+            j + v[3], ASRUtils::expr_type(args[0])));
+    }
+
+    static ASR::expr_t *eval_divmod(Allocator &al, const Location &loc, Vec<ASR::expr_t*> &args) {
+        LFORTRAN_ASSERT(ASRUtils::all_args_evaluated(args));
+        if (args.size() != 2) {
+            throw SemanticError("divmod() takes exactly two arguments (" +
+                std::to_string(args.size()) + " given)", loc);
+        }
+        ASR::ttype_t* type = ASRUtils::expr_type(args[0]);
+        if (!ASRUtils::is_integer(*type) ||
+                !ASRUtils::is_integer(*ASRUtils::expr_type(args[1]))) {
+            // Real arguments are evaluated at runtime
+            return nullptr;
+        }
+        int64_t a = ASR::down_cast<ASR::IntegerConstant_t>(args[0])->m_n;
+        int64_t b = ASR::down_cast<ASR::IntegerConstant_t>(args[1])->m_n;
+        if (b == 0) {
+            throw SemanticError("integer division or modulo by zero", loc);
+        }
+        // The quotient is rounded towards negative infinity, as in Python
+        int64_t q = a / b, r = a % b;
+        if (r != 0 && ((r < 0) != (b < 0))) {
+            q -= 1;
+            r += b;
+        }
+        Vec<ASR::expr_t*> elements;
+        elements.reserve(al, 2);
+        elements.push_back(al, ASR::down_cast<ASR::expr_t>(
+            ASR::make_IntegerConstant_t(al, loc, q, type)));
+        elements.push_back(al, ASR::down_cast<ASR::expr_t>(
+            ASR::make_IntegerConstant_t(al, loc, r, type)));
+        Vec<ASR::ttype_t*> types;
+        types.reserve(al, 2);
+        types.push_back(al, type);
+        types.push_back(al, type);
+        ASR::ttype_t *tuple_type = ASRUtils::TYPE(ASR::make_Tuple_t(al, loc,
+            types.p, types.size()));
+        return ASR::down_cast<ASR::expr_t>(ASR::make_TupleConstant_t(al, loc,
+            elements.p, elements.size(), tuple_type));
+    }
+
+    // Evaluates the bitwise operator `op` with the semantics of a fixed
+    // width integer of the type of the arguments
+    static ASR::expr_t *eval_bitwise(Allocator &al, const Location &loc,
+            Vec<ASR::expr_t*> &args, const std::string &op) {
+        LFORTRAN_ASSERT(ASRUtils::all_args_evaluated(args));
+        if (args.size() != 2) {
+            throw SemanticError("The operator " + op + " takes two integer arguments", loc);
+        }
+        ASR::ttype_t *type = ASRUtils::expr_type(args[0]);
+        int64_t a = ASR::down_cast<ASR::IntegerConstant_t>(args[0])->m_n;
+        int64_t b = ASR::down_cast<ASR::IntegerConstant_t>(args[1])->m_n;
+        int bits = 8*ASRUtils::extract_kind_from_ttype_t(type);
+        int64_t r;
+        if (op == "<<" || op == ">>") {
+            if (b < 0) {
+                throw SemanticError("Negative shift count not allowed.", loc);
+            }
+            if (op == "<<") {
+                r = b >= bits ? 0 : (int64_t)((uint64_t)a << b);
+            } else {
+                r = a >> std::min<int64_t>(b, 63);
+            }
+        } else if (op == "&") {
+            r = a & b;
+        } else if (op == "|") {
+            r = a | b;
+        } else {
+            r = a ^ b;
+        }
+        if (bits < 64) {
+            // Wrap around to the width of the type
+            r = (int64_t)((uint64_t)r << (64 - bits)) >> (64 - bits);
+        }
+        return ASR::down_cast<ASR::expr_t>(
+            ASR::make_IntegerConstant_t(al, loc, r, type));
+    }
+
+    static ASR::expr_t *eval__bitwise_and(Allocator &al, const Location &loc, Vec<ASR::expr_t*> &args) {
+        return eval_bitwise(al, loc, args, "&");
+    }
+
+    static ASR::expr_t *eval__bitwise_or(Allocator &al, const Location &loc, Vec<ASR::expr_t*> &args) {
+        return eval_bitwise(al, loc, args, "|");
+    }
+
+    static ASR::expr_t *eval__bitwise_xor(Allocator &al, const Location &loc, Vec<ASR::expr_t*> &args) {
+        return eval_bitwise(al, loc, args, "^");
+    }
+
+    static ASR::expr_t *eval__bitwise_lshift(Allocator &al, const Location &loc, Vec<ASR::expr_t*> &args) {
+        return eval_bitwise(al, loc, args, "<<");
+    }
+
+    static ASR::expr_t *eval__bitwise_rshift(Allocator &al, const Location &loc, Vec<ASR::expr_t*> &args) {
+        return eval_bitwise(al, loc, args, ">>");
+    }
+
     static ASR::expr_t *eval_len(Allocator &al, const Location &loc, Vec<ASR::expr_t*> &args) {
         LFORTRAN_ASSERT(ASRUtils::all_args_evaluated(args));
         if (args.size() != 1) {
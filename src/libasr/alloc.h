@@ -20,6 +20,7 @@ class Allocator
     void *start;
     size_t current_pos;
     size_t size;
+    size_t size_retired = 0; // Bytes used in the previous (full) chunks
     std::vector<void*> blocks;
 public:
     Allocator(size_t s) {
@@ -64,6 +65,8 @@ public:
     }
 
     void *new_chunk(size_t s) {
+        // `alloc` already advanced `current_pos` past the end of the chunk
+        size_retired += size_current() - align(s);
         size_t snew = std::max(s+ALIGNMENT, 2*size);
         start = malloc(snew);
         blocks.push_back(start);
@@ -113,6 +116,11 @@ public:
     size_t num_chunks() {
         return blocks.size();
     }
+
+    // Total number of bytes allocated so far, in all chunks
+    size_t size_allocated() {
+        return size_retired + size_current();
+    }
 };
 
 #endif
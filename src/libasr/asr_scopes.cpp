@@ -1,5 +1,6 @@
 #include <iomanip>
 #include <sstream>
+#include <atomic>
 
 #include <libasr/asr_scopes.h>
 #include <libasr/asr_utils.h>
@@ -64,11 +65,11 @@ std::string hexify(T i)
     return buf.str();
 }
 
-unsigned int symbol_table_counter = 0;
+// Atomic, because several translation units may be compiled concurrently
+std::atomic<unsigned int> symbol_table_counter{0};
 
 SymbolTable::SymbolTable(SymbolTable *parent) : parent{parent} {
-    symbol_table_counter++;
-    counter = symbol_table_counter;
+    counter = ++symbol_table_counter;
 }
 
 void SymbolTable::reset_global_counter() {
@@ -375,6 +375,18 @@ bool is_op_overloaded(ASR::binopType op, std::string& intrinsic_op_name,
             }
             break;
         }
+        case ASR::binopType::FloorDiv: {
+            if(intrinsic_op_name != "~floordiv") {
+                result = false;
+            }
+            break;
+        }
+        case ASR::binopType::Mod: {
+            if(intrinsic_op_name != "~mod") {
+                result = false;
+            }
+            break;
+        }
     }
     if( result && curr_scope->get_symbol(intrinsic_op_name) == nullptr ) {
         result = false;
@@ -109,6 +109,7 @@ static inline ASR::ttype_t* expr_type(const ASR::expr_t *f)
         case ASR::exprType::ComplexConstant: { return ((ASR::ComplexConstant_t*)f)->m_type; }
         case ASR::exprType::SetConstant: { return ((ASR::SetConstant_t*)f)->m_type; }
         case ASR::exprType::SetLen: { return ((ASR::SetLen_t*)f)->m_type; }
+        case ASR::exprType::SetContains: { return ((ASR::SetContains_t*)f)->m_type; }
         case ASR::exprType::ListConstant: { return ((ASR::ListConstant_t*)f)->m_type; }
         case ASR::exprType::ListConcat: { return ((ASR::ListConcat_t*)f)->m_type; }
         case ASR::exprType::ListLen: { return ((ASR::ListLen_t*)f)->m_type; }
@@ -123,6 +124,7 @@ static inline ASR::ttype_t* expr_type(const ASR::expr_t *f)
         case ASR::exprType::StringSection: { return ((ASR::StringSection_t*)f)->m_type; }
         case ASR::exprType::DictConstant: { return ((ASR::DictConstant_t*)f)->m_type; }
         case ASR::exprType::DictLen: { return ((ASR::DictLen_t*)f)->m_type; }
+        case ASR::exprType::DictContains: { return ((ASR::DictContains_t*)f)->m_type; }
         case ASR::exprType::IntegerBOZ: { return ((ASR::IntegerBOZ_t*)f)->m_type; }
         case ASR::exprType::Var: { return EXPR2VAR(f)->m_type; }
         case ASR::exprType::ArrayRef: { return ((ASR::ArrayRef_t*)f)->m_type; }
@@ -302,9 +304,11 @@ static inline ASR::expr_t* expr_value(ASR::expr_t *f)
         case ASR::exprType::StringItem: { return ASR::down_cast<ASR::StringItem_t>(f)->m_value; }
         case ASR::exprType::StringSection: { return ASR::down_cast<ASR::StringSection_t>(f)->m_value; }
         case ASR::exprType::DictLen: { return ASR::down_cast<ASR::DictLen_t>(f)->m_value; }
+        case ASR::exprType::DictContains: { return ASR::down_cast<ASR::DictContains_t>(f)->m_value; }
         case ASR::exprType::ListLen: { return ASR::down_cast<ASR::ListLen_t>(f)->m_value; }
         case ASR::exprType::TupleLen: { return ASR::down_cast<ASR::TupleLen_t>(f)->m_value; }
         case ASR::exprType::SetLen: { return ASR::down_cast<ASR::SetLen_t>(f)->m_value; }
+        case ASR::exprType::SetContains: { return ASR::down_cast<ASR::SetContains_t>(f)->m_value; }
         case ASR::exprType::StringConcat: { return ASR::down_cast<ASR::StringConcat_t>(f)->m_value; }
         case ASR::exprType::StringRepeat: { return ASR::down_cast<ASR::StringRepeat_t>(f)->m_value; }
         case ASR::exprType::ComplexRe: { return ASR::down_cast<ASR::ComplexRe_t>(f)->m_value; }
@@ -315,7 +319,7 @@ static inline ASR::expr_t* expr_value(ASR::expr_t *f)
         case ASR::exprType::ListPop: { return ASR::down_cast<ASR::ListPop_t>(f)->m_value; }
         case ASR::exprType::DictPop: { return ASR::down_cast<ASR::DictPop_t>(f)->m_value; }
         case ASR::exprType::SetPop: { return ASR::down_cast<ASR::SetPop_t>(f)->m_value; }
-        case ASR::exprType::DictItem: // Drop through
+        case ASR::exprType::DictItem: { return nullptr; }
         case ASR::exprType::ArrayConstant: // Drop through
         case ASR::exprType::IntegerConstant: // Drop through
         case ASR::exprType::RealConstant: // Drop through
@@ -1084,21 +1088,27 @@ inline bool is_same_type_pointer(ASR::ttype_t* source, ASR::ttype_t* dest) {
             }
 
             inline bool check_equal_type(ASR::ttype_t* x, ASR::ttype_t* y) {
+                // The elements of lists, sets and dicts are stored in the
+                // container, so the kinds must be the same as well
+                auto check_equal_element_type = [](ASR::ttype_t *a, ASR::ttype_t *b) {
+                    return extract_kind_from_ttype_t(a) == extract_kind_from_ttype_t(b)
+                        && check_equal_type(a, b);
+                };
                 if (ASR::is_a<ASR::List_t>(*x) && ASR::is_a<ASR::List_t>(*y)) {
                     x = ASR::down_cast<ASR::List_t>(x)->m_type;
                     y = ASR::down_cast<ASR::List_t>(y)->m_type;
-                    return check_equal_type(x, y);
+                    return check_equal_element_type(x, y);
                 } else if (ASR::is_a<ASR::Set_t>(*x) && ASR::is_a<ASR::Set_t>(*y)) {
                     x = ASR::down_cast<ASR::Set_t>(x)->m_type;
                     y = ASR::down_cast<ASR::Set_t>(y)->m_type;
-                    return check_equal_type(x, y);
+                    return check_equal_element_type(x, y);
                 } else if (ASR::is_a<ASR::Dict_t>(*x) && ASR::is_a<ASR::Dict_t>(*y)) {
                     ASR::ttype_t *x_key_type = ASR::down_cast<ASR::Dict_t>(x)->m_key_type;
                     ASR::ttype_t *y_key_type = ASR::down_cast<ASR::Dict_t>(y)->m_key_type;
                     ASR::ttype_t *x_value_type = ASR::down_cast<ASR::Dict_t>(x)->m_value_type;
                     ASR::ttype_t *y_value_type = ASR::down_cast<ASR::Dict_t>(y)->m_value_type;
-                    return (check_equal_type(x_key_type, y_key_type) &&
-                            check_equal_type(x_value_type, y_value_type));
+                    return (check_equal_element_type(x_key_type, y_key_type) &&
+                            check_equal_element_type(x_value_type, y_value_type));
                 } else if (ASR::is_a<ASR::Tuple_t>(*x) && ASR::is_a<ASR::Tuple_t>(*y)) {
                     ASR::Tuple_t *a = ASR::down_cast<ASR::Tuple_t>(x);
                     ASR::Tuple_t *b = ASR::down_cast<ASR::Tuple_t>(y);
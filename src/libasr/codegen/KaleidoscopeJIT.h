@@ -13,6 +13,10 @@
 #ifndef LLVM_EXECUTIONENGINE_ORC_KALEIDOSCOPEJIT_H
 #define LLVM_EXECUTIONENGINE_ORC_KALEIDOSCOPEJIT_H
 
+#include "llvm/Config/llvm-config.h"
+
+#if LLVM_VERSION_MAJOR <= 11
+
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/iterator_range.h"
 #include "llvm/ExecutionEngine/ExecutionEngine.h"
@@ -137,4 +141,121 @@ private:
 } // end namespace orc
 } // end namespace llvm
 
+#else // LLVM_VERSION_MAJOR >= 12
+
+// The legacy ORC layers used above were removed in LLVM 12. This is the same
+// JIT with the same interface, built on top of the ORCv2 layers.
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ExecutionEngine/JITSymbol.h"
+#include "llvm/ExecutionEngine/Orc/CompileUtils.h"
+#include "llvm/ExecutionEngine/Orc/Core.h"
+#include "llvm/ExecutionEngine/Orc/ExecutionUtils.h"
+#include "llvm/ExecutionEngine/Orc/IRCompileLayer.h"
+#include "llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h"
+#include "llvm/ExecutionEngine/Orc/RTDyldObjectLinkingLayer.h"
+#include "llvm/ExecutionEngine/SectionMemoryManager.h"
+#include "llvm/IR/DataLayout.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/MC/SubtargetFeature.h"
+#include "llvm/Target/TargetMachine.h"
+#if LLVM_VERSION_MAJOR >= 13
+#include "llvm/ExecutionEngine/Orc/ExecutorProcessControl.h"
+#endif
+#include <memory>
+#include <string>
+
+namespace llvm {
+namespace orc {
+
+class KaleidoscopeJIT {
+public:
+  // Generates code for the host CPU, unless `CPU` is given. `Features` are
+  // added to the CPU's features.
+  KaleidoscopeJIT(const std::string &CPU = "", const std::string &Features = "")
+      : ES(createExecutionSession()), JTMB(detectHost(CPU, Features)),
+        TM(cantFail(JTMB.createTargetMachine())), DL(TM->createDataLayout()),
+        Mangle(*ES, DL),
+        ObjectLayer(*ES,
+                    []() { return std::make_unique<SectionMemoryManager>(); }),
+        CompileLayer(*ES, ObjectLayer,
+                     std::make_unique<ConcurrentIRCompiler>(JTMB)),
+        MainJD(ES->createBareJITDylib("<main>")),
+        TSCtx(std::make_unique<LLVMContext>()) {
+    if (JTMB.getTargetTriple().isOSBinFormatCOFF()) {
+      ObjectLayer.setOverrideObjectFlagsWithResponsibilityFlags(true);
+      ObjectLayer.setAutoClaimResponsibilityForObjectSymbols(true);
+    }
+    // Resolve the symbols not defined by the added modules (the runtime
+    // library, libc, libm) from the host process
+    MainJD.addGenerator(
+        cantFail(DynamicLibrarySearchGenerator::GetForCurrentProcess(
+            DL.getGlobalPrefix())));
+  }
+
+  ~KaleidoscopeJIT() {
+    if (auto Err = ES->endSession())
+      ES->reportError(std::move(Err));
+  }
+
+  TargetMachine &getTargetMachine() { return *TM; }
+
+  // The module stays in the LLVMContext it was created in, the caller must
+  // keep that context alive as long as this JIT exists. `TSCtx` only
+  // provides the lock that ORC takes while it compiles the module.
+  void addModule(std::unique_ptr<Module> M) {
+    cantFail(CompileLayer.add(MainJD, ThreadSafeModule(std::move(M), TSCtx)));
+  }
+
+  JITSymbol findSymbol(const std::string Name) {
+    auto Sym = ES->lookup({&MainJD}, Mangle(Name));
+    if (!Sym) {
+      consumeError(Sym.takeError());
+      return nullptr;
+    }
+    return JITSymbol(Sym->getAddress(), Sym->getFlags());
+  }
+
+private:
+  static std::unique_ptr<ExecutionSession> createExecutionSession() {
+#if LLVM_VERSION_MAJOR >= 13
+    return std::make_unique<ExecutionSession>(
+        cantFail(SelfExecutorProcessControl::Create()));
+#else
+    return std::make_unique<ExecutionSession>();
+#endif
+  }
+
+  static JITTargetMachineBuilder detectHost(const std::string &CPU,
+                                            const std::string &Features) {
+    JITTargetMachineBuilder JTMB = cantFail(JITTargetMachineBuilder::detectHost());
+    if (!CPU.empty()) {
+      JTMB.setCPU(CPU);
+      JTMB.getFeatures() = SubtargetFeatures();
+    }
+    if (!Features.empty()) {
+      SmallVector<StringRef, 16> Attrs;
+      StringRef(Features).split(Attrs, ",", -1, false);
+      std::vector<std::string> FeatureList(Attrs.begin(), Attrs.end());
+      JTMB.addFeatures(FeatureList);
+    }
+    return JTMB;
+  }
+
+  std::unique_ptr<ExecutionSession> ES;
+  JITTargetMachineBuilder JTMB;
+  std::unique_ptr<TargetMachine> TM;
+  const DataLayout DL;
+  MangleAndInterner Mangle;
+  RTDyldObjectLinkingLayer ObjectLayer;
+  IRCompileLayer CompileLayer;
+  JITDylib &MainJD;
+  ThreadSafeContext TSCtx;
+};
+
+} // end namespace orc
+} // end namespace llvm
+
+#endif // LLVM_VERSION_MAJOR
+
 #endif // LLVM_EXECUTIONENGINE_ORC_KALEIDOSCOPEJIT_H
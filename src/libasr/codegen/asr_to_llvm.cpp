@@ -1,6 +1,7 @@
 #include <iostream>
 #include <memory>
 #include <unordered_map>
+#include <set>
 #include <functional>
 #include <string_view>
 #include <utility>
@@ -21,6 +22,7 @@
 #include <llvm/IR/Intrinsics.h>
 #include <llvm/IR/LegacyPassManager.h>
 #include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/MDBuilder.h>
 #include <llvm/IR/Module.h>
 #include <llvm/IR/Type.h>
 #include <llvm/Support/Casting.h>
@@ -60,8 +62,11 @@
 #include <libasr/pass/unused_functions.h>
 #include <libasr/pass/inline_function_calls.h>
 #include <libasr/pass/dead_code_removal.h>
+#include <libasr/pass/procedure_effects.h>
 #include <libasr/exception.h>
 #include <libasr/asr_utils.h>
+#include <libasr/pass/pass_utils.h>
+#include <libasr/string_utils.h>
 #include <libasr/codegen/llvm_utils.h>
 #include <libasr/codegen/llvm_array_utils.h>
 
@@ -157,22 +162,49 @@ void exit(llvm::LLVMContext &context, llvm::Module &module,
     builder.CreateCall(fn_exit, {exit_code});
 }
 
-void string_init(llvm::LLVMContext &context, llvm::Module &module,
-        llvm::IRBuilder<> &builder, llvm::Value* arg_size, llvm::Value* arg_string) {
-    std::string func_name = "_lfortran_string_init";
-    llvm::Function *fn = module.getFunction(func_name);
-    if (!fn) {
-        llvm::FunctionType *function_type = llvm::FunctionType::get(
-                llvm::Type::getVoidTy(context), {
-                    llvm::Type::getInt32Ty(context),
-                    llvm::Type::getInt8PtrTy(context)
-                }, true);
-        fn = llvm::Function::Create(function_type,
-                llvm::Function::ExternalLinkage, func_name, module);
-    }
-    std::vector<llvm::Value*> args = {arg_size, arg_string};
-    builder.CreateCall(fn, args);
-}
+// Whether the visited statements create temporary strings, these are
+// allocated in the string arena
+class StringTempFinder : public ASR::BaseWalkVisitor<StringTempFinder>
+{
+public:
+    bool found = false;
+
+    void visit_StringConcat(const ASR::StringConcat_t &x) {
+        if (!x.m_value) found = true;
+    }
+
+    void visit_StringRepeat(const ASR::StringRepeat_t &x) {
+        if (!x.m_value) found = true;
+    }
+
+    void visit_StringSection(const ASR::StringSection_t &x) {
+        if (!x.m_value) found = true;
+    }
+
+    void visit_FunctionCall(const ASR::FunctionCall_t &x) {
+        if (ASR::is_a<ASR::Character_t>(*x.m_type) && !x.m_value) {
+            found = true;
+            return;
+        }
+        ASR::BaseWalkVisitor<StringTempFinder>::visit_FunctionCall(x);
+    }
+
+    // `s = s + x` appends in place
+    void visit_Assignment(const ASR::Assignment_t &x) {
+        if (ASR::is_a<ASR::Var_t>(*x.m_target) &&
+                ASR::is_a<ASR::StringConcat_t>(*x.m_value)) {
+            ASR::StringConcat_t *concat = ASR::down_cast<ASR::StringConcat_t>(
+                x.m_value);
+            if (ASR::is_a<ASR::Var_t>(*concat->m_left) &&
+                    ASR::down_cast<ASR::Var_t>(concat->m_left)->m_v ==
+                    ASR::down_cast<ASR::Var_t>(x.m_target)->m_v) {
+                visit_expr(*concat->m_right);
+                return;
+            }
+        }
+        ASR::BaseWalkVisitor<StringTempFinder>::visit_Assignment(x);
+    }
+};
 
 class ASRToLLVMVisitor : public ASR::BaseVisitor<ASRToLLVMVisitor>
 {
@@ -211,10 +243,29 @@ public:
     llvm::BasicBlock *current_loophead, *current_loopend, *proc_return;
     std::string mangle_prefix;
     bool prototype_only;
+    bool naive_complex_div = false; // --fast: skip the scaling in division
+    int64_t stack_array_limit = 65536; // Larger local arrays go on the heap
+    bool contiguous_clones_enabled = false; // -O1 and up, not -Os
     llvm::StructType *complex_type_4, *complex_type_8;
     llvm::StructType *complex_type_4_ptr, *complex_type_8_ptr;
     llvm::PointerType *character_type;
-    llvm::PointerType *list_type;
+    std::map<std::string, llvm::Constant*> string_literals;
+    // The mark of the string arena at the entry of the current function,
+    // nullptr if the function does not create temporary strings
+    llvm::Value *function_arena_mark = nullptr;
+    // The elements of the local arrays of the current function that are on
+    // the heap, freed when it returns
+    std::vector<llvm::Value*> heap_arrays;
+    // An array section passed to a `@ccall` procedure, whose elements are
+    // copied into the contiguous buffer `buf` if `copied` is true
+    struct BindCArrayCopy {
+        llvm::Value *arr, *buf, *copied;
+        int n_dims;
+        bool write_back;
+    };
+    // The copies made for the arguments of the calls being generated, the
+    // arguments of a call can contain other calls
+    std::vector<BindCArrayCopy> bindc_array_copies;
 
     std::unordered_map<std::uint32_t, std::unordered_map<std::string, llvm::Type*>> arr_arg_type_cache;
 
@@ -266,8 +317,25 @@ public:
         in a nested_function before checking if we need to declare stack
         types */
 
+    std::map<const ASR::symbol_t*, ProcedureEffects> proc_effects; /* From
+        the procedure_effects analysis pass, for the attributes of the
+        functions and their arguments */
+    std::map<const ASR::symbol_t*, std::pair<llvm::MDNode*, llvm::MDNode*>>
+        restrict_scopes; /* The alias scope of each array argument of a
+        `@restrict` procedure and the list of the scopes of the other array
+        arguments, for the element accesses in its body */
+    std::map<ASR::symbol_t*, llvm::Function*> contiguous_clones; /* The
+        clones of the procedures that take contiguous arrays, see
+        can_clone_contiguous */
+    std::vector<ASR::symbol_t*> clones_to_generate;
+    llvm::Function *clone_fn = nullptr; // The clone that is generated
+    std::set<uint64_t> contiguous_args; /* The array arguments of the clone
+        that is generated */
+
     std::unique_ptr<LLVMUtils> llvm_utils;
     std::unique_ptr<LLVMArrUtils::Descriptor> arr_descr;
+    std::unique_ptr<LLVMList> list_api;
+    std::unique_ptr<LLVMDict> dict_api;
 
     ASRToLLVMVisitor(Allocator &al, llvm::LLVMContext &context, Platform platform,
         diag::Diagnostics &diagnostics) :
@@ -281,8 +349,13 @@ public:
     arr_descr(LLVMArrUtils::Descriptor::get_descriptor(context,
               builder.get(),
               llvm_utils.get(),
-              LLVMArrUtils::DESCR_TYPE::_SimpleCMODescriptor))
+              LLVMArrUtils::DESCR_TYPE::_SimpleCMODescriptor)),
+    list_api(std::make_unique<LLVMList>(context, llvm_utils.get(),
+              builder.get())),
+    dict_api(std::make_unique<LLVMDict>(context, llvm_utils.get(),
+              builder.get(), list_api.get()))
     {
+        list_api->set_dict_api(dict_api.get());
     }
 
     llvm::Value* CreateLoad(llvm::Value *x) {
@@ -390,7 +463,7 @@ public:
     }
 
     void fill_array_details(llvm::Value* arr, ASR::dimension_t* m_dims,
-        int n_dims) {
+        int n_dims, llvm::Value* data=nullptr) {
         std::vector<std::pair<llvm::Value*, llvm::Value*>> llvm_dims;
         for( int r = 0; r < n_dims; r++ ) {
             ASR::dimension_t m_dim = m_dims[r];
@@ -400,7 +473,186 @@ public:
             llvm::Value* end = tmp;
             llvm_dims.push_back(std::make_pair(start, end));
         }
-        arr_descr->fill_array_details(arr, m_dims, n_dims, llvm_dims);
+        arr_descr->fill_array_details(arr, m_dims, n_dims, llvm_dims, data);
+    }
+
+    /*
+    The elements of a local array whose size is known at compile time. Up
+    to `stack_array_limit` bytes they are on the stack, a larger array of a
+    procedure or the main program is on the heap and freed when it returns.
+    Both are aligned to 64 bytes, so that the vectorizer can use aligned
+    loads. Returns nullptr for the other arrays, whose elements are put on
+    the stack by `fill_array_details`.
+    */
+    llvm::Value* allocate_local_array(ASR::Variable_t *v) {
+        int64_t size = PassUtils::get_fixed_array_size(v);
+        if (size < 0) {
+            return nullptr;
+        }
+        llvm::Type *el_type = get_el_type(v->m_type,
+            ASRUtils::extract_kind_from_ttype_t(v->m_type));
+        ASR::symbol_t *owner = ASR::down_cast<ASR::symbol_t>(
+            v->m_parent_symtab->asr_owner);
+        bool heap = size > stack_array_limit && v->m_intent == intent_local &&
+            (is_a<ASR::Function_t>(*owner) || is_a<ASR::Subroutine_t>(*owner) ||
+             is_a<ASR::Program_t>(*owner));
+        if (!heap) {
+            if (size < 64) {
+                return nullptr;
+            }
+            uint64_t n = size / module->getDataLayout().getTypeAllocSize(el_type);
+            llvm::AllocaInst *data = builder->CreateAlloca(el_type,
+                llvm::ConstantInt::get(context, llvm::APInt(32, n)));
+            data->setAlignment(llvm::Align(64));
+            return data;
+        }
+        llvm::Value *data = array_alloc(
+            llvm::ConstantInt::get(context, llvm::APInt(64, size)));
+        heap_arrays.push_back(data);
+        return builder->CreateBitCast(data, el_type->getPointerTo());
+    }
+
+    // Allocates `n_bytes` (i64) for array elements on the heap
+    llvm::Value* array_alloc(llvm::Value *n_bytes) {
+        llvm::Function *fn = list_api->get_runtime_function(*module,
+            "_lfortran_array_alloc", llvm::FunctionType::get(
+            llvm::Type::getInt8PtrTy(context), {llvm::Type::getInt64Ty(context)},
+            false));
+#if LLVM_VERSION_MAJOR >= 14
+        fn->addRetAttr(llvm::Attribute::NoAlias);
+        fn->addRetAttr(llvm::Attribute::getWithAlignment(context, llvm::Align(64)));
+#else
+        fn->addAttribute(llvm::AttributeList::ReturnIndex, llvm::Attribute::NoAlias);
+        fn->addAttribute(llvm::AttributeList::ReturnIndex,
+            llvm::Attribute::getWithAlignment(context, llvm::Align(64)));
+#endif
+        return builder->CreateCall(fn, {n_bytes});
+    }
+
+    void free_heap_arrays() {
+        for (llvm::Value *data : heap_arrays) {
+            lfortran_str_call("_lfortran_array_free",
+                llvm::Type::getVoidTy(context), {data});
+        }
+        heap_arrays.clear();
+    }
+
+    /*
+    C expects the elements of an array argument to be contiguous, but a
+    section such as `x[::2]` is a view with the strides of the section
+    into the elements of `x`. The elements of an array whose strides are
+    not those of a contiguous array are copied into a buffer for the call
+    of a `@ccall` procedure, and copied back after it returns unless the
+    argument is `intent(in)`. A contiguous array is passed as a pointer to
+    its first element, its strides are checked at runtime, as an argument
+    can be either.
+    */
+    llvm::Value* get_bindc_array_data(llvm::Value *arr, int n_dims,
+            bool write_back) {
+        llvm::Value *data = get_array_data(arr);
+        llvm::Value *first = llvm_utils->create_ptr_gep(data,
+            arr_descr->get_offset(arr));
+        llvm::Value *dims = arr_descr->get_pointer_to_dimension_descriptor_array(arr);
+        llvm::Value *n = llvm::ConstantInt::get(context, llvm::APInt(32, 1));
+        llvm::Value *contiguous = llvm::ConstantInt::getTrue(context);
+        for (int r = 0; r < n_dims; r++) {
+            llvm::Value *dim = llvm_utils->create_ptr_gep(dims, r);
+            contiguous = builder->CreateAnd(contiguous,
+                builder->CreateICmpEQ(arr_descr->get_stride(dim), n));
+            n = builder->CreateMul(n, arr_descr->get_dimension_size(dims,
+                llvm::ConstantInt::get(context, llvm::APInt(32, r))));
+        }
+        llvm::BasicBlock *entryBB = builder->GetInsertBlock();
+        llvm::BasicBlock *copyBB = llvm::BasicBlock::Create(context, "bindc.array.copy");
+        llvm::BasicBlock *contBB = llvm::BasicBlock::Create(context, "bindc.array");
+        builder->CreateCondBr(contiguous, contBB, copyBB);
+        start_new_block(copyBB);
+        llvm::Type *el_type = first->getType()->getContainedType(0);
+        llvm::Value *n_bytes = builder->CreateMul(builder->CreateZExt(n,
+            llvm::Type::getInt64Ty(context)), llvm::ConstantExpr::getSizeOf(el_type));
+        llvm::Value *buf = builder->CreateBitCast(array_alloc(n_bytes),
+            first->getType());
+        copy_section_elements(arr, n_dims, buf, true);
+        copyBB = builder->GetInsertBlock();
+        start_new_block(contBB);
+        llvm::PHINode *ptr = builder->CreatePHI(first->getType(), 2);
+        ptr->addIncoming(first, entryBB);
+        ptr->addIncoming(buf, copyBB);
+        llvm::PHINode *copied = builder->CreatePHI(
+            llvm::Type::getInt1Ty(context), 2);
+        copied->addIncoming(llvm::ConstantInt::getFalse(context), entryBB);
+        copied->addIncoming(llvm::ConstantInt::getTrue(context), copyBB);
+        bindc_array_copies.push_back({arr, ptr, copied, n_dims, write_back});
+        return ptr;
+    }
+
+    // A pointer to the element of `arr` at offset 0
+    llvm::Value* get_array_data(llvm::Value *arr) {
+        llvm::Value *data = arr_descr->get_pointer_to_data(arr);
+        if (!data->getType()->getContainedType(0)->isArrayTy()) {
+            data = CreateLoad(data);
+        }
+        if (data->getType()->getContainedType(0)->isArrayTy()) {
+            data = llvm_utils->create_gep(data, 0);
+        }
+        return data;
+    }
+
+    // Copies the elements of the array `arr` into the contiguous `buf`, or
+    // back from it, in column-major order
+    void copy_section_elements(llvm::Value *arr, int n_dims, llvm::Value *buf,
+            bool to_buf) {
+        llvm::Value *data = get_array_data(arr);
+        llvm::Value *offset = arr_descr->get_offset(arr);
+        llvm::Value *dims = arr_descr->get_pointer_to_dimension_descriptor_array(arr);
+        std::vector<llvm::Value*> strides, sizes;
+        llvm::Value *n = llvm::ConstantInt::get(context, llvm::APInt(32, 1));
+        for (int r = 0; r < n_dims; r++) {
+            strides.push_back(arr_descr->get_stride(
+                llvm_utils->create_ptr_gep(dims, r)));
+            sizes.push_back(arr_descr->get_dimension_size(dims,
+                llvm::ConstantInt::get(context, llvm::APInt(32, r))));
+            n = builder->CreateMul(n, sizes[r]);
+        }
+        list_api->create_loop(n, [&](llvm::Value *i) {
+            // The index of the i-th element in each dimension
+            llvm::Value *idx = offset, *rest = i;
+            for (int r = 0; r < n_dims; r++) {
+                llvm::Value *i_r = rest;
+                if (r + 1 < n_dims) {
+                    i_r = builder->CreateSRem(rest, sizes[r]);
+                    rest = builder->CreateSDiv(rest, sizes[r]);
+                }
+                idx = builder->CreateAdd(idx, builder->CreateMul(i_r, strides[r]));
+            }
+            llvm::Value *el = llvm_utils->create_ptr_gep(data, idx);
+            llvm::Value *buf_el = llvm_utils->create_ptr_gep(buf, i);
+            if (to_buf) {
+                builder->CreateStore(CreateLoad(el), buf_el);
+            } else {
+                builder->CreateStore(CreateLoad(buf_el), el);
+            }
+        });
+    }
+
+    // Copies back and frees the buffers of the array sections passed to a
+    // `@ccall` procedure after the call, from `bindc_array_copies[start]`
+    void finish_bindc_array_copies(size_t start) {
+        for (size_t i = start; i < bindc_array_copies.size(); i++) {
+            BindCArrayCopy &c = bindc_array_copies[i];
+            llvm::BasicBlock *copyBB = llvm::BasicBlock::Create(context, "bindc.array.copyback");
+            llvm::BasicBlock *contBB = llvm::BasicBlock::Create(context, "bindc.array.end");
+            builder->CreateCondBr(c.copied, copyBB, contBB);
+            start_new_block(copyBB);
+            if (c.write_back) {
+                copy_section_elements(c.arr, c.n_dims, c.buf, false);
+            }
+            lfortran_str_call("_lfortran_array_free",
+                llvm::Type::getVoidTy(context), {builder->CreateBitCast(c.buf,
+                llvm::Type::getInt8PtrTy(context))});
+            start_new_block(contBB);
+        }
+        bindc_array_copies.resize(start);
     }
 
     /*
@@ -672,14 +924,11 @@ public:
     * ====
     *
     * Internally the call to this function gets transformed into a runtime call:
-    * void _lfortran_complex_add(complex* a, complex* b, complex *result)
+    * void _lfortran_complex_pow(complex* a, complex* b, complex *result)
     *
     * As of now the following values for func_name are supported,
     *
-    * _lfortran_complex_add
-    * _lfortran_complex_sub
-    * _lfortran_complex_div
-    * _lfortran_complex_mul
+    * _lfortran_complex_pow
     */
     llvm::Value* lfortran_complex_bin_op(llvm::Value* left_arg, llvm::Value* right_arg,
                                          std::string runtime_func_name,
@@ -715,160 +964,174 @@ public:
     }
 
 
-    llvm::Value* lfortran_strop(llvm::Value* left_arg, llvm::Value* right_arg,
-                                         std::string runtime_func_name)
-    {
-        llvm::Function *fn = module->getFunction(runtime_func_name);
-        if (!fn) {
-            llvm::FunctionType *function_type = llvm::FunctionType::get(
-                    llvm::Type::getVoidTy(context), {
-                        character_type->getPointerTo(),
-                        character_type->getPointerTo(),
-                        character_type->getPointerTo()
-                    }, false);
-            fn = llvm::Function::Create(function_type,
-                    llvm::Function::ExternalLinkage, runtime_func_name, *module);
-        }
-        llvm::AllocaInst *pleft_arg = builder->CreateAlloca(character_type,
-            nullptr);
-        builder->CreateStore(left_arg, pleft_arg);
-        llvm::AllocaInst *pright_arg = builder->CreateAlloca(character_type,
-            nullptr);
-        builder->CreateStore(right_arg, pright_arg);
-        llvm::AllocaInst *presult = builder->CreateAlloca(character_type,
-            nullptr);
-        std::vector<llvm::Value*> args = {pleft_arg, pright_arg, presult};
-        builder->CreateCall(fn, args);
-        return CreateLoad(presult);
+    // Strings are `char*` to the characters that follow a header
+    // `{char** owner, i64 cap, i64 len}` (see compy_intrinsics.c). The
+    // operations that create strings return temporaries in the string arena.
+    llvm::Value* lfortran_str_call(const std::string &runtime_func_name,
+            llvm::Type *return_type, const std::vector<llvm::Value*> &args) {
+        std::vector<llvm::Type*> arg_types;
+        for (auto &arg : args) arg_types.push_back(arg->getType());
+        llvm::Function *fn = list_api->get_runtime_function(*module,
+            runtime_func_name, llvm::FunctionType::get(return_type,
+            arg_types, false));
+        return builder->CreateCall(fn, args);
     }
 
-    llvm::Value* lfortran_strrepeat(llvm::Value* left_arg, llvm::Value* right_arg)
+    // The length is the eight bytes before the characters
+    llvm::Value* lfortran_str_len(llvm::Value* str)
     {
-        std::string runtime_func_name = "_lfortran_strrepeat";
-        llvm::Function *fn = module->getFunction(runtime_func_name);
-        if (!fn) {
-            llvm::FunctionType *function_type = llvm::FunctionType::get(
-                    llvm::Type::getVoidTy(context), {
-                        character_type->getPointerTo(),
-                        llvm::Type::getInt32Ty(context),
-                        character_type->getPointerTo()
-                    }, false);
-            fn = llvm::Function::Create(function_type,
-                    llvm::Function::ExternalLinkage, runtime_func_name, *module);
+        llvm::Type *i64 = llvm::Type::getInt64Ty(context);
+        llvm::Value *len = CreateLoad(llvm_utils->create_ptr_gep(
+            builder->CreateBitCast(str, i64->getPointerTo()), -1));
+        return builder->CreateTrunc(len, llvm::Type::getInt32Ty(context));
+    }
+
+    // A literal is a constant with a static header, equal literals are
+    // emitted once
+    llvm::Constant* get_string_literal(const std::string &s) {
+        auto it = string_literals.find(s);
+        if (it != string_literals.end()) return it->second;
+        llvm::Type *i32 = llvm::Type::getInt32Ty(context);
+        llvm::Type *i64 = llvm::Type::getInt64Ty(context);
+        llvm::Constant *init = llvm::ConstantStruct::getAnon(context, {
+            llvm::Constant::getNullValue(character_type->getPointerTo()),
+            llvm::ConstantInt::get(i64, -1, true),
+            llvm::ConstantInt::get(i64, s.size()),
+            llvm::ConstantDataArray::getString(context, s)});
+        llvm::GlobalVariable *g = new llvm::GlobalVariable(*module,
+            init->getType(), true, llvm::GlobalValue::PrivateLinkage, init,
+            ".str");
+        g->setUnnamedAddr(llvm::GlobalValue::UnnamedAddr::Global);
+        g->setAlignment(llvm::Align(8));
+        llvm::Constant *zero = llvm::ConstantInt::get(i32, 0);
+        llvm::Constant *idx[3] = {zero, llvm::ConstantInt::get(i32, 3), zero};
+        llvm::Constant *ptr = llvm::ConstantExpr::getInBoundsGetElementPtr(
+            init->getType(), g, idx);
+        string_literals[s] = ptr;
+        return ptr;
+    }
+
+    llvm::Value* string_arena_mark() {
+        return lfortran_str_call("_lfortran_str_arena_mark", character_type, {});
+    }
+
+    void string_arena_release(llvm::Value *mark) {
+        lfortran_str_call("_lfortran_str_arena_release",
+            llvm::Type::getVoidTy(context), {mark});
+    }
+
+    // Frees the buffers owned by the local string variables of a function
+    // that returns
+    void free_local_strings(SymbolTable *symtab) {
+        for (auto &item : symtab->get_scope()) {
+            if (!is_a<ASR::Variable_t>(*item.second)) continue;
+            ASR::Variable_t *v = down_cast<ASR::Variable_t>(item.second);
+            if ((v->m_intent != intent_local && v->m_intent != intent_return_var)
+                    || !is_a<ASR::Character_t>(*v->m_type)) continue;
+            uint32_t h = get_hash((ASR::asr_t*)v);
+            if (llvm_symtab.find(h) == llvm_symtab.end() ||
+                    llvm_symtab[h]->getType() != character_type->getPointerTo()) {
+                continue;
+            }
+            lfortran_str_call("_lfortran_str_free",
+                llvm::Type::getVoidTy(context), {llvm_symtab[h]});
         }
-        llvm::AllocaInst *pleft_arg = builder->CreateAlloca(character_type,
-            nullptr);
-        builder->CreateStore(left_arg, pleft_arg);
-        llvm::AllocaInst *presult = builder->CreateAlloca(character_type,
-            nullptr);
-        std::vector<llvm::Value*> args = {pleft_arg, right_arg, presult};
-        builder->CreateCall(fn, args);
-        return CreateLoad(presult);
     }
 
-    llvm::Value* lfortran_str_len(llvm::Value* str)
-    {
-        std::string runtime_func_name = "_lfortran_str_len";
-        llvm::Function *fn = module->getFunction(runtime_func_name);
-        if (!fn) {
-            llvm::FunctionType *function_type = llvm::FunctionType::get(
-                    llvm::Type::getInt32Ty(context), {
-                        character_type->getPointerTo()
-                    }, false);
-            fn = llvm::Function::Create(function_type,
-                    llvm::Function::ExternalLinkage, runtime_func_name, *module);
+    // Frees the buffers owned by the local list, dict and set variables of
+    // a function that returns, including those of the nested containers
+    void free_local_containers(SymbolTable *symtab) {
+        for (auto &item : symtab->get_scope()) {
+            if (!is_a<ASR::Variable_t>(*item.second)) continue;
+            ASR::Variable_t *v = down_cast<ASR::Variable_t>(item.second);
+            if (v->m_intent != intent_local || !is_container(v->m_type)) {
+                continue;
+            }
+            uint32_t h = get_hash((ASR::asr_t*)v);
+            if (llvm_symtab.find(h) == llvm_symtab.end()) continue;
+            list_api->deepfree(llvm_symtab[h], *module);
         }
-        return builder->CreateCall(fn, {str});
     }
 
-    llvm::Value* lfortran_str_copy(llvm::Value* str, llvm::Value* idx1, llvm::Value* idx2)
-    {
-        std::string runtime_func_name = "_lfortran_str_copy";
-        llvm::Function *fn = module->getFunction(runtime_func_name);
-        if (!fn) {
-            llvm::FunctionType *function_type = llvm::FunctionType::get(
-                    character_type, {
-                        character_type, llvm::Type::getInt32Ty(context), llvm::Type::getInt32Ty(context)
-                    }, false);
-            fn = llvm::Function::Create(function_type,
-                    llvm::Function::ExternalLinkage, runtime_func_name, *module);
+    bool creates_string_temporaries(ASR::stmt_t **stmts, size_t n) {
+        StringTempFinder finder;
+        for (size_t i = 0; i < n && !finder.found; i++) {
+            finder.visit_stmt(*stmts[i]);
         }
-        return builder->CreateCall(fn, {str, idx1, idx2});
+        return finder.found;
     }
 
-    llvm::Value* lcompilers_list_init_i32()
-    {
-        std::string runtime_func_name = "_lcompilers_list_init_i32";
-        llvm::Function *fn = module->getFunction(runtime_func_name);
-        if (!fn) {
-            llvm::FunctionType *function_type = llvm::FunctionType::get(
-                    list_type, { }, false);
-            fn = llvm::Function::Create(function_type,
-                    llvm::Function::ExternalLinkage, runtime_func_name, *module);
+    static bool is_container(ASR::ttype_t *type) {
+        return ASR::is_a<ASR::List_t>(*type) || ASR::is_a<ASR::Dict_t>(*type) ||
+            ASR::is_a<ASR::Set_t>(*type);
+    }
+
+    // The LLVM type of a list, dict or set
+    llvm::Type* get_container_type(ASR::ttype_t *type) {
+        switch (type->type) {
+            case ASR::ttypeType::List: {
+                ASR::ttype_t *el_type = ASR::down_cast<ASR::List_t>(type)->m_type;
+                return list_api->get_list_type(get_container_el_type(el_type),
+                    ASRUtils::type_to_str_python(el_type));
+            }
+            case ASR::ttypeType::Dict: {
+                ASR::Dict_t *t = ASR::down_cast<ASR::Dict_t>(type);
+                return dict_api->get_dict_type(get_container_el_type(t->m_key_type),
+                    get_container_el_type(t->m_value_type),
+                    ASRUtils::type_to_str_python(t->m_key_type) + "_" +
+                    ASRUtils::type_to_str_python(t->m_value_type));
+            }
+            case ASR::ttypeType::Set: {
+                ASR::ttype_t *el_type = ASR::down_cast<ASR::Set_t>(type)->m_type;
+                return dict_api->get_set_type(get_container_el_type(el_type),
+                    ASRUtils::type_to_str_python(el_type));
+            }
+            default:
+                LFORTRAN_ASSERT(false);
+                return nullptr;
         }
-        return builder->CreateCall(fn, {});
     }
 
-    void lcompilers_list_append_i32(llvm::Value* plist, llvm::Value *item)
-    {
-        std::string runtime_func_name = "_lcompilers_list_append_i32";
-        llvm::Function *fn = module->getFunction(runtime_func_name);
-        if (!fn) {
-            llvm::FunctionType *function_type = llvm::FunctionType::get(
-                    llvm::Type::getVoidTy(context), {
-                        list_type, llvm::Type::getInt32Ty(context)
-                    }, false);
-            fn = llvm::Function::Create(function_type,
-                    llvm::Function::ExternalLinkage, runtime_func_name, *module);
+    // A tuple is a literal struct of its elements, it is passed around as a
+    // first class value so that it lives in registers
+    llvm::StructType* get_tuple_type(ASR::ttype_t *type) {
+        ASR::Tuple_t *t = ASR::down_cast<ASR::Tuple_t>(type);
+        std::vector<llvm::Type*> el_types;
+        for (size_t i = 0; i < t->n_type; i++) {
+            el_types.push_back(get_container_el_type(t->m_type[i]));
         }
-        builder->CreateCall(fn, {plist, item});
+        return llvm::StructType::get(context, el_types);
     }
 
-    llvm::Value* lcompilers_list_item_i32(llvm::Value* plist, llvm::Value *pos)
-    {
-        std::string runtime_func_name = "_lcompilers_list_item_i32";
-        llvm::Function *fn = module->getFunction(runtime_func_name);
-        if (!fn) {
-            llvm::FunctionType *function_type = llvm::FunctionType::get(
-                    llvm::Type::getInt32Ty(context), {
-                        list_type, llvm::Type::getInt32Ty(context)
-                    }, false);
-            fn = llvm::Function::Create(function_type,
-                    llvm::Function::ExternalLinkage, runtime_func_name, *module);
+    // The elements of containers are stored by value, nested containers
+    // are owned by the outer one
+    llvm::Type* get_container_el_type(ASR::ttype_t *type) {
+        if (is_container(type)) return get_container_type(type);
+        if (ASR::is_a<ASR::Tuple_t>(*type)) return get_tuple_type(type);
+        llvm::Type *el_type = get_el_type(type,
+            ASRUtils::extract_kind_from_ttype_t(type));
+        if (el_type == nullptr) {
+            throw CodeGenError("Element type '" +
+                ASRUtils::type_to_str_python(type) + "' not supported");
         }
-        return builder->CreateCall(fn, {plist, pos});
+        return el_type;
     }
 
     // This function is called as:
     // float complex_re(complex a)
     // And it extracts the real part of the complex number
-    llvm::Value *complex_re(llvm::Value *c, llvm::Type* complex_type=nullptr) {
-        if( complex_type == nullptr ) {
-            complex_type = complex_type_4;
-        }
+    llvm::Value *complex_re(llvm::Value *c) {
         if( c->getType()->isPointerTy() ) {
             c = CreateLoad(c);
         }
-        llvm::AllocaInst *pc = builder->CreateAlloca(complex_type, nullptr);
-        builder->CreateStore(c, pc);
-        std::vector<llvm::Value *> idx = {
-            llvm::ConstantInt::get(context, llvm::APInt(32, 0)),
-            llvm::ConstantInt::get(context, llvm::APInt(32, 0))};
-        llvm::Value *pim = CreateGEP(pc, idx);
-        return CreateLoad(pim);
+        return builder->CreateExtractValue(c, 0);
     }
 
-    llvm::Value *complex_im(llvm::Value *c, llvm::Type* complex_type=nullptr) {
-        if( complex_type == nullptr ) {
-            complex_type = complex_type_4;
+    llvm::Value *complex_im(llvm::Value *c) {
+        if( c->getType()->isPointerTy() ) {
+            c = CreateLoad(c);
         }
-        llvm::AllocaInst *pc = builder->CreateAlloca(complex_type, nullptr);
-        builder->CreateStore(c, pc);
-        std::vector<llvm::Value *> idx = {
-            llvm::ConstantInt::get(context, llvm::APInt(32, 0)),
-            llvm::ConstantInt::get(context, llvm::APInt(32, 1))};
-        llvm::Value *pim = CreateGEP(pc, idx);
-        return CreateLoad(pim);
+        return builder->CreateExtractValue(c, 1);
     }
 
     llvm::Value *complex_from_floats(llvm::Value *re, llvm::Value *im,
@@ -876,18 +1139,48 @@ public:
         if( complex_type == nullptr ) {
             complex_type = complex_type_4;
         }
-        llvm::AllocaInst *pres = builder->CreateAlloca(complex_type, nullptr);
-        std::vector<llvm::Value *> idx1 = {
-            llvm::ConstantInt::get(context, llvm::APInt(32, 0)),
-            llvm::ConstantInt::get(context, llvm::APInt(32, 0))};
-        std::vector<llvm::Value *> idx2 = {
-            llvm::ConstantInt::get(context, llvm::APInt(32, 0)),
-            llvm::ConstantInt::get(context, llvm::APInt(32, 1))};
-        llvm::Value *pre = CreateGEP(pres, idx1);
-        llvm::Value *pim = CreateGEP(pres, idx2);
-        builder->CreateStore(re, pre);
-        builder->CreateStore(im, pim);
-        return CreateLoad(pres);
+        llvm::Value *res = llvm::UndefValue::get(complex_type);
+        res = builder->CreateInsertValue(res, re, 0);
+        return builder->CreateInsertValue(res, im, 1);
+    }
+
+    // Divides (a + bi) by (c + di). The naive formula overflows and
+    // underflows in the intermediate c*c + d*d, so by default Smith's
+    // algorithm is used, written with selects instead of branches so that
+    // loops over complex arrays stay vectorizable:
+    //
+    //     swap = |c| < |d|, (p, q, x, y) = swap ? (d, c, b, a) : (c, d, a, b)
+    //     r = q/p, den = p + q*r
+    //     re = (x + y*r)/den, im = +-(y - x*r)/den (negative when swapped)
+    llvm::Value *complex_div(llvm::Value *left, llvm::Value *right,
+            llvm::Type *complex_type) {
+        llvm::Value *a = complex_re(left), *b = complex_im(left);
+        llvm::Value *c = complex_re(right), *d = complex_im(right);
+        if (naive_complex_div) {
+            llvm::Value *den = builder->CreateFAdd(builder->CreateFMul(c, c),
+                builder->CreateFMul(d, d));
+            llvm::Value *re = builder->CreateFAdd(builder->CreateFMul(a, c),
+                builder->CreateFMul(b, d));
+            llvm::Value *im = builder->CreateFSub(builder->CreateFMul(b, c),
+                builder->CreateFMul(a, d));
+            return complex_from_floats(builder->CreateFDiv(re, den),
+                builder->CreateFDiv(im, den), complex_type);
+        }
+        llvm::Value *swap = builder->CreateFCmpOLT(
+            builder->CreateUnaryIntrinsic(llvm::Intrinsic::fabs, c),
+            builder->CreateUnaryIntrinsic(llvm::Intrinsic::fabs, d));
+        llvm::Value *p = builder->CreateSelect(swap, d, c);
+        llvm::Value *q = builder->CreateSelect(swap, c, d);
+        llvm::Value *x = builder->CreateSelect(swap, b, a);
+        llvm::Value *y = builder->CreateSelect(swap, a, b);
+        llvm::Value *r = builder->CreateFDiv(q, p);
+        llvm::Value *den = builder->CreateFAdd(p, builder->CreateFMul(q, r));
+        llvm::Value *re = builder->CreateFDiv(
+            builder->CreateFAdd(x, builder->CreateFMul(y, r)), den);
+        llvm::Value *im = builder->CreateFDiv(
+            builder->CreateFSub(y, builder->CreateFMul(x, r)), den);
+        im = builder->CreateSelect(swap, builder->CreateFNeg(im), im);
+        return complex_from_floats(re, im, complex_type);
     }
 
     llvm::Value *nested_struct_rd(std::vector<llvm::Value*> vals,
@@ -947,7 +1240,6 @@ public:
         complex_type_4_ptr = llvm::StructType::create(context, els_4_ptr, "complex_4_ptr");
         complex_type_8_ptr = llvm::StructType::create(context, els_8_ptr, "complex_8_ptr");
         character_type = llvm::Type::getInt8PtrTy(context);
-        list_type = llvm::Type::getInt8PtrTy(context);
 
         llvm::Type* bound_arg = static_cast<llvm::Type*>(arr_descr->get_dimension_descriptor_type(true));
         fname2arg_type["lbound"] = std::make_pair(bound_arg, bound_arg->getPointerTo());
@@ -1014,6 +1306,8 @@ public:
                 visit_symbol(*item.second);
             }
         }
+
+        generate_contiguous_clones();
     }
 
     void visit_Allocate(const ASR::Allocate_t& x) {
@@ -1103,54 +1397,254 @@ public:
         _Deallocate<ASR::ExplicitDeallocate_t>(x);
     }
 
-    void visit_ListAppend(const ASR::ListAppend_t& x) {
-        ASR::Variable_t *l = ASR::down_cast<ASR::Variable_t>(x.m_a);
-        uint32_t v_h = get_hash((ASR::asr_t*)l);
-        LFORTRAN_ASSERT(llvm_symtab.find(v_h) != llvm_symtab.end());
-        llvm::Value *plist = llvm_symtab[v_h];
+    // A pointer to the list, dict or set `x`, containers that are neither
+    // variables nor elements of containers are stored in a temporary. It is
+    // also used for the variables of a tuple assignment
+    llvm::Value* get_container_pointer(const ASR::expr_t *x) {
+        if (is_a<ASR::Var_t>(*x)) {
+            ASR::Variable_t *v = ASR::down_cast<ASR::Variable_t>(
+                symbol_get_past_external(ASR::down_cast<ASR::Var_t>(x)->m_v));
+            uint32_t h = get_hash((ASR::asr_t*)v);
+            LFORTRAN_ASSERT(llvm_symtab.find(h) != llvm_symtab.end());
+            return llvm_symtab[h];
+        } else if (is_a<ASR::ListItem_t>(*x)) {
+            return get_list_item_pointer(*ASR::down_cast<ASR::ListItem_t>(x));
+        } else if (is_a<ASR::DictItem_t>(*x) &&
+                !ASR::down_cast<ASR::DictItem_t>(x)->m_default) {
+            return get_dict_item_pointer(*ASR::down_cast<ASR::DictItem_t>(x));
+        }
+        this->visit_expr(*x);
+        llvm::Value *pcontainer = list_api->create_alloca(tmp->getType());
+        builder->CreateStore(tmp, pcontainer);
+        return pcontainer;
+    }
 
-        this->visit_expr_wrapper(x.m_ele, true);
-        llvm::Value *ele = tmp;
+    llvm::Value* get_list_item_pointer(const ASR::ListItem_t &x) {
+        llvm::Value *plist = get_container_pointer(x.m_a);
+        this->visit_expr_wrapper(x.m_pos, true);
+        llvm::Value *pos = list_api->normalize_index(plist, tmp);
+        list_api->check_index(plist, pos, *module,
+            "IndexError: list index out of range");
+        return list_api->read_item(plist, pos, true);
+    }
 
-        ASR::ttype_t *el_type = ASR::down_cast<ASR::List_t>(l->m_type)->m_type;
-        if (is_a<ASR::Integer_t>(*el_type)) {
-            int kind = ASR::down_cast<ASR::Integer_t>(el_type)->m_kind;
-            if (kind == 4) {
-                llvm::Value *plist2 = CreateLoad(plist);
-                lcompilers_list_append_i32(plist2, ele);
-            } else {
-                throw CodeGenError("Integer kind not supported yet in ListAppend", x.base.base.loc);
-            }
+    llvm::Value* get_dict_item_pointer(const ASR::DictItem_t &x) {
+        llvm::Value *pdict = get_container_pointer(x.m_a);
+        this->visit_expr_wrapper(x.m_key, true);
+        return dict_api->get_value_pointer(pdict, tmp, *module);
+    }
 
-        } else {
-            throw CodeGenError("List type not supported yet in ListAppend", x.base.base.loc);
-        }
+    // The value of `x` to be stored in a container or in a container
+    // variable; a container that is referred to by a variable or by
+    // position is copied, and so is a string
+    llvm::Value* get_value_copy(const ASR::expr_t *x) {
+        if (is_container(expr_type(x)) && (is_a<ASR::Var_t>(*x) ||
+                is_a<ASR::ListItem_t>(*x) || is_a<ASR::DictItem_t>(*x))) {
+            llvm::Value *src = get_container_pointer(x);
+            llvm::Value *copy = list_api->create_alloca(
+                src->getType()->getContainedType(0));
+            list_api->deepcopy(src, copy, *module);
+            return CreateLoad(copy);
+        }
+        this->visit_expr_wrapper(x, true);
+        if (is_a<ASR::Character_t>(*expr_type(x)) && !ASRUtils::expr_value(
+                const_cast<ASR::expr_t*>(x))) {
+            // Not owned by a variable and not in the arena
+            tmp = lfortran_str_call("_lfortran_str_persist", character_type,
+                {tmp});
+        }
+        return tmp;
+    }
 
+    void visit_ListConstant(const ASR::ListConstant_t& x) {
+        llvm::Value *plist = list_api->create_alloca(get_container_type(x.m_type));
+        llvm::Value *n = llvm::ConstantInt::get(context, llvm::APInt(32, x.n_args));
+        list_api->list_init(plist, *module, n);
+        for (size_t i = 0; i < x.n_args; i++) {
+            llvm::Value *item = get_value_copy(x.m_args[i]);
+            list_api->write_item(plist, llvm::ConstantInt::get(context,
+                llvm::APInt(32, i)), item);
+        }
+        builder->CreateStore(n, list_api->get_pointer_to_len(plist));
+        tmp = CreateLoad(plist);
+    }
+
+    void visit_ListLen(const ASR::ListLen_t& x) {
+        if (x.m_value) {
+            this->visit_expr_wrapper(x.m_value, true);
+            return;
+        }
+        tmp = list_api->len(get_container_pointer(x.m_arg));
     }
 
     void visit_ListItem(const ASR::ListItem_t& x) {
-        ASR::Variable_t *l = ASR::down_cast<ASR::Variable_t>(x.m_a);
-        uint32_t v_h = get_hash((ASR::asr_t*)l);
-        LFORTRAN_ASSERT(llvm_symtab.find(v_h) != llvm_symtab.end());
-        llvm::Value *plist = llvm_symtab[v_h];
+        tmp = CreateLoad(get_list_item_pointer(x));
+    }
+
+    void visit_ListSection(const ASR::ListSection_t& x) {
+        llvm::Value *plist = get_container_pointer(x.m_a);
+        llvm::Value *bounds[3] = {nullptr, nullptr, nullptr};
+        ASR::expr_t *asr_bounds[3] = {x.m_section.m_left,
+            x.m_section.m_right, x.m_section.m_step};
+        for (int i = 0; i < 3; i++) {
+            if (asr_bounds[i]) {
+                this->visit_expr_wrapper(asr_bounds[i], true);
+                bounds[i] = tmp;
+            }
+        }
+        llvm::Value *result = list_api->create_alloca(
+            plist->getType()->getContainedType(0));
+        list_api->section(plist, bounds[0], bounds[1], bounds[2], result,
+            *module);
+        tmp = CreateLoad(result);
+    }
+
+    void visit_ListConcat(const ASR::ListConcat_t& x) {
+        llvm::Value *left = get_container_pointer(x.m_left);
+        llvm::Value *right = get_container_pointer(x.m_right);
+        llvm::Value *result = list_api->create_alloca(
+            left->getType()->getContainedType(0));
+        list_api->concat(left, right, result, *module);
+        tmp = CreateLoad(result);
+    }
+
+    void visit_ListAppend(const ASR::ListAppend_t& x) {
+        llvm::Value *item = get_value_copy(x.m_ele);
+        list_api->append(get_container_pointer(x.m_a), item, *module);
+    }
 
+    void visit_ListInsert(const ASR::ListInsert_t& x) {
+        llvm::Value *item = get_value_copy(x.m_ele);
         this->visit_expr_wrapper(x.m_pos, true);
         llvm::Value *pos = tmp;
+        list_api->insert(get_container_pointer(x.m_a), pos, item, *module);
+    }
 
-        ASR::ttype_t *el_type = ASR::down_cast<ASR::List_t>(l->m_type)->m_type;
-        if (is_a<ASR::Integer_t>(*el_type)) {
-            int kind = ASR::down_cast<ASR::Integer_t>(el_type)->m_kind;
-            if (kind == 4) {
-                llvm::Value *plist2 = CreateLoad(plist);
-                tmp = lcompilers_list_item_i32(plist2, pos);
-            } else {
-                throw CodeGenError("Integer kind not supported yet in ListAppend", x.base.base.loc);
-            }
+    void visit_ListRemove(const ASR::ListRemove_t& x) {
+        this->visit_expr_wrapper(x.m_ele, true);
+        llvm::Value *item = tmp;
+        list_api->remove(get_container_pointer(x.m_a), item, *module);
+    }
 
-        } else {
-            throw CodeGenError("List type not supported yet in ListAppend", x.base.base.loc);
+    void visit_ListPop(const ASR::ListPop_t& x) {
+        llvm::Value *pos = nullptr;
+        if (x.m_index) {
+            this->visit_expr_wrapper(x.m_index, true);
+            pos = tmp;
         }
+        tmp = list_api->pop(get_container_pointer(x.m_a), pos, *module);
+    }
 
+    void visit_DictConstant(const ASR::DictConstant_t& x) {
+        llvm::Value *pdict = list_api->create_alloca(get_container_type(x.m_type));
+        dict_api->dict_init(pdict);
+        if (x.n_keys > 0) dict_api->reserve(pdict, x.n_keys, *module);
+        for (size_t i = 0; i < x.n_keys; i++) {
+            llvm::Value *value = get_value_copy(x.m_values[i]);
+            llvm::Value *key = get_value_copy(x.m_keys[i]);
+            dict_api->write_item(pdict, key, value, *module);
+        }
+        tmp = CreateLoad(pdict);
+    }
+
+    void visit_SetConstant(const ASR::SetConstant_t& x) {
+        llvm::Value *pset = list_api->create_alloca(get_container_type(x.m_type));
+        dict_api->dict_init(pset);
+        if (x.n_elements > 0) dict_api->reserve(pset, x.n_elements, *module);
+        for (size_t i = 0; i < x.n_elements; i++) {
+            dict_api->insert(pset, get_value_copy(x.m_elements[i]), *module);
+        }
+        tmp = CreateLoad(pset);
+    }
+
+    void visit_DictLen(const ASR::DictLen_t& x) {
+        if (x.m_value) {
+            this->visit_expr_wrapper(x.m_value, true);
+            return;
+        }
+        tmp = dict_api->len(get_container_pointer(x.m_arg));
+    }
+
+    void visit_SetLen(const ASR::SetLen_t& x) {
+        if (x.m_value) {
+            this->visit_expr_wrapper(x.m_value, true);
+            return;
+        }
+        tmp = dict_api->len(get_container_pointer(x.m_arg));
+    }
+
+    void visit_DictItem(const ASR::DictItem_t& x) {
+        llvm::Value *pdict = get_container_pointer(x.m_a);
+        llvm::Value *def = nullptr;
+        if (x.m_default) {
+            this->visit_expr_wrapper(x.m_default, true);
+            def = tmp;
+        }
+        this->visit_expr_wrapper(x.m_key, true);
+        tmp = dict_api->get_value(pdict, tmp, def, *module);
+    }
+
+    void visit_DictInsert(const ASR::DictInsert_t& x) {
+        llvm::Value *value = get_value_copy(x.m_value);
+        llvm::Value *key = get_value_copy(x.m_key);
+        dict_api->write_item(get_container_pointer(x.m_a), key, value, *module);
+    }
+
+    void visit_DictPop(const ASR::DictPop_t& x) {
+        this->visit_expr_wrapper(x.m_key, true);
+        llvm::Value *key = tmp;
+        tmp = dict_api->pop(get_container_pointer(x.m_a), key, *module);
+    }
+
+    void visit_DictContains(const ASR::DictContains_t& x) {
+        this->visit_expr_wrapper(x.m_key, true);
+        llvm::Value *key = tmp;
+        tmp = dict_api->contains(get_container_pointer(x.m_a), key, *module);
+    }
+
+    void visit_SetInsert(const ASR::SetInsert_t& x) {
+        llvm::Value *ele = get_value_copy(x.m_ele);
+        dict_api->insert(get_container_pointer(x.m_a), ele, *module);
+    }
+
+    void visit_SetRemove(const ASR::SetRemove_t& x) {
+        this->visit_expr_wrapper(x.m_ele, true);
+        llvm::Value *ele = tmp;
+        dict_api->remove(get_container_pointer(x.m_a), ele, *module);
+    }
+
+    void visit_SetPop(const ASR::SetPop_t& x) {
+        tmp = dict_api->set_pop(get_container_pointer(x.m_a), *module);
+    }
+
+    void visit_SetContains(const ASR::SetContains_t& x) {
+        this->visit_expr_wrapper(x.m_ele, true);
+        llvm::Value *ele = tmp;
+        tmp = dict_api->contains(get_container_pointer(x.m_a), ele, *module);
+    }
+
+    void visit_TupleConstant(const ASR::TupleConstant_t& x) {
+        llvm::Value *tuple = llvm::UndefValue::get(get_tuple_type(x.m_type));
+        for (size_t i = 0; i < x.n_elements; i++) {
+            tuple = builder->CreateInsertValue(tuple,
+                get_value_copy(x.m_elements[i]), i);
+        }
+        tmp = tuple;
+    }
+
+    void visit_TupleItem(const ASR::TupleItem_t& x) {
+        if (x.m_value) {
+            this->visit_expr_wrapper(x.m_value, true);
+            return;
+        }
+        unsigned pos = ASR::down_cast<ASR::IntegerConstant_t>(x.m_pos)->m_n;
+        this->visit_expr_wrapper(x.m_a, true);
+        tmp = builder->CreateExtractValue(tmp, pos);
+    }
+
+    void visit_TupleLen(const ASR::TupleLen_t& x) {
+        LFORTRAN_ASSERT(x.m_value);
+        this->visit_expr_wrapper(x.m_value, true);
     }
 
     void visit_ArrayRef(const ASR::ArrayRef_t& x) {
@@ -1176,11 +1670,11 @@ public:
             this->visit_expr_wrapper(x.m_value, true);
             return;
         }
-        this->visit_expr_wrapper(x.m_idx, true);
-        llvm::Value *idx = tmp;
         this->visit_expr_wrapper(x.m_arg, true);
         llvm::Value *str = tmp;
-        tmp = lfortran_str_copy(str, idx, idx);
+        this->visit_expr_wrapper(x.m_idx, true);
+        tmp = lfortran_str_call("_lfortran_str_item", character_type,
+            {str, builder->CreateSExtOrTrunc(tmp, llvm::Type::getInt32Ty(context))});
     }
 
     void visit_StringSection(const ASR::StringSection_t& x) {
@@ -1189,12 +1683,20 @@ public:
             return;
         }
         this->visit_expr_wrapper(x.m_arg, true);
-        llvm::Value *str = tmp;
-        this->visit_expr_wrapper(x.m_start, true);
-        llvm::Value *left = tmp;
-        this->visit_expr_wrapper(x.m_end, true);
-        llvm::Value *right = tmp;
-        tmp = lfortran_str_copy(str, left, right);   
+        std::vector<llvm::Value*> args = {tmp};
+        llvm::Type *i32 = llvm::Type::getInt32Ty(context);
+        ASR::expr_t *bounds[3] = {x.m_start, x.m_end, x.m_step};
+        for (int i = 0; i < 3; i++) {
+            if (bounds[i]) {
+                this->visit_expr_wrapper(bounds[i], true);
+                args.push_back(builder->CreateSExtOrTrunc(tmp, i32));
+            } else {
+                args.push_back(llvm::ConstantInt::get(i32, i == 2 ? 1 : 0));
+            }
+        }
+        args.push_back(llvm::ConstantInt::get(i32, x.m_start ? 1 : 0));
+        args.push_back(llvm::ConstantInt::get(i32, x.m_end ? 1 : 0));
+        tmp = lfortran_str_call("_lfortran_str_slice", character_type, args);
     }
 
     void visit_DerivedRef(const ASR::DerivedRef_t& x) {
@@ -1305,6 +1807,23 @@ public:
                 }
             }
             llvm_symtab[h] = ptr;
+        } else if (is_container(x.m_type)) {
+            llvm::Type *type = get_container_type(x.m_type);
+            llvm::Constant *ptr = module->getOrInsertGlobal(x.m_name, type);
+            if (!external) {
+                // The empty list, dict or set, all the fields are zero
+                module->getNamedGlobal(x.m_name)->setInitializer(
+                    llvm::Constant::getNullValue(type));
+            }
+            llvm_symtab[h] = ptr;
+        } else if (ASR::is_a<ASR::Tuple_t>(*x.m_type)) {
+            llvm::Type *type = get_tuple_type(x.m_type);
+            llvm::Constant *ptr = module->getOrInsertGlobal(x.m_name, type);
+            if (!external) {
+                module->getNamedGlobal(x.m_name)->setInitializer(
+                    llvm::Constant::getNullValue(type));
+            }
+            llvm_symtab[h] = ptr;
         } else {
             throw CodeGenError("Variable type not supported", x.base.base.loc);
         }
@@ -1357,9 +1876,34 @@ public:
         finish_module_init_function_prototype(x);
 
         visit_procedures(x);
+        set_module_linkage(x);
         mangle_prefix = "";
     }
 
+    // Every translation unit that imports a module gets its own copy of the
+    // module's code and globals. Mark them linkonce_odr so that separately
+    // compiled objects importing the same module can be linked together.
+    void set_module_linkage(const ASR::Module_t &x) {
+        for (auto &item : x.m_symtab->get_scope()) {
+            if (is_a<ASR::Variable_t>(*item.second)) {
+                llvm::GlobalVariable *g = module->getNamedGlobal(
+                    down_cast<ASR::Variable_t>(item.second)->m_name);
+                if (g && g->hasInitializer()) {
+                    g->setLinkage(llvm::GlobalValue::LinkOnceODRLinkage);
+                }
+            } else if (is_a<ASR::Function_t>(*item.second)
+                    || is_a<ASR::Subroutine_t>(*item.second)) {
+                uint32_t h = get_hash((ASR::asr_t*)item.second);
+                if (llvm_symtab_fn.find(h) != llvm_symtab_fn.end()) {
+                    llvm::Function *F = llvm_symtab_fn[h];
+                    if (!F->isDeclaration()) {
+                        F->setLinkage(llvm::GlobalValue::LinkOnceODRLinkage);
+                    }
+                }
+            }
+        }
+    }
+
     void visit_Program(const ASR::Program_t &x) {
         // Generate code for nested subroutines and functions first:
         for (auto &item : x.m_symtab->get_scope()) {
@@ -1386,10 +1930,12 @@ public:
         llvm::BasicBlock *BB = llvm::BasicBlock::Create(context,
                 ".entry", F);
         builder->SetInsertPoint(BB);
+        heap_arrays.clear();
         declare_vars(x);
         for (size_t i=0; i<x.n_body; i++) {
             this->visit_stmt(*x.m_body[i]);
         }
+        free_heap_arrays();
         llvm::Value *ret_val2 = llvm::ConstantInt::get(context,
             llvm::APInt(32, 0));
         builder->CreateRet(ret_val2);
@@ -1583,10 +2129,14 @@ public:
                             }
                             break;
                         }
-                        case (ASR::ttypeType::List) : {
-                            //ASR::List_t* v_type = down_cast<ASR::List_t>(v->m_type);
-                            //ASR::ttype_t *el_type = v_type->m_type;
-                            type = list_type;
+                        case (ASR::ttypeType::List) :
+                        case (ASR::ttypeType::Dict) :
+                        case (ASR::ttypeType::Set) : {
+                            type = get_container_type(v->m_type);
+                            break;
+                        }
+                        case (ASR::ttypeType::Tuple) : {
+                            type = get_tuple_type(v->m_type);
                             break;
                         }
                         default :
@@ -1638,7 +2188,8 @@ public:
                         arr_descr->fill_dimension_descriptor(ptr, n_dims);
                     }
                     if( is_array_type && !is_malloc_array_type ) {
-                        fill_array_details(ptr, m_dims, n_dims);
+                        fill_array_details(ptr, m_dims, n_dims,
+                            allocate_local_array(v));
                     }
                     if( is_array_type && is_malloc_array_type ) {
                         // Set allocatable arrays as unallocated
@@ -1670,29 +2221,24 @@ public:
                             if (strlen >= 0) {
                                 // Compile time length
                                 std::string empty(strlen, ' ');
-                                llvm::Value *init_value = builder->CreateGlobalStringPtr(s2c(al, empty));
-                                builder->CreateStore(init_value, target_var);
+                                builder->CreateStore(get_string_literal(empty), target_var);
                             } else if (strlen == -2) {
-                                // Allocatable string. Initialize to `nullptr` (unallocated)
-                                llvm::Value *init_value = llvm::Constant::getNullValue(type);
-                                builder->CreateStore(init_value, target_var);
+                                // Allocatable string, the empty string until
+                                // it is assigned
+                                builder->CreateStore(get_string_literal(""), target_var);
                             } else if (strlen == -3) {
                                 LFORTRAN_ASSERT(t->m_len_expr)
                                 this->visit_expr(*t->m_len_expr);
-                                llvm::Value *arg_size = tmp;
-                                arg_size = builder->CreateAdd(arg_size, llvm::ConstantInt::get(context, llvm::APInt(32, 1)));
-                                // TODO: this temporary string is never deallocated (leaks memory)
-                                llvm::Value *init_value = LLVMArrUtils::lfortran_malloc(context, *module, *builder, arg_size);
-                                string_init(context, *module, *builder, arg_size, init_value);
-                                builder->CreateStore(init_value, target_var);
+                                lfortran_str_call("_lfortran_str_blank",
+                                    llvm::Type::getVoidTy(context), {target_var,
+                                    builder->CreateSExtOrTrunc(tmp, llvm::Type::getInt32Ty(context))});
                             } else {
                                 throw CodeGenError("Unsupported len value in ASR");
                             }
                         } else if (is_a<ASR::List_t>(*v->m_type)) {
-                            // TODO: do a different initialization based on element type
-                            llvm::Value *init_value = lcompilers_list_init_i32();
-                            target_var = ptr;
-                            builder->CreateStore(init_value, target_var);
+                            list_api->list_init(ptr, *module);
+                        } else if (is_container(v->m_type)) {
+                            dict_api->dict_init(ptr);
                         }
                     }
                 }
@@ -1893,6 +2439,16 @@ public:
                         }
                         break;
                     }
+                    case (ASR::ttypeType::List) :
+                    case (ASR::ttypeType::Dict) :
+                    case (ASR::ttypeType::Set) : {
+                        type = get_container_type(arg->m_type)->getPointerTo();
+                        break;
+                    }
+                    case (ASR::ttypeType::Tuple) : {
+                        type = get_tuple_type(arg->m_type)->getPointerTo();
+                        break;
+                    }
                     default :
                         LFORTRAN_ASSERT(false);
                 }
@@ -2089,7 +2645,354 @@ public:
                 llvm_arg.setName(arg_s);
                 llvm_symtab_fn_arg[h] = &llvm_arg;
             }
-            i++;
+            i++;
+        }
+    }
+
+    /*
+    The attributes that the procedure_effects analysis proves for the
+    function `F` of the procedure `x`. An array argument is a pointer to its
+    descriptor, so that `noalias` on it tells that the descriptor does not
+    change while the function runs, which lets LLVM load its data pointer
+    and strides once outside of the loops over the elements. In the
+    `contiguous` clone it is the pointer to the first element instead.
+    */
+    template <typename T>
+    void set_procedure_attributes(const T &x, llvm::Function &F,
+            bool contiguous=false) {
+        auto it = proc_effects.find((ASR::symbol_t*)&x);
+        if (it == proc_effects.end()) {
+            return;
+        }
+        const ProcedureEffects &e = it->second;
+        F.addFnAttr(llvm::Attribute::NoUnwind);
+        if (e.will_return) {
+            F.addFnAttr(llvm::Attribute::WillReturn);
+        }
+        // The LLVM argument of each argument, in the clone the bounds of an
+        // array follow its pointer
+        std::vector<unsigned> index;
+        unsigned n = 0;
+        for (size_t i = 0; i < x.n_args; i++) {
+            index.push_back(n++);
+            if (contiguous && ASRUtils::is_array(expr_type(x.m_args[i]))) {
+                n += 2 * PassUtils::get_rank(x.m_args[i]);
+            }
+        }
+        bool scalars_written = e.writes_memory, arrays_written = false;
+        bool has_pointer_args = false, has_array_args = false;
+        for (size_t i = 0; i < x.n_args && index[i] < F.arg_size(); i++) {
+            if (!F.getArg(index[i])->getType()->isPointerTy()) {
+                continue;
+            }
+            has_pointer_args = true;
+            bool is_array = ASRUtils::is_array(expr_type(x.m_args[i]));
+            has_array_args = has_array_args || is_array;
+            if (e.arg_written[i]) {
+                (is_array ? arrays_written : scalars_written) = true;
+            }
+        }
+        // The elements of arrays are not reached through the argument
+        // itself but through the data pointer in the descriptor
+        bool arg_memory_only = !e.reads_memory && !e.writes_memory &&
+            (contiguous || !has_array_args);
+        if (!scalars_written && !arrays_written) {
+            if (!has_pointer_args && !e.reads_memory) {
+                F.addFnAttr(llvm::Attribute::ReadNone);
+            } else {
+                F.addFnAttr(llvm::Attribute::ReadOnly);
+                if (arg_memory_only) {
+                    F.addFnAttr(llvm::Attribute::ArgMemOnly);
+                }
+            }
+        } else if (arg_memory_only) {
+            F.addFnAttr(llvm::Attribute::ArgMemOnly);
+        }
+        for (size_t i = 0; i < x.n_args && index[i] < F.arg_size(); i++) {
+            if (!F.getArg(index[i])->getType()->isPointerTy() ||
+                    !is_a<ASR::Variable_t>(*symbol_get_past_external(
+                        ASR::down_cast<ASR::Var_t>(x.m_args[i])->m_v))) {
+                continue;
+            }
+            if (!e.arg_captured[i]) {
+                F.addParamAttr(index[i], llvm::Attribute::NoCapture);
+            }
+            if (!e.arg_written[i]) {
+                F.addParamAttr(index[i], llvm::Attribute::ReadOnly);
+            }
+            // A scalar argument points to a variable of the caller, which
+            // can also be another argument or a global variable. The same
+            // array can be passed twice, unless the procedure is `@restrict`.
+            bool noalias;
+            if (!ASRUtils::is_array(expr_type(x.m_args[i]))) {
+                noalias = !scalars_written;
+            } else if (contiguous) {
+                noalias = x.m_restrict || (!arrays_written && !e.writes_memory);
+            } else {
+                noalias = !e.writes_descriptors;
+            }
+            if (noalias) {
+                F.addParamAttr(index[i], llvm::Attribute::NoAlias);
+            }
+        }
+    }
+
+    /*
+    Contiguous clones: a procedure with array arguments gets a second
+    function `<name>.contiguous`, which takes each array as the pointer to
+    its first element followed by the lower and upper bound of each
+    dimension. The calls whose array arguments are all contiguous (local
+    arrays of the caller or arrays that the caller got contiguous) call
+    the clone. Its body builds a local descriptor with unit strides from
+    the arguments, which LLVM folds away, so that an element access is a
+    single GEP and the loops over the elements can be vectorized. The
+    original function stays for the other calls and for other objects.
+    */
+    template <typename T>
+    bool can_clone_contiguous(const T &x) {
+        if (x.m_abi != ASR::abiType::Source ||
+                x.m_deftype != ASR::deftypeType::Implementation) {
+            return false;
+        }
+        // The nested procedures share the arguments through a global struct
+        ASR::asr_t *owner = x.m_symtab->parent->asr_owner;
+        if (owner && ASR::is_a<ASR::symbol_t>(*owner) &&
+                (is_a<ASR::Function_t>(*ASR::down_cast<ASR::symbol_t>(owner)) ||
+                 is_a<ASR::Subroutine_t>(*ASR::down_cast<ASR::symbol_t>(owner)))) {
+            return false;
+        }
+        for (auto &item : x.m_symtab->get_scope()) {
+            if (is_a<ASR::Function_t>(*item.second) ||
+                    is_a<ASR::Subroutine_t>(*item.second)) {
+                return false;
+            }
+        }
+        bool has_array_args = false;
+        for (size_t i = 0; i < x.n_args; i++) {
+            if (!is_a<ASR::Var_t>(*x.m_args[i]) ||
+                    !is_a<ASR::Variable_t>(*symbol_get_past_external(
+                        ASR::down_cast<ASR::Var_t>(x.m_args[i])->m_v))) {
+                return false;
+            }
+            ASR::Variable_t *arg = EXPR2VAR(x.m_args[i]);
+            if (!ASRUtils::is_array(arg->m_type)) {
+                continue;
+            }
+            if (arg->m_storage == ASR::storage_typeType::Allocatable ||
+                    !(is_a<ASR::Integer_t>(*arg->m_type) || is_a<ASR::Real_t>(*arg->m_type) ||
+                      is_a<ASR::Complex_t>(*arg->m_type) || is_a<ASR::Logical_t>(*arg->m_type))) {
+                return false;
+            }
+            has_array_args = true;
+        }
+        return has_array_args;
+    }
+
+    // The elements of the array `x` are contiguous from its data pointer: a
+    // local array or an array argument of the clone that is generated. A
+    // section is a view with strides, an allocatable array can be
+    // reallocated by the callee.
+    bool is_contiguous_array(ASR::expr_t *x) {
+        if (!is_a<ASR::Var_t>(*x)) {
+            return false;
+        }
+        ASR::symbol_t *sym = symbol_get_past_external(
+            ASR::down_cast<ASR::Var_t>(x)->m_v);
+        if (!is_a<ASR::Variable_t>(*sym)) {
+            return false;
+        }
+        ASR::Variable_t *v = down_cast<ASR::Variable_t>(sym);
+        if (!ASRUtils::is_array(v->m_type) || is_a<ASR::Pointer_t>(*v->m_type) ||
+                v->m_storage == ASR::storage_typeType::Allocatable) {
+            return false;
+        }
+        uint32_t h = get_hash((ASR::asr_t*)v);
+        if (contiguous_args.find(h) != contiguous_args.end()) {
+            return true;
+        }
+        ASR::symbol_t *owner = ASR::down_cast<ASR::symbol_t>(
+            v->m_parent_symtab->asr_owner);
+        return v->m_intent == intent_local &&
+            (is_a<ASR::Function_t>(*owner) || is_a<ASR::Subroutine_t>(*owner) ||
+             is_a<ASR::Program_t>(*owner));
+    }
+
+    template <typename T, typename C>
+    bool calls_contiguous_clone(const T &x, const C &call) {
+        if (!contiguous_clones_enabled || call.m_dt || call.n_args != x.n_args ||
+                !can_clone_contiguous(x)) {
+            return false;
+        }
+        for (size_t i = 0; i < x.n_args; i++) {
+            if (ASRUtils::is_array(expr_type(x.m_args[i])) &&
+                    (call.m_args[i].m_value == nullptr ||
+                     !is_contiguous_array(call.m_args[i].m_value))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    template <typename T>
+    llvm::Function* get_contiguous_clone(const T &x) {
+        ASR::symbol_t *sym = (ASR::symbol_t*)&x;
+        auto it = contiguous_clones.find(sym);
+        if (it != contiguous_clones.end()) {
+            return it->second;
+        }
+        uint32_t h = get_hash((ASR::asr_t*)&x);
+        llvm::Function *orig = llvm_symtab_fn[h];
+        llvm::FunctionType *orig_type = orig->getFunctionType();
+        llvm::Type *i32 = llvm::Type::getInt32Ty(context);
+        std::vector<llvm::Type*> params;
+        for (size_t i = 0; i < x.n_args; i++) {
+            ASR::ttype_t *type = expr_type(x.m_args[i]);
+            if (!ASRUtils::is_array(type)) {
+                params.push_back(orig_type->getParamType(i));
+                continue;
+            }
+            params.push_back(get_el_type(type,
+                ASRUtils::extract_kind_from_ttype_t(type))->getPointerTo());
+            for (int r = 0; r < PassUtils::get_rank(x.m_args[i]); r++) {
+                params.push_back(i32);
+                params.push_back(i32);
+            }
+        }
+        llvm::Function *F = llvm::Function::Create(llvm::FunctionType::get(
+            orig_type->getReturnType(), params, false),
+            llvm::Function::InternalLinkage, orig->getName() + ".contiguous",
+            module.get());
+        set_procedure_attributes(x, *F, true);
+        contiguous_clones[sym] = F;
+        clones_to_generate.push_back(sym);
+        return F;
+    }
+
+    // The arguments of the call of the clone: the descriptor of an array is
+    // replaced by its data pointer and bounds
+    template <typename T>
+    std::vector<llvm::Value*> get_contiguous_args(const T &x,
+            const std::vector<llvm::Value*> &args) {
+        llvm::Type *i32 = llvm::Type::getInt32Ty(context);
+        std::vector<llvm::Value*> new_args;
+        for (size_t i = 0; i < args.size(); i++) {
+            if (!ASRUtils::is_array(expr_type(x.m_args[i]))) {
+                new_args.push_back(args[i]);
+                continue;
+            }
+            new_args.push_back(CreateLoad(arr_descr->get_pointer_to_data(args[i])));
+            llvm::Value *dims = arr_descr->get_pointer_to_dimension_descriptor_array(args[i]);
+            for (int r = 0; r < PassUtils::get_rank(x.m_args[i]); r++) {
+                llvm::Value *dim = arr_descr->get_pointer_to_dimension_descriptor(dims,
+                    llvm::ConstantInt::get(i32, r));
+                new_args.push_back(arr_descr->get_lower_bound(dim));
+                new_args.push_back(arr_descr->get_upper_bound(dim));
+            }
+        }
+        return new_args;
+    }
+
+    // The arguments of the clone, an array gets a local descriptor
+    template <typename T>
+    void declare_contiguous_args(const T &x, llvm::Function &F) {
+        auto llvm_arg = F.arg_begin();
+        for (size_t i = 0; i < x.n_args; i++) {
+            ASR::Variable_t *arg = EXPR2VAR(x.m_args[i]);
+            uint32_t h = get_hash((ASR::asr_t*)arg);
+            llvm::Value *value = &*llvm_arg++;
+            value->setName(arg->m_name);
+            if (ASRUtils::is_array(arg->m_type)) {
+                ASR::dimension_t *m_dims = nullptr;
+                int n_dims = 0;
+                PassUtils::get_dim_rank(arg->m_type, m_dims, n_dims);
+                int a_kind = ASRUtils::extract_kind_from_ttype_t(arg->m_type);
+                llvm::Type *type = arr_descr->get_array_type(arg->m_type, a_kind,
+                    n_dims, get_el_type(arg->m_type, a_kind));
+                llvm::Value *arr = builder->CreateAlloca(type, nullptr);
+                std::vector<std::pair<llvm::Value*, llvm::Value*>> llvm_dims;
+                for (int r = 0; r < n_dims; r++) {
+                    llvm::Value *lower = &*llvm_arg++;
+                    llvm::Value *upper = &*llvm_arg++;
+                    llvm_dims.push_back(std::make_pair(lower, upper));
+                }
+                arr_descr->fill_array_details(arr, m_dims, n_dims, llvm_dims, value);
+                contiguous_args.insert(h);
+                value = arr;
+            }
+            llvm_symtab[h] = value;
+        }
+    }
+
+    // Generates the bodies of the clones that the calls asked for, which
+    // can ask for more clones
+    void generate_contiguous_clones() {
+        for (size_t i = 0; i < clones_to_generate.size(); i++) {
+            ASR::symbol_t *sym = clones_to_generate[i];
+            clone_fn = contiguous_clones[sym];
+            contiguous_args.clear();
+            std::map<uint64_t, llvm::BasicBlock*> goto_targets;
+            std::swap(goto_targets, llvm_goto_targets);
+            if (is_a<ASR::Function_t>(*sym)) {
+                generate_function(*down_cast<ASR::Function_t>(sym));
+                parent_function = nullptr;
+            } else {
+                generate_subroutine(*down_cast<ASR::Subroutine_t>(sym));
+                parent_subroutine = nullptr;
+            }
+            std::swap(goto_targets, llvm_goto_targets);
+            clone_fn = nullptr;
+            contiguous_args.clear();
+        }
+    }
+
+    /*
+    The array arguments of a `@restrict` procedure do not share elements.
+    Each one gets its own alias scope: an access to one of its elements is
+    in its scope and does not alias the scopes of the other arguments.
+    */
+    template <typename T>
+    void set_restrict_scopes(const T &x) {
+        restrict_scopes.clear();
+        if (!x.m_restrict || x.m_abi == ASR::abiType::BindC) {
+            return;
+        }
+        llvm::MDBuilder mdb(context);
+        llvm::MDNode *domain = mdb.createAnonymousAliasScopeDomain(x.m_name);
+        std::vector<std::pair<const ASR::symbol_t*, llvm::MDNode*>> scopes;
+        for (size_t i = 0; i < x.n_args; i++) {
+            ASR::symbol_t *sym = symbol_get_past_external(
+                ASR::down_cast<ASR::Var_t>(x.m_args[i])->m_v);
+            if (is_a<ASR::Variable_t>(*sym) &&
+                    ASRUtils::is_array(down_cast<ASR::Variable_t>(sym)->m_type)) {
+                scopes.push_back({sym, mdb.createAnonymousAliasScope(domain,
+                    down_cast<ASR::Variable_t>(sym)->m_name)});
+            }
+        }
+        for (auto &scope : scopes) {
+            std::vector<llvm::Metadata*> others;
+            for (auto &other : scopes) {
+                if (other.first != scope.first) {
+                    others.push_back(other.second);
+                }
+            }
+            restrict_scopes[scope.first] = {llvm::MDNode::get(context, {scope.second}),
+                llvm::MDNode::get(context, others)};
+        }
+    }
+
+    // Puts the load or store `inst` of the element `x` into the alias scope
+    // of its array, see set_restrict_scopes
+    void set_alias_scope(llvm::Value *inst, const ASR::expr_t *x) {
+        if (restrict_scopes.empty() || !is_a<ASR::ArrayRef_t>(*x) ||
+                !llvm::isa<llvm::Instruction>(inst)) {
+            return;
+        }
+        auto it = restrict_scopes.find(symbol_get_past_external(
+            ASR::down_cast<ASR::ArrayRef_t>(x)->m_v));
+        if (it != restrict_scopes.end()) {
+            llvm::Instruction *i = llvm::cast<llvm::Instruction>(inst);
+            i->setMetadata(llvm::LLVMContext::MD_alias_scope, it->second.first);
+            i->setMetadata(llvm::LLVMContext::MD_noalias, it->second.second);
         }
     }
 
@@ -2106,6 +3009,12 @@ public:
     }
 
     void visit_Subroutine(const ASR::Subroutine_t &x) {
+        if (x.m_abi == ASR::abiType::BindC &&
+                x.m_deftype == ASR::deftypeType::Interface) {
+            // A `@ccall` subroutine, only declared
+            instantiate_subroutine(x);
+            return;
+        }
         if (x.m_abi != ASR::abiType::Source &&
             x.m_abi != ASR::abiType::Interactive &&
             x.m_abi != ASR::abiType::Intrinsic) {
@@ -2142,6 +3051,7 @@ public:
                 llvm_symtab_fn_names[fn_name] = h;
                 F = llvm::Function::Create(function_type,
                     llvm::Function::ExternalLinkage, fn_name, module.get());
+                set_procedure_attributes(x, *F);
             } else {
                 uint32_t old_h = llvm_symtab_fn_names[fn_name];
                 F = llvm_symtab_fn[old_h];
@@ -2215,6 +3125,7 @@ public:
                 llvm_symtab_fn_names[fn_name] = h;
                 F = llvm::Function::Create(function_type,
                     llvm::Function::ExternalLinkage, fn_name, module.get());
+                set_procedure_attributes(x, *F);
             } else {
                 uint32_t old_h = llvm_symtab_fn_names[fn_name];
                 F = llvm_symtab_fn[old_h];
@@ -2299,6 +3210,16 @@ public:
             case (ASR::ttypeType::Derived) :
                 throw CodeGenError("Derived return type not implemented yet");
                 break;
+            case (ASR::ttypeType::List) :
+            case (ASR::ttypeType::Dict) :
+            case (ASR::ttypeType::Set) :
+                return_type = get_container_type(return_var_type0);
+                break;
+            case (ASR::ttypeType::Tuple) :
+                // Returned by value, LLVM demotes it to a hidden pointer
+                // argument if it does not fit in the return registers
+                return_type = get_tuple_type(return_var_type0);
+                break;
             default :
                 LFORTRAN_ASSERT(false);
                 throw CodeGenError("Type not implemented");
@@ -2362,13 +3283,21 @@ public:
         uint32_t h = get_hash((ASR::asr_t*)&x);
         parent_function = &x;
         parent_function_hash = h;
-        llvm::Function* F = llvm_symtab_fn[h];
+        llvm::Function* F = clone_fn ? clone_fn : llvm_symtab_fn[h];
         proc_return = llvm::BasicBlock::Create(context, "return");
         llvm::BasicBlock *BB = llvm::BasicBlock::Create(context,
                 ".entry", F);
         builder->SetInsertPoint(BB);
-        declare_args(x, *F);
+        if (clone_fn) {
+            declare_contiguous_args(x, *F);
+        } else {
+            declare_args(x, *F);
+        }
+        set_restrict_scopes(x);
+        heap_arrays.clear();
         declare_local_vars(x);
+        function_arena_mark = creates_string_temporaries(x.m_body, x.n_body)
+            ? string_arena_mark() : nullptr;
     }
 
 
@@ -2376,21 +3305,38 @@ public:
         uint32_t h = get_hash((ASR::asr_t*)&x);
         parent_subroutine = &x;
         parent_function_hash = h;
-        llvm::Function* F = llvm_symtab_fn[h];
+        llvm::Function* F = clone_fn ? clone_fn : llvm_symtab_fn[h];
         proc_return = llvm::BasicBlock::Create(context, "return");
         llvm::BasicBlock *BB = llvm::BasicBlock::Create(context,
                 ".entry", F);
         builder->SetInsertPoint(BB);
-        declare_args(x, *F);
+        if (clone_fn) {
+            declare_contiguous_args(x, *F);
+        } else {
+            declare_args(x, *F);
+        }
+        set_restrict_scopes(x);
+        heap_arrays.clear();
         declare_local_vars(x);
+        function_arena_mark = creates_string_temporaries(x.m_body, x.n_body)
+            ? string_arena_mark() : nullptr;
     }
 
     inline void define_function_exit(const ASR::Function_t& x) {
         start_new_block(proc_return);
+        if (function_arena_mark) string_arena_release(function_arena_mark);
         ASR::Variable_t *asr_retval = EXPR2VAR(x.m_return_var);
         uint32_t h = get_hash((ASR::asr_t*)asr_retval);
         llvm::Value *ret_val = llvm_symtab[h];
         llvm::Value *ret_val2 = CreateLoad(ret_val);
+        if (is_a<ASR::Character_t>(*asr_retval->m_type)) {
+            // The returned string is copied into the arena of the caller
+            ret_val2 = lfortran_str_call("_lfortran_str_temp", character_type,
+                {ret_val2});
+        }
+        free_local_strings(x.m_symtab);
+        free_local_containers(x.m_symtab);
+        free_heap_arrays();
         // Handle Complex type return value for BindC:
         if (x.m_abi == ASR::abiType::BindC) {
             ASR::ttype_t* arg_type = asr_retval->m_type;
@@ -2434,8 +3380,12 @@ public:
     }
 
 
-    inline void define_subroutine_exit(const ASR::Subroutine_t& /*x*/) {
+    inline void define_subroutine_exit(const ASR::Subroutine_t& x) {
         start_new_block(proc_return);
+        if (function_arena_mark) string_arena_release(function_arena_mark);
+        free_local_strings(x.m_symtab);
+        free_local_containers(x.m_symtab);
+        free_heap_arrays();
         builder->CreateRetVoid();
     }
 
@@ -2507,6 +3457,51 @@ public:
     }
 
     void visit_Associate(const ASR::Associate_t& x) {
+        if (is_a<ASR::ArrayRef_t>(*x.m_value)) {
+            // The target becomes a view of the section, see arr_slice
+            ASR::ArrayRef_t *section = down_cast<ASR::ArrayRef_t>(x.m_value);
+            ASR::Variable_t *v = down_cast<ASR::Variable_t>(
+                symbol_get_past_external(section->m_v));
+            uint32_t array_h = get_hash((ASR::asr_t*)v);
+            uint32_t view_h = get_hash((ASR::asr_t*)EXPR2VAR(x.m_target));
+            llvm::Value *array = llvm_symtab[array_h];
+            llvm::Value *view = llvm_symtab[view_h];
+            llvm::Value *dims = arr_descr->get_pointer_to_dimension_descriptor_array(array);
+            llvm::Type *i32 = llvm::Type::getInt32Ty(context);
+            std::vector<llvm::Value*> starts, ends, steps;
+            for (size_t r = 0; r < section->n_args; r++) {
+                ASR::array_index_t idx = section->m_args[r];
+                llvm::Value *dim = arr_descr->get_pointer_to_dimension_descriptor(dims,
+                    llvm::ConstantInt::get(i32, r));
+                llvm::Value *start, *end, *step;
+                if (idx.m_step == nullptr) {
+                    this->visit_expr_wrapper(idx.m_right, true);
+                    start = end = builder->CreateSExtOrTrunc(tmp, i32);
+                    step = llvm::ConstantInt::get(i32, 1);
+                } else {
+                    if (idx.m_left) {
+                        this->visit_expr_wrapper(idx.m_left, true);
+                        start = builder->CreateSExtOrTrunc(tmp, i32);
+                    } else {
+                        start = arr_descr->get_lower_bound(dim);
+                    }
+                    if (idx.m_right) {
+                        this->visit_expr_wrapper(idx.m_right, true);
+                        end = builder->CreateSExtOrTrunc(tmp, i32);
+                    } else {
+                        end = arr_descr->get_upper_bound(dim);
+                    }
+                    this->visit_expr_wrapper(idx.m_step, true);
+                    step = builder->CreateSExtOrTrunc(tmp, i32);
+                }
+                starts.push_back(start);
+                ends.push_back(end);
+                steps.push_back(step);
+            }
+            arr_descr->fill_array_section(view, array, starts, ends, steps,
+                section->n_args);
+            return;
+        }
         ASR::Variable_t *asr_target = EXPR2VAR(x.m_target);
         ASR::Variable_t *asr_value = EXPR2VAR(x.m_value);
         uint32_t value_h = get_hash((ASR::asr_t*)asr_value);
@@ -2519,6 +3514,37 @@ public:
             this->visit_stmt(*x.m_overloaded);
             return ;
         }
+        if (is_a<ASR::TupleConstant_t>(*x.m_target)) {
+            // `a, b = value`, the whole value is computed before any of
+            // the targets is written, so that `a, b = b, a` swaps
+            ASR::TupleConstant_t *targets = ASR::down_cast<ASR::TupleConstant_t>(
+                x.m_target);
+            this->visit_expr_wrapper(x.m_value, true);
+            llvm::Value *value = tmp;
+            for (size_t i = 0; i < targets->n_elements; i++) {
+                llvm::Value *item = builder->CreateExtractValue(value, i);
+                llvm::Value *target = get_container_pointer(targets->m_elements[i]);
+                if (is_a<ASR::Character_t>(*expr_type(targets->m_elements[i]))) {
+                    lfortran_str_call("_lfortran_str_assign",
+                        llvm::Type::getVoidTy(context), {target, item});
+                } else {
+                    builder->CreateStore(item, target);
+                }
+            }
+            return;
+        }
+        if (is_a<ASR::ListItem_t>(*x.m_target) ||
+                is_container(expr_type(x.m_target))) {
+            // The old buffers of a container are freed, the new value is a
+            // copy if it is referred to by name or by position elsewhere
+            llvm::Value *value = get_value_copy(x.m_value);
+            llvm::Value *target = get_container_pointer(x.m_target);
+            if (is_container(expr_type(x.m_target))) {
+                list_api->deepfree(target, *module);
+            }
+            builder->CreateStore(value, target);
+            return;
+        }
         llvm::Value *target, *value;
         uint32_t h;
         bool lhs_is_string_arrayref = false;
@@ -2566,17 +3592,35 @@ public:
                 }
             }
         }
-        this->visit_expr_wrapper(x.m_value, true);
-        value = tmp;
-        if ( is_a<ASR::Character_t>(*expr_type(x.m_value)) ) {
-            ASR::Character_t *t = ASR::down_cast<ASR::Character_t>(expr_type(x.m_value));
-            if (t->n_dims == 0) {
-                if (lhs_is_string_arrayref) {
-                    value = CreateLoad(value);
+        if (is_a<ASR::Var_t>(*x.m_target) &&
+                is_a<ASR::Character_t>(*expr_type(x.m_target)) &&
+                target->getType() == character_type->getPointerTo()) {
+            // A string variable, `s = s + x` appends to `s` in place
+            ASR::symbol_t *sym = ASR::down_cast<ASR::Var_t>(x.m_target)->m_v;
+            ASR::StringConcat_t *concat = nullptr;
+            if (is_a<ASR::StringConcat_t>(*x.m_value)) {
+                concat = ASR::down_cast<ASR::StringConcat_t>(x.m_value);
+                if (concat->m_value || !is_a<ASR::Var_t>(*concat->m_left) ||
+                        ASR::down_cast<ASR::Var_t>(concat->m_left)->m_v != sym) {
+                    concat = nullptr;
+                }
+            }
+            this->visit_expr_wrapper(concat ? concat->m_right : x.m_value, true);
+            lfortran_str_call(concat ? "_lfortran_str_append" : "_lfortran_str_assign",
+                llvm::Type::getVoidTy(context), {target, tmp});
+        } else {
+            this->visit_expr_wrapper(x.m_value, true);
+            value = tmp;
+            if ( is_a<ASR::Character_t>(*expr_type(x.m_value)) ) {
+                ASR::Character_t *t = ASR::down_cast<ASR::Character_t>(expr_type(x.m_value));
+                if (t->n_dims == 0) {
+                    if (lhs_is_string_arrayref) {
+                        value = CreateLoad(value);
+                    }
                 }
             }
+            set_alias_scope(builder->CreateStore(value, target), x.m_target);
         }
-        builder->CreateStore(value, target);
         auto finder = std::find(nested_globals.begin(),
                 nested_globals.end(), h);
         if (finder != nested_globals.end()) {
@@ -2614,6 +3658,7 @@ public:
             x->type == ASR::exprType::DerivedRef ) {
             if( load_ref ) {
                 tmp = CreateLoad(tmp);
+                set_alias_scope(tmp, x);
             }
         }
     }
@@ -2633,7 +3678,12 @@ public:
         llvm::Value *right = tmp;
         LFORTRAN_ASSERT(expr_type(x.m_left)->type == expr_type(x.m_right)->type);
         ASR::ttypeType optype = expr_type(x.m_left)->type;
-        if (optype == ASR::ttypeType::Integer) {
+        if (optype == ASR::ttypeType::Tuple) {
+            tmp = list_api->is_equal_by_value(left, right, *module);
+            if (x.m_op == ASR::cmpopType::NotEq) {
+                tmp = builder->CreateNot(tmp);
+            }
+        } else if (optype == ASR::ttypeType::Integer) {
             switch (x.m_op) {
                 case (ASR::cmpopType::Eq) : {
                     tmp = builder->CreateICmpEQ(left, right);
@@ -2696,10 +3746,10 @@ public:
                 }
             }
         } else if (optype == ASR::ttypeType::Complex) {
-            llvm::Value* real_left = complex_re(left, left->getType());
-            llvm::Value* real_right = complex_re(right, right->getType());
-            llvm::Value* img_left = complex_im(left, left->getType());
-            llvm::Value* img_right = complex_im(right, right->getType());
+            llvm::Value* real_left = complex_re(left);
+            llvm::Value* real_right = complex_re(right);
+            llvm::Value* img_left = complex_im(left);
+            llvm::Value* img_right = complex_im(right);
             llvm::Value *real_res, *img_res;
             switch (x.m_op) {
                 case (ASR::cmpopType::Eq) : {
@@ -2719,9 +3769,11 @@ public:
             }
             tmp = builder->CreateAnd(real_res, img_res);
         } else if (optype == ASR::ttypeType::Character) {
-            // TODO: For now we only compare the first character of the strings
-            left = CreateLoad(left);
-            right = CreateLoad(right);
+            // The strings are compared by the runtime, the result is
+            // compared with 0
+            left = lfortran_str_call("_lfortran_str_compare",
+                llvm::Type::getInt32Ty(context), {left, right});
+            right = llvm::ConstantInt::get(context, llvm::APInt(32, 0));
             switch (x.m_op) {
                 case (ASR::cmpopType::Eq) : {
                     tmp = builder->CreateICmpEQ(left, right);
@@ -2732,19 +3784,19 @@ public:
                     break;
                 }
                 case (ASR::cmpopType::Gt) : {
-                    tmp = builder->CreateICmpUGT(left, right);
+                    tmp = builder->CreateICmpSGT(left, right);
                     break;
                 }
                 case (ASR::cmpopType::GtE) : {
-                    tmp = builder->CreateICmpUGE(left, right);
+                    tmp = builder->CreateICmpSGE(left, right);
                     break;
                 }
                 case (ASR::cmpopType::Lt) : {
-                    tmp = builder->CreateICmpULT(left, right);
+                    tmp = builder->CreateICmpSLT(left, right);
                     break;
                 }
                 case (ASR::cmpopType::LtE) : {
-                    tmp = builder->CreateICmpULE(left, right);
+                    tmp = builder->CreateICmpSLE(left, right);
                     break;
                 }
                 default : {
@@ -2820,9 +3872,17 @@ public:
         llvm::BasicBlock *loopend = llvm::BasicBlock::Create(context, "loop.end");
         this->current_loophead = loophead;
         this->current_loopend = loopend;
+        // The temporary strings of an iteration are released before the
+        // next one
+        llvm::Value *arena_mark = nullptr;
+        ASR::stmt_t *loop = (ASR::stmt_t*)&x;
+        if (creates_string_temporaries(&loop, 1)) {
+            arena_mark = string_arena_mark();
+        }
 
         // head
         start_new_block(loophead);
+        if (arena_mark) string_arena_release(arena_mark);
         this->visit_expr_wrapper(x.m_test, true);
         llvm::Value *cond = tmp;
         builder->CreateCondBr(cond, loopbody, loopend);
@@ -2836,6 +3896,7 @@ public:
 
         // end
         start_new_block(loopend);
+        if (arena_mark) string_arena_release(arena_mark);
     }
 
     void visit_Exit(const ASR::Exit_t & /* x */) {
@@ -2924,7 +3985,9 @@ public:
         llvm::Value *left_val = tmp;
         this->visit_expr_wrapper(x.m_right, true);
         llvm::Value *right_val = tmp;
-        tmp = lfortran_strrepeat(left_val, right_val);
+        tmp = lfortran_str_call("_lfortran_str_repeat", character_type,
+            {left_val, builder->CreateSExtOrTrunc(right_val,
+            llvm::Type::getInt32Ty(context))});
     }
 
     void visit_StringConcat(const ASR::StringConcat_t &x) {
@@ -2936,7 +3999,8 @@ public:
         llvm::Value *left_val = tmp;
         this->visit_expr_wrapper(x.m_right, true);
         llvm::Value *right_val = tmp;
-        tmp = lfortran_strop(left_val, right_val, "_lfortran_strcat");
+        tmp = lfortran_str_call("_lfortran_str_concat", character_type,
+            {left_val, right_val});
     }
 
     void visit_StringLen(const ASR::StringLen_t &x) {
@@ -2945,9 +4009,88 @@ public:
             return;
         }
         this->visit_expr_wrapper(x.m_arg, true);
-        llvm::AllocaInst *parg = builder->CreateAlloca(character_type, nullptr);
-        builder->CreateStore(tmp, parg);
-        tmp = lfortran_str_len(parg);
+        tmp = lfortran_str_len(tmp);
+    }
+
+    // Returns `base` raised to the integer power `exp` (of the same type) by
+    // squaring, exactly and wrapping around on overflow. A negative `exp`
+    // gives the integer part of the result: 0, or +-1 for a `base` of +-1.
+    llvm::Value* integer_pow(llvm::Value *base, llvm::Value *exp) {
+        llvm::Type *type = base->getType();
+        llvm::Value *zero = llvm::ConstantInt::get(type, 0);
+        llvm::Value *one = llvm::ConstantInt::get(type, 1);
+        if (llvm::ConstantInt *c = llvm::dyn_cast<llvm::ConstantInt>(exp)) {
+            if (!c->isNegative()) {
+                uint64_t n = c->getZExtValue();
+                llvm::Value *result = one;
+                llvm::Value *p = base;
+                while (n > 0) {
+                    if (n & 1) {
+                        result = result == one ? p : builder->CreateMul(result, p);
+                    }
+                    n >>= 1;
+                    if (n > 0) p = builder->CreateMul(p, p);
+                }
+                return result;
+            }
+        }
+        llvm::Value *pbase = list_api->create_alloca(type);
+        llvm::Value *pexp = list_api->create_alloca(type);
+        llvm::Value *presult = list_api->create_alloca(type);
+        builder->CreateStore(base, pbase);
+        builder->CreateStore(exp, pexp);
+        builder->CreateStore(one, presult);
+        llvm::BasicBlock *loophead = llvm::BasicBlock::Create(context, "pow.head");
+        llvm::BasicBlock *loopbody = llvm::BasicBlock::Create(context, "pow.body");
+        llvm::BasicBlock *loopend = llvm::BasicBlock::Create(context, "pow.end");
+        start_new_block(loophead);
+        llvm::Value *e = CreateLoad(pexp);
+        builder->CreateCondBr(builder->CreateICmpSGT(e, zero), loopbody, loopend);
+        start_new_block(loopbody);
+        llvm::Value *b = CreateLoad(pbase);
+        llvm::Value *r = CreateLoad(presult);
+        builder->CreateStore(builder->CreateSelect(builder->CreateICmpNE(
+            builder->CreateAnd(e, one), zero), builder->CreateMul(r, b), r),
+            presult);
+        builder->CreateStore(builder->CreateMul(b, b), pbase);
+        builder->CreateStore(builder->CreateLShr(e, one), pexp);
+        builder->CreateBr(loophead);
+        start_new_block(loopend);
+        llvm::Value *result = CreateLoad(presult);
+        llvm::Value *minus_one = llvm::ConstantInt::get(type, -1, true);
+        llvm::Value *negative = builder->CreateSelect(
+            builder->CreateICmpEQ(base, one), one, builder->CreateSelect(
+            builder->CreateICmpEQ(base, minus_one), builder->CreateSelect(
+            builder->CreateICmpNE(builder->CreateAnd(exp, one), zero),
+            minus_one, one), zero));
+        return builder->CreateSelect(builder->CreateICmpSLT(exp, zero),
+            negative, result);
+    }
+
+    // Raises ZeroDivisionError if the integer `divisor` is zero. sdiv/srem
+    // of the most negative value by -1 overflow, so -1 is replaced by 1 in
+    // the returned divisor and `is_minus_one` is set to the condition (left
+    // nullptr for constant divisors other than 0 and -1).
+    llvm::Value* check_int_divisor(llvm::Value *divisor,
+            llvm::Value *&is_minus_one) {
+        is_minus_one = nullptr;
+        if (llvm::ConstantInt *c = llvm::dyn_cast<llvm::ConstantInt>(divisor)) {
+            if (!c->isZero() && !c->isMinusOne()) return divisor;
+        }
+        llvm::BasicBlock *errorBB = llvm::BasicBlock::Create(context, "zerodiv.error");
+        llvm::BasicBlock *contBB = llvm::BasicBlock::Create(context, "zerodiv.cont");
+        llvm::MDBuilder md(context);
+        llvm::Value *zero = llvm::ConstantInt::get(divisor->getType(), 0);
+        builder->CreateCondBr(builder->CreateICmpEQ(divisor, zero), errorBB,
+            contBB, md.createBranchWeights(1, 1000));
+        start_new_block(errorBB);
+        list_api->raise_error(*module,
+            "ZeroDivisionError: integer division or modulo by zero");
+        start_new_block(contBB);
+        llvm::Value *one = llvm::ConstantInt::get(divisor->getType(), 1);
+        is_minus_one = builder->CreateICmpEQ(divisor,
+            llvm::ConstantInt::get(divisor->getType(), -1, true));
+        return builder->CreateSelect(is_minus_one, one, divisor);
     }
 
     void visit_BinOp(const ASR::BinOp_t &x) {
@@ -2978,30 +4121,41 @@ public:
                     break;
                 };
                 case ASR::binopType::Div: {
-                    tmp = builder->CreateUDiv(left_val, right_val);
+                    tmp = builder->CreateSDiv(left_val, right_val);
                     break;
                 };
-                case ASR::binopType::Pow: {
-                    llvm::Type *type;
-                    int a_kind;
-                    a_kind = down_cast<ASR::Integer_t>(ASRUtils::type_get_past_pointer(x.m_type))->m_kind;
-                    type = getFPType(a_kind);
-                    llvm::Value *fleft = builder->CreateSIToFP(left_val,
-                            type);
-                    llvm::Value *fright = builder->CreateSIToFP(right_val,
-                            type);
-                    std::string func_name = a_kind == 4 ? "llvm.pow.f32" : "llvm.pow.f64";
-                    llvm::Function *fn_pow = module->getFunction(func_name);
-                    if (!fn_pow) {
-                        llvm::FunctionType *function_type = llvm::FunctionType::get(
-                                type, { type, type}, false);
-                        fn_pow = llvm::Function::Create(function_type,
-                                llvm::Function::ExternalLinkage, func_name,
-                                module.get());
+                case ASR::binopType::FloorDiv:
+                case ASR::binopType::Mod: {
+                    // sdiv/srem round towards zero. If the remainder is not
+                    // zero and its sign differs from the divisor's, the
+                    // quotient is one less and the divisor is added to the
+                    // remainder.
+                    llvm::Value *is_minus_one = nullptr;
+                    llvm::Value *divisor = check_int_divisor(right_val,
+                        is_minus_one);
+                    llvm::Value *q = builder->CreateSDiv(left_val, divisor);
+                    llvm::Value *r = builder->CreateSRem(left_val, divisor);
+                    llvm::Value *zero = llvm::ConstantInt::get(r->getType(), 0);
+                    if (is_minus_one) {
+                        // Wraps around for the most negative value
+                        q = builder->CreateSelect(is_minus_one,
+                            builder->CreateSub(zero, left_val), q);
+                    }
+                    llvm::Value *fix = builder->CreateAnd(
+                        builder->CreateICmpNE(r, zero),
+                        builder->CreateICmpSLT(
+                            builder->CreateXor(r, right_val), zero));
+                    if (x.m_op == ASR::binopType::FloorDiv) {
+                        tmp = builder->CreateSub(q,
+                            builder->CreateZExt(fix, q->getType()));
+                    } else {
+                        tmp = builder->CreateAdd(r,
+                            builder->CreateSelect(fix, right_val, zero));
                     }
-                    tmp = builder->CreateCall(fn_pow, {fleft, fright});
-                    type = getIntType(a_kind);
-                    tmp = builder->CreateFPToSI(tmp, type);
+                    break;
+                };
+                case ASR::binopType::Pow: {
+                    tmp = integer_pow(left_val, right_val);
                     break;
                 };
             }
@@ -3040,6 +4194,11 @@ public:
                     tmp = builder->CreateCall(fn_pow, {left_val, right_val});
                     break;
                 };
+                case ASR::binopType::FloorDiv:
+                case ASR::binopType::Mod: {
+                    // Implemented by `_compy_floordiv` and `_mod`
+                    throw CodeGenError("Binop: FloorDiv and Mod are only implemented for integers");
+                };
             }
         } else if (ASRUtils::is_complex(*x.m_type)) {
             llvm::Type *type;
@@ -3052,39 +4211,33 @@ public:
             if( right_val->getType()->isPointerTy() ) {
                 right_val = CreateLoad(right_val);
             }
+            // Add, Sub, Mul and Div are computed inline on the {re, im}
+            // pair, Pow calls the runtime
+            llvm::Value *a = complex_re(left_val), *b = complex_im(left_val);
+            llvm::Value *c = complex_re(right_val), *d = complex_im(right_val);
             std::string fn_name;
             switch (x.m_op) {
                 case ASR::binopType::Add: {
-                    if (a_kind == 4) {
-                        fn_name = "_lfortran_complex_add_32";
-                    } else {
-                        fn_name = "_lfortran_complex_add_64";
-                    }
-                    break;
+                    tmp = complex_from_floats(builder->CreateFAdd(a, c),
+                        builder->CreateFAdd(b, d), type);
+                    return;
                 };
                 case ASR::binopType::Sub: {
-                    if (a_kind == 4) {
-                        fn_name = "_lfortran_complex_sub_32";
-                    } else {
-                        fn_name = "_lfortran_complex_sub_64";
-                    }
-                    break;
+                    tmp = complex_from_floats(builder->CreateFSub(a, c),
+                        builder->CreateFSub(b, d), type);
+                    return;
                 };
                 case ASR::binopType::Mul: {
-                    if (a_kind == 4) {
-                        fn_name = "_lfortran_complex_mul_32";
-                    } else {
-                        fn_name = "_lfortran_complex_mul_64";
-                    }
-                    break;
+                    tmp = complex_from_floats(
+                        builder->CreateFSub(builder->CreateFMul(a, c),
+                            builder->CreateFMul(b, d)),
+                        builder->CreateFAdd(builder->CreateFMul(a, d),
+                            builder->CreateFMul(b, c)), type);
+                    return;
                 };
                 case ASR::binopType::Div: {
-                    if (a_kind == 4) {
-                        fn_name = "_lfortran_complex_div_32";
-                    } else {
-                        fn_name = "_lfortran_complex_div_64";
-                    }
-                    break;
+                    tmp = complex_div(left_val, right_val, type);
+                    return;
                 };
                 case ASR::binopType::Pow: {
                     if (a_kind == 4) {
@@ -3094,6 +4247,10 @@ public:
                     }
                     break;
                 };
+                case ASR::binopType::FloorDiv:
+                case ASR::binopType::Mod: {
+                    throw CodeGenError("Binop: FloorDiv and Mod are not defined for complex numbers");
+                };
             }
             tmp = lfortran_complex_bin_op(left_val, right_val, fn_name, type);
         } else {
@@ -3338,7 +4495,7 @@ public:
 
 
     void visit_StringConstant(const ASR::StringConstant_t &x) {
-        tmp = builder->CreateGlobalStringPtr(x.m_s);
+        tmp = get_string_literal(x.m_s);
     }
 
     inline void fetch_ptr(ASR::Variable_t* x) {
@@ -3461,19 +4618,19 @@ public:
         llvm::Value *re;
         if (arg_kind == 4 && dest_kind == 4) {
             // complex(4) -> real(4)
-            re = complex_re(tmp, complex_type_4);
+            re = complex_re(tmp);
             tmp = re;
         } else if (arg_kind == 4 && dest_kind == 8) {
             // complex(4) -> real(8)
-            re = complex_re(tmp, complex_type_4);
+            re = complex_re(tmp);
             tmp = builder->CreateFPExt(re, llvm::Type::getDoubleTy(context));
         } else if (arg_kind == 8 && dest_kind == 4) {
             // complex(8) -> real(4)
-            re = complex_re(tmp, complex_type_8);
+            re = complex_re(tmp);
             tmp = builder->CreateFPTrunc(re, llvm::Type::getFloatTy(context));
         } else if (arg_kind == 8 && dest_kind == 8) {
             // complex(8) -> real(8)
-            re = complex_re(tmp, complex_type_8);
+            re = complex_re(tmp);
             tmp = re;
         } else {
             std::string msg = "Conversion from " + std::to_string(arg_kind) +
@@ -3483,41 +4640,8 @@ public:
     }
 
     void visit_ComplexIm(const ASR::ComplexIm_t &x) {
-        ASR::ttype_t* curr_type = extract_ttype_t_from_expr(x.m_arg);
-        int arg_kind = ASRUtils::extract_kind_from_ttype_t(curr_type);
-        llvm::Function *fn = nullptr;
-        llvm::Type *ret_type = nullptr, *complex_type = nullptr;
-        llvm::AllocaInst *arg = nullptr;
-        std::string runtime_func_name = "";
-        if (arg_kind == 4) {
-            runtime_func_name = "_lfortran_complex_aimag_32";
-            ret_type = llvm::Type::getFloatTy(context);
-            complex_type = complex_type_4;
-            arg = builder->CreateAlloca(complex_type_4,
-                nullptr);
-        } else {
-             runtime_func_name = "_lfortran_complex_aimag_64";
-            ret_type = llvm::Type::getDoubleTy(context);
-            complex_type = complex_type_8;
-            arg = builder->CreateAlloca(complex_type_8,
-                nullptr);
-        }
-        fn = module->getFunction(runtime_func_name);
-        if (!fn) {
-            llvm::FunctionType *function_type = llvm::FunctionType::get(
-                    llvm::Type::getVoidTy(context), {
-                        complex_type->getPointerTo(),
-                        ret_type->getPointerTo(),
-                    }, true);
-            fn = llvm::Function::Create(function_type,
-                    llvm::Function::ExternalLinkage, runtime_func_name, *module);
-        }
         this->visit_expr_wrapper(x.m_arg, true);
-        builder->CreateStore(tmp, arg);
-        llvm::AllocaInst *result = builder->CreateAlloca(ret_type, nullptr);
-        std::vector<llvm::Value*> args = {arg, result};
-        builder->CreateCall(fn, args);
-        tmp = CreateLoad(result);
+        tmp = complex_im(tmp);
     }
 
     void visit_Cast(const ASR::Cast_t &x) {
@@ -3677,15 +4801,15 @@ public:
                 {
                     if( arg_kind == 4 && dest_kind == 8 ) {
                         target_type = complex_type_8;
-                        re = complex_re(tmp, complex_type_4);
+                        re = complex_re(tmp);
                         re = builder->CreateFPExt(re, llvm::Type::getDoubleTy(context));
-                        im = complex_im(tmp, complex_type_4);
+                        im = complex_im(tmp);
                         im = builder->CreateFPExt(im, llvm::Type::getDoubleTy(context));
                     } else if( arg_kind == 8 && dest_kind == 4 ) {
                         target_type = complex_type_4;
-                        re = complex_re(tmp, complex_type_8);
+                        re = complex_re(tmp);
                         re = builder->CreateFPTrunc(re, llvm::Type::getFloatTy(context));
-                        im = complex_im(tmp, complex_type_8);
+                        im = complex_im(tmp);
                         im = builder->CreateFPTrunc(im, llvm::Type::getFloatTy(context));
                     } else {
                         std::string msg = "Conversion from " + std::to_string(arg_kind) +
@@ -3706,19 +4830,19 @@ public:
                 {
                     if( arg_kind == 4 && dest_kind == 4 ) {
                         // complex(4) -> real(4)
-                        re = complex_re(tmp, complex_type_4);
+                        re = complex_re(tmp);
                         tmp = re;
                     } else if( arg_kind == 4 && dest_kind == 8 ) {
                         // complex(4) -> real(8)
-                        re = complex_re(tmp, complex_type_4);
+                        re = complex_re(tmp);
                         tmp = builder->CreateFPExt(re, llvm::Type::getDoubleTy(context));
                     } else if( arg_kind == 8 && dest_kind == 4 ) {
                         // complex(8) -> real(4)
-                        re = complex_re(tmp, complex_type_8);
+                        re = complex_re(tmp);
                         tmp = builder->CreateFPTrunc(re, llvm::Type::getFloatTy(context));
                     } else if( arg_kind == 8 && dest_kind == 8 ) {
                         // complex(8) -> real(8)
-                        re = complex_re(tmp, complex_type_8);
+                        re = complex_re(tmp);
                         tmp = re;
                     } else {
                         std::string msg = "Conversion from " + std::to_string(arg_kind) +
@@ -3770,114 +4894,219 @@ public:
         handle_print(x);
     }
 
-    template <typename T>
-    void handle_print(const T &x) {
-        std::vector<llvm::Value *> args;
-        std::vector<std::string> fmt;
-        for (size_t i=0; i<x.n_values; i++) {
-            this->visit_expr_wrapper(x.m_values[i], true);
-            ASR::expr_t *v = x.m_values[i];
-            ASR::ttype_t *t = expr_type(v);
-            int a_kind = ASRUtils::extract_kind_from_ttype_t(t);
-            if (ASRUtils::is_integer(*t) ||
-                ASR::is_a<ASR::Logical_t>(*ASRUtils::type_get_past_pointer(t))) {
-                switch( a_kind ) {
-                    case 1 : {
-                        fmt.push_back("%d");
-                        break;
-                    }
-                    case 2 : {
-                        fmt.push_back("%d");
-                        break;
-                    }
-                    case 4 : {
-                        fmt.push_back("%d");
-                        break;
-                    }
-                    case 8 : {
-                        fmt.push_back("%lld");
-                        break;
-                    }
-                    default: {
-                        throw CodeGenError(R"""(Printing support is available only
-                                            for 8, 16, 32, and 64 bit integer kinds.)""",
-                                            x.base.base.loc);
-                    }
+    // Calls `_compy_write_<suffix>(v)` of the buffered output runtime
+    void write_value(const std::string &suffix, llvm::Value *v) {
+        std::string fn_name = "_compy_write_" + suffix;
+        llvm::Function *fn = module->getFunction(fn_name);
+        if (!fn) {
+            llvm::FunctionType *function_type = llvm::FunctionType::get(
+                    llvm::Type::getVoidTy(context), {v->getType()}, false);
+            fn = llvm::Function::Create(function_type,
+                    llvm::Function::ExternalLinkage, fn_name, *module);
+        }
+        builder->CreateCall(fn, {v});
+    }
+
+    void write_char(char c) {
+        write_value("char", llvm::ConstantInt::get(context,
+            llvm::APInt(32, c)));
+    }
+
+    // Writes `tmp` of the type `t`, the elements of lists, dicts and sets
+    // are written by a loop in the generated code
+    void write_typed_value(ASR::ttype_t *t, const Location &loc) {
+        int a_kind = ASRUtils::extract_kind_from_ttype_t(t);
+        if (ASR::is_a<ASR::Logical_t>(*ASRUtils::type_get_past_pointer(t))) {
+            write_value("i32", builder->CreateZExt(tmp,
+                llvm::Type::getInt32Ty(context)));
+        } else if (ASRUtils::is_integer(*t)) {
+            switch( a_kind ) {
+                case 1 :
+                case 2 : {
+                    write_value("i32", builder->CreateSExt(tmp,
+                        llvm::Type::getInt32Ty(context)));
+                    break;
                 }
-                args.push_back(tmp);
-            } else if (ASRUtils::is_real(*t)) {
-                llvm::Value *d;
-                switch( a_kind ) {
-                    case 4 : {
-                        // Cast float to double as a workaround for the fact that
-                        // vprintf() seems to cast to double even for %f, which
-                        // causes it to print 0.000000.
-                        fmt.push_back("%f");
-                        d = builder->CreateFPExt(tmp,
-                        llvm::Type::getDoubleTy(context));
-                        break;
-                    }
-                    case 8 : {
-                        fmt.push_back("%23.17f");
-                        d = builder->CreateFPExt(tmp,
-                        llvm::Type::getDoubleTy(context));
-                        break;
-                    }
-                    default: {
-                        throw CodeGenError(R"""(Printing support is available only
-                                            for 32, and 64 bit real kinds.)""",
-                                            x.base.base.loc);
-                    }
+                case 4 : {
+                    write_value("i32", tmp);
+                    break;
                 }
-                args.push_back(d);
-            } else if (t->type == ASR::ttypeType::Character) {
-                fmt.push_back("%s");
-                args.push_back(tmp);
-            } else if (ASRUtils::is_complex(*t)) {
-                llvm::Type *type, *complex_type;
-                switch( a_kind ) {
-                    case 4 : {
-                        // Cast float to double as a workaround for the fact that
-                        // vprintf() seems to cast to double even for %f, which
-                        // causes it to print 0.000000.
-                        fmt.push_back("(%f,%f)");
-                        type = llvm::Type::getDoubleTy(context);
-                        complex_type = complex_type_4;
-                        break;
-                    }
-                    case 8 : {
-                        fmt.push_back("(%lf,%lf)");
-                        type = llvm::Type::getDoubleTy(context);
-                        complex_type = complex_type_8;
-                        break;
-                    }
-                    default: {
-                        throw CodeGenError(R"""(Printing support is available only
-                                            for 32, and 64 bit complex kinds.)""",
-                                            x.base.base.loc);
-                    }
+                case 8 : {
+                    write_value("i64", tmp);
+                    break;
+                }
+                default: {
+                    throw CodeGenError(R"""(Printing support is available only
+                                        for 8, 16, 32, and 64 bit integer kinds.)""",
+                                        loc);
+                }
+            }
+        } else if (ASRUtils::is_real(*t)) {
+            switch( a_kind ) {
+                case 4 : {
+                    write_value("f32", tmp);
+                    break;
                 }
-                llvm::Value *d;
-                d = builder->CreateFPExt(complex_re(tmp, complex_type), type);
-                args.push_back(d);
-                d = builder->CreateFPExt(complex_im(tmp, complex_type), type);
-                args.push_back(d);
+                case 8 : {
+                    write_value("f64", tmp);
+                    break;
+                }
+                default: {
+                    throw CodeGenError(R"""(Printing support is available only
+                                        for 32, and 64 bit real kinds.)""",
+                                        loc);
+                }
+            }
+        } else if (t->type == ASR::ttypeType::Character) {
+            write_value("str", tmp);
+        } else if (ASRUtils::is_complex(*t)) {
+            std::string suffix;
+            switch( a_kind ) {
+                case 4 : {
+                    suffix = "f32";
+                    break;
+                }
+                case 8 : {
+                    suffix = "f64";
+                    break;
+                }
+                default: {
+                    throw CodeGenError(R"""(Printing support is available only
+                                        for 32, and 64 bit complex kinds.)""",
+                                        loc);
+                }
+            }
+            llvm::Value *c = tmp;
+            write_char('(');
+            write_value(suffix, complex_re(c));
+            write_char(',');
+            write_value(suffix, complex_im(c));
+            write_char(')');
+        } else if (ASR::is_a<ASR::List_t>(*t)) {
+            ASR::ttype_t *el_type = ASR::down_cast<ASR::List_t>(t)->m_type;
+            llvm::Value *plist = list_api->create_alloca(tmp->getType());
+            builder->CreateStore(tmp, plist);
+            write_char('[');
+            llvm::Value *n = list_api->len(plist);
+            llvm::Value *zero = llvm::ConstantInt::get(context, llvm::APInt(32, 0));
+            llvm::BasicBlock *loophead = llvm::BasicBlock::Create(context, "print.list.head");
+            llvm::BasicBlock *loopbody = llvm::BasicBlock::Create(context, "print.list.body");
+            llvm::BasicBlock *sepBB = llvm::BasicBlock::Create(context, "print.list.sep");
+            llvm::BasicBlock *itemBB = llvm::BasicBlock::Create(context, "print.list.item");
+            llvm::BasicBlock *loopend = llvm::BasicBlock::Create(context, "print.list.end");
+            llvm::Value *pi = list_api->create_alloca(llvm::Type::getInt32Ty(context));
+            builder->CreateStore(zero, pi);
+            start_new_block(loophead);
+            llvm::Value *i = CreateLoad(pi);
+            builder->CreateCondBr(builder->CreateICmpSLT(i, n), loopbody, loopend);
+            start_new_block(loopbody);
+            builder->CreateCondBr(builder->CreateICmpSGT(i, zero), sepBB, itemBB);
+            start_new_block(sepBB);
+            write_char(',');
+            write_char(' ');
+            start_new_block(itemBB);
+            tmp = list_api->read_item(plist, i);
+            bool is_str = ASR::is_a<ASR::Character_t>(*el_type);
+            if (is_str) write_char('\'');
+            write_typed_value(el_type, loc);
+            if (is_str) write_char('\'');
+            builder->CreateStore(builder->CreateAdd(i,
+                llvm::ConstantInt::get(context, llvm::APInt(32, 1))), pi);
+            builder->CreateBr(loophead);
+            start_new_block(loopend);
+            write_char(']');
+        } else if (ASR::is_a<ASR::Dict_t>(*t) || ASR::is_a<ASR::Set_t>(*t)) {
+            // The items are written in the order of the slots of the table
+            ASR::ttype_t *key_type, *value_type = nullptr;
+            if (ASR::is_a<ASR::Dict_t>(*t)) {
+                key_type = ASR::down_cast<ASR::Dict_t>(t)->m_key_type;
+                value_type = ASR::down_cast<ASR::Dict_t>(t)->m_value_type;
             } else {
-                throw LFortranException("Printing support is available only for integer, real,"
-                    " character, and complex types.");
+                key_type = ASR::down_cast<ASR::Set_t>(t)->m_type;
+            }
+            llvm::Value *ptable = list_api->create_alloca(tmp->getType());
+            builder->CreateStore(tmp, ptable);
+            llvm::Value *pfirst = list_api->create_alloca(llvm::Type::getInt1Ty(context));
+            builder->CreateStore(llvm::ConstantInt::getTrue(context), pfirst);
+            llvm::BasicBlock *emptysetBB = llvm::BasicBlock::Create(context, "print.set.empty");
+            llvm::BasicBlock *itemsBB = llvm::BasicBlock::Create(context, "print.dict");
+            llvm::BasicBlock *endBB = llvm::BasicBlock::Create(context, "print.dict.end");
+            if (!value_type) {
+                builder->CreateCondBr(builder->CreateICmpEQ(dict_api->len(ptable),
+                    llvm::ConstantInt::get(context, llvm::APInt(32, 0))),
+                    emptysetBB, itemsBB);
+                start_new_block(emptysetBB);
+                write_value("str", builder->CreateGlobalStringPtr("set()"));
+                builder->CreateBr(endBB);
+            }
+            start_new_block(itemsBB);
+            write_char('{');
+            auto write_item = [&](ASR::ttype_t *type) {
+                bool is_str = ASR::is_a<ASR::Character_t>(*type);
+                if (is_str) write_char('\'');
+                write_typed_value(type, loc);
+                if (is_str) write_char('\'');
+            };
+            dict_api->for_each(ptable, [&](llvm::Value *slot) {
+                llvm::BasicBlock *sepBB = llvm::BasicBlock::Create(context, "print.dict.sep");
+                llvm::BasicBlock *itemBB = llvm::BasicBlock::Create(context, "print.dict.item");
+                builder->CreateCondBr(CreateLoad(pfirst), itemBB, sepBB);
+                start_new_block(sepBB);
+                write_char(',');
+                write_char(' ');
+                start_new_block(itemBB);
+                builder->CreateStore(llvm::ConstantInt::getFalse(context), pfirst);
+                tmp = dict_api->read_key(ptable, slot);
+                write_item(key_type);
+                if (value_type) {
+                    write_char(':');
+                    write_char(' ');
+                    tmp = dict_api->read_value(ptable, slot);
+                    write_item(value_type);
+                }
+            });
+            write_char('}');
+            start_new_block(endBB);
+        } else if (ASR::is_a<ASR::Tuple_t>(*t)) {
+            ASR::Tuple_t *tuple_type = ASR::down_cast<ASR::Tuple_t>(t);
+            llvm::Value *tuple = tmp;
+            write_char('(');
+            for (size_t i = 0; i < tuple_type->n_type; i++) {
+                if (i > 0) {
+                    write_char(',');
+                    write_char(' ');
+                }
+                ASR::ttype_t *el_type = tuple_type->m_type[i];
+                bool is_str = ASR::is_a<ASR::Character_t>(*el_type);
+                tmp = builder->CreateExtractValue(tuple, i);
+                if (is_str) write_char('\'');
+                write_typed_value(el_type, loc);
+                if (is_str) write_char('\'');
             }
+            if (tuple_type->n_type == 1) write_char(',');
+            write_char(')');
+        } else {
+            throw LFortranException("Printing support is available only for integer, real,"
+                " character, complex, list, dict, set and tuple types.");
         }
-        std::string fmt_str;
-        for (size_t i=0; i<fmt.size(); i++) {
-            fmt_str += fmt[i];
-            if (i < fmt.size()-1) fmt_str += " ";
+    }
+
+    template <typename T>
+    void handle_print(const T &x) {
+        // Each value is written by a typed call, no format string is
+        // built or parsed at runtime. All values are evaluated before the
+        // first one is written, as a call in them can print too.
+        std::vector<llvm::Value*> values;
+        for (size_t i=0; i<x.n_values; i++) {
+            this->visit_expr_wrapper(x.m_values[i], true);
+            values.push_back(tmp);
         }
-        fmt_str += "\n";
-        llvm::Value *fmt_ptr = builder->CreateGlobalStringPtr(fmt_str);
-        std::vector<llvm::Value *> printf_args;
-        printf_args.push_back(fmt_ptr);
-        printf_args.insert(printf_args.end(), args.begin(), args.end());
-        printf(context, *module, *builder, printf_args);
+        for (size_t i=0; i<x.n_values; i++) {
+            if (i > 0) write_char(' ');
+            tmp = values[i];
+            write_typed_value(expr_type(x.m_values[i]), x.base.base.loc);
+        }
+        write_char('\n');
     }
 
     void visit_Stop(const ASR::Stop_t &x) {
@@ -3981,11 +5210,9 @@ public:
                                 tmp = arr_descr->convert_to_argument(tmp, new_arr_type);
                             } else if ( x_abi == ASR::abiType::BindC ) {
                                 if( arr_descr->is_array(tmp) ) {
-                                    tmp = CreateLoad(arr_descr->get_pointer_to_data(tmp));
-                                    llvm::PointerType* tmp_type = static_cast<llvm::PointerType*>(tmp->getType());
-                                    if( tmp_type->getElementType()->isArrayTy() ) {
-                                        tmp = llvm_utils->create_gep(tmp, 0);
-                                    }
+                                    tmp = get_bindc_array_data(tmp,
+                                        PassUtils::get_rank(x.m_args[i].m_value),
+                                        orig_arg->m_intent != ASRUtils::intent_in);
                                 } else {
                                     if (orig_arg->m_abi == ASR::abiType::BindC
                                         && orig_arg->m_value_attr) {
@@ -4072,6 +5299,9 @@ public:
                             tmp = llvm_symtab_fn_arg[h];
                         }
                     }
+                } else if (is_container(expr_type(x.m_args[i].m_value))) {
+                    // Lists, dicts and sets are passed by reference
+                    tmp = get_container_pointer(x.m_args[i].m_value);
                 } else {
                     this->visit_expr_wrapper(x.m_args[i].m_value);
                     llvm::Value *value=tmp;
@@ -4115,6 +5345,9 @@ public:
                         case (ASR::ttypeType::Logical) :
                             target_type = llvm::Type::getInt1Ty(context);
                             break;
+                        case (ASR::ttypeType::Tuple) :
+                            target_type = value->getType();
+                            break;
                         case (ASR::ttypeType::Derived) :
                             break;
                         default :
@@ -4228,6 +5461,175 @@ public:
         return false;
     }
 
+    // Returns the name of the builtin (e.g. `abs`) that `s` implements if it
+    // comes from the `builtin_functions` runtime module, otherwise ""
+    std::string get_builtin_name(const ASR::Function_t *s) {
+        ASR::Module_t *m = ASRUtils::get_sym_module0((ASR::symbol_t*)s);
+        if (m == nullptr || std::string(m->m_name) != "builtin_functions") {
+            return "";
+        }
+        std::string name = s->m_name;
+        // The overloads are named `__compy_overloaded_<n>__<name>`
+        std::string prefix = "__compy_overloaded_";
+        if (startswith(name, prefix)) {
+            size_t pos = name.find("__", prefix.size());
+            if (pos != std::string::npos) name = name.substr(pos + 2);
+        }
+        return name;
+    }
+
+    // Emits the pure builtins `abs`, `min`, `max`, `pow`, `round` and
+    // `_bitwise_*` as instructions instead of calls, so that the loops that
+    // use them can be vectorized. Returns false if the call has to be made.
+    bool generate_builtin_instructions(const ASR::Function_t *s,
+            const ASR::FunctionCall_t &x) {
+        std::string name = get_builtin_name(s);
+        if (name.empty()) return false;
+        std::vector<ASR::ttype_t*> types;
+        for (size_t i = 0; i < x.n_args; i++) {
+            ASR::expr_t *e = x.m_args[i].m_value;
+            ASR::ttype_t *t = ASRUtils::expr_type(e);
+            // ArrayRef carries the type of the array, an element reference
+            // is a scalar
+            bool is_element = false;
+            if (ASR::is_a<ASR::ArrayRef_t>(*e)) {
+                ASR::ArrayRef_t *ref = ASR::down_cast<ASR::ArrayRef_t>(e);
+                is_element = true;
+                for (size_t j = 0; j < ref->n_args; j++) {
+                    if (ref->m_args[j].m_left || ref->m_args[j].m_step) {
+                        is_element = false;
+                    }
+                }
+            }
+            if ((ASRUtils::is_array(t) && !is_element)
+                    || !(ASRUtils::is_integer(*t) || ASRUtils::is_real(*t))) {
+                return false;
+            }
+            types.push_back(t);
+        }
+        auto same_types = [&]() {
+            for (size_t i = 1; i < types.size(); i++) {
+                if (!ASRUtils::check_equal_type(types[0], types[i])) return false;
+            }
+            return true;
+        };
+        auto arg = [&](size_t i) {
+            this->visit_expr_wrapper(x.m_args[i].m_value, true);
+            return tmp;
+        };
+        if (name == "abs" && x.n_args == 1) {
+            llvm::Value *v = arg(0);
+            if (ASRUtils::is_real(*types[0])) {
+                tmp = builder->CreateUnaryIntrinsic(llvm::Intrinsic::fabs, v);
+            } else {
+                llvm::Value *zero = llvm::ConstantInt::get(v->getType(), 0);
+                tmp = builder->CreateSelect(builder->CreateICmpSLT(v, zero),
+                    builder->CreateNeg(v), v);
+            }
+            return true;
+        } else if ((name == "max" || name == "min") && x.n_args >= 2) {
+            if (!same_types()) return false;
+            // Like Python, the first of the equal (or unordered) values
+            // is returned
+            bool is_max = name == "max";
+            bool is_int = ASRUtils::is_integer(*types[0]);
+            llvm::Value *res = arg(0);
+            for (size_t i = 1; i < x.n_args; i++) {
+                llvm::Value *v = arg(i);
+                llvm::Value *cond;
+                if (is_int) {
+                    cond = is_max ? builder->CreateICmpSGT(v, res)
+                                  : builder->CreateICmpSLT(v, res);
+                } else {
+                    cond = is_max ? builder->CreateFCmpOGT(v, res)
+                                  : builder->CreateFCmpOLT(v, res);
+                }
+                res = builder->CreateSelect(cond, v, res);
+            }
+            tmp = res;
+            return true;
+        } else if (name == "pow" && x.n_args == 2) {
+            bool int0 = ASRUtils::is_integer(*types[0]);
+            bool int1 = ASRUtils::is_integer(*types[1]);
+            int kind0 = ASRUtils::extract_kind_from_ttype_t(types[0]);
+            int kind1 = ASRUtils::extract_kind_from_ttype_t(types[1]);
+            if (!int0 && int1 && kind1 == 4) {
+                llvm::Value *a = arg(0);
+                llvm::Value *b = arg(1);
+#if LLVM_VERSION_MAJOR >= 13
+                tmp = builder->CreateIntrinsic(llvm::Intrinsic::powi,
+                    {a->getType(), b->getType()}, {a, b});
+#else
+                tmp = builder->CreateIntrinsic(llvm::Intrinsic::powi,
+                    {a->getType()}, {a, b});
+#endif
+                return true;
+            }
+            if (int0 && int1) {
+                if (!same_types()) return false;
+                // The same as the `**` operator
+                llvm::Value *a = arg(0);
+                tmp = integer_pow(a, arg(1));
+                return true;
+            }
+            if (!int0 && kind0 != kind1) return false;
+            if (int1) return false;
+            // The integer base is converted to the real type of the result
+            llvm::Type *type = getFPType(int0 ? kind1 : kind0);
+            llvm::Value *a = arg(0);
+            llvm::Value *b = arg(1);
+            if (int0) a = builder->CreateSIToFP(a, type);
+            tmp = builder->CreateBinaryIntrinsic(llvm::Intrinsic::pow, a, b);
+            return true;
+        } else if (name == "round" && x.n_args == 1) {
+            llvm::Value *v = arg(0);
+            if (ASRUtils::is_real(*types[0])) {
+                // rint rounds half to even in the default rounding mode,
+                // as Python's round() does
+                v = builder->CreateUnaryIntrinsic(llvm::Intrinsic::rint, v);
+                tmp = builder->CreateFPToSI(v, getIntType(
+                    ASRUtils::extract_kind_from_ttype_t(x.m_type)));
+            } else {
+                tmp = v;
+            }
+            return true;
+        } else if (startswith(name, "_bitwise_") && x.n_args == 2) {
+            if (!same_types() || !ASRUtils::is_integer(*types[0])) return false;
+            if (name == "_bitwise_lshift" || name == "_bitwise_rshift") {
+                // A negative count raises ValueError in the runtime
+                // library, only constant counts are emitted inline
+                ASR::expr_t *count = ASRUtils::expr_value(x.m_args[1].m_value);
+                if (!count || !ASR::is_a<ASR::IntegerConstant_t>(*count)) {
+                    return false;
+                }
+                int64_t n = ASR::down_cast<ASR::IntegerConstant_t>(count)->m_n;
+                if (n < 0) return false;
+                llvm::Value *a = arg(0);
+                int64_t bits = a->getType()->getIntegerBitWidth();
+                if (name == "_bitwise_lshift") {
+                    tmp = n >= bits ? llvm::ConstantInt::get(a->getType(), 0)
+                        : builder->CreateShl(a, n);
+                } else {
+                    tmp = builder->CreateAShr(a, std::min(n, bits - 1));
+                }
+                return true;
+            }
+            llvm::Value *a = arg(0);
+            llvm::Value *b = arg(1);
+            if (name == "_bitwise_and") {
+                tmp = builder->CreateAnd(a, b);
+            } else if (name == "_bitwise_or") {
+                tmp = builder->CreateOr(a, b);
+            } else if (name == "_bitwise_xor") {
+                tmp = builder->CreateXor(a, b);
+            } else {
+                throw CodeGenError("Unknown bitwise builtin '" + name + "'");
+            }
+            return true;
+        }
+        return false;
+    }
+
     void visit_SubroutineCall(const ASR::SubroutineCall_t &x) {
         if( ASRUtils::is_intrinsic_optimization(x.m_name) ) {
             ASR::Subroutine_t* routine = ASR::down_cast<ASR::Subroutine_t>(
@@ -4270,6 +5672,7 @@ public:
         } else {
             throw CodeGenError("ABI type not implemented yet in SubroutineCall.");
         }
+        size_t n_array_copies = bindc_array_copies.size();
         if (llvm_symtab_fn_arg.find(h) != llvm_symtab_fn_arg.end()) {
             // Check if this is a callback function
             llvm::Value* fn = llvm_symtab_fn_arg[h];
@@ -4284,9 +5687,14 @@ public:
             llvm::Function *fn = llvm_symtab_fn[h];
             std::string m_name = std::string(((ASR::Subroutine_t*)(&(x.m_name->base)))->m_name);
             std::vector<llvm::Value *> args2 = convert_call_args(x, m_name);
+            if (calls_contiguous_clone(*s, x)) {
+                fn = get_contiguous_clone(*s);
+                args2 = get_contiguous_args(*s, args2);
+            }
             args.insert(args.end(), args2.begin(), args2.end());
             builder->CreateCall(fn, args);
         }
+        finish_bindc_array_copies(n_array_copies);
         calling_function_hash = h;
         pop_nested_stack(s);
     }
@@ -4321,6 +5729,9 @@ public:
         if( s == nullptr ) {
             s = ASR::down_cast<ASR::Function_t>(symbol_get_past_external(x.m_name));
         }
+        if (generate_builtin_instructions(s, x)) {
+            return;
+        }
         if (parent_function){
             push_nested_stack(parent_function);
         } else if (parent_subroutine){
@@ -4344,7 +5755,7 @@ public:
                 if (func_name == "len") {
                     args = convert_call_args(x, "len");
                     LFORTRAN_ASSERT(args.size() == 1)
-                    tmp = lfortran_str_len(args[0]);
+                    tmp = lfortran_str_len(CreateLoad(args[0]));
                     return;
                 }
                 if( s->m_deftype == ASR::deftypeType::Interface ) {
@@ -4356,6 +5767,7 @@ public:
         } else {
             throw CodeGenError("ABI type not implemented yet.");
         }
+        size_t n_array_copies = bindc_array_copies.size();
         if (llvm_symtab_fn_arg.find(h) != llvm_symtab_fn_arg.end()) {
             // Check if this is a callback function
             llvm::Value* fn = llvm_symtab_fn_arg[h];
@@ -4370,6 +5782,11 @@ public:
             llvm::Function *fn = llvm_symtab_fn[h];
             std::string m_name = std::string(((ASR::Function_t*)(&(x.m_name->base)))->m_name);
             std::vector<llvm::Value *> args2 = convert_call_args(x, m_name);
+            if (s->m_abi == ASR::abiType::Source && !intrinsic_function &&
+                    calls_contiguous_clone(*s, x)) {
+                fn = get_contiguous_clone(*s);
+                args2 = get_contiguous_args(*s, args2);
+            }
             args.insert(args.end(), args2.begin(), args2.end());
             if (s->m_abi == ASR::abiType::BindC) {
                 ASR::ttype_t *return_var_type0 = EXPR2VAR(s->m_return_var)->m_type;
@@ -4395,6 +5812,7 @@ public:
                 tmp = builder->CreateCall(fn, args);
             }
         }
+        finish_bindc_array_copies(n_array_copies);
         if (s->m_abi == ASR::abiType::BindC) {
             ASR::ttype_t *return_var_type0 = EXPR2VAR(s->m_return_var)->m_type;
             if (is_a<ASR::Complex_t>(*return_var_type0)) {
@@ -4428,6 +5846,12 @@ public:
                         tmp = CreateLoad(tmp);
                     }
                 }
+            } else if (is_a<ASR::Character_t>(*return_var_type0)
+                    && !startswith(std::string(s->m_name), "_compy_")) {
+                // A string from C does not have a header, except for one
+                // from the runtime library
+                tmp = lfortran_str_call("_lfortran_str_from_cstr",
+                    character_type, {tmp});
             }
         }
         calling_function_hash = h;
@@ -4507,46 +5931,81 @@ public:
 
 Result<std::unique_ptr<LLVMModule>> asr_to_llvm(ASR::TranslationUnit_t &asr,
         diag::Diagnostics &diagnostics,
-        llvm::LLVMContext &context, Allocator &al, Platform platform,
-        bool fast, const std::string &rl_path, const std::string &run_fn)
+        llvm::LLVMContext &context, Allocator &al, const CompilerOptions &co,
+        const std::string &rl_path, const std::string &run_fn,
+        TimeReport *time_report)
 {
-    ASRToLLVMVisitor v(al, context, platform, diagnostics);
-    pass_wrap_global_stmts_into_function(al, asr, run_fn);
+    ASRToLLVMVisitor v(al, context, co.platform, diagnostics);
+    v.naive_complex_div = co.fast_math;
+    v.stack_array_limit = co.stack_array_limit;
+    v.contiguous_clones_enabled = co.opt_level >= 1 && !co.opt_size;
+    // The optimizing ASR passes enabled at each level: dead code removal
+    // from -O1, inlining from -O2, unrolling from -O3. -Os does not inline.
+    // The rewrites into the `lfortran_intrinsic_optimization` procedures
+    // (flipsign, sign_from_value, x/c -> x*(1/c), fma) can change rounding
+    // and run only with --fast.
+    int opt_level = co.opt_level;
+    bool inline_calls = opt_level >= 2 && !co.opt_size;
+    // With PGO the LLVM inliner and unroller decide using the profile. The
+    // ASR passes must not run, because a profile only applies to functions
+    // whose control flow is the same as in the instrumented build.
+    bool pgo = co.profile_generate.size() > 0 || co.profile_use.size() > 0;
+    bool unroll_loops = opt_level >= 3 && !pgo;
+    inline_calls = inline_calls && !pgo;
+    auto pass = [&](const std::string &name, auto &&f) {
+        return time_phase(time_report, name, 1, &al, f);
+    };
+    pass("global_stmts", [&]() {
+        pass_wrap_global_stmts_into_function(al, asr, run_fn); });
 
     // Uncomment for debugging the ASR after the transformation
     // std::cout << pickle(asr) << std::endl;
-    pass_replace_class_constructor(al, asr);
-    pass_replace_implied_do_loops(al, asr, rl_path);
-    pass_replace_arr_slice(al, asr, rl_path);
-    pass_replace_array_op(al, asr, rl_path);
-    pass_replace_print_arr(al, asr, rl_path);
-
-    if( fast ) {
-        pass_loop_unroll(al, asr, rl_path);
+    pass("class_constructor", [&]() {
+        pass_replace_class_constructor(al, asr); });
+    pass("implied_do_loops", [&]() {
+        pass_replace_implied_do_loops(al, asr, rl_path); });
+    pass("arr_slice", [&]() { pass_replace_arr_slice(al, asr, rl_path); });
+    pass("array_op", [&]() { pass_replace_array_op(al, asr, rl_path); });
+    pass("print_arr", [&]() { pass_replace_print_arr(al, asr, rl_path); });
+
+    if( unroll_loops ) {
+        pass("loop_unroll", [&]() { pass_loop_unroll(al, asr, rl_path); });
     }
 
-    pass_replace_do_loops(al, asr);
-    pass_replace_forall(al, asr);
+    // Before the do loops become while loops, whose number of iterations
+    // is not known
+    pass("procedure_effects", [&]() {
+        v.proc_effects = pass_find_procedure_effects(asr, co.stack_array_limit); });
+    pass("do_loops", [&]() { pass_replace_do_loops(al, asr); });
+    pass("forall", [&]() { pass_replace_forall(al, asr); });
 
-    if( fast ) {
-        pass_dead_code_removal(al, asr, rl_path);
+    if( opt_level >= 1 ) {
+        pass("dead_code_removal", [&]() {
+            pass_dead_code_removal(al, asr, rl_path); });
     }
 
-    pass_replace_select_case(al, asr);
-    pass_unused_functions(al, asr);
-
-    if( fast ) {
-        pass_replace_flip_sign(al, asr, rl_path);
-        pass_replace_sign_from_value(al, asr, rl_path);
-        pass_replace_div_to_mul(al, asr, rl_path);
-        pass_replace_fma(al, asr, rl_path);
-        pass_inline_function_calls(al, asr, rl_path);
+    pass("select_case", [&]() { pass_replace_select_case(al, asr); });
+    pass("unused_functions", [&]() { pass_unused_functions(al, asr); });
+
+    if( co.fast_math ) {
+        pass("flip_sign", [&]() {
+            pass_replace_flip_sign(al, asr, rl_path); });
+        pass("sign_from_value", [&]() {
+            pass_replace_sign_from_value(al, asr, rl_path); });
+        pass("div_to_mul", [&]() {
+            pass_replace_div_to_mul(al, asr, rl_path); });
+        pass("fma", [&]() { pass_replace_fma(al, asr, rl_path); });
+    }
+    if( inline_calls ) {
+        pass("inline_function_calls", [&]() {
+            pass_inline_function_calls(al, asr, rl_path); });
     }
 
-    v.nested_func_types = pass_find_nested_vars(asr, context,
-        v.nested_globals, v.nested_call_out, v.nesting_map);
+    pass("nested_vars", [&]() {
+        v.nested_func_types = pass_find_nested_vars(asr, context,
+            v.nested_globals, v.nested_call_out, v.nesting_map); });
     try {
-        v.visit_asr((ASR::asr_t&)asr);
+        pass("visit ASR", [&]() { v.visit_asr((ASR::asr_t&)asr); });
     } catch (const CodeGenError &e) {
         Error error;
         diagnostics.diagnostics.push_back(e.d);
@@ -4558,7 +6017,7 @@ Result<std::unique_ptr<LLVMModule>> asr_to_llvm(ASR::TranslationUnit_t &asr,
     }
     std::string msg;
     llvm::raw_string_ostream err(msg);
-    if (llvm::verifyModule(*v.module, &err)) {
+    if (pass("verify LLVM", [&]() { return llvm::verifyModule(*v.module, &err); })) {
         std::string buf;
         llvm::raw_string_ostream os(buf);
         v.module->print(os, nullptr);
@@ -3,13 +3,15 @@
 
 #include <libasr/asr.h>
 #include <libasr/codegen/evaluator.h>
+#include <libasr/time_report.h>
 
 namespace LFortran {
 
     Result<std::unique_ptr<LLVMModule>> asr_to_llvm(ASR::TranslationUnit_t &asr,
             diag::Diagnostics &diagnostics,
-            llvm::LLVMContext &context, Allocator &al, Platform platform,
-            bool fast, const std::string &rl_path, const std::string &run_fn);
+            llvm::LLVMContext &context, Allocator &al, const CompilerOptions &co,
+            const std::string &rl_path, const std::string &run_fn,
+            TimeReport *time_report=nullptr);
 
 } // namespace LFortran
 
@@ -333,6 +333,11 @@ public:
                     throw CodeGenError("Pow not implemented yet.");
                     break;
                 };
+                case ASR::binopType::FloorDiv:
+                case ASR::binopType::Mod: {
+                    throw CodeGenError("FloorDiv and Mod not implemented yet.");
+                    break;
+                };
             }
         } else {
             throw CodeGenError("Binop: Only Integer types implemented so far");
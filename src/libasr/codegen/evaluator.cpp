@@ -1,5 +1,8 @@
 #include <iostream>
 #include <fstream>
+#include <mutex>
+#include <algorithm>
+#include <set>
 
 #include <llvm/IR/LLVMContext.h>
 #include <llvm/ADT/STLExtras.h>
@@ -17,6 +20,7 @@
 #include <llvm/IR/Function.h>
 #include <llvm/IR/IRBuilder.h>
 #include <llvm/IR/Instructions.h>
+#include <llvm/IR/InstIterator.h>
 #include <llvm/IR/Intrinsics.h>
 #include <llvm/IR/LegacyPassManager.h>
 #include <llvm/IR/Module.h>
@@ -36,7 +40,13 @@
 #include <llvm/Transforms/Vectorize.h>
 #include <llvm/Transforms/IPO.h>
 #include <llvm/Transforms/IPO/AlwaysInliner.h>
-#include <llvm/Transforms/IPO/PassManagerBuilder.h>
+#include <llvm/Passes/PassBuilder.h>
+#include <llvm/CodeGen/ParallelCG.h>
+#include <llvm/Transforms/Utils/Cloning.h>
+#include <llvm/ProfileData/InstrProfReader.h>
+#include <llvm/Transforms/Instrumentation.h>
+#include <llvm/Transforms/Instrumentation/InstrProfiling.h>
+#include <llvm/Transforms/Instrumentation/PGOInstrumentation.h>
 #include <llvm/Transforms/Instrumentation/AddressSanitizer.h>
 #include <llvm/Transforms/Instrumentation/ThreadSanitizer.h>
 #include <llvm/Transforms/InstCombine/InstCombine.h>
@@ -45,6 +55,11 @@
 #include <llvm/Support/FileSystem.h>
 #include <llvm/Support/Path.h>
 #include <llvm/AsmParser/Parser.h>
+#include <llvm/IRReader/IRReader.h>
+#include <llvm/Linker/Linker.h>
+#include <llvm/ADT/StringSet.h>
+#include <llvm/ADT/Triple.h>
+#include <llvm/Transforms/IPO/Internalize.h>
 #include <llvm/Support/SourceMgr.h>
 #include <llvm/ADT/StringRef.h>
 #include <llvm/Target/TargetOptions.h>
@@ -54,9 +69,8 @@
 #    include <llvm/Support/TargetRegistry.h>
 #endif
 #include <llvm/Support/Host.h>
-#if LLVM_VERSION_MAJOR <= 11
-#    include <libasr/codegen/KaleidoscopeJIT.h>
-#endif
+#include <llvm/MC/MCSubtargetInfo.h>
+#include <libasr/codegen/KaleidoscopeJIT.h>
 
 #include <libasr/codegen/evaluator.h>
 #include <libasr/codegen/asr_to_llvm.h>
@@ -137,26 +151,47 @@ float _lfortran_stan(float x);
 
 }
 
-LLVMEvaluator::LLVMEvaluator(const std::string &t)
+namespace {
+
+#if LLVM_VERSION_MAJOR >= 14
+using OptimizationLevel = llvm::OptimizationLevel;
+#else
+using OptimizationLevel = llvm::PassBuilder::OptimizationLevel;
+#endif
+
+// The target registry is global state, so it must be populated exactly once
+// even when several evaluators are created concurrently (e.g. `compy -j N`).
+void initialize_targets()
 {
-    llvm::InitializeNativeTarget();
-    llvm::InitializeNativeTargetAsmPrinter();
-    llvm::InitializeNativeTargetAsmParser();
+    static std::once_flag flag;
+    std::call_once(flag, []() {
+        llvm::InitializeNativeTarget();
+        llvm::InitializeNativeTargetAsmPrinter();
+        llvm::InitializeNativeTargetAsmParser();
 
 #ifdef HAVE_TARGET_AARCH64
-    LLVMInitializeAArch64Target();
-    LLVMInitializeAArch64TargetInfo();
-    LLVMInitializeAArch64TargetMC();
-    LLVMInitializeAArch64AsmPrinter();
-    LLVMInitializeAArch64AsmParser();
+        LLVMInitializeAArch64Target();
+        LLVMInitializeAArch64TargetInfo();
+        LLVMInitializeAArch64TargetMC();
+        LLVMInitializeAArch64AsmPrinter();
+        LLVMInitializeAArch64AsmParser();
 #endif
 #ifdef HAVE_TARGET_X86
-    LLVMInitializeX86Target();
-    LLVMInitializeX86TargetInfo();
-    LLVMInitializeX86TargetMC();
-    LLVMInitializeX86AsmPrinter();
-    LLVMInitializeX86AsmParser();
+        LLVMInitializeX86Target();
+        LLVMInitializeX86TargetInfo();
+        LLVMInitializeX86TargetMC();
+        LLVMInitializeX86AsmPrinter();
+        LLVMInitializeX86AsmParser();
 #endif
+    });
+}
+
+} // anonymous namespace
+
+LLVMEvaluator::LLVMEvaluator(const std::string &t, const std::string &cpu,
+    const std::string &features)
+{
+    initialize_targets();
 
     context = std::make_unique<llvm::LLVMContext>();
 
@@ -170,29 +205,59 @@ LLVMEvaluator::LLVMEvaluator(const std::string &t)
     if (!target) {
         throw LFortranException(Error);
     }
-    std::string CPU = "generic";
-    std::string features = "";
+    if (cpu == "native") {
+        target_cpu = get_host_cpu_name();
+        target_features = get_host_cpu_features();
+        if (features.size() > 0) {
+            // Later features override the earlier ones
+            target_features += "," + features;
+        }
+    } else {
+        target_cpu = (cpu == "") ? "generic" : cpu;
+        target_features = features;
+    }
+    if (cpu != "") {
+        jit_cpu = target_cpu;
+        jit_features = target_features;
+    } else {
+        jit_features = features;
+    }
     llvm::TargetOptions opt;
     llvm::Optional<llvm::Reloc::Model> RM = llvm::Reloc::Model::PIC_;
-    TM = target->createTargetMachine(target_triple, CPU, features, opt, RM);
-
-    // For some reason the JIT requires a different TargetMachine
-    llvm::TargetMachine *TM2 = llvm::EngineBuilder().selectTarget();
-#if LLVM_VERSION_MAJOR <= 11
-    jit = std::make_unique<llvm::orc::KaleidoscopeJIT>(TM2);
-#endif
+    TM = target->createTargetMachine(target_triple, target_cpu,
+        target_features, opt, RM);
 
     _lfortran_stan(0.5);
 }
 
 LLVMEvaluator::~LLVMEvaluator()
 {
-#if LLVM_VERSION_MAJOR <= 11
     jit.reset();
-#endif
     context.reset();
 }
 
+llvm::orc::KaleidoscopeJIT &LLVMEvaluator::get_jit()
+{
+    if (!jit) {
+#if LLVM_VERSION_MAJOR <= 11
+        // For some reason the JIT requires a different TargetMachine
+        llvm::EngineBuilder builder;
+        if (jit_cpu.size() > 0) builder.setMCPU(jit_cpu);
+        if (jit_features.size() > 0) {
+            llvm::SmallVector<llvm::StringRef, 16> attrs;
+            llvm::StringRef(jit_features).split(attrs, ",", -1, false);
+            builder.setMAttrs(attrs);
+        }
+        llvm::TargetMachine *TM2 = builder.selectTarget();
+        jit = std::make_unique<llvm::orc::KaleidoscopeJIT>(TM2);
+#else
+        jit = std::make_unique<llvm::orc::KaleidoscopeJIT>(jit_cpu,
+            jit_features);
+#endif
+    }
+    return *jit;
+}
+
 std::unique_ptr<llvm::Module> LLVMEvaluator::parse_module(const std::string &source)
 {
     llvm::SMDiagnostic err;
@@ -206,9 +271,7 @@ std::unique_ptr<llvm::Module> LLVMEvaluator::parse_module(const std::string &sou
         throw LFortranException("parse_module(): module failed verification.");
     };
     module->setTargetTriple(target_triple);
-#if LLVM_VERSION_MAJOR <= 11
-    module->setDataLayout(jit->getTargetMachine().createDataLayout());
-#endif
+    module->setDataLayout(get_jit().getTargetMachine().createDataLayout());
     return module;
 }
 
@@ -229,10 +292,8 @@ void LLVMEvaluator::add_module(std::unique_ptr<llvm::Module> mod) {
     // These are already set in parse_module(), but we set it here again for
     // cases when the Module was constructed directly, not via parse_module().
     mod->setTargetTriple(target_triple);
-#if LLVM_VERSION_MAJOR <= 11
-    mod->setDataLayout(jit->getTargetMachine().createDataLayout());
-    jit->addModule(std::move(mod));
-#endif
+    mod->setDataLayout(get_jit().getTargetMachine().createDataLayout());
+    get_jit().addModule(std::move(mod));
 }
 
 void LLVMEvaluator::add_module(std::unique_ptr<LLVMModule> m) {
@@ -240,16 +301,11 @@ void LLVMEvaluator::add_module(std::unique_ptr<LLVMModule> m) {
 }
 
 intptr_t LLVMEvaluator::get_symbol_address(const std::string &name) {
-#if LLVM_VERSION_MAJOR <= 11
-    llvm::JITSymbol s = jit->findSymbol(name);
-#else
-    llvm::JITSymbol s = nullptr;
-#endif
+    llvm::JITSymbol s = get_jit().findSymbol(name);
     if (!s) {
         throw std::runtime_error("findSymbol() failed to find the symbol '"
             + name + "'");
     }
-#if LLVM_VERSION_MAJOR <= 11
     llvm::Expected<uint64_t> addr0 = s.getAddress();
     if (!addr0) {
         llvm::Error e = addr0.takeError();
@@ -261,7 +317,6 @@ intptr_t LLVMEvaluator::get_symbol_address(const std::string &name) {
         throw LFortranException("JITSymbol::getAddress() returned an error: " + msg);
     }
     return (intptr_t)cantFail(std::move(addr0));
-#endif
 }
 
 int32_t LLVMEvaluator::int32fn(const std::string &name) {
@@ -325,11 +380,9 @@ std::string LLVMEvaluator::get_asm(llvm::Module &m)
     llvm::CodeGenFileType ft = llvm::CGFT_AssemblyFile;
     llvm::SmallVector<char, 128> buf;
     llvm::raw_svector_ostream dest(buf);
-#if LLVM_VERSION_MAJOR <= 11
-    if (jit->getTargetMachine().addPassesToEmitFile(pass, dest, nullptr, ft)) {
+    if (get_jit().getTargetMachine().addPassesToEmitFile(pass, dest, nullptr, ft)) {
         throw std::runtime_error("TargetMachine can't emit a file of this type");
     }
-#endif
     pass.run(m);
     return std::string(dest.str().data(), dest.str().size());
 }
@@ -339,10 +392,24 @@ void LLVMEvaluator::save_asm_file(llvm::Module &m, const std::string &filename)
     write_file(filename, get_asm(m));
 }
 
-void LLVMEvaluator::save_object_file(llvm::Module &m, const std::string &filename) {
+void LLVMEvaluator::prepare_codegen(llvm::Module &m) {
     m.setTargetTriple(target_triple);
     m.setDataLayout(TM->createDataLayout());
 
+    // Record the CPU the code was generated for in the object file (the
+    // .comment section on ELF)
+    std::string ident = "compy target-cpu=" + target_cpu;
+    if (target_features.size() > 0) {
+        ident += " target-features=" + target_features;
+    }
+    llvm::LLVMContext &ctx = m.getContext();
+    m.getOrInsertNamedMetadata("llvm.ident")->addOperand(
+        llvm::MDNode::get(ctx, {llvm::MDString::get(ctx, ident)}));
+}
+
+void LLVMEvaluator::save_object_file(llvm::Module &m, const std::string &filename) {
+    prepare_codegen(m);
+
     llvm::legacy::PassManager pass;
     llvm::CodeGenFileType ft = llvm::CGFT_ObjectFile;
     std::error_code EC;
@@ -357,43 +424,211 @@ void LLVMEvaluator::save_object_file(llvm::Module &m, const std::string &filenam
     dest.flush();
 }
 
+void LLVMEvaluator::save_object_files(llvm::Module &m,
+    const std::vector<std::string> &filenames) {
+    if (filenames.size() == 1) {
+        save_object_file(m, filenames[0]);
+        return;
+    }
+    prepare_codegen(m);
+
+    std::vector<std::unique_ptr<llvm::raw_fd_ostream>> files;
+    std::vector<llvm::raw_pwrite_stream*> streams;
+    for (auto &filename : filenames) {
+        std::error_code EC;
+        files.push_back(std::make_unique<llvm::raw_fd_ostream>(filename, EC,
+            llvm::sys::fs::OF_None));
+        if (EC) {
+            throw std::runtime_error("raw_fd_ostream failed");
+        }
+        streams.push_back(files.back().get());
+    }
+    // Every thread needs its own TargetMachine (the parts are also in their
+    // own LLVMContext)
+    const llvm::Target &target = TM->getTarget();
+    llvm::TargetOptions options = TM->Options;
+    auto create_tm = [&]() {
+        return std::unique_ptr<llvm::TargetMachine>(
+            target.createTargetMachine(target_triple, target_cpu,
+                target_features, options, llvm::Reloc::Model::PIC_));
+    };
+    // The functions and globals are assigned to the parts by the hash of
+    // their name, so each part only depends on the module and the number of
+    // parts, not on the thread scheduling
+#if LLVM_VERSION_MAJOR >= 13
+    llvm::splitCodeGen(m, streams, {}, create_tm, llvm::CGFT_ObjectFile);
+#else
+    llvm::splitCodeGen(llvm::CloneModule(m), streams, {}, create_tm,
+        llvm::CGFT_ObjectFile);
+#endif
+    for (auto &f : files) {
+        f->flush();
+    }
+}
+
 void LLVMEvaluator::create_empty_object_file(const std::string &filename) {
     std::string source;
     std::unique_ptr<llvm::Module> module = parse_module(source);
     save_object_file(*module, filename);
 }
 
-void LLVMEvaluator::opt(llvm::Module &m) {
+namespace {
+
+// Returns true if `c` is (or is a constant expression that refers to) a
+// writable global variable defined in the module
+bool is_global_state(const llvm::Value *c)
+{
+    if (auto *gv = llvm::dyn_cast<llvm::GlobalVariable>(c)) {
+        return !gv->isDeclaration() && !gv->isConstant();
+    }
+    if (auto *ce = llvm::dyn_cast<llvm::ConstantExpr>(c)) {
+        for (const llvm::Use &op : ce->operands()) {
+            if (is_global_state(op.get())) return true;
+        }
+    }
+    return false;
+}
+
+// Turns the functions of the runtime library that use its global state (or
+// call internal functions that do) into declarations. Those must keep
+// calling the one copy in the runtime library, otherwise every module
+// linked with the bitcode would get its own copy of the state.
+void keep_stateful_functions_external(llvm::Module &rt)
+{
+    std::set<llvm::Function*> stateful;
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (llvm::Function &f : rt) {
+            if (f.isDeclaration() || stateful.count(&f)) continue;
+            for (llvm::Instruction &inst : llvm::instructions(f)) {
+                bool uses_state = false;
+                for (const llvm::Use &op : inst.operands()) {
+                    auto *fn = llvm::dyn_cast<llvm::Function>(op.get());
+                    if (is_global_state(op.get()) || (fn
+                            && fn->hasLocalLinkage() && stateful.count(fn))) {
+                        uses_state = true;
+                        break;
+                    }
+                }
+                if (uses_state) {
+                    stateful.insert(&f);
+                    changed = true;
+                    break;
+                }
+            }
+        }
+    }
+    for (llvm::Function *f : stateful) {
+        if (!f->hasLocalLinkage()) f->deleteBody();
+    }
+}
+
+} // anonymous namespace
+
+bool LLVMEvaluator::link_bitcode(llvm::Module &m, const std::string &filename)
+{
+    llvm::SMDiagnostic err;
+    std::unique_ptr<llvm::Module> rt = llvm::parseIRFile(filename, err,
+        m.getContext());
+    if (!rt) return false;
+    llvm::Triple rt_triple(rt->getTargetTriple());
+    llvm::Triple triple(target_triple);
+    if (rt_triple.getArch() != triple.getArch()
+            || rt_triple.getOS() != triple.getOS()) {
+        // The runtime bitcode was built for a different target
+        return false;
+    }
     m.setTargetTriple(target_triple);
     m.setDataLayout(TM->createDataLayout());
-
-    llvm::legacy::PassManager mpm;
-    mpm.add(new llvm::TargetLibraryInfoWrapperPass(TM->getTargetTriple()));
-    mpm.add(llvm::createTargetTransformInfoWrapperPass(TM->getTargetIRAnalysis()));
-    llvm::legacy::FunctionPassManager fpm(&m);
-    fpm.add(llvm::createTargetTransformInfoWrapperPass(TM->getTargetIRAnalysis()));
-
-    int optLevel = 3;
-    int sizeLevel = 0;
-    llvm::PassManagerBuilder builder;
-    builder.OptLevel = optLevel;
-    builder.SizeLevel = sizeLevel;
-    builder.Inliner = llvm::createFunctionInliningPass(optLevel, sizeLevel,
-        false);
-    builder.DisableUnrollLoops = false;
-    builder.LoopVectorize = true;
-    builder.SLPVectorize = true;
-    builder.populateFunctionPassManager(fpm);
-    builder.populateModulePassManager(mpm);
-
-    fpm.doInitialization();
-    for (llvm::Function &func : m) {
-        fpm.run(func);
+    rt->setTargetTriple(target_triple);
+    rt->setDataLayout(TM->createDataLayout());
+    keep_stateful_functions_external(*rt);
+    for (llvm::Function &f : *rt) {
+        // Use the CPU and features of the module, otherwise the inliner
+        // refuses to inline functions compiled for a different CPU
+        f.removeFnAttr("target-cpu");
+        f.removeFnAttr("target-features");
+        f.removeFnAttr("tune-cpu");
     }
-    fpm.doFinalization();
+    // Only link in the functions that `m` uses and make them internal, so
+    // that they are inlined and the unused ones are removed
+    bool failed = llvm::Linker::linkModules(m, std::move(rt),
+        llvm::Linker::Flags::LinkOnlyNeeded,
+        [](llvm::Module &m, const llvm::StringSet<> &gvs) {
+            llvm::internalizeModule(m, [&gvs](const llvm::GlobalValue &gv) {
+                return !gv.hasName() || gvs.count(gv.getName()) == 0;
+            });
+        });
+    if (failed) {
+        throw LFortranException("link_bitcode(): failed to link '"
+            + filename + "'");
+    }
+    return true;
+}
 
-    mpm.add(llvm::createVerifierPass());
-    mpm.run(m);
+void LLVMEvaluator::opt(llvm::Module &m, int opt_level, bool size,
+    const std::string &passes, const std::string &profile_generate,
+    const std::string &profile_use) {
+    m.setTargetTriple(target_triple);
+    m.setDataLayout(TM->createDataLayout());
+
+    llvm::LoopAnalysisManager lam;
+    llvm::FunctionAnalysisManager fam;
+    llvm::CGSCCAnalysisManager cgam;
+    llvm::ModuleAnalysisManager mam;
+    llvm::PipelineTuningOptions pto;
+    pto.LoopUnrolling = !size;
+    pto.LoopVectorization = opt_level >= 2 && !size;
+    pto.SLPVectorization = opt_level >= 2 && !size;
+    // The default pipelines place the PGO passes themselves, the others get
+    // them in front of the pipeline below
+    bool default_pipeline = passes.size() == 0 && opt_level > 0;
+    llvm::Optional<llvm::PGOOptions> pgo;
+    if (default_pipeline && profile_generate.size() > 0) {
+        pgo = llvm::PGOOptions(profile_generate, "", "",
+            llvm::PGOOptions::IRInstr);
+    } else if (default_pipeline && profile_use.size() > 0) {
+        pgo = llvm::PGOOptions(profile_use, "", "", llvm::PGOOptions::IRUse);
+    }
+#if LLVM_VERSION_MAJOR >= 12 && LLVM_VERSION_MAJOR < 14
+    llvm::PassBuilder pb(false, TM, pto, pgo);
+#else
+    llvm::PassBuilder pb(TM, pto, pgo);
+#endif
+    pb.registerModuleAnalyses(mam);
+    pb.registerCGSCCAnalyses(cgam);
+    pb.registerFunctionAnalyses(fam);
+    pb.registerLoopAnalyses(lam);
+    pb.crossRegisterProxies(lam, fam, cgam, mam);
+
+    llvm::ModulePassManager mpm;
+    if (!default_pipeline && profile_generate.size() > 0) {
+        llvm::InstrProfOptions options;
+        options.InstrProfileOutput = profile_generate;
+        mpm.addPass(llvm::PGOInstrumentationGen());
+        mpm.addPass(llvm::InstrProfiling(options));
+    } else if (!default_pipeline && profile_use.size() > 0) {
+        mpm.addPass(llvm::PGOInstrumentationUse(profile_use));
+    }
+    if (passes.size() > 0) {
+        if (llvm::Error err = pb.parsePassPipeline(mpm, passes)) {
+            throw LFortranException("Invalid LLVM pass pipeline '" + passes
+                + "': " + llvm::toString(std::move(err)));
+        }
+    } else if (opt_level > 0) {
+        OptimizationLevel level = OptimizationLevel::O3;
+        if (size) {
+            level = OptimizationLevel::Os;
+        } else if (opt_level == 1) {
+            level = OptimizationLevel::O1;
+        } else if (opt_level == 2) {
+            level = OptimizationLevel::O2;
+        }
+        mpm.addPass(pb.buildPerModuleDefaultPipeline(level));
+    }
+    mpm.addPass(llvm::VerifierPass());
+    mpm.run(m, mam);
 }
 
 std::string LLVMEvaluator::module_to_string(llvm::Module &m) {
@@ -432,4 +667,54 @@ std::string LLVMEvaluator::get_default_target_triple()
     return llvm::sys::getDefaultTargetTriple();
 }
 
+std::string LLVMEvaluator::get_host_cpu_name()
+{
+    return std::string(llvm::sys::getHostCPUName());
+}
+
+std::string LLVMEvaluator::get_host_cpu_features()
+{
+    llvm::StringMap<bool> host_features;
+    std::string features;
+    if (llvm::sys::getHostCPUFeatures(host_features)) {
+        // Sort the features, so that the string is deterministic
+        std::vector<std::string> names;
+        for (auto &f : host_features) {
+            names.push_back((f.second ? "+" : "-") + std::string(f.first()));
+        }
+        std::sort(names.begin(), names.end());
+        for (auto &name : names) {
+            if (features.size() > 0) features += ",";
+            features += name;
+        }
+    }
+    return features;
+}
+
+std::string LLVMEvaluator::check_profile(const std::string &filename)
+{
+    auto reader = llvm::IndexedInstrProfReader::create(filename);
+    if (!reader) {
+        return llvm::toString(reader.takeError());
+    }
+    if (!(*reader)->isIRLevelProfile()) {
+        return "'" + filename + "' is not an IR level profile";
+    }
+    return "";
+}
+
+bool LLVMEvaluator::is_cpu_supported(const std::string &t,
+    const std::string &cpu)
+{
+    initialize_targets();
+    std::string triple = (t == "") ? get_default_target_triple() : t;
+    std::string error;
+    const llvm::Target *target = llvm::TargetRegistry::lookupTarget(triple,
+        error);
+    if (!target) return false;
+    std::unique_ptr<llvm::MCSubtargetInfo> sti(
+        target->createMCSubtargetInfo(triple, "", ""));
+    return sti && sti->isCPUStringValid(cpu);
+}
+
 } // namespace LFortran
@@ -4,6 +4,8 @@
 #include <complex>
 #include <iostream>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include <libasr/alloc.h>
 #include <libasr/asr_scopes.h>
@@ -19,11 +21,9 @@ namespace llvm {
     class Module;
     class Function;
     class TargetMachine;
-#if LLVM_VERSION_MAJOR <= 11
     namespace orc {
         class KaleidoscopeJIT;
     }
-#endif
 }
 
 namespace LFortran {
@@ -42,14 +42,25 @@ public:
 class LLVMEvaluator
 {
 private:
-#if LLVM_VERSION_MAJOR <= 11
+    // The JIT is only created when it is first needed, compiling to object
+    // files does not use it
     std::unique_ptr<llvm::orc::KaleidoscopeJIT> jit;
-#endif
     std::unique_ptr<llvm::LLVMContext> context;
     std::string target_triple;
+    // The CPU and features the code is generated for, see the constructor
+    std::string target_cpu, target_features;
+    // The JIT uses the host CPU unless a CPU was requested explicitly
+    std::string jit_cpu, jit_features;
     llvm::TargetMachine *TM;
+    llvm::orc::KaleidoscopeJIT &get_jit();
+    // Sets the target and records the target CPU in `m`
+    void prepare_codegen(llvm::Module &m);
 public:
-    LLVMEvaluator(const std::string &t = "");
+    // `t` is the target triple, `cpu` the target CPU ("native" for the host
+    // CPU, "generic" if empty) and `features` the additional target features
+    // (e.g. "+avx2,+fma"), all empty for the defaults
+    LLVMEvaluator(const std::string &t = "", const std::string &cpu = "",
+        const std::string &features = "");
     ~LLVMEvaluator();
     std::unique_ptr<llvm::Module> parse_module(const std::string &source);
     void add_module(const std::string &source);
@@ -67,13 +78,39 @@ public:
     std::string get_asm(llvm::Module &m);
     void save_asm_file(llvm::Module &m, const std::string &filename);
     void save_object_file(llvm::Module &m, const std::string &filename);
+    // Splits `m` into `filenames.size()` parts and generates their code
+    // concurrently, each part into one of the object files
+    void save_object_files(llvm::Module &m,
+        const std::vector<std::string> &filenames);
     void create_empty_object_file(const std::string &filename);
-    void opt(llvm::Module &m);
+    // Links the functions that `m` uses from the LLVM bitcode `filename`
+    // (the runtime library) into `m` as internal functions, so that `opt()`
+    // can inline them. Returns false if the file cannot be loaded or was
+    // built for a different target.
+    bool link_bitcode(llvm::Module &m, const std::string &filename);
+    // Optimizes `m` with the default LLVM pipeline of the given level (1-3,
+    // `size` for -Os) or, if `passes` is not empty, with this pipeline in the
+    // `opt -passes=` syntax. Throws LFortranException for an invalid pipeline.
+    // If `profile_generate` is not empty, `m` is instrumented to write its
+    // profile to this file, if `profile_use` is not empty, the profile in
+    // this (indexed, .profdata) file is used.
+    void opt(llvm::Module &m, int opt_level = 3, bool size = false,
+        const std::string &passes = "",
+        const std::string &profile_generate = "",
+        const std::string &profile_use = "");
     static std::string module_to_string(llvm::Module &m);
     static void print_version_message();
     llvm::LLVMContext &get_context();
     static void print_targets();
     static std::string get_default_target_triple();
+    static std::string get_host_cpu_name();
+    // The features of the host CPU as "+feature,-feature,..."
+    static std::string get_host_cpu_features();
+    // Returns true if `cpu` is a known CPU of the target `t`
+    static bool is_cpu_supported(const std::string &t, const std::string &cpu);
+    // Returns an empty string if `filename` is a readable indexed profile
+    // (.profdata), otherwise the error message
+    static std::string check_profile(const std::string &filename);
 };
 
 
@@ -137,16 +137,23 @@ namespace LFortran {
 
         llvm::Value* SimpleCMODescriptor::
         convert_to_argument(llvm::Value* tmp, llvm::Type* arg_type) {
-            llvm::Value* arg_struct = builder->CreateAlloca(arg_type, nullptr);
-            llvm::Value* first_ele_ptr = nullptr;
             llvm::Type* tmp_type = static_cast<llvm::PointerType*>(tmp->getType())->getElementType();
             llvm::StructType* tmp_struct_type = static_cast<llvm::StructType*>(tmp_type);
+            if( !tmp_struct_type->getElementType(0)->isArrayTy() &&
+                tmp_struct_type->getNumElements() == 5 ) {
+                return tmp;
+            }
+            // Create the alloca at the beginning of the function, the call
+            // can be inside a loop, which would run out of stack
+            llvm::BasicBlock &entry_block = builder->GetInsertBlock()->getParent()->getEntryBlock();
+            llvm::IRBuilder<> builder0(context);
+            builder0.SetInsertPoint(&entry_block, entry_block.getFirstInsertionPt());
+            llvm::Value* arg_struct = builder0.CreateAlloca(arg_type, nullptr);
+            llvm::Value* first_ele_ptr = nullptr;
             if( tmp_struct_type->getElementType(0)->isArrayTy() ) {
                 first_ele_ptr = llvm_utils->create_gep(get_pointer_to_data(tmp), 0);
             } else if( tmp_struct_type->getNumElements() < 5 ) {
                 first_ele_ptr = LLVM::CreateLoad(*builder, get_pointer_to_data(tmp));
-            } else if( tmp_struct_type->getNumElements() == 5 ) {
-                return tmp;
             }
             llvm::Value* first_arg_ptr = llvm_utils->create_gep(arg_struct, 0);
             builder->CreateStore(first_ele_ptr, first_arg_ptr);
@@ -280,7 +287,8 @@ namespace LFortran {
 
         void SimpleCMODescriptor::fill_array_details(
         llvm::Value* arr, ASR::dimension_t* m_dims, int n_dims,
-        std::vector<std::pair<llvm::Value*, llvm::Value*>>& llvm_dims) {
+        std::vector<std::pair<llvm::Value*, llvm::Value*>>& llvm_dims,
+        llvm::Value* data) {
             llvm::Value* offset_val = llvm_utils->create_gep(arr, 1);
             builder->CreateStore(llvm::ConstantInt::get(context, llvm::APInt(32, 0)), offset_val);
             llvm::Value* dim_des_val = llvm_utils->create_gep(arr, 2);
@@ -291,13 +299,14 @@ namespace LFortran {
             builder->CreateStore(llvm::ConstantInt::get(context, llvm::APInt(32, n_dims)), get_rank(arr, true));
             builder->CreateStore(dim_des_first, dim_des_val);
             dim_des_val = LLVM::CreateLoad(*builder, dim_des_val);
+            llvm::Value* stride = llvm::ConstantInt::get(context, llvm::APInt(32, 1));
             for( int r = 0; r < n_dims; r++ ) {
                 llvm::Value* dim_val = llvm_utils->create_ptr_gep(dim_des_val, r);
                 llvm::Value* s_val = llvm_utils->create_gep(dim_val, 0);
                 llvm::Value* l_val = llvm_utils->create_gep(dim_val, 1);
                 llvm::Value* u_val = llvm_utils->create_gep(dim_val, 2);
                 llvm::Value* dim_size_ptr = llvm_utils->create_gep(dim_val, 3);
-                builder->CreateStore(llvm::ConstantInt::get(context, llvm::APInt(32, 1)), s_val);
+                builder->CreateStore(stride, s_val);
                 builder->CreateStore(llvm_dims[r].first, l_val);
                 builder->CreateStore(llvm_dims[r].second, u_val);
                 u_val = LLVM::CreateLoad(*builder, u_val);
@@ -305,6 +314,7 @@ namespace LFortran {
                 llvm::Value* dim_size = builder->CreateAdd(builder->CreateSub(u_val, l_val),
                                                         llvm::ConstantInt::get(context, llvm::APInt(32, 1)));
                 builder->CreateStore(dim_size, dim_size_ptr);
+                stride = builder->CreateMul(stride, dim_size);
             }
 
             llvm::Value* llvm_size = builder->CreateAlloca(llvm::Type::getInt32Ty(context), nullptr);
@@ -325,6 +335,10 @@ namespace LFortran {
             }
             builder->CreateStore(prod, llvm_size);
             llvm::Value* first_ptr = get_pointer_to_data(arr);
+            if( data ) {
+                builder->CreateStore(data, first_ptr);
+                return;
+            }
             llvm::PointerType* first_ptr2ptr_type = static_cast<llvm::PointerType*>(first_ptr->getType());
             llvm::PointerType* first_ptr_type = static_cast<llvm::PointerType*>(first_ptr2ptr_type->getElementType());
             llvm::Value* arr_first = builder->CreateAlloca(first_ptr_type->getElementType(),
@@ -348,7 +362,7 @@ namespace LFortran {
                 llvm::Value* l_val = llvm_utils->create_gep(dim_val, 1);
                 llvm::Value* u_val = llvm_utils->create_gep(dim_val, 2);
                 llvm::Value* dim_size_ptr = llvm_utils->create_gep(dim_val, 3);
-                builder->CreateStore(llvm::ConstantInt::get(context, llvm::APInt(32, 1)), s_val);
+                builder->CreateStore(num_elements, s_val);
                 builder->CreateStore(llvm_dims[r].first, l_val);
                 builder->CreateStore(llvm_dims[r].second, u_val);
                 u_val = LLVM::CreateLoad(*builder, u_val);
@@ -406,8 +420,45 @@ namespace LFortran {
             return LLVM::CreateLoad(*builder, llvm_utils->create_gep(dim_des, 2));
         }
 
-        llvm::Value* SimpleCMODescriptor::get_stride(llvm::Value*) {
-            return nullptr;
+        llvm::Value* SimpleCMODescriptor::get_stride(llvm::Value* dim_des) {
+            return LLVM::CreateLoad(*builder, llvm_utils->create_gep(dim_des, 0));
+        }
+
+        void SimpleCMODescriptor::fill_array_section(llvm::Value* view,
+            llvm::Value* arr, std::vector<llvm::Value*>& starts,
+            std::vector<llvm::Value*>& ends, std::vector<llvm::Value*>& steps,
+            int n_dims) {
+            llvm::Value* const_0 = llvm::ConstantInt::get(context, llvm::APInt(32, 0));
+            llvm::Value* const_1 = llvm::ConstantInt::get(context, llvm::APInt(32, 1));
+            builder->CreateStore(LLVM::CreateLoad(*builder, get_pointer_to_data(arr)),
+                get_pointer_to_data(view));
+            llvm::Value* arr_dims = get_pointer_to_dimension_descriptor_array(arr);
+            llvm::Value* view_dims = get_pointer_to_dimension_descriptor_array(view);
+            llvm::Value* offset = get_offset(arr);
+            for( int r = 0; r < n_dims; r++ ) {
+                llvm::Value* arr_dim = llvm_utils->create_ptr_gep(arr_dims, r);
+                llvm::Value* stride = get_stride(arr_dim);
+                llvm::Value* first = builder->CreateSub(starts[r], get_lower_bound(arr_dim));
+                offset = builder->CreateAdd(offset, builder->CreateMul(first, stride));
+                // The extent is (end - start)/step + 1, empty sections
+                // have an extent of 0
+                llvm::Value* extent = builder->CreateAdd(builder->CreateSDiv(
+                    builder->CreateSub(ends[r], starts[r]), steps[r]), const_1);
+                llvm::Value* is_empty = builder->CreateOr(
+                    builder->CreateICmpSLT(extent, const_0),
+                    builder->CreateICmpSLT(builder->CreateMul(
+                        builder->CreateSub(ends[r], starts[r]), steps[r]), const_0));
+                extent = builder->CreateSelect(is_empty, const_0, extent);
+                llvm::Value* view_dim = llvm_utils->create_ptr_gep(view_dims, r);
+                builder->CreateStore(builder->CreateMul(stride, steps[r]),
+                    llvm_utils->create_gep(view_dim, 0));
+                builder->CreateStore(const_1, llvm_utils->create_gep(view_dim, 1));
+                builder->CreateStore(extent, llvm_utils->create_gep(view_dim, 2));
+                builder->CreateStore(extent, llvm_utils->create_gep(view_dim, 3));
+            }
+            builder->CreateStore(offset, llvm_utils->create_gep(view, 1));
+            builder->CreateStore(llvm::ConstantInt::get(context, llvm::APInt(32, n_dims)),
+                get_rank(view, true));
         }
 
         // TODO: Uncomment and implement later
@@ -417,9 +468,10 @@ namespace LFortran {
         llvm::Value* SimpleCMODescriptor::cmo_convertor_single_element(
             llvm::Value* arr, std::vector<llvm::Value*>& m_args,
             int n_args, bool check_for_bounds) {
+            // The element is at offset + sum(stride*(i - lbound)) from the
+            // data, sections share the data of the array they refer to
             llvm::Value* dim_des_arr_ptr = LLVM::CreateLoad(*builder, llvm_utils->create_gep(arr, 2));
-            llvm::Value* prod = llvm::ConstantInt::get(context, llvm::APInt(32, 1));
-            llvm::Value* idx = llvm::ConstantInt::get(context, llvm::APInt(32, 0));
+            llvm::Value* idx = get_offset(arr);
             for( int r = 0; r < n_args; r++ ) {
                 llvm::Value* curr_llvm_idx = m_args[r];
                 llvm::Value* dim_des_ptr = llvm_utils->create_ptr_gep(dim_des_arr_ptr, r);
@@ -428,9 +480,7 @@ namespace LFortran {
                 if( check_for_bounds ) {
                     // check_single_element(curr_llvm_idx, arr); TODO: To be implemented
                 }
-                idx = builder->CreateAdd(idx, builder->CreateMul(prod, curr_llvm_idx));
-                llvm::Value* dim_size = LLVM::CreateLoad(*builder, llvm_utils->create_gep(dim_des_ptr, 3));
-                prod = builder->CreateMul(prod, dim_size);
+                idx = builder->CreateAdd(idx, builder->CreateMul(get_stride(dim_des_ptr), curr_llvm_idx));
             }
             return idx;
         }
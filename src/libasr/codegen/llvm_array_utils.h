@@ -135,12 +135,14 @@ namespace LFortran {
 
                 /*
                 * Fills the elements of the input array descriptor
-                * for arrays on stack memory.
+                * for arrays on stack memory, or for the elements
+                * in `data` if given.
                 */
                 virtual
                 void fill_array_details(
                     llvm::Value* arr, ASR::dimension_t* m_dims, int n_dims,
-                    std::vector<std::pair<llvm::Value*, llvm::Value*>>& llvm_dims) = 0;
+                    std::vector<std::pair<llvm::Value*, llvm::Value*>>& llvm_dims,
+                    llvm::Value* data=nullptr) = 0;
 
                 /*
                 * Fills the elements of the input array descriptor
@@ -156,6 +158,19 @@ namespace LFortran {
                 void fill_dimension_descriptor(
                     llvm::Value* arr, int n_dims) = 0;
 
+                /*
+                * Fills the input array descriptor `view` so that
+                * it refers to the section `starts:ends:steps` of
+                * `arr`, sharing its data. The elements are
+                * not copied, only the offset and strides of
+                * the section are computed.
+                */
+                virtual
+                void fill_array_section(llvm::Value* view, llvm::Value* arr,
+                    std::vector<llvm::Value*>& starts,
+                    std::vector<llvm::Value*>& ends,
+                    std::vector<llvm::Value*>& steps, int n_dims) = 0;
+
                 /*
                 * Returns the llvm::Type* associated with the
                 * dimension descriptor used by the current class.
@@ -304,7 +319,8 @@ namespace LFortran {
                 virtual
                 void fill_array_details(
                     llvm::Value* arr, ASR::dimension_t* m_dims, int n_dims,
-                    std::vector<std::pair<llvm::Value*, llvm::Value*>>& llvm_dims);
+                    std::vector<std::pair<llvm::Value*, llvm::Value*>>& llvm_dims,
+                    llvm::Value* data=nullptr);
 
                 virtual
                 void fill_malloc_array_details(
@@ -316,6 +332,12 @@ namespace LFortran {
                 void fill_dimension_descriptor(
                     llvm::Value* arr, int n_dims);
 
+                virtual
+                void fill_array_section(llvm::Value* view, llvm::Value* arr,
+                    std::vector<llvm::Value*>& starts,
+                    std::vector<llvm::Value*>& ends,
+                    std::vector<llvm::Value*>& steps, int n_dims);
+
                 virtual
                 llvm::Type* get_dimension_descriptor_type(bool get_pointer=false);
 
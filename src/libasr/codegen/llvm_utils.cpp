@@ -1,3 +1,5 @@
+#include <llvm/IR/MDBuilder.h>
+
 #include <libasr/assert.h>
 #include <libasr/codegen/llvm_utils.h>
 
@@ -59,4 +61,1113 @@ namespace LFortran {
         return LLVM::CreateInBoundsGEP(*builder, ptr, idx_vec);
     }
 
+    LLVMList::LLVMList(llvm::LLVMContext& context, LLVMUtils* llvm_utils,
+        llvm::IRBuilder<>* builder):
+        context(context),
+        llvm_utils(llvm_utils),
+        builder(builder),
+        dict_api(nullptr) {
+        }
+
+    void LLVMList::set_dict_api(LLVMDict* dict_api) {
+        this->dict_api = dict_api;
+    }
+
+    llvm::StructType* LLVMList::get_list_type(llvm::Type* el_type,
+        const std::string& type_code) {
+        if (typecode2listtype.find(type_code) == typecode2listtype.end()) {
+            std::vector<llvm::Type*> els = {
+                llvm::Type::getInt32Ty(context),
+                llvm::Type::getInt32Ty(context),
+                el_type->getPointerTo()};
+            typecode2listtype[type_code] = llvm::StructType::create(context,
+                els, "list_" + type_code);
+        }
+        return typecode2listtype[type_code];
+    }
+
+    bool LLVMList::is_list(llvm::Type* type) {
+        for (auto &it: typecode2listtype) {
+            if (it.second == type) return true;
+        }
+        return false;
+    }
+
+    bool LLVMList::is_container(llvm::Type* type) {
+        return is_list(type) || (dict_api && dict_api->is_dict(type));
+    }
+
+    llvm::Value* LLVMList::create_alloca(llvm::Type* type) {
+        llvm::BasicBlock &entry_block = builder->GetInsertBlock()->getParent()->getEntryBlock();
+        llvm::IRBuilder<> builder0(context);
+        builder0.SetInsertPoint(&entry_block, entry_block.getFirstInsertionPt());
+        return builder0.CreateAlloca(type, nullptr);
+    }
+
+    void LLVMList::start_new_block(llvm::BasicBlock* bb) {
+        llvm::BasicBlock *last_bb = builder->GetInsertBlock();
+        llvm::Function *fn = last_bb->getParent();
+        if (last_bb->getTerminator() == nullptr) {
+            builder->CreateBr(bb);
+        }
+        fn->getBasicBlockList().push_back(bb);
+        builder->SetInsertPoint(bb);
+    }
+
+    void LLVMList::create_loop(llvm::Value* n,
+        std::function<void(llvm::Value*)> body) {
+        llvm::Value *pi = create_alloca(llvm::Type::getInt32Ty(context));
+        builder->CreateStore(llvm::ConstantInt::get(context, llvm::APInt(32, 0)), pi);
+        llvm::BasicBlock *loophead = llvm::BasicBlock::Create(context, "list.loop.head");
+        llvm::BasicBlock *loopbody = llvm::BasicBlock::Create(context, "list.loop.body");
+        llvm::BasicBlock *loopend = llvm::BasicBlock::Create(context, "list.loop.end");
+        start_new_block(loophead);
+        llvm::Value *i = LLVM::CreateLoad(*builder, pi);
+        builder->CreateCondBr(builder->CreateICmpSLT(i, n), loopbody, loopend);
+        start_new_block(loopbody);
+        body(i);
+        builder->CreateStore(builder->CreateAdd(i,
+            llvm::ConstantInt::get(context, llvm::APInt(32, 1))), pi);
+        builder->CreateBr(loophead);
+        start_new_block(loopend);
+    }
+
+    llvm::Function* LLVMList::get_runtime_function(llvm::Module& module,
+        const std::string& name, llvm::FunctionType* type) {
+        llvm::Function *fn = module.getFunction(name);
+        if (!fn) {
+            fn = llvm::Function::Create(type, llvm::Function::ExternalLinkage,
+                name, module);
+        }
+        return fn;
+    }
+
+    llvm::Value* LLVMList::realloc(llvm::Module& module, llvm::Value* ptr,
+        llvm::Value* n_bytes) {
+        llvm::Type *i8_ptr = llvm::Type::getInt8PtrTy(context);
+        llvm::Function *fn = get_runtime_function(module, "_lfortran_realloc",
+            llvm::FunctionType::get(i8_ptr, {i8_ptr,
+                llvm::Type::getInt64Ty(context)}, false));
+        return builder->CreateCall(fn, {builder->CreateBitCast(ptr, i8_ptr),
+            n_bytes});
+    }
+
+    void LLVMList::raise_error(llvm::Module& module, const std::string& msg) {
+        llvm::Type *i8_ptr = llvm::Type::getInt8PtrTy(context);
+        llvm::Function *fn_printf = get_runtime_function(module,
+            "_lfortran_printf", llvm::FunctionType::get(
+                llvm::Type::getVoidTy(context), {i8_ptr}, true));
+        builder->CreateCall(fn_printf, {builder->CreateGlobalStringPtr("%s\n"),
+            builder->CreateGlobalStringPtr(msg)});
+        llvm::Function *fn_exit = get_runtime_function(module, "exit",
+            llvm::FunctionType::get(llvm::Type::getVoidTy(context),
+                {llvm::Type::getInt32Ty(context)}, false));
+        builder->CreateCall(fn_exit, {llvm::ConstantInt::get(context,
+            llvm::APInt(32, 1))});
+        builder->CreateUnreachable();
+    }
+
+    llvm::Value* LLVMList::get_el_size(llvm::Type* el_type) {
+        return llvm::ConstantExpr::getSizeOf(el_type);
+    }
+
+    llvm::Type* LLVMList::get_el_type(llvm::Value* list) {
+        return list->getType()->getContainedType(0)->getStructElementType(2)
+            ->getContainedType(0);
+    }
+
+    llvm::Value* LLVMList::get_pointer_to_len(llvm::Value* list) {
+        return llvm_utils->create_gep(list, 0);
+    }
+
+    llvm::Value* LLVMList::get_pointer_to_capacity(llvm::Value* list) {
+        return llvm_utils->create_gep(list, 1);
+    }
+
+    llvm::Value* LLVMList::get_pointer_to_data(llvm::Value* list) {
+        return llvm_utils->create_gep(list, 2);
+    }
+
+    llvm::Value* LLVMList::len(llvm::Value* list) {
+        return LLVM::CreateLoad(*builder, get_pointer_to_len(list));
+    }
+
+    void LLVMList::list_init(llvm::Value* list, llvm::Module& module,
+        llvm::Value* capacity) {
+        llvm::PointerType *data_type = llvm::cast<llvm::PointerType>(
+            list->getType()->getContainedType(0)->getStructElementType(2));
+        llvm::Value *data = llvm::ConstantPointerNull::get(data_type);
+        if (capacity) {
+            llvm::Value *n_bytes = builder->CreateMul(builder->CreateZExt(
+                capacity, llvm::Type::getInt64Ty(context)),
+                get_el_size(data_type->getElementType()));
+            data = builder->CreateBitCast(realloc(module, data, n_bytes),
+                data_type);
+        } else {
+            capacity = llvm::ConstantInt::get(context, llvm::APInt(32, 0));
+        }
+        builder->CreateStore(llvm::ConstantInt::get(context, llvm::APInt(32, 0)),
+            get_pointer_to_len(list));
+        builder->CreateStore(capacity, get_pointer_to_capacity(list));
+        builder->CreateStore(data, get_pointer_to_data(list));
+    }
+
+    llvm::Value* LLVMList::normalize_index(llvm::Value* list, llvm::Value* pos) {
+        if (llvm::ConstantInt *c = llvm::dyn_cast<llvm::ConstantInt>(pos)) {
+            if (!c->isNegative()) return pos;
+        }
+        return builder->CreateSelect(builder->CreateICmpSLT(pos,
+            llvm::ConstantInt::get(context, llvm::APInt(32, 0))),
+            builder->CreateAdd(pos, len(list)), pos);
+    }
+
+    void LLVMList::check_index(llvm::Value* list, llvm::Value* pos,
+        llvm::Module& module, const std::string& msg) {
+        // A negative position is a large unsigned one
+        llvm::BasicBlock *errorBB = llvm::BasicBlock::Create(context, "list.index.error");
+        llvm::BasicBlock *contBB = llvm::BasicBlock::Create(context, "list.index");
+        llvm::MDBuilder md(context);
+        builder->CreateCondBr(builder->CreateICmpUGE(pos, len(list)),
+            errorBB, contBB, md.createBranchWeights(1, 1000));
+        start_new_block(errorBB);
+        raise_error(module, msg);
+        start_new_block(contBB);
+    }
+
+    llvm::Value* LLVMList::read_item(llvm::Value* list, llvm::Value* pos,
+        bool get_pointer) {
+        llvm::Value *data = LLVM::CreateLoad(*builder, get_pointer_to_data(list));
+        llvm::Value *item = llvm_utils->create_ptr_gep(data, pos);
+        if (get_pointer) return item;
+        return LLVM::CreateLoad(*builder, item);
+    }
+
+    void LLVMList::write_item(llvm::Value* list, llvm::Value* pos,
+        llvm::Value* item) {
+        builder->CreateStore(item, read_item(list, pos, true));
+    }
+
+    void LLVMList::reserve(llvm::Value* list, llvm::Value* n,
+        llvm::Module& module) {
+        llvm::Value *capacity = LLVM::CreateLoad(*builder,
+            get_pointer_to_capacity(list));
+        llvm::BasicBlock *growBB = llvm::BasicBlock::Create(context, "list.grow");
+        llvm::BasicBlock *contBB = llvm::BasicBlock::Create(context, "list.grow.end");
+        llvm::MDBuilder md(context);
+        builder->CreateCondBr(builder->CreateICmpSGT(n, capacity), growBB,
+            contBB, md.createBranchWeights(1, 1000));
+        start_new_block(growBB);
+        llvm::Value *new_capacity = builder->CreateMul(capacity,
+            llvm::ConstantInt::get(context, llvm::APInt(32, 2)));
+        new_capacity = builder->CreateSelect(builder->CreateICmpSGT(n,
+            new_capacity), n, new_capacity);
+        llvm::Value *data_ptr = get_pointer_to_data(list);
+        llvm::Type *data_type = data_ptr->getType()->getContainedType(0);
+        llvm::Value *n_bytes = builder->CreateMul(builder->CreateZExt(
+            new_capacity, llvm::Type::getInt64Ty(context)),
+            get_el_size(data_type->getContainedType(0)));
+        llvm::Value *data = realloc(module, LLVM::CreateLoad(*builder,
+            data_ptr), n_bytes);
+        builder->CreateStore(builder->CreateBitCast(data, data_type), data_ptr);
+        builder->CreateStore(new_capacity, get_pointer_to_capacity(list));
+        start_new_block(contBB);
+    }
+
+    void LLVMList::append(llvm::Value* list, llvm::Value* item,
+        llvm::Module& module) {
+        llvm::Value *n = len(list);
+        llvm::Value *new_len = builder->CreateAdd(n,
+            llvm::ConstantInt::get(context, llvm::APInt(32, 1)));
+        reserve(list, new_len, module);
+        write_item(list, n, item);
+        builder->CreateStore(new_len, get_pointer_to_len(list));
+    }
+
+    void LLVMList::move_items(llvm::Value* list, llvm::Value* src,
+        llvm::Value* dest, llvm::Value* n) {
+        llvm::Value *psrc = read_item(list, src, true);
+        llvm::Value *pdest = read_item(list, dest, true);
+        llvm::Value *n_bytes = builder->CreateMul(builder->CreateZExt(n,
+            llvm::Type::getInt64Ty(context)), get_el_size(
+            psrc->getType()->getContainedType(0)));
+        builder->CreateMemMove(pdest, llvm::MaybeAlign(), psrc,
+            llvm::MaybeAlign(), n_bytes);
+    }
+
+    void LLVMList::copy_items(llvm::Value* src, llvm::Value* src_pos,
+        llvm::Value* dest, llvm::Value* dest_pos, llvm::Value* n,
+        llvm::Module& module) {
+        llvm::Type *el_type = get_el_type(src);
+        if (is_container(el_type)) {
+            create_loop(n, [&](llvm::Value *i) {
+                deepcopy(read_item(src, builder->CreateAdd(src_pos, i), true),
+                    read_item(dest, builder->CreateAdd(dest_pos, i), true),
+                    module);
+            });
+        } else {
+            llvm::Value *n_bytes = builder->CreateMul(builder->CreateZExt(n,
+                llvm::Type::getInt64Ty(context)), get_el_size(el_type));
+            builder->CreateMemCpy(read_item(dest, dest_pos, true),
+                llvm::MaybeAlign(), read_item(src, src_pos, true),
+                llvm::MaybeAlign(), n_bytes);
+        }
+    }
+
+    void LLVMList::insert(llvm::Value* list, llvm::Value* pos,
+        llvm::Value* item, llvm::Module& module) {
+        // Python clamps the position of the insertion to [0, len]
+        llvm::Value *zero = llvm::ConstantInt::get(context, llvm::APInt(32, 0));
+        llvm::Value *n = len(list);
+        pos = normalize_index(list, pos);
+        pos = builder->CreateSelect(builder->CreateICmpSLT(pos, zero), zero, pos);
+        pos = builder->CreateSelect(builder->CreateICmpSGT(pos, n), n, pos);
+        llvm::Value *new_len = builder->CreateAdd(n,
+            llvm::ConstantInt::get(context, llvm::APInt(32, 1)));
+        reserve(list, new_len, module);
+        move_items(list, pos, builder->CreateAdd(pos,
+            llvm::ConstantInt::get(context, llvm::APInt(32, 1))),
+            builder->CreateSub(n, pos));
+        write_item(list, pos, item);
+        builder->CreateStore(new_len, get_pointer_to_len(list));
+    }
+
+    void LLVMList::remove(llvm::Value* list, llvm::Value* item,
+        llvm::Module& module) {
+        llvm::Value *n = len(list);
+        llvm::Value *pi = create_alloca(llvm::Type::getInt32Ty(context));
+        builder->CreateStore(llvm::ConstantInt::get(context, llvm::APInt(32, 0)), pi);
+        llvm::BasicBlock *loophead = llvm::BasicBlock::Create(context, "list.remove.head");
+        llvm::BasicBlock *loopbody = llvm::BasicBlock::Create(context, "list.remove.body");
+        llvm::BasicBlock *loopnext = llvm::BasicBlock::Create(context, "list.remove.next");
+        llvm::BasicBlock *notfound = llvm::BasicBlock::Create(context, "list.remove.notfound");
+        llvm::BasicBlock *found = llvm::BasicBlock::Create(context, "list.remove.found");
+        start_new_block(loophead);
+        llvm::Value *i = LLVM::CreateLoad(*builder, pi);
+        builder->CreateCondBr(builder->CreateICmpSLT(i, n), loopbody, notfound);
+        start_new_block(loopbody);
+        llvm::Value *is_equal = is_equal_by_value(read_item(list, i), item, module);
+        builder->CreateCondBr(is_equal, found, loopnext);
+        start_new_block(loopnext);
+        builder->CreateStore(builder->CreateAdd(i,
+            llvm::ConstantInt::get(context, llvm::APInt(32, 1))), pi);
+        builder->CreateBr(loophead);
+        start_new_block(notfound);
+        raise_error(module, "ValueError: list.remove(x): x not in list");
+        start_new_block(found);
+        i = LLVM::CreateLoad(*builder, pi);
+        llvm::Value *one = llvm::ConstantInt::get(context, llvm::APInt(32, 1));
+        move_items(list, builder->CreateAdd(i, one), i,
+            builder->CreateSub(builder->CreateSub(n, i), one));
+        builder->CreateStore(builder->CreateSub(n, one), get_pointer_to_len(list));
+    }
+
+    llvm::Value* LLVMList::pop(llvm::Value* list, llvm::Value* pos,
+        llvm::Module& module) {
+        llvm::Value *one = llvm::ConstantInt::get(context, llvm::APInt(32, 1));
+        llvm::Value *n = len(list);
+        if (pos) {
+            pos = normalize_index(list, pos);
+            check_index(list, pos, module, "IndexError: pop index out of range");
+        } else {
+            // The last item, -1 is out of range for an empty list
+            pos = builder->CreateSub(n, one);
+            check_index(list, pos, module, "IndexError: pop from empty list");
+        }
+        llvm::Value *item = read_item(list, pos);
+        move_items(list, builder->CreateAdd(pos, one), pos,
+            builder->CreateSub(builder->CreateSub(n, pos), one));
+        builder->CreateStore(builder->CreateSub(n, one), get_pointer_to_len(list));
+        return item;
+    }
+
+    void LLVMList::list_deepcopy(llvm::Value* src, llvm::Value* dest,
+        llvm::Module& module) {
+        llvm::Value *n = len(src);
+        list_init(dest, module, n);
+        copy_items(src, llvm::ConstantInt::get(context, llvm::APInt(32, 0)),
+            dest, llvm::ConstantInt::get(context, llvm::APInt(32, 0)), n, module);
+        builder->CreateStore(n, get_pointer_to_len(dest));
+    }
+
+    void LLVMList::deepcopy(llvm::Value* src, llvm::Value* dest,
+        llvm::Module& module) {
+        if (is_list(src->getType()->getContainedType(0))) {
+            list_deepcopy(src, dest, module);
+        } else {
+            dict_api->dict_deepcopy(src, dest, module);
+        }
+    }
+
+    void LLVMList::concat(llvm::Value* left, llvm::Value* right,
+        llvm::Value* result, llvm::Module& module) {
+        llvm::Value *zero = llvm::ConstantInt::get(context, llvm::APInt(32, 0));
+        llvm::Value *n_left = len(left);
+        llvm::Value *n_right = len(right);
+        llvm::Value *n = builder->CreateAdd(n_left, n_right);
+        list_init(result, module, n);
+        copy_items(left, zero, result, zero, n_left, module);
+        copy_items(right, zero, result, n_left, n_right, module);
+        builder->CreateStore(n, get_pointer_to_len(result));
+    }
+
+    void LLVMList::section(llvm::Value* list, llvm::Value* start,
+        llvm::Value* end, llvm::Value* step, llvm::Value* result,
+        llvm::Module& module) {
+        llvm::Value *zero = llvm::ConstantInt::get(context, llvm::APInt(32, 0));
+        llvm::Value *one = llvm::ConstantInt::get(context, llvm::APInt(32, 1));
+        llvm::Value *minus_one = llvm::ConstantInt::get(context, llvm::APInt(32, -1, true));
+        bool unit_step = !step || (llvm::isa<llvm::ConstantInt>(step) &&
+            llvm::cast<llvm::ConstantInt>(step)->isOne());
+        if (!step) step = one;
+        if (!llvm::isa<llvm::ConstantInt>(step)) {
+            llvm::BasicBlock *errorBB = llvm::BasicBlock::Create(context, "list.section.error");
+            llvm::BasicBlock *contBB = llvm::BasicBlock::Create(context, "list.section");
+            builder->CreateCondBr(builder->CreateICmpEQ(step, zero), errorBB, contBB);
+            start_new_block(errorBB);
+            raise_error(module, "ValueError: slice step cannot be zero");
+            start_new_block(contBB);
+        }
+        // The bounds are normalized as in Python: a negative bound counts
+        // from the end and the result is clamped to [0, len] for a positive
+        // step and to [-1, len-1] for a negative step
+        llvm::Value *n = len(list);
+        llvm::Value *positive = builder->CreateICmpSGT(step, zero);
+        llvm::Value *lower = builder->CreateSelect(positive, zero, minus_one);
+        llvm::Value *upper = builder->CreateSelect(positive, n,
+            builder->CreateSub(n, one));
+        auto normalize = [&](llvm::Value *v) {
+            v = builder->CreateSelect(builder->CreateICmpSLT(v, zero),
+                builder->CreateAdd(v, n), v);
+            v = builder->CreateSelect(builder->CreateICmpSLT(v, lower), lower, v);
+            return builder->CreateSelect(builder->CreateICmpSGT(v, upper), upper, v);
+        };
+        start = start ? normalize(start) : builder->CreateSelect(positive,
+            zero, builder->CreateSub(n, one));
+        end = end ? normalize(end) : builder->CreateSelect(positive, n, minus_one);
+        // The number of elements is ceil((end - start)/step) if positive
+        llvm::Value *distance = builder->CreateSub(end, start);
+        llvm::Value *count = builder->CreateSDiv(builder->CreateAdd(distance,
+            builder->CreateSub(step, builder->CreateSelect(positive, one,
+            minus_one))), step);
+        count = builder->CreateSelect(builder->CreateICmpSGT(count, zero),
+            count, zero);
+        list_init(result, module, count);
+        if (unit_step) {
+            copy_items(list, start, result, zero, count, module);
+        } else {
+            bool is_nested = is_container(get_el_type(list));
+            create_loop(count, [&](llvm::Value *i) {
+                llvm::Value *pos = builder->CreateAdd(start,
+                    builder->CreateMul(i, step));
+                if (is_nested) {
+                    deepcopy(read_item(list, pos, true),
+                        read_item(result, i, true), module);
+                } else {
+                    write_item(result, i, read_item(list, pos));
+                }
+            });
+        }
+        builder->CreateStore(count, get_pointer_to_len(result));
+    }
+
+    void LLVMList::free_data(llvm::Value* list, llvm::Module& module) {
+        llvm::Type *i8_ptr = llvm::Type::getInt8PtrTy(context);
+        llvm::Function *fn = get_runtime_function(module, "_lfortran_free",
+            llvm::FunctionType::get(llvm::Type::getVoidTy(context), {i8_ptr},
+            true));
+        llvm::Value *data = LLVM::CreateLoad(*builder, get_pointer_to_data(list));
+        builder->CreateCall(fn, {builder->CreateBitCast(data, i8_ptr)});
+    }
+
+    void LLVMList::deepfree(llvm::Value* container, llvm::Module& module) {
+        if (!is_list(container->getType()->getContainedType(0))) {
+            dict_api->dict_deepfree(container, module);
+            return;
+        }
+        if (is_container(get_el_type(container))) {
+            create_loop(len(container), [&](llvm::Value *i) {
+                deepfree(read_item(container, i, true), module);
+            });
+        }
+        free_data(container, module);
+    }
+
+    llvm::Value* LLVMList::is_equal_by_value(llvm::Value* left,
+        llvm::Value* right, llvm::Module& module) {
+        llvm::Type *type = left->getType();
+        if (type->isIntegerTy()) {
+            return builder->CreateICmpEQ(left, right);
+        } else if (type->isFloatingPointTy()) {
+            return builder->CreateFCmpOEQ(left, right);
+        } else if (type->isPointerTy()) {
+            // Strings
+            llvm::Type *i8_ptr = llvm::Type::getInt8PtrTy(context);
+            llvm::Function *fn = get_runtime_function(module,
+                "_lfortran_str_compare", llvm::FunctionType::get(
+                llvm::Type::getInt32Ty(context), {i8_ptr, i8_ptr}, false));
+            llvm::Value *c = builder->CreateCall(fn, {left, right});
+            return builder->CreateICmpEQ(c,
+                llvm::ConstantInt::get(context, llvm::APInt(32, 0)));
+        } else if (is_list(type)) {
+            llvm::Value *pleft = create_alloca(type);
+            llvm::Value *pright = create_alloca(type);
+            builder->CreateStore(left, pleft);
+            builder->CreateStore(right, pright);
+            llvm::Value *presult = create_alloca(llvm::Type::getInt1Ty(context));
+            llvm::Value *n = len(pleft);
+            builder->CreateStore(builder->CreateICmpEQ(n, len(pright)), presult);
+            llvm::BasicBlock *loopBB = llvm::BasicBlock::Create(context, "list.eq");
+            llvm::BasicBlock *endBB = llvm::BasicBlock::Create(context, "list.eq.end");
+            builder->CreateCondBr(LLVM::CreateLoad(*builder, presult), loopBB, endBB);
+            start_new_block(loopBB);
+            create_loop(n, [&](llvm::Value *i) {
+                llvm::Value *is_equal = is_equal_by_value(read_item(pleft, i),
+                    read_item(pright, i), module);
+                builder->CreateStore(builder->CreateAnd(is_equal,
+                    LLVM::CreateLoad(*builder, presult)), presult);
+            });
+            start_new_block(endBB);
+            return LLVM::CreateLoad(*builder, presult);
+        } else {
+            // Complex numbers and tuples, field by field
+            LFORTRAN_ASSERT(type->isStructTy());
+            llvm::Value *result = llvm::ConstantInt::getTrue(context);
+            for (unsigned i = 0; i < type->getStructNumElements(); i++) {
+                result = builder->CreateAnd(result, is_equal_by_value(
+                    builder->CreateExtractValue(left, i),
+                    builder->CreateExtractValue(right, i), module));
+            }
+            return result;
+        }
+    }
+
+
+    // The control bytes of the slots without a key, the other slots have
+    // the low 7 bits of the hash of their key, which are non-negative
+    static const int8_t ctrl_empty = -128;
+    static const int8_t ctrl_deleted = -2;
+
+    LLVMDict::LLVMDict(llvm::LLVMContext& context, LLVMUtils* llvm_utils,
+        llvm::IRBuilder<>* builder, LLVMList* list_api):
+        context(context),
+        llvm_utils(llvm_utils),
+        builder(builder),
+        list_api(list_api) {
+        }
+
+    llvm::StructType* LLVMDict::get_dict_type(llvm::Type* key_type,
+        llvm::Type* value_type, const std::string& type_code) {
+        std::string name = (value_type ? "dict_" : "set_") + type_code;
+        if (typecode2tabletype.find(name) == typecode2tabletype.end()) {
+            std::vector<llvm::Type*> els = {
+                llvm::Type::getInt32Ty(context),
+                llvm::Type::getInt32Ty(context),
+                llvm::Type::getInt32Ty(context),
+                llvm::Type::getInt8PtrTy(context),
+                key_type->getPointerTo()};
+            if (value_type) els.push_back(value_type->getPointerTo());
+            typecode2tabletype[name] = llvm::StructType::create(context,
+                els, name);
+        }
+        return typecode2tabletype[name];
+    }
+
+    llvm::StructType* LLVMDict::get_set_type(llvm::Type* el_type,
+        const std::string& type_code) {
+        return get_dict_type(el_type, nullptr, type_code);
+    }
+
+    bool LLVMDict::is_dict(llvm::Type* type) {
+        for (auto &it: typecode2tabletype) {
+            if (it.second == type) return true;
+        }
+        return false;
+    }
+
+    bool LLVMDict::has_values(llvm::Value* table) {
+        return table->getType()->getContainedType(0)->getStructNumElements() == 6;
+    }
+
+    llvm::Type* LLVMDict::get_key_type(llvm::Type* table_type) {
+        return table_type->getStructElementType(4)->getContainedType(0);
+    }
+
+    llvm::Value* LLVMDict::get_pointer_to_len(llvm::Value* table) {
+        return llvm_utils->create_gep(table, 0);
+    }
+
+    llvm::Value* LLVMDict::get_pointer_to_capacity(llvm::Value* table) {
+        return llvm_utils->create_gep(table, 1);
+    }
+
+    llvm::Value* LLVMDict::get_pointer_to_filled(llvm::Value* table) {
+        return llvm_utils->create_gep(table, 2);
+    }
+
+    llvm::Value* LLVMDict::get_pointer_to_ctrl(llvm::Value* table) {
+        return llvm_utils->create_gep(table, 3);
+    }
+
+    llvm::Value* LLVMDict::get_pointer_to_keys(llvm::Value* table) {
+        return llvm_utils->create_gep(table, 4);
+    }
+
+    llvm::Value* LLVMDict::get_pointer_to_values(llvm::Value* table) {
+        return llvm_utils->create_gep(table, 5);
+    }
+
+    void LLVMDict::dict_init(llvm::Value* table) {
+        builder->CreateStore(llvm::Constant::getNullValue(
+            table->getType()->getContainedType(0)), table);
+    }
+
+    llvm::Value* LLVMDict::len(llvm::Value* table) {
+        return LLVM::CreateLoad(*builder, get_pointer_to_len(table));
+    }
+
+    llvm::Value* LLVMDict::mix(llvm::Value* h) {
+        llvm::Type *i64 = llvm::Type::getInt64Ty(context);
+        llvm::Value *shift = llvm::ConstantInt::get(i64, 33);
+        h = builder->CreateXor(h, builder->CreateLShr(h, shift));
+        h = builder->CreateMul(h, llvm::ConstantInt::get(i64, 0xff51afd7ed558ccdULL));
+        h = builder->CreateXor(h, builder->CreateLShr(h, shift));
+        h = builder->CreateMul(h, llvm::ConstantInt::get(i64, 0xc4ceb9fe1a85ec53ULL));
+        return builder->CreateXor(h, builder->CreateLShr(h, shift));
+    }
+
+    llvm::Value* LLVMDict::hash(llvm::Value* key, llvm::Module& module) {
+        llvm::Type *type = key->getType();
+        llvm::Type *i64 = llvm::Type::getInt64Ty(context);
+        if (type->isIntegerTy()) {
+            if (type->getIntegerBitWidth() == 1) {
+                key = builder->CreateZExt(key, i64);
+            } else if (type->getIntegerBitWidth() < 64) {
+                key = builder->CreateSExt(key, i64);
+            }
+            return mix(key);
+        } else if (type->isFloatingPointTy()) {
+            // -0.0 == 0.0, so both are hashed as 0
+            llvm::Type *int_type = llvm::Type::getIntNTy(context,
+                type->getPrimitiveSizeInBits());
+            llvm::Value *bits = builder->CreateBitCast(key, int_type);
+            llvm::Value *zero = llvm::ConstantInt::get(int_type, 0);
+            llvm::Value *is_zero = builder->CreateICmpEQ(builder->CreateShl(bits,
+                llvm::ConstantInt::get(int_type, 1)), zero);
+            bits = builder->CreateSelect(is_zero, zero, bits);
+            return mix(builder->CreateZExt(bits, i64));
+        } else if (type->isPointerTy()) {
+            // Strings
+            llvm::Function *fn = list_api->get_runtime_function(module,
+                "_lfortran_str_hash", llvm::FunctionType::get(i64,
+                {llvm::Type::getInt8PtrTy(context)}, false));
+            return mix(builder->CreateCall(fn, {key}));
+        } else {
+            // Complex numbers and tuples, the hashes of the fields are
+            // combined in order
+            LFORTRAN_ASSERT(type->isStructTy());
+            llvm::Value *h = llvm::ConstantInt::get(i64, 0);
+            for (unsigned i = 0; i < type->getStructNumElements(); i++) {
+                h = builder->CreateXor(builder->CreateMul(h,
+                    llvm::ConstantInt::get(i64, 0x9e3779b97f4a7c15ULL)),
+                    hash(builder->CreateExtractValue(key, i), module));
+            }
+            return mix(h);
+        }
+    }
+
+    llvm::Value* LLVMDict::get_h2(llvm::Value* hash) {
+        return builder->CreateTrunc(builder->CreateAnd(hash,
+            llvm::ConstantInt::get(hash->getType(), 0x7f)),
+            llvm::Type::getInt8Ty(context));
+    }
+
+    llvm::Value* LLVMDict::get_h1(llvm::Value* hash, llvm::Value* mask) {
+        return builder->CreateAnd(builder->CreateTrunc(builder->CreateLShr(hash,
+            llvm::ConstantInt::get(hash->getType(), 7)),
+            llvm::Type::getInt32Ty(context)), mask);
+    }
+
+    llvm::Value* LLVMDict::allocate(llvm::Type* el_type, llvm::Value* n,
+        llvm::Module& module) {
+        llvm::Value *n_bytes = builder->CreateMul(builder->CreateZExt(n,
+            llvm::Type::getInt64Ty(context)), list_api->get_el_size(el_type));
+        llvm::Value *ptr = list_api->realloc(module,
+            llvm::ConstantPointerNull::get(llvm::Type::getInt8PtrTy(context)),
+            n_bytes);
+        return builder->CreateBitCast(ptr, el_type->getPointerTo());
+    }
+
+    llvm::Function* LLVMDict::create_function(const std::string& name,
+        llvm::Type* table_type, llvm::Type* return_type,
+        std::vector<llvm::Type*> arg_types, llvm::Module& module,
+        bool& defined) {
+        std::string fn_name = table_type->getStructName().str() + "." + name;
+        llvm::Function *fn = module.getFunction(fn_name);
+        defined = fn != nullptr;
+        if (defined) return fn;
+        arg_types.insert(arg_types.begin(), table_type->getPointerTo());
+        fn = llvm::Function::Create(llvm::FunctionType::get(return_type,
+            arg_types, false), llvm::Function::InternalLinkage, fn_name, module);
+        builder->SetInsertPoint(llvm::BasicBlock::Create(context, "entry", fn));
+        builder->SetCurrentDebugLocation(llvm::DebugLoc());
+        return fn;
+    }
+
+    llvm::Function* LLVMDict::get_find_function(llvm::Type* table_type,
+        llvm::Module& module) {
+        llvm::IRBuilderBase::InsertPointGuard guard(*builder);
+        llvm::Type *i32 = llvm::Type::getInt32Ty(context);
+        llvm::Type *i8 = llvm::Type::getInt8Ty(context);
+        bool defined;
+        llvm::Function *fn = create_function("find", table_type, i32,
+            {get_key_type(table_type)}, module, defined);
+        if (defined) return fn;
+        llvm::Value *table = fn->getArg(0);
+        llvm::Value *key = fn->getArg(1);
+        llvm::Value *pidx = list_api->create_alloca(i32);
+        llvm::BasicBlock *probeBB = llvm::BasicBlock::Create(context, "probe");
+        llvm::BasicBlock *loophead = llvm::BasicBlock::Create(context, "probe.head");
+        llvm::BasicBlock *checkBB = llvm::BasicBlock::Create(context, "probe.check");
+        llvm::BasicBlock *missBB = llvm::BasicBlock::Create(context, "probe.miss");
+        llvm::BasicBlock *nextBB = llvm::BasicBlock::Create(context, "probe.next");
+        llvm::BasicBlock *foundBB = llvm::BasicBlock::Create(context, "found");
+        llvm::BasicBlock *notfoundBB = llvm::BasicBlock::Create(context, "notfound");
+        llvm::Value *capacity = LLVM::CreateLoad(*builder,
+            get_pointer_to_capacity(table));
+        builder->CreateCondBr(builder->CreateICmpEQ(capacity,
+            llvm::ConstantInt::get(i32, 0)), notfoundBB, probeBB);
+        list_api->start_new_block(probeBB);
+        llvm::Value *h = hash(key, module);
+        llvm::Value *h2 = get_h2(h);
+        llvm::Value *mask = builder->CreateSub(capacity, llvm::ConstantInt::get(i32, 1));
+        llvm::Value *ctrl = LLVM::CreateLoad(*builder, get_pointer_to_ctrl(table));
+        llvm::Value *keys = LLVM::CreateLoad(*builder, get_pointer_to_keys(table));
+        builder->CreateStore(get_h1(h, mask), pidx);
+        list_api->start_new_block(loophead);
+        llvm::Value *idx = LLVM::CreateLoad(*builder, pidx);
+        llvm::Value *c = LLVM::CreateLoad(*builder,
+            llvm_utils->create_ptr_gep(ctrl, idx));
+        builder->CreateCondBr(builder->CreateICmpEQ(c, h2), checkBB, missBB);
+        list_api->start_new_block(checkBB);
+        llvm::Value *is_equal = list_api->is_equal_by_value(LLVM::CreateLoad(
+            *builder, llvm_utils->create_ptr_gep(keys, idx)), key, module);
+        builder->CreateCondBr(is_equal, foundBB, missBB);
+        list_api->start_new_block(missBB);
+        builder->CreateCondBr(builder->CreateICmpEQ(c,
+            llvm::ConstantInt::get(i8, ctrl_empty, true)), notfoundBB, nextBB);
+        list_api->start_new_block(nextBB);
+        builder->CreateStore(builder->CreateAnd(builder->CreateAdd(idx,
+            llvm::ConstantInt::get(i32, 1)), mask), pidx);
+        builder->CreateBr(loophead);
+        list_api->start_new_block(foundBB);
+        builder->CreateRet(idx);
+        list_api->start_new_block(notfoundBB);
+        builder->CreateRet(llvm::ConstantInt::get(i32, -1, true));
+        return fn;
+    }
+
+    llvm::Function* LLVMDict::get_insert_function(llvm::Type* table_type,
+        llvm::Module& module) {
+        llvm::IRBuilderBase::InsertPointGuard guard(*builder);
+        llvm::Type *i32 = llvm::Type::getInt32Ty(context);
+        llvm::Type *i64 = llvm::Type::getInt64Ty(context);
+        llvm::Type *i8 = llvm::Type::getInt8Ty(context);
+        llvm::Function *rehash_fn = get_rehash_function(table_type, module);
+        bool defined;
+        llvm::Function *fn = create_function("insert", table_type, i32,
+            {get_key_type(table_type)}, module, defined);
+        if (defined) return fn;
+        llvm::Value *table = fn->getArg(0);
+        llvm::Value *key = fn->getArg(1);
+        llvm::Value *zero = llvm::ConstantInt::get(i32, 0);
+        llvm::Value *one = llvm::ConstantInt::get(i32, 1);
+        llvm::Value *pidx = list_api->create_alloca(i32);
+        llvm::Value *pdeleted = list_api->create_alloca(i32);
+        llvm::BasicBlock *growBB = llvm::BasicBlock::Create(context, "grow");
+        llvm::BasicBlock *probeBB = llvm::BasicBlock::Create(context, "probe");
+        llvm::BasicBlock *loophead = llvm::BasicBlock::Create(context, "probe.head");
+        llvm::BasicBlock *checkBB = llvm::BasicBlock::Create(context, "probe.check");
+        llvm::BasicBlock *missBB = llvm::BasicBlock::Create(context, "probe.miss");
+        llvm::BasicBlock *nextBB = llvm::BasicBlock::Create(context, "probe.next");
+        llvm::BasicBlock *foundBB = llvm::BasicBlock::Create(context, "found");
+        llvm::BasicBlock *emptyBB = llvm::BasicBlock::Create(context, "empty");
+        // At most 3/4 of the slots are filled, so that the probe sequences
+        // are short and always end with an empty slot
+        llvm::Value *n = len(table);
+        llvm::Value *capacity = LLVM::CreateLoad(*builder,
+            get_pointer_to_capacity(table));
+        llvm::Value *filled = LLVM::CreateLoad(*builder,
+            get_pointer_to_filled(table));
+        llvm::Value *needs_rehash = builder->CreateICmpUGT(
+            builder->CreateMul(builder->CreateZExt(builder->CreateAdd(filled, one),
+                i64), llvm::ConstantInt::get(i64, 4)),
+            builder->CreateMul(builder->CreateZExt(capacity, i64),
+                llvm::ConstantInt::get(i64, 3)));
+        llvm::MDBuilder md(context);
+        builder->CreateCondBr(needs_rehash, growBB, probeBB,
+            md.createBranchWeights(1, 1000));
+        list_api->start_new_block(growBB);
+        // The capacity is doubled, unless the table is mostly deleted slots
+        llvm::Value *doubled = builder->CreateMul(capacity, llvm::ConstantInt::get(i32, 2));
+        doubled = builder->CreateSelect(builder->CreateICmpULT(doubled,
+            llvm::ConstantInt::get(i32, 8)), llvm::ConstantInt::get(i32, 8), doubled);
+        llvm::Value *new_capacity = builder->CreateSelect(builder->CreateICmpUGT(
+            builder->CreateMul(builder->CreateAdd(n, one), llvm::ConstantInt::get(i32, 2)),
+            capacity), doubled, capacity);
+        builder->CreateCall(rehash_fn, {table, new_capacity});
+        list_api->start_new_block(probeBB);
+        capacity = LLVM::CreateLoad(*builder, get_pointer_to_capacity(table));
+        llvm::Value *h = hash(key, module);
+        llvm::Value *h2 = get_h2(h);
+        llvm::Value *mask = builder->CreateSub(capacity, one);
+        llvm::Value *ctrl = LLVM::CreateLoad(*builder, get_pointer_to_ctrl(table));
+        llvm::Value *keys = LLVM::CreateLoad(*builder, get_pointer_to_keys(table));
+        builder->CreateStore(get_h1(h, mask), pidx);
+        builder->CreateStore(llvm::ConstantInt::get(i32, -1, true), pdeleted);
+        list_api->start_new_block(loophead);
+        llvm::Value *idx = LLVM::CreateLoad(*builder, pidx);
+        llvm::Value *c = LLVM::CreateLoad(*builder,
+            llvm_utils->create_ptr_gep(ctrl, idx));
+        builder->CreateCondBr(builder->CreateICmpEQ(c, h2), checkBB, missBB);
+        list_api->start_new_block(checkBB);
+        llvm::Value *is_equal = list_api->is_equal_by_value(LLVM::CreateLoad(
+            *builder, llvm_utils->create_ptr_gep(keys, idx)), key, module);
+        builder->CreateCondBr(is_equal, foundBB, missBB);
+        list_api->start_new_block(missBB);
+        builder->CreateCondBr(builder->CreateICmpEQ(c,
+            llvm::ConstantInt::get(i8, ctrl_empty, true)), emptyBB, nextBB);
+        list_api->start_new_block(nextBB);
+        // The first deleted slot of the probe sequence is reused
+        llvm::Value *deleted = LLVM::CreateLoad(*builder, pdeleted);
+        llvm::Value *is_first_deleted = builder->CreateAnd(builder->CreateICmpEQ(c,
+            llvm::ConstantInt::get(i8, ctrl_deleted, true)),
+            builder->CreateICmpSLT(deleted, zero));
+        builder->CreateStore(builder->CreateSelect(is_first_deleted, idx, deleted),
+            pdeleted);
+        builder->CreateStore(builder->CreateAnd(builder->CreateAdd(idx, one), mask),
+            pidx);
+        builder->CreateBr(loophead);
+        list_api->start_new_block(foundBB);
+        builder->CreateRet(idx);
+        list_api->start_new_block(emptyBB);
+        deleted = LLVM::CreateLoad(*builder, pdeleted);
+        llvm::Value *reuse = builder->CreateICmpSGE(deleted, zero);
+        llvm::Value *slot = builder->CreateSelect(reuse, deleted, idx);
+        llvm::Value *pfilled = get_pointer_to_filled(table);
+        builder->CreateStore(builder->CreateAdd(LLVM::CreateLoad(*builder, pfilled),
+            builder->CreateSelect(reuse, zero, one)), pfilled);
+        builder->CreateStore(builder->CreateAdd(len(table), one),
+            get_pointer_to_len(table));
+        builder->CreateStore(h2, llvm_utils->create_ptr_gep(ctrl, slot));
+        builder->CreateStore(key, llvm_utils->create_ptr_gep(keys, slot));
+        builder->CreateRet(slot);
+        return fn;
+    }
+
+    llvm::Function* LLVMDict::get_rehash_function(llvm::Type* table_type,
+        llvm::Module& module) {
+        llvm::IRBuilderBase::InsertPointGuard guard(*builder);
+        llvm::Type *i32 = llvm::Type::getInt32Ty(context);
+        llvm::Type *i8 = llvm::Type::getInt8Ty(context);
+        bool defined;
+        llvm::Function *fn = create_function("rehash", table_type,
+            llvm::Type::getVoidTy(context), {i32}, module, defined);
+        if (defined) return fn;
+        llvm::Value *table = fn->getArg(0);
+        llvm::Value *new_capacity = fn->getArg(1);
+        bool values = has_values(table);
+        llvm::Value *empty = llvm::ConstantInt::get(i8, ctrl_empty, true);
+        llvm::Value *one = llvm::ConstantInt::get(i32, 1);
+        llvm::Value *pidx = list_api->create_alloca(i32);
+        llvm::Value *capacity = LLVM::CreateLoad(*builder,
+            get_pointer_to_capacity(table));
+        llvm::Value *ctrl = LLVM::CreateLoad(*builder, get_pointer_to_ctrl(table));
+        llvm::Value *keys = LLVM::CreateLoad(*builder, get_pointer_to_keys(table));
+        llvm::Value *vals = values ? LLVM::CreateLoad(*builder,
+            get_pointer_to_values(table)) : nullptr;
+        llvm::Value *new_ctrl = allocate(i8, new_capacity, module);
+        builder->CreateMemSet(new_ctrl, empty, builder->CreateZExt(new_capacity,
+            llvm::Type::getInt64Ty(context)), llvm::MaybeAlign());
+        llvm::Value *new_keys = allocate(keys->getType()->getContainedType(0),
+            new_capacity, module);
+        llvm::Value *new_vals = values ? allocate(
+            vals->getType()->getContainedType(0), new_capacity, module) : nullptr;
+        llvm::Value *mask = builder->CreateSub(new_capacity, one);
+        list_api->create_loop(capacity, [&](llvm::Value *i) {
+            llvm::BasicBlock *moveBB = llvm::BasicBlock::Create(context, "rehash.move");
+            llvm::BasicBlock *loophead = llvm::BasicBlock::Create(context, "rehash.probe");
+            llvm::BasicBlock *nextBB = llvm::BasicBlock::Create(context, "rehash.next");
+            llvm::BasicBlock *placeBB = llvm::BasicBlock::Create(context, "rehash.place");
+            llvm::BasicBlock *skipBB = llvm::BasicBlock::Create(context, "rehash.skip");
+            llvm::Value *c = LLVM::CreateLoad(*builder,
+                llvm_utils->create_ptr_gep(ctrl, i));
+            builder->CreateCondBr(builder->CreateICmpSGE(c,
+                llvm::ConstantInt::get(i8, 0)), moveBB, skipBB);
+            list_api->start_new_block(moveBB);
+            // The keys are distinct, so the first empty slot is taken
+            llvm::Value *key = LLVM::CreateLoad(*builder,
+                llvm_utils->create_ptr_gep(keys, i));
+            builder->CreateStore(get_h1(hash(key, module), mask), pidx);
+            list_api->start_new_block(loophead);
+            llvm::Value *idx = LLVM::CreateLoad(*builder, pidx);
+            builder->CreateCondBr(builder->CreateICmpEQ(LLVM::CreateLoad(*builder,
+                llvm_utils->create_ptr_gep(new_ctrl, idx)), empty), placeBB, nextBB);
+            list_api->start_new_block(nextBB);
+            builder->CreateStore(builder->CreateAnd(builder->CreateAdd(idx, one),
+                mask), pidx);
+            builder->CreateBr(loophead);
+            list_api->start_new_block(placeBB);
+            builder->CreateStore(c, llvm_utils->create_ptr_gep(new_ctrl, idx));
+            builder->CreateStore(key, llvm_utils->create_ptr_gep(new_keys, idx));
+            if (values) {
+                builder->CreateStore(LLVM::CreateLoad(*builder,
+                    llvm_utils->create_ptr_gep(vals, i)),
+                    llvm_utils->create_ptr_gep(new_vals, idx));
+            }
+            list_api->start_new_block(skipBB);
+        });
+        free_data(table, module);
+        builder->CreateStore(new_ctrl, get_pointer_to_ctrl(table));
+        builder->CreateStore(new_keys, get_pointer_to_keys(table));
+        if (values) builder->CreateStore(new_vals, get_pointer_to_values(table));
+        builder->CreateStore(new_capacity, get_pointer_to_capacity(table));
+        builder->CreateStore(len(table), get_pointer_to_filled(table));
+        builder->CreateRetVoid();
+        return fn;
+    }
+
+    void LLVMDict::reserve(llvm::Value* table, size_t n, llvm::Module& module) {
+        size_t capacity = 8;
+        while (4*n > 3*capacity) capacity *= 2;
+        builder->CreateCall(get_rehash_function(
+            table->getType()->getContainedType(0), module), {table,
+            llvm::ConstantInt::get(context, llvm::APInt(32, capacity))});
+    }
+
+    llvm::Value* LLVMDict::find(llvm::Value* table, llvm::Value* key,
+        llvm::Module& module) {
+        return builder->CreateCall(get_find_function(
+            table->getType()->getContainedType(0), module), {table, key});
+    }
+
+    llvm::Value* LLVMDict::contains(llvm::Value* table, llvm::Value* key,
+        llvm::Module& module) {
+        return builder->CreateICmpSGE(find(table, key, module),
+            llvm::ConstantInt::get(context, llvm::APInt(32, 0)));
+    }
+
+    llvm::Value* LLVMDict::insert(llvm::Value* table, llvm::Value* key,
+        llvm::Module& module) {
+        return builder->CreateCall(get_insert_function(
+            table->getType()->getContainedType(0), module), {table, key});
+    }
+
+    llvm::Value* LLVMDict::read_key(llvm::Value* table, llvm::Value* slot,
+        bool get_pointer) {
+        llvm::Value *keys = LLVM::CreateLoad(*builder, get_pointer_to_keys(table));
+        llvm::Value *key = llvm_utils->create_ptr_gep(keys, slot);
+        if (get_pointer) return key;
+        return LLVM::CreateLoad(*builder, key);
+    }
+
+    llvm::Value* LLVMDict::read_value(llvm::Value* table, llvm::Value* slot,
+        bool get_pointer) {
+        llvm::Value *values = LLVM::CreateLoad(*builder, get_pointer_to_values(table));
+        llvm::Value *value = llvm_utils->create_ptr_gep(values, slot);
+        if (get_pointer) return value;
+        return LLVM::CreateLoad(*builder, value);
+    }
+
+    void LLVMDict::write_item(llvm::Value* dict, llvm::Value* key,
+        llvm::Value* value, llvm::Module& module) {
+        llvm::Value *slot = insert(dict, key, module);
+        builder->CreateStore(value, read_value(dict, slot, true));
+    }
+
+    llvm::Value* LLVMDict::get_value_pointer(llvm::Value* dict, llvm::Value* key,
+        llvm::Module& module) {
+        llvm::Value *slot = find(dict, key, module);
+        llvm::BasicBlock *errorBB = llvm::BasicBlock::Create(context, "dict.item.error");
+        llvm::BasicBlock *contBB = llvm::BasicBlock::Create(context, "dict.item");
+        llvm::MDBuilder md(context);
+        builder->CreateCondBr(builder->CreateICmpSLT(slot,
+            llvm::ConstantInt::get(context, llvm::APInt(32, 0))), errorBB, contBB,
+            md.createBranchWeights(1, 1000));
+        list_api->start_new_block(errorBB);
+        list_api->raise_error(module, "KeyError: the key is not in the dict");
+        list_api->start_new_block(contBB);
+        return read_value(dict, slot, true);
+    }
+
+    llvm::Value* LLVMDict::get_value(llvm::Value* dict, llvm::Value* key,
+        llvm::Value* def, llvm::Module& module) {
+        if (!def) {
+            return LLVM::CreateLoad(*builder, get_value_pointer(dict, key, module));
+        }
+        llvm::Value *slot = find(dict, key, module);
+        llvm::Value *presult = list_api->create_alloca(def->getType());
+        builder->CreateStore(def, presult);
+        llvm::BasicBlock *foundBB = llvm::BasicBlock::Create(context, "dict.get.found");
+        llvm::BasicBlock *endBB = llvm::BasicBlock::Create(context, "dict.get.end");
+        builder->CreateCondBr(builder->CreateICmpSGE(slot,
+            llvm::ConstantInt::get(context, llvm::APInt(32, 0))), foundBB, endBB);
+        list_api->start_new_block(foundBB);
+        builder->CreateStore(read_value(dict, slot), presult);
+        list_api->start_new_block(endBB);
+        return LLVM::CreateLoad(*builder, presult);
+    }
+
+    void LLVMDict::erase(llvm::Value* table, llvm::Value* slot) {
+        // The slot becomes empty again if the next one is, as no probe
+        // sequence can continue past it
+        llvm::Type *i8 = llvm::Type::getInt8Ty(context);
+        llvm::Value *one = llvm::ConstantInt::get(context, llvm::APInt(32, 1));
+        llvm::Value *mask = builder->CreateSub(LLVM::CreateLoad(*builder,
+            get_pointer_to_capacity(table)), one);
+        llvm::Value *ctrl = LLVM::CreateLoad(*builder, get_pointer_to_ctrl(table));
+        llvm::Value *next = builder->CreateAnd(builder->CreateAdd(slot, one), mask);
+        llvm::Value *empty = llvm::ConstantInt::get(i8, ctrl_empty, true);
+        llvm::Value *next_is_empty = builder->CreateICmpEQ(LLVM::CreateLoad(
+            *builder, llvm_utils->create_ptr_gep(ctrl, next)), empty);
+        builder->CreateStore(builder->CreateSelect(next_is_empty, empty,
+            llvm::ConstantInt::get(i8, ctrl_deleted, true)),
+            llvm_utils->create_ptr_gep(ctrl, slot));
+        llvm::Value *pfilled = get_pointer_to_filled(table);
+        builder->CreateStore(builder->CreateSub(LLVM::CreateLoad(*builder, pfilled),
+            builder->CreateZExt(next_is_empty, slot->getType())), pfilled);
+        builder->CreateStore(builder->CreateSub(len(table), one),
+            get_pointer_to_len(table));
+    }
+
+    llvm::Value* LLVMDict::remove(llvm::Value* table, llvm::Value* key,
+        llvm::Module& module) {
+        llvm::Value *slot = find(table, key, module);
+        llvm::BasicBlock *errorBB = llvm::BasicBlock::Create(context, "dict.remove.error");
+        llvm::BasicBlock *contBB = llvm::BasicBlock::Create(context, "dict.remove");
+        llvm::MDBuilder md(context);
+        builder->CreateCondBr(builder->CreateICmpSLT(slot,
+            llvm::ConstantInt::get(context, llvm::APInt(32, 0))), errorBB, contBB,
+            md.createBranchWeights(1, 1000));
+        list_api->start_new_block(errorBB);
+        list_api->raise_error(module, has_values(table) ?
+            "KeyError: the key is not in the dict" :
+            "KeyError: the element is not in the set");
+        list_api->start_new_block(contBB);
+        erase(table, slot);
+        return slot;
+    }
+
+    llvm::Value* LLVMDict::pop(llvm::Value* dict, llvm::Value* key,
+        llvm::Module& module) {
+        llvm::Value *slot = remove(dict, key, module);
+        return read_value(dict, slot);
+    }
+
+    llvm::Value* LLVMDict::set_pop(llvm::Value* set, llvm::Module& module) {
+        llvm::Type *i32 = llvm::Type::getInt32Ty(context);
+        llvm::Value *pidx = list_api->create_alloca(i32);
+        llvm::BasicBlock *errorBB = llvm::BasicBlock::Create(context, "set.pop.error");
+        llvm::BasicBlock *loophead = llvm::BasicBlock::Create(context, "set.pop.head");
+        llvm::BasicBlock *nextBB = llvm::BasicBlock::Create(context, "set.pop.next");
+        llvm::BasicBlock *foundBB = llvm::BasicBlock::Create(context, "set.pop.found");
+        llvm::MDBuilder md(context);
+        builder->CreateStore(llvm::ConstantInt::get(i32, 0), pidx);
+        builder->CreateCondBr(builder->CreateICmpEQ(len(set),
+            llvm::ConstantInt::get(i32, 0)), errorBB, loophead,
+            md.createBranchWeights(1, 1000));
+        list_api->start_new_block(errorBB);
+        list_api->raise_error(module, "KeyError: 'pop from an empty set'");
+        list_api->start_new_block(loophead);
+        llvm::Value *ctrl = LLVM::CreateLoad(*builder, get_pointer_to_ctrl(set));
+        llvm::Value *idx = LLVM::CreateLoad(*builder, pidx);
+        builder->CreateCondBr(builder->CreateICmpSGE(LLVM::CreateLoad(*builder,
+            llvm_utils->create_ptr_gep(ctrl, idx)),
+            llvm::ConstantInt::get(context, llvm::APInt(8, 0))), foundBB, nextBB);
+        list_api->start_new_block(nextBB);
+        builder->CreateStore(builder->CreateAdd(idx, llvm::ConstantInt::get(i32, 1)),
+            pidx);
+        builder->CreateBr(loophead);
+        list_api->start_new_block(foundBB);
+        llvm::Value *key = read_key(set, idx);
+        erase(set, idx);
+        return key;
+    }
+
+    void LLVMDict::for_each(llvm::Value* table,
+        std::function<void(llvm::Value*)> body) {
+        llvm::Value *capacity = LLVM::CreateLoad(*builder,
+            get_pointer_to_capacity(table));
+        llvm::Value *ctrl = LLVM::CreateLoad(*builder, get_pointer_to_ctrl(table));
+        list_api->create_loop(capacity, [&](llvm::Value *i) {
+            llvm::BasicBlock *bodyBB = llvm::BasicBlock::Create(context, "dict.slot");
+            llvm::BasicBlock *skipBB = llvm::BasicBlock::Create(context, "dict.slot.end");
+            builder->CreateCondBr(builder->CreateICmpSGE(LLVM::CreateLoad(*builder,
+                llvm_utils->create_ptr_gep(ctrl, i)),
+                llvm::ConstantInt::get(context, llvm::APInt(8, 0))), bodyBB, skipBB);
+            list_api->start_new_block(bodyBB);
+            body(i);
+            list_api->start_new_block(skipBB);
+        });
+    }
+
+    void LLVMDict::dict_deepcopy(llvm::Value* src, llvm::Value* dest,
+        llvm::Module& module) {
+        llvm::Value *capacity = LLVM::CreateLoad(*builder,
+            get_pointer_to_capacity(src));
+        builder->CreateStore(LLVM::CreateLoad(*builder, src), dest);
+        auto copy_buffer = [&](llvm::Value *ptr) {
+            llvm::Value *data = LLVM::CreateLoad(*builder, ptr);
+            llvm::Type *el_type = data->getType()->getContainedType(0);
+            llvm::Value *copy = allocate(el_type, capacity, module);
+            llvm::Value *n_bytes = builder->CreateMul(builder->CreateZExt(capacity,
+                llvm::Type::getInt64Ty(context)), list_api->get_el_size(el_type));
+            builder->CreateMemCpy(copy, llvm::MaybeAlign(), data,
+                llvm::MaybeAlign(), n_bytes);
+            return copy;
+        };
+        builder->CreateStore(copy_buffer(get_pointer_to_ctrl(src)),
+            get_pointer_to_ctrl(dest));
+        builder->CreateStore(copy_buffer(get_pointer_to_keys(src)),
+            get_pointer_to_keys(dest));
+        if (has_values(src)) {
+            builder->CreateStore(copy_buffer(get_pointer_to_values(src)),
+                get_pointer_to_values(dest));
+            llvm::Type *value_type = src->getType()->getContainedType(0)
+                ->getStructElementType(5)->getContainedType(0);
+            if (list_api->is_container(value_type)) {
+                for_each(src, [&](llvm::Value *slot) {
+                    list_api->deepcopy(read_value(src, slot, true),
+                        read_value(dest, slot, true), module);
+                });
+            }
+        }
+    }
+
+    void LLVMDict::free_data(llvm::Value* table, llvm::Module& module) {
+        llvm::Type *i8_ptr = llvm::Type::getInt8PtrTy(context);
+        llvm::Function *fn = list_api->get_runtime_function(module,
+            "_lfortran_free", llvm::FunctionType::get(
+            llvm::Type::getVoidTy(context), {i8_ptr}, true));
+        std::vector<llvm::Value*> buffers = {get_pointer_to_ctrl(table),
+            get_pointer_to_keys(table)};
+        if (has_values(table)) buffers.push_back(get_pointer_to_values(table));
+        for (auto &ptr: buffers) {
+            builder->CreateCall(fn, {builder->CreateBitCast(
+                LLVM::CreateLoad(*builder, ptr), i8_ptr)});
+        }
+    }
+
+    void LLVMDict::dict_deepfree(llvm::Value* table, llvm::Module& module) {
+        if (has_values(table)) {
+            llvm::Type *value_type = table->getType()->getContainedType(0)
+                ->getStructElementType(5)->getContainedType(0);
+            if (list_api->is_container(value_type)) {
+                for_each(table, [&](llvm::Value *slot) {
+                    list_api->deepfree(read_value(table, slot, true), module);
+                });
+            }
+        }
+        free_data(table, module);
+    }
+
 } // LFortran
@@ -1,10 +1,14 @@
 #ifndef LFORTRAN_LLVM_UTILS_H
 #define LFORTRAN_LLVM_UTILS_H
 
+#include <functional>
+#include <map>
 #include <memory>
+#include <string>
 
 #include <llvm/IR/Value.h>
 #include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/Module.h>
 
 namespace LFortran {
 
@@ -37,6 +41,298 @@ namespace LFortran {
 
     }; // LLVMUtils
 
+    class LLVMDict;
+
+    /*
+        A list is the descriptor `{i32 len, i32 capacity, T* data}`, the
+        elements are stored in a buffer from `_lfortran_realloc` that grows
+        geometrically. All the operations are emitted inline, they take a
+        pointer to the descriptor. Elements that are lists themselves are
+        owned by the outer list and copied by `list_deepcopy`.
+    */
+    class LLVMList {
+
+        private:
+
+            llvm::LLVMContext& context;
+            LLVMUtils* llvm_utils;
+            llvm::IRBuilder<>* builder;
+            LLVMDict* dict_api;
+
+            std::map<std::string, llvm::StructType*> typecode2listtype;
+
+            llvm::Type* get_el_type(llvm::Value* list);
+
+            // Moves `n` elements within the data buffer of `list` from `src`
+            // to `dest`, the ranges may overlap
+            void move_items(llvm::Value* list, llvm::Value* src,
+                llvm::Value* dest, llvm::Value* n);
+
+            // Copies `n` elements of `src` starting at `src_pos` into the
+            // uninitialized elements of `dest` starting at `dest_pos`
+            void copy_items(llvm::Value* src, llvm::Value* src_pos,
+                llvm::Value* dest, llvm::Value* dest_pos, llvm::Value* n,
+                llvm::Module& module);
+
+        public:
+
+            LLVMList(llvm::LLVMContext& context, LLVMUtils* llvm_utils,
+                llvm::IRBuilder<>* builder);
+
+            void set_dict_api(LLVMDict* dict_api);
+
+            llvm::Function* get_runtime_function(llvm::Module& module,
+                const std::string& name, llvm::FunctionType* type);
+
+            llvm::Value* realloc(llvm::Module& module, llvm::Value* ptr,
+                llvm::Value* n_bytes);
+
+            llvm::Value* get_el_size(llvm::Type* el_type);
+
+            void raise_error(llvm::Module& module, const std::string& msg);
+
+            void start_new_block(llvm::BasicBlock* bb);
+
+            // Emits `for (i = 0; i < n; i++) body(i)`
+            void create_loop(llvm::Value* n,
+                std::function<void(llvm::Value*)> body);
+
+            llvm::StructType* get_list_type(llvm::Type* el_type,
+                const std::string& type_code);
+
+            bool is_list(llvm::Type* type);
+
+            // Lists, dicts and sets own their buffers
+            bool is_container(llvm::Type* type);
+
+            // Allocates `type` in the entry block of the current function
+            llvm::Value* create_alloca(llvm::Type* type);
+
+            llvm::Value* get_pointer_to_len(llvm::Value* list);
+
+            llvm::Value* get_pointer_to_capacity(llvm::Value* list);
+
+            llvm::Value* get_pointer_to_data(llvm::Value* list);
+
+            // Sets `list` to an empty list with room for `capacity` elements
+            void list_init(llvm::Value* list, llvm::Module& module,
+                llvm::Value* capacity=nullptr);
+
+            llvm::Value* len(llvm::Value* list);
+
+            // Returns `pos + len` for a negative `pos`, Python style
+            llvm::Value* normalize_index(llvm::Value* list, llvm::Value* pos);
+
+            // Raises `msg` if the normalized `pos` is not in [0, len)
+            void check_index(llvm::Value* list, llvm::Value* pos,
+                llvm::Module& module, const std::string& msg);
+
+            llvm::Value* read_item(llvm::Value* list, llvm::Value* pos,
+                bool get_pointer=false);
+
+            void write_item(llvm::Value* list, llvm::Value* pos,
+                llvm::Value* item);
+
+            // Grows the buffer to hold at least `n` elements, at least
+            // doubling the capacity
+            void reserve(llvm::Value* list, llvm::Value* n,
+                llvm::Module& module);
+
+            void append(llvm::Value* list, llvm::Value* item,
+                llvm::Module& module);
+
+            void insert(llvm::Value* list, llvm::Value* pos,
+                llvm::Value* item, llvm::Module& module);
+
+            void remove(llvm::Value* list, llvm::Value* item,
+                llvm::Module& module);
+
+            // Removes and returns the item at `pos`, the last one if `pos`
+            // is `nullptr`
+            llvm::Value* pop(llvm::Value* list, llvm::Value* pos,
+                llvm::Module& module);
+
+            // Copies `src` into the uninitialized `dest`
+            void list_deepcopy(llvm::Value* src, llvm::Value* dest,
+                llvm::Module& module);
+
+            // Copies the list, dict or set `src` into the uninitialized `dest`
+            void deepcopy(llvm::Value* src, llvm::Value* dest,
+                llvm::Module& module);
+
+            void concat(llvm::Value* left, llvm::Value* right,
+                llvm::Value* result, llvm::Module& module);
+
+            // `list[start:end:step]`, the bounds may be `nullptr`
+            void section(llvm::Value* list, llvm::Value* start,
+                llvm::Value* end, llvm::Value* step, llvm::Value* result,
+                llvm::Module& module);
+
+            // Frees the buffer of `list`, but not the buffers of the elements
+            void free_data(llvm::Value* list, llvm::Module& module);
+
+            // Frees the buffers of the list, dict or set `container` and of
+            // the containers in it
+            void deepfree(llvm::Value* container, llvm::Module& module);
+
+            llvm::Value* is_equal_by_value(llvm::Value* left,
+                llvm::Value* right, llvm::Module& module);
+
+    }; // LLVMList
+
+    /*
+        Dicts and sets are open addressing hash tables with linear probing,
+        the descriptor is `{i32 len, i32 capacity, i32 filled, i8* ctrl,
+        K* keys, V* values}`, a set has no `values`. The capacity is a power
+        of two. As in SwissTable, each slot has a control byte that is
+        `EMPTY`, `DELETED` or the low 7 bits of the hash of its key, so most
+        probes are rejected without comparing keys; `filled` counts the
+        slots that are not `EMPTY`. Keys and values are stored inline. The
+        probing and the rehashing are done by internal functions generated
+        once per table type, the other operations are emitted inline.
+    */
+    class LLVMDict {
+
+        private:
+
+            llvm::LLVMContext& context;
+            LLVMUtils* llvm_utils;
+            llvm::IRBuilder<>* builder;
+            LLVMList* list_api;
+
+            std::map<std::string, llvm::StructType*> typecode2tabletype;
+
+            llvm::Type* get_key_type(llvm::Type* table_type);
+
+            llvm::Value* get_pointer_to_filled(llvm::Value* table);
+
+            llvm::Value* get_pointer_to_ctrl(llvm::Value* table);
+
+            llvm::Value* get_pointer_to_keys(llvm::Value* table);
+
+            // The 64 bit hash of `key`, as in the finalizer of MurmurHash3
+            llvm::Value* hash(llvm::Value* key, llvm::Module& module);
+
+            llvm::Value* mix(llvm::Value* h);
+
+            // The control byte of `hash` and the slot where its probe
+            // sequence starts
+            llvm::Value* get_h2(llvm::Value* hash);
+
+            llvm::Value* get_h1(llvm::Value* hash, llvm::Value* mask);
+
+            // Starts the body of the function `name` of `table_type`,
+            // returns it if it is already defined
+            llvm::Function* create_function(const std::string& name,
+                llvm::Type* table_type, llvm::Type* return_type,
+                std::vector<llvm::Type*> arg_types, llvm::Module& module,
+                bool& defined);
+
+            // `i32 find(table*, key)`, the slot of `key` or -1
+            llvm::Function* get_find_function(llvm::Type* table_type,
+                llvm::Module& module);
+
+            // `i32 insert(table*, key)`, the slot of `key`, which is added
+            // if it is missing
+            llvm::Function* get_insert_function(llvm::Type* table_type,
+                llvm::Module& module);
+
+            // `void rehash(table*, i32 capacity)`
+            llvm::Function* get_rehash_function(llvm::Type* table_type,
+                llvm::Module& module);
+
+            // Marks `slot` as deleted
+            void erase(llvm::Value* table, llvm::Value* slot);
+
+            llvm::Value* allocate(llvm::Type* el_type, llvm::Value* n,
+                llvm::Module& module);
+
+        public:
+
+            LLVMDict(llvm::LLVMContext& context, LLVMUtils* llvm_utils,
+                llvm::IRBuilder<>* builder, LLVMList* list_api);
+
+            llvm::StructType* get_dict_type(llvm::Type* key_type,
+                llvm::Type* value_type, const std::string& type_code);
+
+            llvm::StructType* get_set_type(llvm::Type* el_type,
+                const std::string& type_code);
+
+            // Dicts and sets
+            bool is_dict(llvm::Type* type);
+
+            bool has_values(llvm::Value* table);
+
+            llvm::Value* get_pointer_to_len(llvm::Value* table);
+
+            llvm::Value* get_pointer_to_capacity(llvm::Value* table);
+
+            llvm::Value* get_pointer_to_values(llvm::Value* table);
+
+            // Sets `table` to an empty table, nothing is allocated
+            void dict_init(llvm::Value* table);
+
+            // Rehashes so that `n` keys fit without growing
+            void reserve(llvm::Value* table, size_t n, llvm::Module& module);
+
+            llvm::Value* len(llvm::Value* table);
+
+            llvm::Value* find(llvm::Value* table, llvm::Value* key,
+                llvm::Module& module);
+
+            llvm::Value* contains(llvm::Value* table, llvm::Value* key,
+                llvm::Module& module);
+
+            // Adds `key` if it is missing and returns its slot, the value
+            // is written by the caller
+            llvm::Value* insert(llvm::Value* table, llvm::Value* key,
+                llvm::Module& module);
+
+            llvm::Value* read_key(llvm::Value* table, llvm::Value* slot,
+                bool get_pointer=false);
+
+            llvm::Value* read_value(llvm::Value* table, llvm::Value* slot,
+                bool get_pointer=false);
+
+            void write_item(llvm::Value* dict, llvm::Value* key,
+                llvm::Value* value, llvm::Module& module);
+
+            // A pointer to the value of `key`, raises `KeyError` if it is
+            // missing
+            llvm::Value* get_value_pointer(llvm::Value* dict, llvm::Value* key,
+                llvm::Module& module);
+
+            // The value of `key`, or `def` if it is missing
+            llvm::Value* get_value(llvm::Value* dict, llvm::Value* key,
+                llvm::Value* def, llvm::Module& module);
+
+            // Removes `key` and returns its slot, raises `KeyError` if it
+            // is missing; the slot can be read until the next insertion
+            llvm::Value* remove(llvm::Value* table, llvm::Value* key,
+                llvm::Module& module);
+
+            llvm::Value* pop(llvm::Value* dict, llvm::Value* key,
+                llvm::Module& module);
+
+            // Removes and returns an arbitrary element of a set
+            llvm::Value* set_pop(llvm::Value* set, llvm::Module& module);
+
+            // Emits `body(slot)` for each slot that holds a key
+            void for_each(llvm::Value* table,
+                std::function<void(llvm::Value*)> body);
+
+            // Copies `src` into the uninitialized `dest`
+            void dict_deepcopy(llvm::Value* src, llvm::Value* dest,
+                llvm::Module& module);
+
+            // Frees the buffers of `table`, but not those of the values
+            void free_data(llvm::Value* table, llvm::Module& module);
+
+            // Frees the buffers of `table` and of the containers in it
+            void dict_deepfree(llvm::Value* table, llvm::Module& module);
+
+    }; // LLVMDict
+
 } // LFortran
 
 #endif // LFORTRAN_LLVM_UTILS_H
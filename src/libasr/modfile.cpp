@@ -24,7 +24,8 @@ const std::string lfortran_modfile_type_string = "LFortran Modfile";
 
     Comments below show some possible future improvements to the mod format.
 */
-std::string save_modfile(const ASR::TranslationUnit_t &m) {
+std::string save_modfile(const ASR::TranslationUnit_t &m,
+        const std::string &source) {
     LFORTRAN_ASSERT(m.m_global_scope->get_scope().size()== 1);
     for (auto &a : m.m_global_scope->get_scope()) {
         LFORTRAN_ASSERT(ASR::is_a<ASR::Module_t>(*a.second));
@@ -40,11 +41,11 @@ std::string save_modfile(const ASR::TranslationUnit_t &m) {
     b.write_string(LFORTRAN_VERSION);
 
     // AST section: Original module source code:
-    // Currently empty.
+    // Used to check if the modfile is up to date with the source.
     // Note: in the future we can save here:
     // * A path to the original source code
-    // * Hash of the orig source code
-    // * AST binary export of it (this AST only changes if the hash changes)
+    // * AST binary export of it (this AST only changes if the source changes)
+    b.write_string(source);
 
     // ASR section:
 
@@ -72,6 +73,7 @@ ASR::TranslationUnit_t* load_modfile(Allocator &al, const std::string &s,
     if (version != LFORTRAN_VERSION) {
         throw LFortranException("Incompatible format: LFortran Modfile was generated using version '" + version + "', but current LFortran version is '" + LFORTRAN_VERSION + "'");
     }
+    b.read_string(); // Source code
     std::string asr_binary = b.read_string();
     ASR::asr_t *asr = deserialize_asr(al, asr_binary, load_symtab_id, symtab);
 
@@ -79,4 +81,19 @@ ASR::TranslationUnit_t* load_modfile(Allocator &al, const std::string &s,
     return tu;
 }
 
+std::string modfile_source(const std::string &s) {
+#ifdef WITH_LFORTRAN_BINARY_MODFILES
+    BinaryReader b(s);
+#else
+    TextReader b(s);
+#endif
+    std::string file_type = b.read_string();
+    if (file_type != lfortran_modfile_type_string) {
+        throw LFortranException("LFortran Modfile format not recognized");
+    }
+    std::string version = b.read_string();
+    if (version != LFORTRAN_VERSION) return "";
+    return b.read_string();
+}
+
 } // namespace LFortran
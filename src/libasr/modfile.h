@@ -5,8 +5,14 @@
 
 namespace LFortran {
 
-    // Save a module to a modfile
-    std::string save_modfile(const ASR::TranslationUnit_t &m);
+    // Save a module to a modfile. The optional `source` is the source code
+    // the module was compiled from, it is stored so that the loader can detect
+    // a stale modfile.
+    std::string save_modfile(const ASR::TranslationUnit_t &m,
+        const std::string &source="");
+
+    // Returns the source code stored in the modfile (empty if none)
+    std::string modfile_source(const std::string &s);
 
     // Load a module from a modfile
     ASR::TranslationUnit_t* load_modfile(Allocator &al, const std::string &s,
@@ -16,18 +16,30 @@ using ASR::down_cast;
 using ASR::is_a;
 
 /*
-This ASR pass replaces array slice with do loops and array expression assignments.
+This ASR pass replaces array sections in expressions with views of them.
 The function `pass_replace_arr_slice` transforms the ASR tree in-place.
 
 Converts:
 
-    x = y(1:3)
+    x = f(y(2:n:2)) + y(1:3)
 
 to:
 
-    do i = 1, 3
-        x(i) = y(i)
-    end do
+    ~0_slice => y(2:n:2)
+    ~1_slice => y(1:3)
+    x = f(~0_slice) + ~1_slice
+
+A view shares the elements of the array, the backend only fills its
+descriptor with the offset, strides and extents of the section, so that
+creating it takes the same time for any size of the section. The elements
+are copied only when the assignment writes to the array of the section,
+the elements that are written could overlap the ones that are read:
+
+    ~0_slice => y(1:3)
+    allocate(~1_slice(size(~0_slice)))
+    ~1_slice = ~0_slice
+    y(2:4) = ~1_slice
+    deallocate(~1_slice)
 */
 
 class ArrSliceVisitor : public PassUtils::PassVisitor<ArrSliceVisitor>
@@ -35,231 +47,217 @@ class ArrSliceVisitor : public PassUtils::PassVisitor<ArrSliceVisitor>
 private:
     ASR::TranslationUnit_t &unit;
 
-    ASR::expr_t* slice_var;
     bool create_slice_var;
 
     int slice_counter;
 
     std::string rl_path;
 
+    // The array that the current assignment writes to and the copies of
+    // its sections to deallocate after the assignment
+    ASR::symbol_t* written_array;
+    Vec<ASR::symbol_t*> copies;
+
 public:
     ArrSliceVisitor(Allocator &al, ASR::TranslationUnit_t &unit_,
         const std::string &rl_path) : PassVisitor(al, nullptr), unit(unit_),
-    slice_var(nullptr), create_slice_var(false), slice_counter(0),
-    rl_path(rl_path)
+    create_slice_var(false), slice_counter(0), rl_path(rl_path),
+    written_array(nullptr)
     {
         pass_result.reserve(al, 1);
+        copies.reserve(al, 1);
     }
 
-    ASR::ttype_t* get_array_from_slice(const ASR::ArrayRef_t& x, ASR::expr_t* arr_var) {
+    // The type of a view of the section `x`, its shape is only known when
+    // the view is created
+    ASR::ttype_t* get_view_type(const ASR::ArrayRef_t& x) {
         Vec<ASR::dimension_t> m_dims;
         m_dims.reserve(al, x.n_args);
-        ASR::ttype_t* int32_type = LFortran::ASRUtils::TYPE(ASR::make_Integer_t(al, x.base.base.loc, 4, nullptr, 0));
-        ASR::expr_t* const_1 = LFortran::ASRUtils::EXPR(ASR::make_IntegerConstant_t(al, x.base.base.loc, 1, int32_type));
         for( size_t i = 0; i < x.n_args; i++ ) {
-            if( x.m_args[i].m_step != nullptr ) {
-                ASR::expr_t *start = nullptr, *end = nullptr, *step = nullptr;
-                if( x.m_args[i].m_left == nullptr ) {
-                    start = PassUtils::get_bound(arr_var, i + 1, "lbound",
-                                                al, unit, rl_path, current_scope);
-                } else {
-                    start = x.m_args[i].m_left;
-                }
-
-                if( x.m_args[i].m_right == nullptr ) {
-                    end = PassUtils::get_bound(arr_var, i + 1, "ubound",
-                                                al, unit, rl_path, current_scope);
-                } else {
-                    end = x.m_args[i].m_right;
-                }
-
-                if( x.m_args[i].m_step == nullptr ) {
-                    step = const_1;
-                } else {
-                    step = x.m_args[i].m_step;
-                }
-
-                start = PassUtils::to_int32(start, int32_type, al);
-                end = PassUtils::to_int32(end, int32_type, al);
-                step = PassUtils::to_int32(step, int32_type, al);
-
-                ASR::expr_t* gap = LFortran::ASRUtils::EXPR(ASR::make_BinOp_t(al, x.base.base.loc,
-                                                        end, ASR::binopType::Sub, start,
-                                                        int32_type, nullptr, nullptr));
-                // ASR::expr_t* slice_size = LFortran::ASRUtils::EXPR(ASR::make_BinOp_t(al, x.base.base.loc,
-                //                                                  gap, ASR::binopType::Add, const_1,
-                //                                                  int64_type, nullptr));
-                ASR::expr_t* slice_size = LFortran::ASRUtils::EXPR(ASR::make_BinOp_t(al, x.base.base.loc,
-                                                                gap, ASR::binopType::Div, step,
-                                                                int32_type, nullptr, nullptr));
-                ASR::expr_t* actual_size = LFortran::ASRUtils::EXPR(ASR::make_BinOp_t(al, x.base.base.loc,
-                                                                slice_size, ASR::binopType::Add, const_1,
-                                                                int32_type, nullptr, nullptr));
-                ASR::dimension_t curr_dim;
-                curr_dim.loc = x.base.base.loc;
-                curr_dim.m_start = const_1;
-                curr_dim.m_end = actual_size;
-                m_dims.push_back(al, curr_dim);
-            } else {
-                ASR::dimension_t curr_dim;
-                curr_dim.loc = x.base.base.loc;
-                curr_dim.m_start = const_1;
-                curr_dim.m_end = const_1;
-                m_dims.push_back(al, curr_dim);
-            }
+            ASR::dimension_t curr_dim;
+            curr_dim.loc = x.base.base.loc;
+            curr_dim.m_start = nullptr;
+            curr_dim.m_end = nullptr;
+            m_dims.push_back(al, curr_dim);
         }
+        ASR::dimension_t* dims = m_dims.p;
+        int n_dims = m_dims.size();
+        return PassUtils::set_dim_rank(ASRUtils::type_get_past_pointer(x.m_type),
+            dims, n_dims, true, &al);
+    }
+
+    ASR::symbol_t* create_slice_sym(const Location& loc, ASR::ttype_t* type) {
+        Str new_name_str;
+        new_name_str.from_str(al, "~" + std::to_string(slice_counter) + "_slice");
+        slice_counter += 1;
+        char* new_var_name = (char*)new_name_str.c_str(al);
+        ASR::asr_t* slice_asr = ASR::make_Variable_t(al, loc, current_scope, new_var_name,
+                                                    ASR::intentType::Local, nullptr, nullptr, ASR::storage_typeType::Allocatable,
+                                                    type, ASR::abiType::Source, ASR::accessType::Public,
+                                                    ASR::presenceType::Required, false);
+        ASR::symbol_t* slice_sym = ASR::down_cast<ASR::symbol_t>(slice_asr);
+        current_scope->add_symbol(std::string(new_var_name), slice_sym);
+        return slice_sym;
+    }
 
-        ASR::ttype_t* new_type = nullptr;
-        ASR::ttype_t* t2 = ASRUtils::type_get_past_pointer(x.m_type);
-        switch (t2->type)
-        {
-            case ASR::ttypeType::Integer: {
-                ASR::Integer_t* curr_type = down_cast<ASR::Integer_t>(t2);
-                new_type = ASRUtils::TYPE(ASR::make_Integer_t(al, x.base.base.loc, curr_type->m_kind,
-                                                    m_dims.p, m_dims.size()));
-                break;
-            }
-            case ASR::ttypeType::Real: {
-                ASR::Real_t* curr_type = down_cast<ASR::Real_t>(t2);
-                new_type = ASRUtils::TYPE(ASR::make_Real_t(al, x.base.base.loc, curr_type->m_kind,
-                                                    m_dims.p, m_dims.size()));
-                break;
-            }
-            case ASR::ttypeType::Complex: {
-                ASR::Complex_t* curr_type = down_cast<ASR::Complex_t>(t2);
-                new_type = ASRUtils::TYPE(ASR::make_Complex_t(al, x.base.base.loc, curr_type->m_kind,
-                                                    m_dims.p, m_dims.size()));
-                break;
-            }
-            case ASR::ttypeType::Logical: {
-                ASR::Logical_t* curr_type = down_cast<ASR::Logical_t>(t2);
-                new_type = ASRUtils::TYPE(ASR::make_Logical_t(al, x.base.base.loc, curr_type->m_kind,
-                                                    m_dims.p, m_dims.size()));
-                break;
-            }
-            case ASR::ttypeType::Derived: {
-                ASR::Derived_t* curr_type = down_cast<ASR::Derived_t>(t2);
-                new_type = ASRUtils::TYPE(ASR::make_Derived_t(al, x.base.base.loc, curr_type->m_derived_type,
-                                                    m_dims.p, m_dims.size()));
-                break;
-            }
-            default:
-                break;
+    // Returns a view of the section `x`, or a copy of it if the current
+    // assignment writes to its array
+    ASR::expr_t* replace_section(ASR::ArrayRef_t& x) {
+        const Location& loc = x.base.base.loc;
+        ASR::ttype_t* type = get_view_type(x);
+        ASR::expr_t* view = LFortran::ASRUtils::EXPR(ASR::make_Var_t(al, loc,
+            create_slice_sym(loc, type)));
+        pass_result.push_back(al, LFortran::ASRUtils::STMT(ASR::make_Associate_t(
+            al, loc, view, &x.base)));
+        if( ASRUtils::symbol_get_past_external(x.m_v) != written_array ) {
+            return view;
         }
-        if (ASR::is_a<ASR::Pointer_t>(*x.m_type)) {
-            new_type = ASRUtils::TYPE(ASR::make_Pointer_t(al, x.base.base.loc, new_type));
+        ASR::symbol_t* copy_sym = create_slice_sym(loc, type);
+        ASR::ttype_t* int32_type = LFortran::ASRUtils::TYPE(ASR::make_Integer_t(al, loc, 4, nullptr, 0));
+        ASR::expr_t* const_1 = LFortran::ASRUtils::EXPR(ASR::make_IntegerConstant_t(al, loc, 1, int32_type));
+        Vec<ASR::dimension_t> dims;
+        dims.reserve(al, x.n_args);
+        for( size_t i = 0; i < x.n_args; i++ ) {
+            ASR::dimension_t dim;
+            dim.loc = loc;
+            dim.m_start = const_1;
+            ASR::expr_t* i_expr = LFortran::ASRUtils::EXPR(ASR::make_IntegerConstant_t(
+                al, loc, i + 1, int32_type));
+            dim.m_end = LFortran::ASRUtils::EXPR(ASR::make_ArraySize_t(al, loc, view,
+                i_expr, int32_type, nullptr));
+            dims.push_back(al, dim);
         }
-
-        return new_type;
+        Vec<ASR::alloc_arg_t> alloc_args;
+        alloc_args.reserve(al, 1);
+        ASR::alloc_arg_t alloc_arg;
+        alloc_arg.m_a = copy_sym;
+        alloc_arg.m_dims = dims.p;
+        alloc_arg.n_dims = dims.size();
+        alloc_args.push_back(al, alloc_arg);
+        pass_result.push_back(al, LFortran::ASRUtils::STMT(ASR::make_Allocate_t(al, loc,
+            alloc_args.p, alloc_args.size(), nullptr, nullptr)));
+        ASR::expr_t* copy = LFortran::ASRUtils::EXPR(ASR::make_Var_t(al, loc, copy_sym));
+        pass_result.push_back(al, LFortran::ASRUtils::STMT(ASR::make_Assignment_t(al, loc,
+            copy, view, nullptr)));
+        copies.push_back(al, copy_sym);
+        return copy;
     }
 
-    void visit_ArrayRef(const ASR::ArrayRef_t& x) {
-        if( PassUtils::is_slice_present(x) && create_slice_var ) {
-            ASR::expr_t* x_arr_var = LFortran::ASRUtils::EXPR(ASR::make_Var_t(al, x.base.base.loc, x.m_v));
-            Str new_name_str;
-            new_name_str.from_str(al, "~" + std::to_string(slice_counter) + "_slice");
-            slice_counter += 1;
-            char* new_var_name = (char*)new_name_str.c_str(al);
-            ASR::asr_t* slice_asr = ASR::make_Variable_t(al, x.base.base.loc, current_scope, new_var_name,
-                                                        ASR::intentType::Local, nullptr, nullptr, ASR::storage_typeType::Default,
-                                                        get_array_from_slice(x, x_arr_var), ASR::abiType::Source, ASR::accessType::Public,
-                                                        ASR::presenceType::Required, false);
-            ASR::symbol_t* slice_sym = ASR::down_cast<ASR::symbol_t>(slice_asr);
-            current_scope->add_symbol(std::string(new_var_name), slice_sym);
-            slice_var = LFortran::ASRUtils::EXPR(ASR::make_Var_t(al, x.base.base.loc, slice_sym));
-            Vec<ASR::expr_t*> idx_vars_target, idx_vars_value;
-            PassUtils::create_idx_vars(idx_vars_target, x.n_args, x.base.base.loc, al, current_scope, "_t");
-            PassUtils::create_idx_vars(idx_vars_value, x.n_args, x.base.base.loc, al, current_scope, "_v");
-            ASR::stmt_t* doloop = nullptr;
-            ASR::ttype_t* int32_type = LFortran::ASRUtils::TYPE(ASR::make_Integer_t(al, x.base.base.loc, 4, nullptr, 0));
-            ASR::expr_t* const_1 = LFortran::ASRUtils::EXPR(ASR::make_IntegerConstant_t(al, x.base.base.loc, 1, int32_type));
-            for( int i = (int)x.n_args - 1; i >= 0; i-- ) {
-                ASR::do_loop_head_t head;
-                head.m_v = idx_vars_value[i];
-                if( x.m_args[i].m_step != nullptr ) {
-                    if( x.m_args[i].m_left == nullptr ) {
-                        head.m_start = PassUtils::get_bound(x_arr_var, i + 1, "lbound", al, unit, rl_path, current_scope);
-                    } else {
-                        head.m_start = x.m_args[i].m_left;
-                    }
-                    if( x.m_args[i].m_right == nullptr ) {
-                        head.m_end = PassUtils::get_bound(x_arr_var, i + 1, "ubound", al, unit, rl_path, current_scope);
-                    } else {
-                        head.m_end = x.m_args[i].m_right;
-                    }
-                } else {
-                    head.m_start = x.m_args[i].m_right;
-                    head.m_end = x.m_args[i].m_right;
-                }
-                head.m_increment = x.m_args[i].m_step;
-                head.loc = head.m_v->base.loc;
-                Vec<ASR::stmt_t*> doloop_body;
-                doloop_body.reserve(al, 1);
-                if( doloop == nullptr ) {
-                    ASR::expr_t* target_ref = PassUtils::create_array_ref(slice_sym, idx_vars_target, al, x.base.base.loc, x.m_type);
-                    ASR::expr_t* value_ref = PassUtils::create_array_ref(x.m_v, idx_vars_value, al, x.base.base.loc, x.m_type);
-                    ASR::stmt_t* assign_stmt = LFortran::ASRUtils::STMT(ASR::make_Assignment_t(al, x.base.base.loc, target_ref, value_ref, nullptr));
-                    doloop_body.push_back(al, assign_stmt);
-                } else {
-                    ASR::stmt_t* set_to_one = LFortran::ASRUtils::STMT(ASR::make_Assignment_t(al, x.base.base.loc, idx_vars_target[i+1], const_1, nullptr));
-                    doloop_body.push_back(al, set_to_one);
-                    doloop_body.push_back(al, doloop);
-                }
-                ASR::expr_t* inc_expr = LFortran::ASRUtils::EXPR(ASR::make_BinOp_t(al, x.base.base.loc, idx_vars_target[i], ASR::binopType::Add, const_1, int32_type, nullptr, nullptr));
-                ASR::stmt_t* assign_stmt = LFortran::ASRUtils::STMT(ASR::make_Assignment_t(al, x.base.base.loc, idx_vars_target[i], inc_expr, nullptr));
-                doloop_body.push_back(al, assign_stmt);
-                doloop = LFortran::ASRUtils::STMT(ASR::make_DoLoop_t(al, x.base.base.loc, head, doloop_body.p, doloop_body.size()));
-            }
-            ASR::stmt_t* set_to_one = LFortran::ASRUtils::STMT(ASR::make_Assignment_t(al, x.base.base.loc, idx_vars_target[0], const_1, nullptr));
-            pass_result.push_back(al, set_to_one);
-            pass_result.push_back(al, doloop);
+    void replace_slice(ASR::expr_t*& x) {
+        if( x == nullptr ) {
+            return ;
+        }
+        if( create_slice_var && PassUtils::is_slice_present(x) ) {
+            x = replace_section(*ASR::down_cast<ASR::ArrayRef_t>(x));
+        } else {
+            this->visit_expr(*x);
         }
     }
 
-    void visit_Assignment(const ASR::Assignment_t& x) {
-        this->visit_expr(*x.m_value);
-        // If any slicing happened then do loop must have been created
-        // So, the current assignment should be inserted into pass_result
-        // so that it doesn't get ignored.
+    // The statements created for a section are inserted before `x`, the
+    // copies are deallocated after it
+    void finish_stmt(const ASR::stmt_t& x) {
         if( pass_result.size() > 0 ) {
-            pass_result.push_back(al, const_cast<ASR::stmt_t*>(&(x.base)));
+            pass_result.push_back(al, const_cast<ASR::stmt_t*>(&x));
+        }
+        if( copies.size() > 0 ) {
+            pass_result.push_back(al, LFortran::ASRUtils::STMT(ASR::make_ExplicitDeallocate_t(
+                al, x.base.loc, copies.p, copies.size())));
+            copies.reserve(al, 1);
         }
+        create_slice_var = false;
+        written_array = nullptr;
     }
 
-    void visit_BinOp(const ASR::BinOp_t& x) {
-        ASR::BinOp_t& xx = const_cast<ASR::BinOp_t&>(x);
-        create_slice_var = true;
-        slice_var = nullptr;
-        this->visit_expr(*x.m_left);
-        if( slice_var != nullptr ) {
-            xx.m_left = slice_var;
-            slice_var = nullptr;
-        }
-        this->visit_expr(*x.m_right);
-        if( slice_var != nullptr ) {
-            xx.m_right = slice_var;
-            slice_var = nullptr;
+    void visit_Assignment(const ASR::Assignment_t& x) {
+        ASR::Assignment_t& xx = const_cast<ASR::Assignment_t&>(x);
+        if( is_a<ASR::Var_t>(*x.m_target) ) {
+            written_array = ASRUtils::symbol_get_past_external(
+                down_cast<ASR::Var_t>(x.m_target)->m_v);
+        } else if( is_a<ASR::ArrayRef_t>(*x.m_target) ) {
+            written_array = ASRUtils::symbol_get_past_external(
+                down_cast<ASR::ArrayRef_t>(x.m_target)->m_v);
         }
-        create_slice_var = false;
+        create_slice_var = true;
+        replace_slice(xx.m_value);
+        finish_stmt(x.base);
     }
 
     void visit_Print(const ASR::Print_t& x) {
         ASR::Print_t& xx = const_cast<ASR::Print_t&>(x);
+        create_slice_var = true;
         for( size_t i = 0; i < xx.n_values; i++ ) {
-            slice_var = nullptr;
-            create_slice_var = true;
-            this->visit_expr(*xx.m_values[i]);
-            create_slice_var = false;
-            if( slice_var != nullptr ) {
-                xx.m_values[i] = slice_var;
-            }
+            replace_slice(xx.m_values[i]);
         }
-        // If any slicing happened then do loop must have been created
-        // So, the current print should be inserted into pass_result
-        // so that it doesn't get ignored.
-        if( pass_result.size() > 0 ) {
-            pass_result.push_back(al, const_cast<ASR::stmt_t*>(&(x.base)));
+        finish_stmt(x.base);
+    }
+
+    void visit_SubroutineCall(const ASR::SubroutineCall_t& x) {
+        ASR::SubroutineCall_t& xx = const_cast<ASR::SubroutineCall_t&>(x);
+        create_slice_var = true;
+        for( size_t i = 0; i < xx.n_args; i++ ) {
+            replace_slice(xx.m_args[i].m_value);
         }
+        finish_stmt(x.base);
+    }
+
+    void visit_FunctionCall(const ASR::FunctionCall_t& x) {
+        ASR::FunctionCall_t& xx = const_cast<ASR::FunctionCall_t&>(x);
+        for( size_t i = 0; i < xx.n_args; i++ ) {
+            replace_slice(xx.m_args[i].m_value);
+        }
+    }
+
+    void visit_BinOp(const ASR::BinOp_t& x) {
+        ASR::BinOp_t& xx = const_cast<ASR::BinOp_t&>(x);
+        replace_slice(xx.m_left);
+        replace_slice(xx.m_right);
+    }
+
+    void visit_Compare(const ASR::Compare_t& x) {
+        ASR::Compare_t& xx = const_cast<ASR::Compare_t&>(x);
+        replace_slice(xx.m_left);
+        replace_slice(xx.m_right);
+    }
+
+    void visit_BoolOp(const ASR::BoolOp_t& x) {
+        ASR::BoolOp_t& xx = const_cast<ASR::BoolOp_t&>(x);
+        replace_slice(xx.m_left);
+        replace_slice(xx.m_right);
+    }
+
+    void visit_UnaryOp(const ASR::UnaryOp_t& x) {
+        ASR::UnaryOp_t& xx = const_cast<ASR::UnaryOp_t&>(x);
+        replace_slice(xx.m_operand);
+    }
+
+    void visit_Cast(const ASR::Cast_t& x) {
+        ASR::Cast_t& xx = const_cast<ASR::Cast_t&>(x);
+        replace_slice(xx.m_arg);
+    }
+
+    void visit_ArraySize(const ASR::ArraySize_t& x) {
+        ASR::ArraySize_t& xx = const_cast<ASR::ArraySize_t&>(x);
+        replace_slice(xx.m_v);
+    }
+
+    // The sections in the bodies of loops and conditionals are replaced in
+    // place, the ones in their conditions are not, the statements would be
+    // executed only once before the loop
+    void visit_WhileLoop(const ASR::WhileLoop_t &x) {
+        ASR::WhileLoop_t &xx = const_cast<ASR::WhileLoop_t&>(x);
+        transform_stmts(xx.m_body, xx.n_body);
+    }
+
+    void visit_DoLoop(const ASR::DoLoop_t &x) {
+        ASR::DoLoop_t &xx = const_cast<ASR::DoLoop_t&>(x);
+        transform_stmts(xx.m_body, xx.n_body);
+    }
+
+    void visit_If(const ASR::If_t &x) {
+        ASR::If_t &xx = const_cast<ASR::If_t&>(x);
+        transform_stmts(xx.m_body, xx.n_body);
+        transform_stmts(xx.m_orelse, xx.n_orelse);
     }
 };
 
@@ -8,6 +8,7 @@
 
 #include <vector>
 #include <utility>
+#include <algorithm>
 
 
 namespace LFortran {
@@ -58,6 +59,24 @@ Result1 would have already been executed.
 All the nodes should be implemented using the above logic to track
 array operations and perform the do loop pass. As of now, some of the
 nodes are implemented and more are yet to be implemented with time.
+
+Before that, an assignment whose right hand side is an elementwise
+expression, i.e. a tree of BinOp, UnaryOp, Cast, Compare, BoolOp and
+elemental function calls over whole arrays and scalars, is fused into a
+single loop that writes straight to the target:
+
+    c = a*b + d
+
+becomes
+
+    do i = lbound(c), ubound(c)
+        c(i) = a(i)*b(i) + d(i)
+    end do
+
+without the array Result1 and its loop. The scalar subexpressions are
+evaluated once into scalar variables before the loop. When the target is a
+section, an operand that is the whole target array is copied first, since
+the loop could overwrite its elements before they are read.
 */
 
 class ArrayOpVisitor : public PassUtils::PassVisitor<ArrayOpVisitor>
@@ -146,7 +165,8 @@ public:
                     a_args.push_back(al, s->m_return_var);
                     ASR::asr_t* s_sub_asr = ASR::make_Subroutine_t(al, s->base.base.loc, s->m_symtab,
                                                     s->m_name, a_args.p, a_args.size(), s->m_body, s->n_body,
-                                                    s->m_abi, s->m_access, s->m_deftype, nullptr, false, false);
+                                                    s->m_abi, s->m_access, s->m_deftype, nullptr, false, false,
+                                                    s->m_restrict);
                     ASR::symbol_t* s_sub = ASR::down_cast<ASR::symbol_t>(s_sub_asr);
                     replace_vec.push_back(std::make_pair(item.first, s_sub));
                 }
@@ -207,7 +227,8 @@ public:
 
                     ASR::asr_t* s_sub_asr = ASR::make_Subroutine_t(al, s->base.base.loc, s->m_symtab,
                                                     s->m_name, a_args.p, a_args.size(), s->m_body, s->n_body,
-                                                    s->m_abi, s->m_access, s->m_deftype, nullptr, false, false);
+                                                    s->m_abi, s->m_access, s->m_deftype, nullptr, false, false,
+                                                    s->m_restrict);
                     ASR::symbol_t* s_sub = ASR::down_cast<ASR::symbol_t>(s_sub_asr);
                     replace_vec.push_back(std::make_pair(item.first, s_sub));
                 }
@@ -228,10 +249,30 @@ public:
 
     }
 
+    // The array operations in the bodies of loops and conditionals are
+    // replaced in place, so that their loops stay inside of them
+    void visit_WhileLoop(const ASR::WhileLoop_t &x) {
+        ASR::WhileLoop_t &xx = const_cast<ASR::WhileLoop_t&>(x);
+        transform_stmts(xx.m_body, xx.n_body);
+    }
+
+    void visit_DoLoop(const ASR::DoLoop_t &x) {
+        ASR::DoLoop_t &xx = const_cast<ASR::DoLoop_t&>(x);
+        transform_stmts(xx.m_body, xx.n_body);
+    }
+
+    void visit_If(const ASR::If_t &x) {
+        ASR::If_t &xx = const_cast<ASR::If_t&>(x);
+        transform_stmts(xx.m_body, xx.n_body);
+        transform_stmts(xx.m_orelse, xx.n_orelse);
+    }
+
     void visit_Assignment(const ASR::Assignment_t& x) {
         if( PassUtils::is_array(x.m_target) ) {
             result_var = x.m_target;
-            this->visit_expr(*(x.m_value));
+            if( !fuse_elementwise(x) ) {
+                this->visit_expr(*(x.m_value));
+            }
         } else if( PassUtils::is_slice_present(x.m_target) ) {
             ASR::ArrayRef_t* array_ref = ASR::down_cast<ASR::ArrayRef_t>(x.m_target);
             result_var = LFortran::ASRUtils::EXPR(ASR::make_Var_t(al, x.m_target->base.loc, array_ref->m_v));
@@ -262,11 +303,341 @@ public:
                 result_inc.push_back(al, m_increment);
             }
             use_custom_loop_params = true;
-            this->visit_expr(*(x.m_value));
+            if( !fuse_elementwise(x) ) {
+                this->visit_expr(*(x.m_value));
+            }
+            use_custom_loop_params = false;
         }
         result_var = nullptr;
     }
 
+    // Returns true if `x` is a call of a function that is applied to the
+    // elements of its array arguments, i.e. all its parameters are scalars
+    bool is_elemental_call(ASR::expr_t* x) {
+        if( !is_a<ASR::FunctionCall_t>(*x) ) {
+            return false;
+        }
+        ASR::FunctionCall_t* call = down_cast<ASR::FunctionCall_t>(x);
+        ASR::symbol_t* fn = LFortran::ASRUtils::symbol_get_past_external(call->m_name);
+        if( !is_a<ASR::Function_t>(*fn) ) {
+            // A function returning an array, converted to a subroutine
+            return false;
+        }
+        ASR::Function_t* f = down_cast<ASR::Function_t>(fn);
+        if( PassUtils::is_array(f->m_return_var) ) {
+            return false;
+        }
+        for( size_t i = 0; i < f->n_args; i++ ) {
+            if( PassUtils::is_array(f->m_args[i]) ) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /*
+        Classifies `x` for fusion into a loop over arrays of rank `rank`:
+        -1 if it cannot be evaluated element by element, 0 if it is a scalar
+        and 1 if it is elementwise over arrays.
+    */
+    int classify_elementwise(ASR::expr_t* x, int rank) {
+        switch( x->type ) {
+            case ASR::exprType::Var: {
+                int r = PassUtils::get_rank(x);
+                return r == 0 ? 0 : (r == rank ? 1 : -1);
+            }
+            case ASR::exprType::BinOp: {
+                ASR::BinOp_t* op = down_cast<ASR::BinOp_t>(x);
+                return classify_binary(op->m_left, op->m_right, rank);
+            }
+            case ASR::exprType::Compare: {
+                ASR::Compare_t* op = down_cast<ASR::Compare_t>(x);
+                return classify_binary(op->m_left, op->m_right, rank);
+            }
+            case ASR::exprType::BoolOp: {
+                ASR::BoolOp_t* op = down_cast<ASR::BoolOp_t>(x);
+                return classify_binary(op->m_left, op->m_right, rank);
+            }
+            case ASR::exprType::UnaryOp: {
+                return classify_elementwise(down_cast<ASR::UnaryOp_t>(x)->m_operand, rank);
+            }
+            case ASR::exprType::Cast: {
+                return classify_elementwise(down_cast<ASR::Cast_t>(x)->m_arg, rank);
+            }
+            case ASR::exprType::FunctionCall: {
+                if( is_elemental_call(x) ) {
+                    ASR::FunctionCall_t* call = down_cast<ASR::FunctionCall_t>(x);
+                    int res = 0;
+                    for( size_t i = 0; i < call->n_args; i++ ) {
+                        int r = classify_elementwise(call->m_args[i].m_value, rank);
+                        if( r < 0 ) {
+                            return -1;
+                        }
+                        res = std::max(res, r);
+                    }
+                    return res;
+                }
+                return PassUtils::is_array(x) ? -1 : 0;
+            }
+            default:
+                return PassUtils::is_array(x) ? -1 : 0;
+        }
+    }
+
+    int classify_binary(ASR::expr_t* left, ASR::expr_t* right, int rank) {
+        int l = classify_elementwise(left, rank);
+        int r = classify_elementwise(right, rank);
+        if( l < 0 || r < 0 ) {
+            return -1;
+        }
+        return std::max(l, r);
+    }
+
+    /*
+        Returns the element of `x` at `idx_vars`, `x` was classified as
+        elementwise by `classify_elementwise`. The scalar subexpressions are
+        assigned to new variables in `pass_result`, arrays in `copies` are
+        replaced by their copies.
+    */
+    ASR::expr_t* fuse_element(ASR::expr_t* x, Vec<ASR::expr_t*>& idx_vars,
+            int rank, std::vector<std::pair<ASR::symbol_t*, ASR::expr_t*>>& copies) {
+        const Location& loc = x->base.loc;
+        if( classify_elementwise(x, rank) == 0 ) {
+            if( is_a<ASR::Var_t>(*x) || ASRUtils::expr_value(x) != nullptr ||
+                is_a<ASR::IntegerConstant_t>(*x) || is_a<ASR::RealConstant_t>(*x) ||
+                is_a<ASR::ComplexConstant_t>(*x) || is_a<ASR::LogicalConstant_t>(*x) ) {
+                return x;
+            }
+            return hoist_scalar(x);
+        }
+        switch( x->type ) {
+            case ASR::exprType::Var: {
+                ASR::expr_t* arr = x;
+                for( auto& item: copies ) {
+                    if( item.first == down_cast<ASR::Var_t>(x)->m_v ) {
+                        arr = item.second;
+                    }
+                }
+                return PassUtils::create_array_ref(arr, idx_vars, al);
+            }
+            case ASR::exprType::BinOp: {
+                ASR::BinOp_t* op = down_cast<ASR::BinOp_t>(x);
+                ASR::expr_t* left = fuse_element(op->m_left, idx_vars, rank, copies);
+                ASR::expr_t* right = fuse_element(op->m_right, idx_vars, rank, copies);
+                return LFortran::ASRUtils::EXPR(ASR::make_BinOp_t(al, loc,
+                    left, op->m_op, right, op->m_type, nullptr, nullptr));
+            }
+            case ASR::exprType::Compare: {
+                ASR::Compare_t* op = down_cast<ASR::Compare_t>(x);
+                ASR::expr_t* left = fuse_element(op->m_left, idx_vars, rank, copies);
+                ASR::expr_t* right = fuse_element(op->m_right, idx_vars, rank, copies);
+                return LFortran::ASRUtils::EXPR(ASR::make_Compare_t(al, loc,
+                    left, op->m_op, right, op->m_type, nullptr, nullptr));
+            }
+            case ASR::exprType::BoolOp: {
+                ASR::BoolOp_t* op = down_cast<ASR::BoolOp_t>(x);
+                ASR::expr_t* left = fuse_element(op->m_left, idx_vars, rank, copies);
+                ASR::expr_t* right = fuse_element(op->m_right, idx_vars, rank, copies);
+                return LFortran::ASRUtils::EXPR(ASR::make_BoolOp_t(al, loc,
+                    left, op->m_op, right, op->m_type, nullptr));
+            }
+            case ASR::exprType::UnaryOp: {
+                ASR::UnaryOp_t* op = down_cast<ASR::UnaryOp_t>(x);
+                ASR::expr_t* operand = fuse_element(op->m_operand, idx_vars, rank, copies);
+                return LFortran::ASRUtils::EXPR(ASR::make_UnaryOp_t(al, loc,
+                    op->m_op, operand, op->m_type, nullptr));
+            }
+            case ASR::exprType::Cast: {
+                ASR::Cast_t* cast = down_cast<ASR::Cast_t>(x);
+                ASR::expr_t* arg = fuse_element(cast->m_arg, idx_vars, rank, copies);
+                return LFortran::ASRUtils::EXPR(ASR::make_Cast_t(al, loc,
+                    arg, cast->m_kind, cast->m_type, nullptr));
+            }
+            case ASR::exprType::FunctionCall: {
+                ASR::FunctionCall_t* call = down_cast<ASR::FunctionCall_t>(x);
+                Vec<ASR::call_arg_t> args;
+                args.reserve(al, call->n_args);
+                for( size_t i = 0; i < call->n_args; i++ ) {
+                    ASR::call_arg_t arg;
+                    arg.loc = call->m_args[i].loc;
+                    arg.m_value = fuse_element(call->m_args[i].m_value, idx_vars, rank, copies);
+                    args.push_back(al, arg);
+                }
+                return LFortran::ASRUtils::EXPR(ASR::make_FunctionCall_t(al, loc,
+                    call->m_name, call->m_original_name, args.p, args.size(),
+                    call->m_type, nullptr, call->m_dt));
+            }
+            default:
+                throw LFortranException("Cannot fuse the array expression");
+        }
+    }
+
+    // Assigns the scalar `x` to a new variable before the loop
+    ASR::expr_t* hoist_scalar(ASR::expr_t* x) {
+        // An element (ArrayRef) has the type of the array
+        ASR::ttype_t* type = LFortran::ASRUtils::expr_type(x);
+        ASR::dimension_t* m_dims = nullptr;
+        int n_dims = 0;
+        if( PassUtils::get_rank(x) == 0 && LFortran::ASRUtils::is_array(type) ) {
+            type = PassUtils::set_dim_rank(type, m_dims, n_dims, true, &al);
+        }
+        ASR::expr_t* scalar = create_var(result_var_num, "_scalar_res", x->base.loc, type);
+        result_var_num += 1;
+        pass_result.push_back(al, LFortran::ASRUtils::STMT(ASR::make_Assignment_t(
+            al, x->base.loc, scalar, x, nullptr)));
+        return scalar;
+    }
+
+    // Collects the arrays that are operands of the elementwise expression `x`
+    void collect_array_operands(ASR::expr_t* x, int rank, std::vector<ASR::expr_t*>& operands) {
+        if( classify_elementwise(x, rank) != 1 ) {
+            return;
+        }
+        switch( x->type ) {
+            case ASR::exprType::Var: {
+                operands.push_back(x);
+                break;
+            }
+            case ASR::exprType::BinOp: {
+                ASR::BinOp_t* op = down_cast<ASR::BinOp_t>(x);
+                collect_array_operands(op->m_left, rank, operands);
+                collect_array_operands(op->m_right, rank, operands);
+                break;
+            }
+            case ASR::exprType::Compare: {
+                ASR::Compare_t* op = down_cast<ASR::Compare_t>(x);
+                collect_array_operands(op->m_left, rank, operands);
+                collect_array_operands(op->m_right, rank, operands);
+                break;
+            }
+            case ASR::exprType::BoolOp: {
+                ASR::BoolOp_t* op = down_cast<ASR::BoolOp_t>(x);
+                collect_array_operands(op->m_left, rank, operands);
+                collect_array_operands(op->m_right, rank, operands);
+                break;
+            }
+            case ASR::exprType::UnaryOp: {
+                collect_array_operands(down_cast<ASR::UnaryOp_t>(x)->m_operand, rank, operands);
+                break;
+            }
+            case ASR::exprType::Cast: {
+                collect_array_operands(down_cast<ASR::Cast_t>(x)->m_arg, rank, operands);
+                break;
+            }
+            case ASR::exprType::FunctionCall: {
+                ASR::FunctionCall_t* call = down_cast<ASR::FunctionCall_t>(x);
+                for( size_t i = 0; i < call->n_args; i++ ) {
+                    collect_array_operands(call->m_args[i].m_value, rank, operands);
+                }
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    /*
+        Generates the single loop nest for the assignment `x` to `result_var`
+        (with the bounds of the section if `use_custom_loop_params`), returns
+        false if the right hand side is not elementwise.
+    */
+    bool fuse_elementwise(const ASR::Assignment_t& x) {
+        int n_dims = PassUtils::get_rank(result_var);
+        if( use_custom_loop_params ) {
+            n_dims = result_lbound.size();
+        }
+        // A scalar is assigned to each element of a section, the whole
+        // array target of a scalar is handled by the implied_do_loops pass
+        int kind = classify_elementwise(x.m_value, n_dims);
+        if( n_dims == 0 || kind < 0 || (kind == 0 && !use_custom_loop_params) ) {
+            return false;
+        }
+        const Location& loc = x.base.base.loc;
+        ASR::symbol_t* target = down_cast<ASR::Var_t>(result_var)->m_v;
+
+        // An element of the target that the right hand side reads is
+        // evaluated before the loop with the other scalar subexpressions.
+        // The target array as an operand is read at the index that is
+        // written, except when the target is a section.
+        std::vector<std::pair<ASR::symbol_t*, ASR::expr_t*>> copies;
+        if( use_custom_loop_params ) {
+            std::vector<ASR::expr_t*> operands;
+            collect_array_operands(x.m_value, n_dims, operands);
+            for( auto& operand: operands ) {
+                ASR::symbol_t* v = down_cast<ASR::Var_t>(operand)->m_v;
+                if( v != target || !copies.empty() ) {
+                    continue;
+                }
+                ASR::expr_t* copy = create_var(result_var_num, "_array_copy", loc, operand);
+                result_var_num += 1;
+                ASR::expr_t* result_var_copy = result_var;
+                result_var = copy;
+                use_custom_loop_params = false;
+                this->visit_expr(*operand);
+                use_custom_loop_params = true;
+                result_var = result_var_copy;
+                copies.push_back(std::make_pair(v, copy));
+            }
+        }
+
+        Vec<ASR::expr_t*> idx_vars, idx_vars_value;
+        PassUtils::create_idx_vars(idx_vars, n_dims, loc, al, current_scope, "_t");
+        if( use_custom_loop_params ) {
+            PassUtils::create_idx_vars(idx_vars_value, n_dims, loc, al, current_scope, "_v");
+        } else {
+            idx_vars_value = idx_vars;
+        }
+        ASR::expr_t* value = fuse_element(x.m_value, idx_vars_value, n_dims, copies);
+
+        ASR::ttype_t* int32_type = LFortran::ASRUtils::TYPE(ASR::make_Integer_t(al, loc, 4, nullptr, 0));
+        ASR::expr_t* const_1 = LFortran::ASRUtils::EXPR(ASR::make_IntegerConstant_t(al, loc, 1, int32_type));
+        ASR::stmt_t* doloop = nullptr;
+        for( int i = n_dims - 1; i >= 0; i-- ) {
+            ASR::do_loop_head_t head;
+            head.m_v = idx_vars[i];
+            // The bounds are evaluated once, not in each iteration
+            if( use_custom_loop_params ) {
+                head.m_start = result_lbound[i];
+                head.m_end = result_ubound[i];
+                head.m_increment = result_inc[i];
+            } else {
+                head.m_start = PassUtils::get_bound(result_var, i + 1, "lbound", al, unit, rl_path, current_scope);
+                head.m_end = PassUtils::get_bound(result_var, i + 1, "ubound", al, unit, rl_path, current_scope);
+                head.m_increment = nullptr;
+            }
+            if( !is_a<ASR::IntegerConstant_t>(*head.m_end) && !is_a<ASR::Var_t>(*head.m_end) ) {
+                head.m_end = hoist_scalar(head.m_end);
+            }
+            head.loc = head.m_v->base.loc;
+            Vec<ASR::stmt_t*> doloop_body;
+            doloop_body.reserve(al, 3);
+            if( doloop == nullptr ) {
+                ASR::expr_t* res = PassUtils::create_array_ref(result_var, idx_vars, al);
+                doloop_body.push_back(al, LFortran::ASRUtils::STMT(ASR::make_Assignment_t(
+                    al, loc, res, value, nullptr)));
+            } else {
+                if( use_custom_loop_params ) {
+                    doloop_body.push_back(al, LFortran::ASRUtils::STMT(ASR::make_Assignment_t(
+                        al, loc, idx_vars_value[i+1], const_1, nullptr)));
+                }
+                doloop_body.push_back(al, doloop);
+            }
+            if( use_custom_loop_params ) {
+                ASR::expr_t* inc_expr = LFortran::ASRUtils::EXPR(ASR::make_BinOp_t(al, loc,
+                    idx_vars_value[i], ASR::binopType::Add, const_1, int32_type, nullptr, nullptr));
+                doloop_body.push_back(al, LFortran::ASRUtils::STMT(ASR::make_Assignment_t(
+                    al, loc, idx_vars_value[i], inc_expr, nullptr)));
+            }
+            doloop = LFortran::ASRUtils::STMT(ASR::make_DoLoop_t(al, loc, head, doloop_body.p, doloop_body.size()));
+        }
+        if( use_custom_loop_params ) {
+            pass_result.push_back(al, LFortran::ASRUtils::STMT(ASR::make_Assignment_t(
+                al, loc, idx_vars_value[0], const_1, nullptr)));
+        }
+        pass_result.push_back(al, doloop);
+        return true;
+    }
+
     ASR::ttype_t* get_matching_type(ASR::expr_t* sibling) {
         ASR::ttype_t* sibling_type = LFortran::ASRUtils::expr_type(sibling);
         if( sibling->type != ASR::exprType::Var ) {
@@ -297,8 +668,12 @@ public:
 
     ASR::expr_t* create_var(int counter, std::string suffix, const Location& loc,
                             ASR::expr_t* sibling) {
+        return create_var(counter, suffix, loc, get_matching_type(sibling));
+    }
+
+    ASR::expr_t* create_var(int counter, std::string suffix, const Location& loc,
+                            ASR::ttype_t* var_type) {
         ASR::expr_t* idx_var = nullptr;
-        ASR::ttype_t* var_type = get_matching_type(sibling);
         Str str_name;
         str_name.from_str(al, "~" + std::to_string(counter) + suffix);
         const char* const_idx_var_name = str_name.c_str(al);
@@ -116,7 +116,7 @@ void pass_wrap_global_stmts_into_function(Allocator &al,
                 /* n_body */ body.size(),
                 /* a_return_var */ return_var_ref,
                 ASR::abiType::BindC,
-                ASR::Public, ASR::Implementation, nullptr);
+                ASR::Public, ASR::Implementation, nullptr, false);
             std::string sym_name = fn_name;
             if (unit.m_global_scope->get_symbol(sym_name) != nullptr) {
                 throw LFortranException("Function already defined");
@@ -135,7 +135,7 @@ void pass_wrap_global_stmts_into_function(Allocator &al,
                 /* n_body */ body.size(),
                 ASR::abiType::Source,
                 ASR::Public, ASR::Implementation, nullptr,
-                false, false);
+                false, false, false);
             std::string sym_name = fn_name;
             if (unit.m_global_scope->get_symbol(sym_name) != nullptr) {
                 throw LFortranException("Function already defined");
@@ -46,6 +46,10 @@ public:
         contains_array = PassUtils::is_array(x_expr);
     }
 
+    void visit_ArrayRef(const ASR::ArrayRef_t& x) {
+        contains_array = PassUtils::is_slice_present(x);
+    }
+
     void visit_IntegerConstant(const ASR::IntegerConstant_t&) {
         contains_array = false;
     }
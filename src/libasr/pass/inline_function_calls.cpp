@@ -35,6 +35,17 @@ to:
     c = a + 5
 
 */
+// Finds `return` statements (at any depth) in the visited statements
+class ReturnFinder : public ASR::BaseWalkVisitor<ReturnFinder>
+{
+public:
+    bool found = false;
+
+    void visit_Return(const ASR::Return_t &/*x*/) {
+        found = true;
+    }
+};
+
 class InlineFunctionCallVisitor : public PassUtils::PassVisitor<InlineFunctionCallVisitor>
 {
 private:
@@ -86,6 +97,39 @@ public:
         current_routine.clear();
     }
 
+    // Inline the calls in the bodies of loops and conditionals in place, so
+    // that the inlined statements stay inside of them. The calls in the
+    // conditions are not inlined, the inlined statements would be executed
+    // only once before the statement. The body of the function being
+    // inlined is only walked.
+    void visit_WhileLoop(const ASR::WhileLoop_t &x) {
+        if( current_routine_scope ) {
+            PassUtils::PassVisitor<InlineFunctionCallVisitor>::visit_WhileLoop(x);
+            return ;
+        }
+        ASR::WhileLoop_t &xx = const_cast<ASR::WhileLoop_t&>(x);
+        transform_stmts(xx.m_body, xx.n_body);
+    }
+
+    void visit_DoLoop(const ASR::DoLoop_t &x) {
+        if( current_routine_scope ) {
+            PassUtils::PassVisitor<InlineFunctionCallVisitor>::visit_DoLoop(x);
+            return ;
+        }
+        ASR::DoLoop_t &xx = const_cast<ASR::DoLoop_t&>(x);
+        transform_stmts(xx.m_body, xx.n_body);
+    }
+
+    void visit_If(const ASR::If_t &x) {
+        if( current_routine_scope ) {
+            PassUtils::PassVisitor<InlineFunctionCallVisitor>::visit_If(x);
+            return ;
+        }
+        ASR::If_t &xx = const_cast<ASR::If_t&>(x);
+        transform_stmts(xx.m_body, xx.n_body);
+        transform_stmts(xx.m_orelse, xx.n_orelse);
+    }
+
     void visit_Var(const ASR::Var_t& x) {
         ASR::Var_t& xx = const_cast<ASR::Var_t&>(x);
         std::string x_var_name = std::string(ASRUtils::symbol_name(x.m_v));
@@ -113,6 +157,55 @@ public:
         }
     }
 
+    // Returns a symbol for the procedure `sym` called in the body of the
+    // function being inlined that can be used in the current scope, or
+    // nullptr if there is none.
+    ASR::symbol_t* import_procedure(ASR::symbol_t* sym) {
+        std::string sym_name = ASRUtils::symbol_name(sym);
+        if( current_scope->resolve_symbol(sym_name) == sym ) {
+            return sym;
+        }
+        ASR::symbol_t* f_sym = ASRUtils::symbol_get_past_external(sym);
+        SymbolTable* parent = ASRUtils::symbol_parent_symtab(f_sym);
+        if( !parent->asr_owner || !ASR::is_a<ASR::symbol_t>(*parent->asr_owner) ||
+            !ASR::is_a<ASR::Module_t>(*ASR::down_cast<ASR::symbol_t>(parent->asr_owner)) ) {
+            return nullptr;
+        }
+        ASR::Module_t *m = ASR::down_cast<ASR::Module_t>(
+            ASR::down_cast<ASR::symbol_t>(parent->asr_owner));
+        char* f_name = ASRUtils::symbol_name(f_sym);
+        std::string new_sym_name = current_scope->get_unique_name(f_name);
+        ASR::symbol_t* new_sym = ASR::down_cast<ASR::symbol_t>(ASR::make_ExternalSymbol_t(
+                                    al, sym->base.loc, current_scope, s2c(al, new_sym_name),
+                                    f_sym, m->m_name, nullptr, 0,
+                                    f_name, ASR::accessType::Private));
+        current_scope->add_symbol(new_sym_name, new_sym);
+        return new_sym;
+    }
+
+    void visit_SubroutineCall(const ASR::SubroutineCall_t& x) {
+        if( inlining_function ) {
+            ASR::symbol_t* called_sym = import_procedure(x.m_name);
+            if( !called_sym ) {
+                fixed_duplicated_expr_stmt = false;
+                return ;
+            }
+            ASR::SubroutineCall_t& xx = const_cast<ASR::SubroutineCall_t&>(x);
+            xx.m_name = called_sym;
+        }
+        PassUtils::PassVisitor<InlineFunctionCallVisitor>::visit_SubroutineCall(x);
+    }
+
+    void visit_ArrayRef(const ASR::ArrayRef_t& x) {
+        // The node duplicator shares the indices of an ArrayRef with the
+        // original function body, rewriting them would modify the original.
+        if( current_routine_scope ) {
+            fixed_duplicated_expr_stmt = false;
+            return ;
+        }
+        PassUtils::PassVisitor<InlineFunctionCallVisitor>::visit_ArrayRef(x);
+    }
+
     void visit_FunctionCall(const ASR::FunctionCall_t& x) {
         // If this node is visited by any other visitor
         // or it is being visited while inlining another function call
@@ -122,37 +215,13 @@ public:
             if( !inlining_function ) {
                 return ;
             }
-            // TODO: Handle type later
-            if( ASR::is_a<ASR::ExternalSymbol_t>(*x.m_name) ) {
-                ASR::ExternalSymbol_t* called_sym_ext = ASR::down_cast<ASR::ExternalSymbol_t>(x.m_name);
-                ASR::symbol_t* f_sym = ASRUtils::symbol_get_past_external(called_sym_ext->m_external);
-                ASR::Function_t* f = ASR::down_cast<ASR::Function_t>(f_sym);
-
-                // Never inline intrinsic functions
-                if( ASRUtils::is_intrinsic_function2(f) ) {
-                    return ;
-                }
-
-                ASR::symbol_t* called_sym = x.m_name;
-
-                // TODO: Hanlde later
-                // ASR::symbol_t* called_sym_original = x.m_original_name;
-
-                ASR::FunctionCall_t& xx = const_cast<ASR::FunctionCall_t&>(x);
-                std::string called_sym_name = std::string(called_sym_ext->m_name);
-                std::string new_sym_name_str = current_scope->get_unique_name(called_sym_name);
-                char* new_sym_name = s2c(al, new_sym_name_str);
-                if( current_scope->get_symbol(new_sym_name_str) == nullptr ) {
-                    ASR::Module_t *m = ASR::down_cast2<ASR::Module_t>(f->m_symtab->parent->asr_owner);
-                    char *modname = m->m_name;
-                    ASR::symbol_t* new_sym = ASR::down_cast<ASR::symbol_t>(ASR::make_ExternalSymbol_t(
-                                                al, called_sym->base.loc, current_scope, new_sym_name,
-                                                f_sym, modname, nullptr, 0,
-                                                f->m_name, ASR::accessType::Private));
-                    current_scope->add_symbol(new_sym_name_str, new_sym);
-                }
-                xx.m_name = current_scope->get_symbol(new_sym_name_str);
+            ASR::symbol_t* called_sym = import_procedure(x.m_name);
+            if( !called_sym ) {
+                fixed_duplicated_expr_stmt = false;
+                return ;
             }
+            ASR::FunctionCall_t& xx = const_cast<ASR::FunctionCall_t&>(x);
+            xx.m_name = called_sym;
 
             for( size_t i = 0; i < x.n_args; i++ ) {
                 visit_expr(*x.m_args[i].m_value);
@@ -188,7 +257,26 @@ public:
             return ;
         }
 
-        current_routine_scope = func->m_symtab;
+        // Functions without a body (e.g. @ccall) cannot be inlined.
+        if( func->n_body == 0 || func->m_abi == ASR::abiType::BindC ||
+            func->m_deftype == ASR::deftypeType::Interface ) {
+            return ;
+        }
+
+        // The `return` at the end of the body is dropped. Any other `return`
+        // would return from the caller after inlining, so such functions
+        // are not inlined.
+        size_t n_body = func->n_body;
+        if( ASR::is_a<ASR::Return_t>(*func->m_body[n_body - 1]) ) {
+            n_body--;
+        }
+        ReturnFinder return_finder;
+        for( size_t i = 0; i < n_body; i++ ) {
+            return_finder.visit_stmt(*func->m_body[i]);
+        }
+        if( return_finder.found ) {
+            return ;
+        }
 
         ASR::expr_t* return_var = nullptr;
         // The following prepares arg2value map for inlining the
@@ -215,6 +303,15 @@ public:
                 return ;
             }
             ASR::Variable_t* arg_variable = ASR::down_cast<ASR::Variable_t>(arg_var->m_v);
+            // Arguments are passed by copying them into local variables,
+            // which is only correct for scalars.
+            if( ASRUtils::is_array(arg_variable->m_type) ) {
+                for( auto& itr : arg2value ) {
+                    current_scope->erase_symbol(ASRUtils::symbol_name(itr.second));
+                }
+                arg2value.clear();
+                return ;
+            }
             std::string arg_variable_name = std::string(arg_variable->m_name);
             std::string arg_name = current_scope->get_unique_name(arg_variable_name + "_" + std::string(func->m_name));
             ASR::stmt_t* assign_stmt = nullptr;
@@ -231,6 +328,7 @@ public:
             arg2value[arg_variable_name] = ASR::down_cast<ASR::Var_t>(call_arg_var)->m_v;
         }
 
+        current_routine_scope = func->m_symtab;
         bool success = true;
         // Stores the initialisation expression for function's local variables
         // i.e., other than the argument variables.
@@ -292,9 +390,9 @@ public:
         }
 
         Vec<ASR::stmt_t*> func_copy;
-        func_copy.reserve(al, func->n_body);
+        func_copy.reserve(al, n_body);
         // Duplicate each and every statement of the function body.
-        for( size_t i = 0; i < func->n_body && success; i++ ) {
+        for( size_t i = 0; i < n_body && success; i++ ) {
             node_duplicator.success = true;
             ASR::stmt_t* m_body_copy = node_duplicator.duplicate_stmt(func->m_body[i]);
             if( node_duplicator.success ) {
@@ -308,7 +406,7 @@ public:
             // Set inlining_function to true so that we inline
             // only one function at a time.
             inlining_function = true;
-            for( size_t i = 0; i < func->n_body && success; i++ ) {
+            for( size_t i = 0; i < n_body && success; i++ ) {
                 fixed_duplicated_expr_stmt = true;
                 visit_stmt(*func_copy[i]);
                 success = success && fixed_duplicated_expr_stmt;
@@ -323,14 +421,14 @@ public:
                     pass_result.push_back(al, pass_result_local[i]);
                 }
 
-                for( size_t i = 0; i < func->n_body; i++ ) {
+                for( size_t i = 0; i < n_body; i++ ) {
                     pass_result.push_back(al, func_copy[i]);
                 }
             }
             inlining_function = false;
-            current_routine_scope = nullptr;
             function_result_var = return_var;
         }
+        current_routine_scope = nullptr;
 
         if (!success) {
             // If not successfull then delete all the local variables
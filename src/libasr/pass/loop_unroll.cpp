@@ -9,7 +9,6 @@
 #include <vector>
 #include <map>
 #include <utility>
-#include <cmath>
 
 
 namespace LFortran {
@@ -56,11 +55,25 @@ public:
             !ASRUtils::is_value_constant(x_inc, _inc) ) {
             return ;
         }
-        int64_t loop_size = std::ceil( ((float) (_end - _start + 1)) / ((float) _inc) );
+        if( _inc == 0 ) {
+            return ;
+        }
+        // The division below truncates towards zero, an empty loop would
+        // get one iteration
+        if( (_inc > 0 && _end < _start) || (_inc < 0 && _end > _start) ) {
+            return ;
+        }
+        int64_t loop_size = (_end - _start) / _inc + 1;
+        if( loop_size <= 0 ) {
+            return ;
+        }
         int64_t unroll_factor_ = std::min(unroll_factor, loop_size);
         bool create_unrolled_loop = unroll_factor_ < loop_size;
-        int64_t new_end = unroll_factor_ * (loop_size / unroll_factor_);
+        int64_t n_unrolled = unroll_factor_ * (loop_size / unroll_factor_);
         int64_t remaining_part = loop_size % unroll_factor_;
+        // The condition of the loop is checked once per `unroll_factor_`
+        // iterations, the last block must start at this value
+        int64_t new_end = _start + (n_unrolled - unroll_factor_) * _inc;
         ASR::ttype_t *int32_type = LFortran::ASRUtils::TYPE(ASR::make_Integer_t(al, x.base.base.loc,
                                                             4, nullptr, 0));
         xx.m_head.m_end = ASRUtils::EXPR(ASR::make_IntegerConstant_t(al, x_end->base.loc, new_end, int32_type));
@@ -53,6 +53,39 @@ namespace LFortran {
             }
         }
 
+        int64_t get_fixed_array_size(ASR::Variable_t* v) {
+            ASR::ttype_t* t = v->m_type;
+            if (v->m_storage == ASR::storage_typeType::Allocatable ||
+                !(ASR::is_a<ASR::Integer_t>(*t) || ASR::is_a<ASR::Real_t>(*t) ||
+                  ASR::is_a<ASR::Complex_t>(*t) || ASR::is_a<ASR::Logical_t>(*t))) {
+                return -1;
+            }
+            ASR::dimension_t* m_dims = nullptr;
+            int n_dims = 0;
+            get_dim_rank(t, m_dims, n_dims);
+            if (n_dims == 0) {
+                return -1;
+            }
+            // A logical is an `i1`, which takes one byte
+            int64_t size = ASR::is_a<ASR::Logical_t>(*t) ? 1
+                : ASRUtils::extract_kind_from_ttype_t(t);
+            if (ASR::is_a<ASR::Complex_t>(*t)) {
+                size *= 2;
+            }
+            for (int r = 0; r < n_dims; r++) {
+                ASR::expr_t *start = m_dims[r].m_start, *end = m_dims[r].m_end;
+                if (start == nullptr || end == nullptr ||
+                    !ASR::is_a<ASR::IntegerConstant_t>(*start) ||
+                    !ASR::is_a<ASR::IntegerConstant_t>(*end)) {
+                    return -1;
+                }
+                int64_t n = ASR::down_cast<ASR::IntegerConstant_t>(end)->m_n -
+                    ASR::down_cast<ASR::IntegerConstant_t>(start)->m_n + 1;
+                size *= n > 0 ? n : 0;
+            }
+            return size;
+        }
+
         ASR::ttype_t* set_dim_rank(ASR::ttype_t* x_type, ASR::dimension_t*& m_dims, int& n_dims,
                                     bool create_new, Allocator* al) {
             ASR::ttype_t* new_type = nullptr;
@@ -320,14 +353,26 @@ namespace LFortran {
                                 const std::string& rl_path,
                                 SymbolTable*& current_scope) {
             // Loads ubound/lbound from the module already in ASR
-            ASR::symbol_t *v = import_function2(bound, "lpython_builtin", al,
+            ASR::symbol_t *v = import_function2(bound, "builtin_functions", al,
                                                unit, current_scope);
             if (!v) {
-                // If it fails, try to load from the source until we fix
-                // LFortran to preload this module
-                v = import_function(bound, "lfortran_intrinsic_builtin", al,
+                // If it fails, load the module, it is only in ASR if the
+                // program calls a builtin
+                v = import_function(bound, "builtin_functions", al,
                         unit, rl_path, current_scope, arr_expr->base.loc);
+                ASR::Module_t *m = ASR::down_cast<ASR::Module_t>(
+                    unit.m_global_scope->get_symbol("builtin_functions"));
+                m->m_name = s2c(al, "builtin_functions");
+                m->m_intrinsic = true;
+                ASR::down_cast<ASR::ExternalSymbol_t>(v)->m_module_name
+                    = m->m_name;
             }
+            // The backend implements them, as the frontend marks them when
+            // it loads the module
+            ASR::Function_t *f = ASR::down_cast<ASR::Function_t>(
+                ASRUtils::symbol_get_past_external(v));
+            f->m_abi = ASR::abiType::Intrinsic;
+            f->m_deftype = ASR::deftypeType::Interface;
             ASR::ExternalSymbol_t* v_ext = ASR::down_cast<ASR::ExternalSymbol_t>(v);
             ASR::Function_t* mfn = ASR::down_cast<ASR::Function_t>(v_ext->m_external);
             Vec<ASR::call_arg_t> args;
@@ -17,6 +17,10 @@ namespace LFortran {
 
         int get_rank(ASR::expr_t* x);
 
+        // The size in bytes of a local array of numbers or logicals whose
+        // dimensions are known at compile time, -1 for any other variable
+        int64_t get_fixed_array_size(ASR::Variable_t* v);
+
         ASR::expr_t* create_array_ref(ASR::expr_t* arr_expr, Vec<ASR::expr_t*>& idx_vars, Allocator& al);
 
         ASR::expr_t* create_array_ref(ASR::symbol_t* arr, Vec<ASR::expr_t*>& idx_vars, Allocator& al,
@@ -0,0 +1,527 @@
+#include <libasr/asr.h>
+#include <libasr/containers.h>
+#include <libasr/exception.h>
+#include <libasr/asr_utils.h>
+#include <libasr/pass/procedure_effects.h>
+#include <libasr/pass/pass_utils.h>
+#include <set>
+
+namespace LFortran {
+
+using ASR::down_cast;
+using ASR::is_a;
+
+/*
+
+This ASR pass is solely an analysis pass to find which arguments each
+procedure writes to or keeps a pointer to, whether it touches memory other
+than its arguments and whether it always returns. The LLVM backend turns
+these into attributes of the functions and their arguments (`readonly`,
+`nocapture`, `noalias`, `willreturn`, ...).
+
+The effects of a procedure include the effects of the procedures it calls,
+so that they are found together, starting with no effects and repeating
+until nothing changes. A call of a procedure without a body (`@ccall`, a
+procedure argument) can do anything. A procedure with variables that are
+not numbers or arrays of numbers (strings, lists, dicts, ...) uses the heap
+in the runtime library and is assumed to do anything as well. So is one
+with a local array larger than the stack array limit, which the backend
+allocates on the heap.
+
+*/
+
+class ProcedureEffectsVisitor : public ASR::BaseWalkVisitor<ProcedureEffectsVisitor>
+{
+private:
+    std::map<const ASR::symbol_t*, ProcedureEffects> &effects;
+    int64_t stack_array_limit;
+
+    // The procedure that is visited and its effects found so far
+    SymbolTable *proc_scope;
+    std::map<const ASR::symbol_t*, size_t> arg_index;
+    ProcedureEffects e;
+
+    // The views of arrays created by `Associate`, a write to an element of
+    // the view is a write to the array
+    std::map<const ASR::symbol_t*, const ASR::symbol_t*> views;
+
+    // The variables that are written by the body of the loop that is
+    // checked by `is_finite`
+    std::set<const ASR::symbol_t*> *changed_locals;
+
+public:
+    std::vector<const ASR::symbol_t*> procs;
+
+    ProcedureEffectsVisitor(std::map<const ASR::symbol_t*, ProcedureEffects> &effects,
+            int64_t stack_array_limit) :
+        effects{effects}, stack_array_limit{stack_array_limit},
+        proc_scope{nullptr}, changed_locals{nullptr} { }
+
+    void collect_procedures(SymbolTable *scope) {
+        for (auto &item : scope->get_scope()) {
+            ASR::symbol_t *sym = item.second;
+            if (is_a<ASR::Function_t>(*sym)) {
+                ASR::Function_t *f = down_cast<ASR::Function_t>(sym);
+                if (f->m_deftype == ASR::deftypeType::Implementation) {
+                    procs.push_back(sym);
+                    effects[sym].arg_written.resize(f->n_args, false);
+                    effects[sym].arg_captured.resize(f->n_args, false);
+                }
+                collect_procedures(f->m_symtab);
+            } else if (is_a<ASR::Subroutine_t>(*sym)) {
+                ASR::Subroutine_t *s = down_cast<ASR::Subroutine_t>(sym);
+                if (s->m_deftype == ASR::deftypeType::Implementation &&
+                        s->m_abi != ASR::abiType::Interactive) {
+                    procs.push_back(sym);
+                    effects[sym].arg_written.resize(s->n_args, false);
+                    effects[sym].arg_captured.resize(s->n_args, false);
+                }
+                collect_procedures(s->m_symtab);
+            } else if (is_a<ASR::Module_t>(*sym)) {
+                collect_procedures(down_cast<ASR::Module_t>(sym)->m_symtab);
+            } else if (is_a<ASR::Program_t>(*sym)) {
+                collect_procedures(down_cast<ASR::Program_t>(sym)->m_symtab);
+            }
+        }
+    }
+
+    // A number, a logical or an array of them
+    static bool is_plain_type(ASR::ttype_t *t) {
+        t = ASRUtils::type_get_past_pointer(t);
+        return is_a<ASR::Integer_t>(*t) || is_a<ASR::Real_t>(*t) ||
+            is_a<ASR::Complex_t>(*t) || is_a<ASR::Logical_t>(*t);
+    }
+
+    // Returns true if the effects of `proc` changed
+    bool visit_procedure(const ASR::symbol_t *proc) {
+        SymbolTable *symtab;
+        ASR::expr_t **args;
+        size_t n_args;
+        ASR::stmt_t **body;
+        size_t n_body;
+        if (is_a<ASR::Function_t>(*proc)) {
+            const ASR::Function_t *f = down_cast<ASR::Function_t>(proc);
+            symtab = f->m_symtab; args = f->m_args; n_args = f->n_args;
+            body = f->m_body; n_body = f->n_body;
+        } else {
+            const ASR::Subroutine_t *s = down_cast<ASR::Subroutine_t>(proc);
+            symtab = s->m_symtab; args = s->m_args; n_args = s->n_args;
+            body = s->m_body; n_body = s->n_body;
+        }
+        proc_scope = symtab;
+        arg_index.clear();
+        views.clear();
+        for (size_t i = 0; i < n_args; i++) {
+            if (is_a<ASR::Var_t>(*args[i])) {
+                arg_index[ASRUtils::symbol_get_past_external(
+                    down_cast<ASR::Var_t>(args[i])->m_v)] = i;
+            }
+        }
+        e = ProcedureEffects();
+        e.arg_written.resize(n_args, false);
+        e.arg_captured.resize(n_args, false);
+        e.will_return = true;
+        for (auto &item : symtab->get_scope()) {
+            ASR::symbol_t *sym = item.second;
+            if (is_a<ASR::Variable_t>(*sym)) {
+                ASR::Variable_t *v = down_cast<ASR::Variable_t>(sym);
+                if (!is_plain_type(v->m_type)) {
+                    set_unknown();
+                } else if (v->m_intent == ASR::intentType::Local &&
+                        PassUtils::get_fixed_array_size(v) > stack_array_limit) {
+                    // Allocated and freed by the runtime library
+                    e.writes_memory = true;
+                    e.reads_memory = true;
+                }
+            } else if (is_a<ASR::Function_t>(*sym) || is_a<ASR::Subroutine_t>(*sym)) {
+                // The arguments are stored in a global struct for the
+                // nested procedures
+                set_unknown();
+            }
+        }
+        for (size_t i = 0; i < n_body; i++) {
+            visit_stmt(*body[i]);
+        }
+        ProcedureEffects &old = effects[proc];
+        bool changed = old.arg_written != e.arg_written ||
+            old.arg_captured != e.arg_captured ||
+            old.writes_memory != e.writes_memory ||
+            old.reads_memory != e.reads_memory ||
+            old.writes_descriptors != e.writes_descriptors ||
+            old.will_return != e.will_return;
+        old = e;
+        return changed;
+    }
+
+    void set_unknown() {
+        std::fill(e.arg_written.begin(), e.arg_written.end(), true);
+        std::fill(e.arg_captured.begin(), e.arg_captured.end(), true);
+        e.writes_memory = true;
+        e.reads_memory = true;
+        e.writes_descriptors = true;
+        e.will_return = false;
+    }
+
+    const ASR::symbol_t* get_base(const ASR::symbol_t *sym) {
+        sym = ASRUtils::symbol_get_past_external(const_cast<ASR::symbol_t*>(sym));
+        auto it = views.find(sym);
+        while (it != views.end()) {
+            sym = it->second;
+            it = views.find(sym);
+        }
+        return sym;
+    }
+
+    // The variable whose memory `x` refers to, or nullptr
+    const ASR::symbol_t* get_base(const ASR::expr_t *x) {
+        switch (x->type) {
+            case ASR::exprType::Var:
+                return get_base(down_cast<ASR::Var_t>(x)->m_v);
+            case ASR::exprType::ArrayRef:
+                return get_base(down_cast<ASR::ArrayRef_t>(x)->m_v);
+            case ASR::exprType::DerivedRef:
+                return get_base(down_cast<ASR::DerivedRef_t>(x)->m_v);
+            default:
+                return nullptr;
+        }
+    }
+
+    bool is_local(const ASR::symbol_t *sym) {
+        return is_a<ASR::Variable_t>(*sym) &&
+            down_cast<ASR::Variable_t>(sym)->m_parent_symtab == proc_scope &&
+            arg_index.find(sym) == arg_index.end();
+    }
+
+    bool is_global(const ASR::symbol_t *sym) {
+        return is_a<ASR::Variable_t>(*sym) &&
+            down_cast<ASR::Variable_t>(sym)->m_parent_symtab != proc_scope;
+    }
+
+    // `descriptor`: the descriptor of the array is written, not only its
+    // elements, `heap`: the memory of a local array is allocated
+    void write(const ASR::symbol_t *sym, bool descriptor, bool heap=false) {
+        if (sym == nullptr) {
+            e.writes_memory = true;
+            return;
+        }
+        if (changed_locals) {
+            changed_locals->insert(sym);
+        }
+        auto it = arg_index.find(sym);
+        if (it != arg_index.end()) {
+            e.arg_written[it->second] = true;
+            e.writes_descriptors = e.writes_descriptors || descriptor;
+        } else if (is_global(sym)) {
+            e.writes_memory = true;
+            e.writes_descriptors = e.writes_descriptors || descriptor;
+        } else if (heap) {
+            e.writes_memory = true;
+        }
+    }
+
+    void capture(const ASR::symbol_t *sym) {
+        if (sym == nullptr) {
+            return;
+        }
+        auto it = arg_index.find(sym);
+        if (it != arg_index.end()) {
+            e.arg_captured[it->second] = true;
+        }
+    }
+
+    void read(const ASR::symbol_t *sym) {
+        if (is_global(sym)) {
+            e.reads_memory = true;
+        }
+    }
+
+    void visit_expr(const ASR::expr_t &x) {
+        // A procedure argument is a Var of the procedure
+        bool is_procedure = is_a<ASR::Var_t>(x) && !is_a<ASR::Variable_t>(
+            *ASRUtils::symbol_get_past_external(down_cast<ASR::Var_t>(&x)->m_v));
+        if (!is_procedure && !is_plain_type(ASRUtils::expr_type(&x))) {
+            set_unknown();
+        }
+        ASR::BaseWalkVisitor<ProcedureEffectsVisitor>::visit_expr(x);
+    }
+
+    void visit_Var(const ASR::Var_t &x) {
+        read(get_base(x.m_v));
+    }
+
+    void visit_ArrayRef(const ASR::ArrayRef_t &x) {
+        read(get_base(x.m_v));
+        ASR::BaseWalkVisitor<ProcedureEffectsVisitor>::visit_ArrayRef(x);
+    }
+
+    void visit_Assignment(const ASR::Assignment_t &x) {
+        write(get_base(x.m_target), false);
+        ASR::BaseWalkVisitor<ProcedureEffectsVisitor>::visit_Assignment(x);
+    }
+
+    void visit_Associate(const ASR::Associate_t &x) {
+        const ASR::symbol_t *target = get_base(x.m_target);
+        const ASR::symbol_t *value = get_base(x.m_value);
+        if (target && is_local(target) && value) {
+            views[target] = value;
+            if (changed_locals) {
+                changed_locals->insert(target);
+            }
+        } else {
+            write(target, true);
+            capture(value);
+            write(value, false);
+        }
+        ASR::BaseWalkVisitor<ProcedureEffectsVisitor>::visit_Associate(x);
+    }
+
+    void visit_Allocate(const ASR::Allocate_t &x) {
+        for (size_t i = 0; i < x.n_args; i++) {
+            write(get_base(x.m_args[i].m_a), true, true);
+        }
+        ASR::BaseWalkVisitor<ProcedureEffectsVisitor>::visit_Allocate(x);
+    }
+
+    void visit_ExplicitDeallocate(const ASR::ExplicitDeallocate_t &x) {
+        for (size_t i = 0; i < x.n_vars; i++) {
+            write(get_base(x.m_vars[i]), true, true);
+        }
+    }
+
+    void visit_ImplicitDeallocate(const ASR::ImplicitDeallocate_t &x) {
+        for (size_t i = 0; i < x.n_vars; i++) {
+            write(get_base(x.m_vars[i]), true, true);
+        }
+    }
+
+    void visit_Nullify(const ASR::Nullify_t &x) {
+        for (size_t i = 0; i < x.n_vars; i++) {
+            write(get_base(x.m_vars[i]), true);
+        }
+    }
+
+    void visit_call(const ASR::symbol_t *name, ASR::call_arg_t *args, size_t n_args) {
+        const ASR::symbol_t *proc = ASRUtils::symbol_get_past_external(
+            const_cast<ASR::symbol_t*>(name));
+        auto it = effects.find(proc);
+        if (it == effects.end()) {
+            // Without a body the procedure can do anything
+            for (size_t i = 0; i < n_args; i++) {
+                // Other expressions are passed as temporaries
+                const ASR::symbol_t *sym = args[i].m_value ? get_base(args[i].m_value) : nullptr;
+                if (sym) {
+                    write(sym, true);
+                    capture(sym);
+                }
+            }
+            e.writes_memory = true;
+            e.reads_memory = true;
+            e.writes_descriptors = true;
+            e.will_return = false;
+            return;
+        }
+        const ProcedureEffects &callee = it->second;
+        for (size_t i = 0; i < n_args; i++) {
+            const ASR::symbol_t *sym = args[i].m_value ? get_base(args[i].m_value) : nullptr;
+            if (sym == nullptr) {
+                continue;
+            }
+            bool written = i >= callee.arg_written.size() || callee.arg_written[i];
+            bool captured = i >= callee.arg_captured.size() || callee.arg_captured[i];
+            if (written) {
+                write(sym, callee.writes_descriptors);
+            }
+            if (captured) {
+                capture(sym);
+            }
+        }
+        e.writes_memory = e.writes_memory || callee.writes_memory;
+        e.reads_memory = e.reads_memory || callee.reads_memory;
+        e.writes_descriptors = e.writes_descriptors || callee.writes_descriptors;
+        e.will_return = e.will_return && callee.will_return;
+    }
+
+    void visit_FunctionCall(const ASR::FunctionCall_t &x) {
+        visit_call(x.m_name, x.m_args, x.n_args);
+        ASR::BaseWalkVisitor<ProcedureEffectsVisitor>::visit_FunctionCall(x);
+    }
+
+    void visit_SubroutineCall(const ASR::SubroutineCall_t &x) {
+        visit_call(x.m_name, x.m_args, x.n_args);
+        ASR::BaseWalkVisitor<ProcedureEffectsVisitor>::visit_SubroutineCall(x);
+    }
+
+    // The statements that use the runtime library to do input and output or
+    // to stop the program
+    void set_io() {
+        e.writes_memory = true;
+        e.reads_memory = true;
+        e.will_return = false;
+    }
+
+    void visit_Print(const ASR::Print_t &x) {
+        set_io();
+        ASR::BaseWalkVisitor<ProcedureEffectsVisitor>::visit_Print(x);
+    }
+
+    void visit_FileOpen(const ASR::FileOpen_t &/*x*/) { set_io(); }
+    void visit_FileClose(const ASR::FileClose_t &/*x*/) { set_io(); }
+    void visit_FileRewind(const ASR::FileRewind_t &/*x*/) { set_io(); }
+    void visit_FileInquire(const ASR::FileInquire_t &/*x*/) { set_unknown(); }
+    void visit_FileRead(const ASR::FileRead_t &/*x*/) { set_unknown(); }
+    void visit_FileWrite(const ASR::FileWrite_t &/*x*/) { set_io(); }
+    void visit_Flush(const ASR::Flush_t &/*x*/) { set_io(); }
+    void visit_Stop(const ASR::Stop_t &/*x*/) { set_io(); }
+    void visit_ErrorStop(const ASR::ErrorStop_t &/*x*/) { set_io(); }
+
+    void visit_Assert(const ASR::Assert_t &x) {
+        set_io();
+        ASR::BaseWalkVisitor<ProcedureEffectsVisitor>::visit_Assert(x);
+    }
+
+    // The statements whose number of steps is not known
+    void visit_WhileLoop(const ASR::WhileLoop_t &x) {
+        e.will_return = false;
+        ASR::BaseWalkVisitor<ProcedureEffectsVisitor>::visit_WhileLoop(x);
+    }
+
+    void visit_GoTo(const ASR::GoTo_t &/*x*/) { e.will_return = false; }
+    void visit_Assign(const ASR::Assign_t &/*x*/) { e.will_return = false; }
+    void visit_IfArithmetic(const ASR::IfArithmetic_t &/*x*/) { e.will_return = false; }
+    void visit_DoConcurrentLoop(const ASR::DoConcurrentLoop_t &/*x*/) { set_unknown(); }
+    void visit_ForAllSingle(const ASR::ForAllSingle_t &/*x*/) { set_unknown(); }
+    void visit_Where(const ASR::Where_t &/*x*/) { set_unknown(); }
+    void visit_BlockCall(const ASR::BlockCall_t &/*x*/) { set_unknown(); }
+    void visit_AssociateBlockCall(const ASR::AssociateBlockCall_t &/*x*/) { set_unknown(); }
+
+    void visit_DoLoop(const ASR::DoLoop_t &x) {
+        if (!is_finite(x)) {
+            e.will_return = false;
+        }
+        if (changed_locals && x.m_head.m_v) {
+            changed_locals->insert(get_base(x.m_head.m_v));
+        }
+        ASR::BaseWalkVisitor<ProcedureEffectsVisitor>::visit_DoLoop(x);
+    }
+
+    // The loop runs a finite number of times if its step is a constant
+    // and its body cannot change the loop variable or the end of the loop
+    bool is_finite(const ASR::DoLoop_t &x) {
+        if (x.m_head.m_v == nullptr || x.m_head.m_end == nullptr) {
+            return false;
+        }
+        if (x.m_head.m_increment) {
+            int64_t step;
+            ASR::expr_t *step_value = ASRUtils::expr_value(x.m_head.m_increment);
+            if (!ASRUtils::is_value_constant(step_value, step) || step == 0) {
+                return false;
+            }
+        }
+        // The effects of the body alone
+        ProcedureEffects outer = e;
+        std::map<const ASR::symbol_t*, const ASR::symbol_t*> outer_views = views;
+        std::set<const ASR::symbol_t*> changed;
+        std::set<const ASR::symbol_t*> *outer_changed = changed_locals;
+        changed_locals = &changed;
+        e = ProcedureEffects();
+        e.arg_written.resize(outer.arg_written.size(), false);
+        e.arg_captured.resize(outer.arg_captured.size(), false);
+        for (size_t i = 0; i < x.n_body; i++) {
+            visit_stmt(*x.m_body[i]);
+        }
+        changed_locals = outer_changed;
+        ProcedureEffects body = e;
+        e = outer;
+        views = outer_views;
+        bool nonlocal_written = body.writes_memory;
+        for (size_t i = 0; i < body.arg_written.size(); i++) {
+            nonlocal_written = nonlocal_written || body.arg_written[i];
+        }
+        const ASR::symbol_t *v = get_base(x.m_head.m_v);
+        if (v == nullptr || changed.count(v) ||
+                (arg_index.count(v) && body.arg_written[arg_index[v]])) {
+            return false;
+        }
+        return is_loop_invariant(x.m_head.m_end, changed, body, nonlocal_written);
+    }
+
+    // `x` has the same value in each iteration of a loop whose body writes
+    // the variables `changed` and has the effects `body`
+    bool is_loop_invariant(const ASR::expr_t *x, const std::set<const ASR::symbol_t*> &changed,
+            const ProcedureEffects &body, bool nonlocal_written) {
+        switch (x->type) {
+            case ASR::exprType::IntegerConstant:
+                return true;
+            case ASR::exprType::Var: {
+                const ASR::symbol_t *sym = get_base(down_cast<ASR::Var_t>(x)->m_v);
+                if (changed.count(sym)) {
+                    return false;
+                }
+                if (is_local(sym)) {
+                    return true;
+                }
+                // An argument can be the same variable as another argument
+                // or a global variable
+                return arg_index.count(sym) && !nonlocal_written;
+            }
+            case ASR::exprType::BinOp: {
+                const ASR::BinOp_t *op = down_cast<ASR::BinOp_t>(x);
+                return is_loop_invariant(op->m_left, changed, body, nonlocal_written) &&
+                    is_loop_invariant(op->m_right, changed, body, nonlocal_written);
+            }
+            case ASR::exprType::UnaryOp:
+                return is_loop_invariant(down_cast<ASR::UnaryOp_t>(x)->m_operand,
+                    changed, body, nonlocal_written);
+            case ASR::exprType::Cast:
+                return is_loop_invariant(down_cast<ASR::Cast_t>(x)->m_arg,
+                    changed, body, nonlocal_written);
+            case ASR::exprType::ArraySize: {
+                // Only the descriptor of the array is read
+                const ASR::ArraySize_t *size = down_cast<ASR::ArraySize_t>(x);
+                const ASR::symbol_t *sym = get_base(size->m_v);
+                return sym && !changed.count(sym) && !body.writes_descriptors &&
+                    (size->m_dim == nullptr || is_loop_invariant(size->m_dim,
+                        changed, body, nonlocal_written));
+            }
+            case ASR::exprType::FunctionCall: {
+                // `ubound(a, 1)`, a function whose result only depends on
+                // the values of its arguments
+                const ASR::FunctionCall_t *c = down_cast<ASR::FunctionCall_t>(x);
+                auto it = effects.find(ASRUtils::symbol_get_past_external(c->m_name));
+                if (it == effects.end() || it->second.writes_memory ||
+                        it->second.reads_memory || body.writes_descriptors) {
+                    return false;
+                }
+                for (size_t i = 0; i < c->n_args; i++) {
+                    if (c->m_args[i].m_value == nullptr) {
+                        continue;
+                    }
+                    if (it->second.arg_written[i] || !is_loop_invariant(
+                            c->m_args[i].m_value, changed, body, nonlocal_written)) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+            default:
+                return false;
+        }
+    }
+};
+
+std::map<const ASR::symbol_t*, ProcedureEffects> pass_find_procedure_effects(
+        ASR::TranslationUnit_t &unit, int64_t stack_array_limit) {
+    std::map<const ASR::symbol_t*, ProcedureEffects> effects;
+    ProcedureEffectsVisitor v(effects, stack_array_limit);
+    v.collect_procedures(unit.m_global_scope);
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (const ASR::symbol_t *proc : v.procs) {
+            changed = v.visit_procedure(proc) || changed;
+        }
+    }
+    return effects;
+}
+
+} // namespace LFortran
@@ -0,0 +1,35 @@
+#ifndef LFORTRAN_PASS_PROCEDURE_EFFECTS_H
+#define LFORTRAN_PASS_PROCEDURE_EFFECTS_H
+
+#include <libasr/asr.h>
+#include <map>
+#include <vector>
+
+namespace LFortran {
+
+    // What a procedure does to the memory, as far as it can be proven from
+    // its body and the bodies of the procedures it calls
+    struct ProcedureEffects {
+        // The arguments that it writes to, for an array also its elements
+        std::vector<bool> arg_written;
+        // The arguments that it can keep a pointer to after it returns
+        std::vector<bool> arg_captured;
+        // It writes or reads memory that is not its local variables or
+        // arguments: global variables, the heap or files
+        bool writes_memory = false;
+        bool reads_memory = false;
+        // It allocates, deallocates or associates an array that is not its
+        // local variable, which writes the descriptor of the array
+        bool writes_descriptors = false;
+        // It returns to the caller, it has no loop that can run forever and
+        // does not stop the program
+        bool will_return = false;
+    };
+
+    // The local arrays larger than `stack_array_limit` bytes are on the heap
+    std::map<const ASR::symbol_t*, ProcedureEffects> pass_find_procedure_effects(
+        ASR::TranslationUnit_t &unit, int64_t stack_array_limit);
+
+} // namespace LFortran
+
+#endif // LFORTRAN_PASS_PROCEDURE_EFFECTS_H
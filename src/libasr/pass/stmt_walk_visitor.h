@@ -25,6 +25,14 @@ namespace ASR {
             ASR::DoLoop_t &xx = const_cast<ASR::DoLoop_t&>(x);
             PassUtils::PassVisitor<Derived>::transform_stmts(xx.m_body, xx.n_body);
         }
+
+        void visit_If(const ASR::If_t &x) {
+            // FIXME: this is a hack, we need to pass in a non-const `x`,
+            // which requires to generate a TransformVisitor.
+            ASR::If_t &xx = const_cast<ASR::If_t&>(x);
+            PassUtils::PassVisitor<Derived>::transform_stmts(xx.m_body, xx.n_body);
+            PassUtils::PassVisitor<Derived>::transform_stmts(xx.m_orelse, xx.n_orelse);
+        }
     };
 } // namespace ASR
 
@@ -245,25 +245,34 @@ public:
 };
 
 void pass_unused_functions(Allocator &al, ASR::TranslationUnit_t &unit) {
-    if (is_program_present(unit)) {
-        for (int i=0; i < 4; i++)
-        {
-            std::map<uint64_t, std::string> fn_unused;
-            fn_unused = collect_unused_functions(unit);
-    /*
-            std::cout << "Unused functions:" << std::endl;
-            for (auto &a : fn_unused) {
-                std::cout << a.second << " ";
+    // Without a main program (a library unit compiled on its own), the
+    // procedures defined at the global scope are the entry points, so they
+    // are kept and only what they do not reach is removed.
+    bool program_present = is_program_present(unit);
+    for (int i=0; i < 4; i++)
+    {
+        std::map<uint64_t, std::string> fn_unused;
+        fn_unused = collect_unused_functions(unit);
+/*
+        std::cout << "Unused functions:" << std::endl;
+        for (auto &a : fn_unused) {
+            std::cout << a.second << " ";
+        }
+        std::cout << std::endl;
+*/
+        if (!program_present) {
+            for (auto &a : unit.m_global_scope->get_scope()) {
+                if (ASR::is_a<ASR::Function_t>(*a.second) ||
+                        ASR::is_a<ASR::GenericProcedure_t>(*a.second)) {
+                    fn_unused.erase(get_hash((ASR::asr_t*)a.second));
+                }
             }
-            std::cout << std::endl;
-    */
-            UnusedFunctionsVisitor v(al);
-            v.fn_unused = fn_unused;
-            v.visit_TranslationUnit(unit);
-            LFORTRAN_ASSERT(asr_verify(unit));
         }
+        UnusedFunctionsVisitor v(al);
+        v.fn_unused = fn_unused;
+        v.visit_TranslationUnit(unit);
+        LFORTRAN_ASSERT(asr_verify(unit));
     }
 }
 
-
 } // namespace LFortran
@@ -0,0 +1,82 @@
+#include <iomanip>
+#include <sstream>
+
+#include <libasr/time_report.h>
+
+namespace LFortran {
+
+int64_t TimeReport::total_us() const
+{
+    int64_t total = 0;
+    for (auto &e : entries) {
+        if (e.level == 0) total += e.time_us;
+    }
+    return total;
+}
+
+std::string TimeReport::table() const
+{
+    std::stringstream out;
+    out << "Time report: " << title << std::endl;
+    out << std::left << std::setw(36) << "Phase"
+        << std::right << std::setw(12) << "Time [ms]"
+        << std::setw(8) << "%"
+        << std::setw(14) << "Arena [KiB]" << std::endl;
+    int64_t total = total_us();
+    for (auto &e : entries) {
+        std::string name = std::string(2*e.level, ' ') + e.name;
+        double percent = total > 0 ? 100.0 * e.time_us / total : 0;
+        out << std::left << std::setw(36) << name << std::right
+            << std::fixed << std::setprecision(3)
+            << std::setw(12) << e.time_us / 1000.0
+            << std::setprecision(1) << std::setw(8) << percent
+            << std::setprecision(1) << std::setw(14) << e.arena_bytes / 1024.0
+            << std::endl;
+    }
+    out << std::left << std::setw(36) << "Total" << std::right
+        << std::fixed << std::setprecision(3)
+        << std::setw(12) << total / 1000.0 << std::endl;
+    return out.str();
+}
+
+namespace {
+
+std::string json_escape(const std::string &s)
+{
+    std::string r;
+    for (char c : s) {
+        if (c == '"' || c == '\\') {
+            r += '\\';
+            r += c;
+        } else if ((unsigned char)c < 0x20) {
+            std::stringstream u;
+            u << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+                << (int)c;
+            r += u.str();
+        } else {
+            r += c;
+        }
+    }
+    return r;
+}
+
+} // anonymous namespace
+
+std::string TimeReport::json() const
+{
+    std::stringstream out;
+    out << "{\"title\": \"" << json_escape(title) << "\", "
+        << "\"total_us\": " << total_us() << ", \"phases\": [";
+    for (size_t i = 0; i < entries.size(); i++) {
+        const Entry &e = entries[i];
+        if (i > 0) out << ", ";
+        out << "{\"name\": \"" << json_escape(e.name) << "\", "
+            << "\"level\": " << e.level << ", "
+            << "\"time_us\": " << e.time_us << ", "
+            << "\"arena_bytes\": " << e.arena_bytes << "}";
+    }
+    out << "]}";
+    return out.str();
+}
+
+} // namespace LFortran
@@ -0,0 +1,92 @@
+#ifndef LIBASR_TIME_REPORT_H
+#define LIBASR_TIME_REPORT_H
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <libasr/alloc.h>
+
+namespace LFortran {
+
+/*
+   TimeReport collects the wall-clock time and the arena memory used by the
+   individual compiler phases. It is filled by the driver and by the backends
+   when `--time-report` is given and then printed as a table or as JSON.
+
+   Phases have level 0, the steps inside a phase (e.g. the individual ASR
+   passes run by `asr_to_llvm`) have level 1.
+*/
+class TimeReport
+{
+public:
+    struct Entry {
+        std::string name;
+        int level;
+        int64_t time_us;     // Wall-clock time in microseconds
+        size_t arena_bytes;  // Bytes allocated in the Allocator, if any
+    };
+
+    std::string title;
+    std::vector<Entry> entries;
+
+    TimeReport(const std::string &title) : title{title} {}
+
+    // Records the time (and the bytes allocated in `al`, if not null)
+    // between its construction and destruction as one entry
+    class Timer
+    {
+        TimeReport &report;
+        Allocator *al;
+        size_t idx;
+        size_t bytes;
+        std::chrono::high_resolution_clock::time_point t1;
+    public:
+        Timer(TimeReport &report, const std::string &name, int level,
+                Allocator *al) : report{report}, al{al} {
+            // Push the entry first, so that nested entries are listed after
+            idx = report.entries.size();
+            report.entries.push_back({name, level, 0, 0});
+            bytes = al ? al->size_allocated() : 0;
+            t1 = std::chrono::high_resolution_clock::now();
+        }
+        ~Timer() {
+            auto t2 = std::chrono::high_resolution_clock::now();
+            report.entries[idx].time_us = std::chrono::duration_cast<
+                std::chrono::microseconds>(t2 - t1).count();
+            report.entries[idx].arena_bytes =
+                al ? al->size_allocated() - bytes : 0;
+        }
+    };
+
+    // Runs `f()`, records its duration and the number of bytes it allocated
+    // in `al` (pass `nullptr` if the phase does not use an arena) and
+    // returns what `f()` returns
+    template <typename F>
+    auto measure(const std::string &name, int level, Allocator *al, F &&f)
+            -> decltype(f()) {
+        Timer t(*this, name, level, al);
+        return f();
+    }
+
+    // Total time of all the phases (level 0) in microseconds
+    int64_t total_us() const;
+
+    std::string table() const;
+    std::string json() const;
+};
+
+// Calls `report->measure(...)` if `report` is not null, otherwise just `f()`
+template <typename F>
+auto time_phase(TimeReport *report, const std::string &name, int level,
+        Allocator *al, F &&f) -> decltype(f()) {
+    if (report) {
+        return report->measure(name, level, al, f);
+    } else {
+        return f();
+    }
+}
+
+} // namespace LFortran
+
+#endif // LIBASR_TIME_REPORT_H
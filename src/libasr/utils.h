@@ -26,12 +26,21 @@ struct CompilerOptions {
     bool use_colors = true;
     bool indent = false;
     bool tree = false;
-    bool fast = false;
+    int opt_level = 0;           // The -O level, 0-3 (--fast is -O3)
+    bool opt_size = false;       // -Os: -O2 without code size increasing passes
+    bool fast_math = false;      // --fast: allow less accurate arithmetic
+    std::string llvm_passes = ""; // Custom LLVM pipeline, replaces the -O one
+    std::string profile_generate = ""; // The .profraw file to instrument for
+    std::string profile_use = "";      // The .profdata file to optimize with
+    int codegen_threads = 1; // Number of parts a module is split into
+    int64_t stack_array_limit = 65536; // Larger local arrays (bytes) go on the heap
     bool openmp = false;
     bool no_warnings = false;
     bool no_error_banner = false;
     bool new_parser = false;
     std::string target = "";
+    std::string target_cpu = "";      // "native", a CPU name or "" (generic)
+    std::string target_features = ""; // e.g. "+avx2,-fma"
     Platform platform;
 
     CompilerOptions () : platform{get_platform()} {};
@@ -83,19 +83,22 @@ def str(x: i32) -> str:
         return '0'
     result: str
     result = ''
-    if x < 0:
+    # `x` is passed by reference, so work on a copy of it
+    n: i32
+    n = x
+    if n < 0:
         result += '-'
-        x = -x
+        n = -n
     rev_result: str
     rev_result = ''
     rev_result_len: i32
     rev_result_len = 0
     pos_to_str: list[str]
     pos_to_str = ['0', '1', '2', '3', '4', '5', '6', '7', '8', '9']
-    while x > 0:
-        rev_result += pos_to_str[x - _compy_floordiv(x, 10)*10]
+    while n > 0:
+        rev_result += pos_to_str[n % 10]
         rev_result_len += 1
-        x = _compy_floordiv(x, 10)
+        n = n // 10
     pos: i32
     for pos in range(rev_result_len - 1, -1, -1):
         result += rev_result[pos]
@@ -237,7 +240,7 @@ def round(value: f64) -> i32:
     elif f > 0.5:
         return i + 1
     else:
-        if i - _compy_floordiv(i, 2) * 2 == 0:
+        if i % 2 == 0:
             return i
         else:
             return i + 1
@@ -253,7 +256,7 @@ def round(value: f32) -> i32:
     elif f > 0.5:
         return i + 1
     else:
-        if i - _compy_floordiv(i, 2) * 2 == 0:
+        if i % 2 == 0:
             return i
         else:
             return i + 1
@@ -278,10 +281,19 @@ def round(value: i16) -> i16:
 def round(b: bool) -> i32:
     return abs(b)
 
-@interface
+@overload
 def divmod(x: i32, y: i32) -> tuple[i32, i32]:
-    #: TODO: Implement once we have tuple support in the LLVM backend
-    pass
+    return x // y, x % y
+
+@overload
+def divmod(x: i64, y: i64) -> tuple[i64, i64]:
+    return x // y, x % y
+
+@overload
+def divmod(x: f64, y: f64) -> tuple[f64, f64]:
+    q: f64
+    q = _compy_floordiv(x, y)
+    return q, x - q*y
 
 
 def lbound(x: i32[:], dim: i32) -> i32:
@@ -332,28 +344,16 @@ def _compy_floordiv(a: f32, b: f32) -> f32:
 
 @overload
 def _compy_floordiv(a: i32, b: i32) -> i32:
-    r: f32
-    r = a/b
-    result: i32
-    result = int(r)
-    if r >= 0.0 or result == r:
-        return result
-    return result - 1
+    return a // b
 
 @overload
 def _compy_floordiv(a: i64, b: i64) -> i64:
-    r: f64
-    r = a/b
-    result: i64
-    result = int(r)
-    if r >= 0.0 or result == r:
-        return result
-    return result - 1
+    return a // b
 
 
 @overload
 def _mod(a: i32, b: i32) -> i32:
-    return a - _compy_floordiv(a, b)*b
+    return a % b
 
 @overload
 def _mod(a: f32, b: f32) -> f32:
@@ -361,13 +361,37 @@ def _mod(a: f32, b: f32) -> f32:
 
 @overload
 def _mod(a: i64, b: i64) -> i64:
-    return a - _compy_floordiv(a, b)*b
+    return a % b
 
 @overload
 def _mod(a: f64, b: f64) -> f64:
     return a - _compy_floordiv(a, b)*b
 
 
+def _compy_slice_bound(i: i32, n: i32, step: i32, offset: i32) -> i32:
+    """
+    Returns the 1-based index `j + offset` for the bound `i` of a Python
+    slice of an array of size `n`, where `j` is `i` counted from the end if
+    it is negative and clamped to [0, n] for a positive `step` or to
+    [-1, n - 1] for a negative one.
+    """
+    j: i32
+    j = i
+    if j < 0:
+        j += n
+    if step > 0:
+        if j < 0:
+            j = 0
+        elif j > n:
+            j = n
+    else:
+        if j < -1:
+            j = -1
+        elif j > n - 1:
+            j = n - 1
+    return j + offset
+
+
 @overload
 def max(a: i32, b: i32) -> i32:
     if a > b:
@@ -474,7 +498,7 @@ def _bitwise_rshift(a: i32, b: i32) -> i32:
         raise ValueError("Negative shift count not allowed.")
     i: i32
     i = 2
-    return _compy_floordiv(a, i**b)
+    return a // i**b
 
 @overload
 def _bitwise_rshift(a: i64, b: i64) -> i64:
@@ -482,4 +506,4 @@ def _bitwise_rshift(a: i64, b: i64) -> i64:
         raise ValueError("Negative shift count not allowed.")
     i: i64
     i = 2
-    return _compy_floordiv(a, i**b)
+    return a // i**b
@@ -0,0 +1,188 @@
+from ltypes import i32, i64, f32, f64, ccall, overload
+
+def open(path: str, mode: str) -> i64:
+    """
+    Opens the file `path` with the `fopen` mode `mode` and returns its handle
+    """
+    return _compy_open(path, mode)
+
+@ccall
+def _compy_open(path: str, mode: str) -> i64:
+    pass
+
+def close(f: i64):
+    _compy_close(f)
+
+@ccall
+def _compy_close(f: i64):
+    pass
+
+@overload
+def read(f: i64) -> str:
+    """
+    Returns the rest of the file
+    """
+    n: i64
+    n = -1
+    return _compy_read(f, n)
+
+@overload
+def read(f: i64, n: i64) -> str:
+    """
+    Returns the next `n` bytes of the file, fewer at its end
+    """
+    return _compy_read(f, n)
+
+@overload
+def read(f: i64, n: i32) -> str:
+    m: i64
+    m = n
+    return _compy_read(f, m)
+
+@ccall
+def _compy_read(f: i64, n: i64) -> str:
+    pass
+
+def readline(f: i64) -> str:
+    """
+    Returns the next line of the file including its '\n', or "" at the end
+    of the file. The file is buffered, so that reading it line by line does
+    not read it character by character. The lines are iterated by calling it
+    in a `while` loop until it returns "".
+    """
+    return _compy_readline(f)
+
+@ccall
+def _compy_readline(f: i64) -> str:
+    pass
+
+def write(f: i64, s: str):
+    _compy_write(f, s)
+
+@ccall
+def _compy_write(f: i64, s: str):
+    pass
+
+def mmap(path: str) -> str:
+    """
+    Returns the contents of the file `path` without reading it: the string
+    is the file mapped into memory, pages are read when they are accessed.
+    The string is valid until `munmap` is called on it.
+    """
+    return _compy_mmap(path)
+
+@ccall
+def _compy_mmap(path: str) -> str:
+    pass
+
+def munmap(s: str):
+    _compy_munmap(s)
+
+@ccall
+def _compy_munmap(s: str):
+    pass
+
+@overload
+def read_array(f: i64, x: f64[:]) -> i64:
+    """
+    Reads the elements of `x` from the binary file with a single read,
+    returns the number of elements that were read
+    """
+    n: i64
+    n = len(x)
+    return _compy_read_array_f64(f, n, x)
+
+@overload
+def read_array(f: i64, x: f32[:]) -> i64:
+    n: i64
+    n = len(x)
+    return _compy_read_array_f32(f, n, x)
+
+@ccall
+def _compy_read_array_f64(f: i64, n: i64, x: f64[:]) -> i64:
+    pass
+
+@ccall
+def _compy_read_array_f32(f: i64, n: i64, x: f32[:]) -> i64:
+    pass
+
+@overload
+def write_array(f: i64, x: f64[:]):
+    """
+    Writes the elements of `x` to the binary file with a single write
+    """
+    n: i64
+    n = len(x)
+    _compy_write_array_f64(f, n, x)
+
+@overload
+def write_array(f: i64, x: f32[:]):
+    n: i64
+    n = len(x)
+    _compy_write_array_f32(f, n, x)
+
+@ccall
+def _compy_write_array_f64(f: i64, n: i64, x: f64[:]):
+    pass
+
+@ccall
+def _compy_write_array_f32(f: i64, n: i64, x: f32[:]):
+    pass
+
+def npy_len(path: str) -> i64:
+    """
+    Returns the number of elements of the array in the NumPy `.npy` file
+    `path`, to allocate the array that `load_npy` reads
+    """
+    return _compy_npy_len(path)
+
+@overload
+def load_npy(path: str, x: f64[:]):
+    """
+    Reads `x` from the NumPy `.npy` file `path`, which must have as many
+    elements as `x` of the same type
+    """
+    n: i64
+    n = len(x)
+    _compy_npy_load_f64(path, n, x)
+
+@overload
+def load_npy(path: str, x: f32[:]):
+    n: i64
+    n = len(x)
+    _compy_npy_load_f32(path, n, x)
+
+@overload
+def save_npy(path: str, x: f64[:]):
+    """
+    Writes `x` to the NumPy `.npy` file `path`
+    """
+    n: i64
+    n = len(x)
+    _compy_npy_save_f64(path, n, x)
+
+@overload
+def save_npy(path: str, x: f32[:]):
+    n: i64
+    n = len(x)
+    _compy_npy_save_f32(path, n, x)
+
+@ccall
+def _compy_npy_len(path: str) -> i64:
+    pass
+
+@ccall
+def _compy_npy_load_f64(path: str, n: i64, x: f64[:]):
+    pass
+
+@ccall
+def _compy_npy_load_f32(path: str, n: i64, x: f32[:]):
+    pass
+
+@ccall
+def _compy_npy_save_f64(path: str, n: i64, x: f64[:]):
+    pass
+
+@ccall
+def _compy_npy_save_f32(path: str, n: i64, x: f32[:]):
+    pass
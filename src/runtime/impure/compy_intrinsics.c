@@ -9,6 +9,16 @@
 #include <float.h>
 #include <limits.h>
 
+#ifdef _WIN32
+#include <io.h>
+#include <malloc.h>
+#else
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
 #include "compy_intrinsics.h"
 
 
@@ -22,38 +32,707 @@ LFORTRAN_API double _lfortran_sum(int n, double *v)
     return r;
 }
 
-LFORTRAN_API void _lfortran_random_number(int n, double *v)
+/* Random numbers ----------------------------------------------------------- */
+
+/*
+   xoshiro256++ (Blackman and Vigna), one generator per thread. A thread
+   that did not call `_compy_random_seed()` is seeded from the time and the
+   address of its state, so that threads get different streams.
+
+   The bulk fills run four independent generators side by side (the state
+   is stored word-major so that the compiler vectorizes the update); their
+   streams start 2^128 draws apart from the scalar one.
+*/
+
+#ifdef _MSC_VER
+#define COMPY_THREAD_LOCAL __declspec(thread)
+#else
+#define COMPY_THREAD_LOCAL _Thread_local
+#endif
+
+#define COMPY_RNG_LANES 4
+
+static COMPY_THREAD_LOCAL uint64_t _compy_rng[4];
+static COMPY_THREAD_LOCAL int _compy_rng_seeded = 0;
+// _compy_rng_lanes[i][lane] is word `i` of the state of `lane`
+static COMPY_THREAD_LOCAL uint64_t _compy_rng_lanes[4][COMPY_RNG_LANES];
+static COMPY_THREAD_LOCAL int _compy_rng_lanes_seeded = 0;
+
+static inline uint64_t _compy_rotl(uint64_t x, int k)
+{
+    return (x << k) | (x >> (64 - k));
+}
+
+static uint64_t _compy_splitmix64(uint64_t *x)
+{
+    uint64_t z = (*x += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+LFORTRAN_API void _compy_random_seed(int64_t seed)
 {
+    uint64_t x = (uint64_t)seed;
     int i;
-    for (i=0; i < n; i++) {
-        v[i] = rand() / (double) RAND_MAX;
+    for (i = 0; i < 4; i++) _compy_rng[i] = _compy_splitmix64(&x);
+    _compy_rng_seeded = 1;
+    _compy_rng_lanes_seeded = 0;
+}
+
+static inline uint64_t _compy_rng_next()
+{
+    uint64_t *s = _compy_rng;
+    if (!_compy_rng_seeded) {
+        _compy_random_seed((int64_t)((uint64_t)time(NULL)
+            ^ ((uint64_t)(uintptr_t)s << 16) ^ (uint64_t)clock()));
+    }
+    uint64_t result = _compy_rotl(s[0] + s[3], 23) + s[0];
+    uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = _compy_rotl(s[3], 45);
+    return result;
+}
+
+// Advances `s` by 2^128 draws
+static void _compy_rng_jump(uint64_t s[4])
+{
+    static const uint64_t JUMP[] = { 0x180ec6d33cfd0abaULL,
+        0xd5a61266f0c9392cULL, 0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL };
+    uint64_t t[4] = {0, 0, 0, 0};
+    uint64_t saved[4];
+    int i, j, b;
+    memcpy(saved, _compy_rng, sizeof(saved));
+    memcpy(_compy_rng, s, sizeof(saved));
+    for (i = 0; i < 4; i++) {
+        for (b = 0; b < 64; b++) {
+            if (JUMP[i] & ((uint64_t)1 << b)) {
+                for (j = 0; j < 4; j++) t[j] ^= _compy_rng[j];
+            }
+            _compy_rng_next();
+        }
+    }
+    memcpy(s, t, sizeof(t));
+    memcpy(_compy_rng, saved, sizeof(saved));
+}
+
+static void _compy_rng_lanes_init()
+{
+    uint64_t s[4];
+    int i, lane;
+    _compy_rng_next(); // Seeds the scalar generator if needed
+    memcpy(s, _compy_rng, sizeof(s));
+    for (lane = 0; lane < COMPY_RNG_LANES; lane++) {
+        _compy_rng_jump(s);
+        for (i = 0; i < 4; i++) _compy_rng_lanes[i][lane] = s[i];
+    }
+    _compy_rng_lanes_seeded = 1;
+}
+
+// Fills `out` with the next draw of each lane
+static inline void _compy_rng_next_lanes(uint64_t out[COMPY_RNG_LANES])
+{
+    uint64_t (*s)[COMPY_RNG_LANES] = _compy_rng_lanes;
+    int l;
+    for (l = 0; l < COMPY_RNG_LANES; l++) {
+        uint64_t s0 = s[0][l], s1 = s[1][l], s2 = s[2][l], s3 = s[3][l];
+        out[l] = _compy_rotl(s0 + s3, 23) + s0;
+        uint64_t t = s1 << 17;
+        s2 ^= s0;
+        s3 ^= s1;
+        s1 ^= s2;
+        s0 ^= s3;
+        s2 ^= t;
+        s3 = _compy_rotl(s3, 45);
+        s[0][l] = s0; s[1][l] = s1; s[2][l] = s2; s[3][l] = s3;
     }
 }
 
+// Uniform in [0, 1) from the top 53 (24) bits
+#define COMPY_U64_TO_F64(x) ((double)((x) >> 11) * 0x1.0p-53)
+#define COMPY_U64_TO_F32(x) ((float)((x) >> 40) * 0x1.0p-24f)
+
+// Uniform in [0, range) without modulo bias (Lemire's method), `range` > 0
+static inline uint32_t _compy_rng_bounded(uint64_t x, uint32_t range)
+{
+    uint64_t m = (x >> 32) * range;
+    uint32_t l = (uint32_t)m;
+    if (l < range) {
+        uint32_t t = (0 - range) % range;
+        while (l < t) {
+            m = (_compy_rng_next() >> 32) * range;
+            l = (uint32_t)m;
+        }
+    }
+    return (uint32_t)(m >> 32);
+}
+
 LFORTRAN_API double _lfortran_random()
 {
-    return (rand() / (double) RAND_MAX);
+    return COMPY_U64_TO_F64(_compy_rng_next());
 }
 
 LFORTRAN_API int _lfortran_randrange(int lower, int upper)
 {
-    int rr = lower + (rand() % (upper - lower));
-    return rr;
+    uint32_t range = (uint32_t)upper - (uint32_t)lower;
+    if (range == 0) return lower;
+    return (int)((uint32_t)lower + _compy_rng_bounded(_compy_rng_next(), range));
 }
 
 LFORTRAN_API int _lfortran_random_int(int lower, int upper)
 {
-    int randint = lower + (rand() % (upper - lower + 1));
-    return randint;
+    uint32_t range = (uint32_t)upper - (uint32_t)lower + 1;
+    if (range == 0) {
+        // The whole range of int32
+        return (int)(uint32_t)(_compy_rng_next() >> 32);
+    }
+    return (int)((uint32_t)lower + _compy_rng_bounded(_compy_rng_next(), range));
+}
+
+LFORTRAN_API void _compy_random_fill_f64(int32_t n, double *v)
+{
+    uint64_t r[COMPY_RNG_LANES];
+    int64_t i = 0;
+    int l;
+    if (!_compy_rng_lanes_seeded) _compy_rng_lanes_init();
+    for (; i + COMPY_RNG_LANES <= n; i += COMPY_RNG_LANES) {
+        _compy_rng_next_lanes(r);
+        for (l = 0; l < COMPY_RNG_LANES; l++) v[i+l] = COMPY_U64_TO_F64(r[l]);
+    }
+    for (; i < n; i++) v[i] = _lfortran_random();
+}
+
+LFORTRAN_API void _compy_random_fill_f32(int32_t n, float *v)
+{
+    uint64_t r[COMPY_RNG_LANES];
+    int64_t i = 0;
+    int l;
+    if (!_compy_rng_lanes_seeded) _compy_rng_lanes_init();
+    for (; i + COMPY_RNG_LANES <= n; i += COMPY_RNG_LANES) {
+        _compy_rng_next_lanes(r);
+        for (l = 0; l < COMPY_RNG_LANES; l++) v[i+l] = COMPY_U64_TO_F32(r[l]);
+    }
+    for (; i < n; i++) v[i] = COMPY_U64_TO_F32(_compy_rng_next());
+}
+
+// Fills `v` with integers N such that `lower <= N <= upper`
+LFORTRAN_API void _compy_random_fill_i32(int32_t n, int32_t *v,
+        int32_t lower, int32_t upper)
+{
+    uint64_t r[COMPY_RNG_LANES];
+    int64_t i = 0;
+    int l;
+    uint32_t range = (uint32_t)upper - (uint32_t)lower + 1;
+    if (range == 0) {
+        for (; i < n; i++) v[i] = (int32_t)(uint32_t)(_compy_rng_next() >> 32);
+        return;
+    }
+    if (!_compy_rng_lanes_seeded) _compy_rng_lanes_init();
+    for (; i + COMPY_RNG_LANES <= n; i += COMPY_RNG_LANES) {
+        _compy_rng_next_lanes(r);
+        for (l = 0; l < COMPY_RNG_LANES; l++) {
+            v[i+l] = (int32_t)((uint32_t)lower + _compy_rng_bounded(r[l], range));
+        }
+    }
+    for (; i < n; i++) v[i] = _lfortran_random_int(lower, upper);
+}
+
+LFORTRAN_API void _lfortran_random_number(int n, double *v)
+{
+    _compy_random_fill_f64(n, v);
+}
+
+/* Buffered standard output ------------------------------------------------ */
+
+/*
+   Everything that the program prints goes through one buffer, which is
+   written to stdout when it is full, at exit, on an explicit
+   `_compy_flush()` and, if stdout is a terminal, at the end of each line.
+   The `_compy_write_*` functions are what `print` is lowered to.
+*/
+
+#define COMPY_OUT_BUF_SIZE (64*1024)
+
+static char _compy_out_buf[COMPY_OUT_BUF_SIZE];
+static size_t _compy_out_len = 0;
+// -1: not initialized yet, 0: stdout is a file or a pipe, 1: a terminal
+static int _compy_out_tty = -1;
+
+LFORTRAN_API void _compy_flush()
+{
+    if (_compy_out_len > 0) {
+        fwrite(_compy_out_buf, 1, _compy_out_len, stdout);
+        _compy_out_len = 0;
+    }
+    fflush(stdout);
+}
+
+static void _compy_out_init()
+{
+#ifdef _WIN32
+    _compy_out_tty = _isatty(_fileno(stdout)) ? 1 : 0;
+#else
+    _compy_out_tty = isatty(fileno(stdout)) ? 1 : 0;
+#endif
+    atexit(_compy_flush);
+}
+
+// Returns a pointer to at least `n` (<= COMPY_OUT_BUF_SIZE) free bytes
+static inline char *_compy_out_reserve(size_t n)
+{
+    if (_compy_out_tty < 0) _compy_out_init();
+    if (_compy_out_len + n > COMPY_OUT_BUF_SIZE) _compy_flush();
+    return _compy_out_buf + _compy_out_len;
+}
+
+LFORTRAN_API void _compy_write_char(int c)
+{
+    char *p = _compy_out_reserve(1);
+    *p = c;
+    _compy_out_len++;
+    if (c == '\n' && _compy_out_tty == 1) _compy_flush();
+}
+
+LFORTRAN_API void _compy_write_str(const char *s)
+{
+    size_t n = strlen(s);
+    if (n > COMPY_OUT_BUF_SIZE) {
+        _compy_flush();
+        fwrite(s, 1, n, stdout);
+        return;
+    }
+    char *p = _compy_out_reserve(n);
+    memcpy(p, s, n);
+    _compy_out_len += n;
+}
+
+static const char _compy_digit_pairs[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+// Writes `v` backwards ending at `end`, returns the start of the digits
+static inline char *_compy_format_u64(uint64_t v, char *end)
+{
+    while (v >= 100) {
+        const char *d = _compy_digit_pairs + 2*(v % 100);
+        v /= 100;
+        *--end = d[1];
+        *--end = d[0];
+    }
+    if (v >= 10) {
+        const char *d = _compy_digit_pairs + 2*v;
+        *--end = d[1];
+        *--end = d[0];
+    } else {
+        *--end = (char)('0' + v);
+    }
+    return end;
+}
+
+LFORTRAN_API void _compy_write_i64(int64_t x)
+{
+    char buf[24];
+    char *end = buf + sizeof(buf);
+    uint64_t v = x < 0 ? 0 - (uint64_t)x : (uint64_t)x;
+    char *start = _compy_format_u64(v, end);
+    if (x < 0) *--start = '-';
+    size_t n = end - start;
+    memcpy(_compy_out_reserve(n), start, n);
+    _compy_out_len += n;
+}
+
+LFORTRAN_API void _compy_write_i32(int32_t x)
+{
+    _compy_write_i64(x);
+}
+
+/*
+   Shortest round-trip digits with Grisu3 (Loitsch, "Printing Floating-Point
+   Numbers Quickly and Accurately with Integers", PLDI 2010), following the
+   double-conversion library. Grisu3 rejects about 0.5% of the values, for
+   which the digits are found with snprintf() and strtod() instead.
+*/
+
+typedef struct {
+    uint64_t f;
+    int e;
+} _compy_diy_fp;
+
+// 10^k for k = -348, -340, ..., 340, normalized to 64 bit significands
+static const struct {
+    uint64_t f;
+    int16_t e;
+    int16_t k;
+} _compy_cached_powers[] = {
+    {0xfa8fd5a0081c0288ULL, -1220, -348},
+    {0xbaaee17fa23ebf76ULL, -1193, -340},
+    {0x8b16fb203055ac76ULL, -1166, -332},
+    {0xcf42894a5dce35eaULL, -1140, -324},
+    {0x9a6bb0aa55653b2dULL, -1113, -316},
+    {0xe61acf033d1a45dfULL, -1087, -308},
+    {0xab70fe17c79ac6caULL, -1060, -300},
+    {0xff77b1fcbebcdc4fULL, -1034, -292},
+    {0xbe5691ef416bd60cULL, -1007, -284},
+    {0x8dd01fad907ffc3cULL, -980, -276},
+    {0xd3515c2831559a83ULL, -954, -268},
+    {0x9d71ac8fada6c9b5ULL, -927, -260},
+    {0xea9c227723ee8bcbULL, -901, -252},
+    {0xaecc49914078536dULL, -874, -244},
+    {0x823c12795db6ce57ULL, -847, -236},
+    {0xc21094364dfb5637ULL, -821, -228},
+    {0x9096ea6f3848984fULL, -794, -220},
+    {0xd77485cb25823ac7ULL, -768, -212},
+    {0xa086cfcd97bf97f4ULL, -741, -204},
+    {0xef340a98172aace5ULL, -715, -196},
+    {0xb23867fb2a35b28eULL, -688, -188},
+    {0x84c8d4dfd2c63f3bULL, -661, -180},
+    {0xc5dd44271ad3cdbaULL, -635, -172},
+    {0x936b9fcebb25c996ULL, -608, -164},
+    {0xdbac6c247d62a584ULL, -582, -156},
+    {0xa3ab66580d5fdaf6ULL, -555, -148},
+    {0xf3e2f893dec3f126ULL, -529, -140},
+    {0xb5b5ada8aaff80b8ULL, -502, -132},
+    {0x87625f056c7c4a8bULL, -475, -124},
+    {0xc9bcff6034c13053ULL, -449, -116},
+    {0x964e858c91ba2655ULL, -422, -108},
+    {0xdff9772470297ebdULL, -396, -100},
+    {0xa6dfbd9fb8e5b88fULL, -369, -92},
+    {0xf8a95fcf88747d94ULL, -343, -84},
+    {0xb94470938fa89bcfULL, -316, -76},
+    {0x8a08f0f8bf0f156bULL, -289, -68},
+    {0xcdb02555653131b6ULL, -263, -60},
+    {0x993fe2c6d07b7facULL, -236, -52},
+    {0xe45c10c42a2b3b06ULL, -210, -44},
+    {0xaa242499697392d3ULL, -183, -36},
+    {0xfd87b5f28300ca0eULL, -157, -28},
+    {0xbce5086492111aebULL, -130, -20},
+    {0x8cbccc096f5088ccULL, -103, -12},
+    {0xd1b71758e219652cULL, -77, -4},
+    {0x9c40000000000000ULL, -50, 4},
+    {0xe8d4a51000000000ULL, -24, 12},
+    {0xad78ebc5ac620000ULL, 3, 20},
+    {0x813f3978f8940984ULL, 30, 28},
+    {0xc097ce7bc90715b3ULL, 56, 36},
+    {0x8f7e32ce7bea5c70ULL, 83, 44},
+    {0xd5d238a4abe98068ULL, 109, 52},
+    {0x9f4f2726179a2245ULL, 136, 60},
+    {0xed63a231d4c4fb27ULL, 162, 68},
+    {0xb0de65388cc8ada8ULL, 189, 76},
+    {0x83c7088e1aab65dbULL, 216, 84},
+    {0xc45d1df942711d9aULL, 242, 92},
+    {0x924d692ca61be758ULL, 269, 100},
+    {0xda01ee641a708deaULL, 295, 108},
+    {0xa26da3999aef774aULL, 322, 116},
+    {0xf209787bb47d6b85ULL, 348, 124},
+    {0xb454e4a179dd1877ULL, 375, 132},
+    {0x865b86925b9bc5c2ULL, 402, 140},
+    {0xc83553c5c8965d3dULL, 428, 148},
+    {0x952ab45cfa97a0b3ULL, 455, 156},
+    {0xde469fbd99a05fe3ULL, 481, 164},
+    {0xa59bc234db398c25ULL, 508, 172},
+    {0xf6c69a72a3989f5cULL, 534, 180},
+    {0xb7dcbf5354e9beceULL, 561, 188},
+    {0x88fcf317f22241e2ULL, 588, 196},
+    {0xcc20ce9bd35c78a5ULL, 614, 204},
+    {0x98165af37b2153dfULL, 641, 212},
+    {0xe2a0b5dc971f303aULL, 667, 220},
+    {0xa8d9d1535ce3b396ULL, 694, 228},
+    {0xfb9b7cd9a4a7443cULL, 720, 236},
+    {0xbb764c4ca7a44410ULL, 747, 244},
+    {0x8bab8eefb6409c1aULL, 774, 252},
+    {0xd01fef10a657842cULL, 800, 260},
+    {0x9b10a4e5e9913129ULL, 827, 268},
+    {0xe7109bfba19c0c9dULL, 853, 276},
+    {0xac2820d9623bf429ULL, 880, 284},
+    {0x80444b5e7aa7cf85ULL, 907, 292},
+    {0xbf21e44003acdd2dULL, 933, 300},
+    {0x8e679c2f5e44ff8fULL, 960, 308},
+    {0xd433179d9c8cb841ULL, 986, 316},
+    {0x9e19db92b4e31ba9ULL, 1013, 324},
+    {0xeb96bf6ebadf77d9ULL, 1039, 332},
+    {0xaf87023b9bf0ee6bULL, 1066, 340}
+};
+
+static inline _compy_diy_fp _compy_diy_fp_mul(_compy_diy_fp x, _compy_diy_fp y)
+{
+    const uint64_t m32 = 0xFFFFFFFFu;
+    uint64_t a = x.f >> 32, b = x.f & m32, c = y.f >> 32, d = y.f & m32;
+    uint64_t ac = a * c, bc = b * c, ad = a * d, bd = b * d;
+    uint64_t tmp = (bd >> 32) + (ad & m32) + (bc & m32) + (1u << 31);
+    _compy_diy_fp r = {ac + (ad >> 32) + (bc >> 32) + (tmp >> 32),
+        x.e + y.e + 64};
+    return r;
+}
+
+static inline _compy_diy_fp _compy_diy_fp_normalize(_compy_diy_fp x)
+{
+    while (!(x.f & 0xFFC0000000000000ull)) {
+        x.f <<= 10;
+        x.e -= 10;
+    }
+    while (!(x.f & 0x8000000000000000ull)) {
+        x.f <<= 1;
+        x.e -= 1;
+    }
+    return x;
+}
+
+// Moves the last digit towards `w` while the result stays in the safe
+// interval, returns 0 if the digits are not guaranteed to be the closest
+static int _compy_round_weed(char *digits, int len, uint64_t distance_too_high_w,
+    uint64_t unsafe_interval, uint64_t rest, uint64_t ten_kappa, uint64_t unit)
+{
+    uint64_t small_distance = distance_too_high_w - unit;
+    uint64_t big_distance = distance_too_high_w + unit;
+    while (rest < small_distance && unsafe_interval - rest >= ten_kappa &&
+            (rest + ten_kappa < small_distance ||
+             small_distance - rest >= rest + ten_kappa - small_distance)) {
+        digits[len - 1]--;
+        rest += ten_kappa;
+    }
+    if (rest < big_distance && unsafe_interval - rest >= ten_kappa &&
+            (rest + ten_kappa < big_distance ||
+             big_distance - rest > rest + ten_kappa - big_distance)) {
+        return 0;
+    }
+    return 2 * unit <= rest && rest <= unsafe_interval - 4 * unit;
+}
+
+// Generates the shortest digits of `w` in the interval (`low`, `high`),
+// all three scaled so that the exponent is in [-60, -32]
+static int _compy_digit_gen(_compy_diy_fp low, _compy_diy_fp w,
+    _compy_diy_fp high, char *digits, int *len, int *kappa)
+{
+    uint64_t unit = 1;
+    uint64_t too_low = low.f - unit, too_high = high.f + unit;
+    uint64_t unsafe_interval = too_high - too_low;
+    int shift = -w.e;
+    uint64_t one = (uint64_t)1 << shift;
+    uint32_t integrals = (uint32_t)(too_high >> shift);
+    uint64_t fractionals = too_high & (one - 1);
+    uint32_t divisor = 1;
+    *kappa = integrals == 0 ? 0 : 1;
+    while (integrals / divisor >= 10) {
+        divisor *= 10;
+        (*kappa)++;
+    }
+    *len = 0;
+    while (*kappa > 0) {
+        digits[(*len)++] = (char)('0' + integrals / divisor);
+        integrals %= divisor;
+        (*kappa)--;
+        uint64_t rest = ((uint64_t)integrals << shift) + fractionals;
+        if (rest < unsafe_interval) {
+            return _compy_round_weed(digits, *len, too_high - w.f,
+                unsafe_interval, rest, (uint64_t)divisor << shift, unit);
+        }
+        divisor /= 10;
+    }
+    for (;;) {
+        fractionals *= 10;
+        unit *= 10;
+        unsafe_interval *= 10;
+        digits[(*len)++] = (char)('0' + (fractionals >> shift));
+        fractionals &= one - 1;
+        (*kappa)--;
+        if (fractionals < unsafe_interval) {
+            return _compy_round_weed(digits, *len, (too_high - w.f) * unit,
+                unsafe_interval, fractionals, one, unit);
+        }
+    }
+}
+
+// The shortest digits of the positive finite `v` (of the f32 value `v` if
+// `is_f32`) with `v = digits * 10^k`, returns 0 if they could not be found
+static int _compy_grisu3(double v, int is_f32, char *digits, int *len, int *k)
+{
+    uint64_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    int biased_e = (int)((bits >> 52) & 0x7FF);
+    _compy_diy_fp w = {bits & 0x000FFFFFFFFFFFFFull, -1074};
+    if (biased_e != 0) {
+        w.f |= 0x0010000000000000ull;
+        w.e = biased_e - 1075;
+    }
+    // The boundaries are halfway to the neighbouring values, the lower one
+    // is closer if `v` is a power of two
+    _compy_diy_fp b = w;
+    int lower_closer;
+    if (is_f32) {
+        float f = (float)v;
+        uint32_t fbits;
+        memcpy(&fbits, &f, sizeof(fbits));
+        int fbiased_e = (int)((fbits >> 23) & 0xFF);
+        b.f = fbits & 0x7FFFFF;
+        b.e = -149;
+        if (fbiased_e != 0) {
+            b.f |= 0x800000;
+            b.e = fbiased_e - 150;
+        }
+        lower_closer = (fbits & 0x7FFFFF) == 0 && fbiased_e > 1;
+    } else {
+        lower_closer = (bits & 0x000FFFFFFFFFFFFFull) == 0 && biased_e > 1;
+    }
+    w = _compy_diy_fp_normalize(w);
+    _compy_diy_fp plus = {(b.f << 1) + 1, b.e - 1};
+    plus = _compy_diy_fp_normalize(plus);
+    _compy_diy_fp minus = {(b.f << 1) - 1, b.e - 1};
+    if (lower_closer) {
+        minus.f = (b.f << 2) - 1;
+        minus.e = b.e - 2;
+    }
+    minus.f <<= minus.e - plus.e;
+    minus.e = plus.e;
+
+    // A cached power 10^-mk that brings the exponent of `w` to [-60, -32]
+    int min_e = -60 - (w.e + 64);
+    int index = ((int)ceil((min_e + 63) * 0.30102999566398114) + 348 - 1) / 8 + 1;
+    _compy_diy_fp c = {_compy_cached_powers[index].f,
+        _compy_cached_powers[index].e};
+    int mk = _compy_cached_powers[index].k;
+
+    int kappa;
+    int ok = _compy_digit_gen(_compy_diy_fp_mul(minus, c),
+        _compy_diy_fp_mul(w, c), _compy_diy_fp_mul(plus, c), digits, len,
+        &kappa);
+    *k = kappa - mk;
+    return ok;
+}
+
+// The shortest digits of the positive finite `v` that read back as the same
+// f64 (f32 if `is_f32`) with `v = digits * 10^k`, returns their number
+static int _compy_shortest_digits(double v, int is_f32, char *digits, int *k)
+{
+    int len;
+    if (_compy_grisu3(v, is_f32, digits, &len, k)) return len;
+    // The first precision that round trips gives the shortest digits
+    char buf[32];
+    int min_digits = is_f32 ? FLT_DIG : DBL_DIG;
+    int max_digits = is_f32 ? 9 : 17;
+    for (int p = min_digits; p <= max_digits; p++) {
+        snprintf(buf, sizeof(buf), "%.*e", p - 1, v);
+        if (p == max_digits) break;
+        if (is_f32 ? strtof(buf, NULL) == (float)v : strtod(buf, NULL) == v) {
+            break;
+        }
+    }
+    // `buf` is "d.ddde[+-]xx"
+    char *e = strchr(buf, 'e');
+    len = 0;
+    for (char *p = buf; p < e; p++) {
+        if (*p != '.') digits[len++] = *p;
+    }
+    while (len > 1 && digits[len - 1] == '0') len--;
+    *k = atoi(e + 1) - (len - 1);
+    return len;
+}
+
+/*
+   Formats `x` as the shortest decimal string that reads back as the same
+   value (as the same f32 if `is_f32`), in the notation of Python's
+   `repr(float)`. Returns the length of the string in `buf` (at least 32
+   bytes).
+*/
+static int _compy_format_real(double x, int is_f32, char *buf)
+{
+    if (isnan(x)) {
+        strcpy(buf, "nan");
+        return 3;
+    }
+    if (isinf(x)) {
+        strcpy(buf, x < 0 ? "-inf" : "inf");
+        return x < 0 ? 4 : 3;
+    }
+    int n;
+    if (fabs(x) < 1e16 && x == (double)(int64_t)x) {
+        // Integral values: the fast path and no exponent below 1e16
+        char *end = buf + 24;
+        char *start = _compy_format_u64((uint64_t)fabs(x), end);
+        if (signbit(x)) *--start = '-';
+        n = end - start;
+        memmove(buf, start, n);
+        buf[n++] = '.';
+        buf[n++] = '0';
+        buf[n] = '\0';
+        return n;
+    }
+    char digits[20];
+    int k;
+    int len = _compy_shortest_digits(fabs(x), is_f32, digits, &k);
+    // The exponent in scientific notation, which is used outside of
+    // [-4, 16) as in Python
+    int e = len + k - 1;
+    n = 0;
+    if (x < 0) buf[n++] = '-';
+    if (e < -4 || e >= 16) {
+        buf[n++] = digits[0];
+        if (len > 1) {
+            buf[n++] = '.';
+            memcpy(buf + n, digits + 1, len - 1);
+            n += len - 1;
+        }
+        n += sprintf(buf + n, "e%c%02d", e < 0 ? '-' : '+', e < 0 ? -e : e);
+        return n;
+    }
+    if (e < 0) {
+        buf[n++] = '0';
+        buf[n++] = '.';
+        for (int i = -1; i > e; i--) buf[n++] = '0';
+        memcpy(buf + n, digits, len);
+        n += len;
+    } else if (e + 1 >= len) {
+        memcpy(buf + n, digits, len);
+        n += len;
+        for (int i = len; i <= e; i++) buf[n++] = '0';
+        buf[n++] = '.';
+        buf[n++] = '0';
+    } else {
+        memcpy(buf + n, digits, e + 1);
+        n += e + 1;
+        buf[n++] = '.';
+        memcpy(buf + n, digits + e + 1, len - e - 1);
+        n += len - e - 1;
+    }
+    buf[n] = '\0';
+    return n;
+}
+
+LFORTRAN_API void _compy_write_f64(double x)
+{
+    char *p = _compy_out_reserve(32);
+    _compy_out_len += _compy_format_real(x, 0, p);
+}
+
+LFORTRAN_API void _compy_write_f32(float x)
+{
+    char *p = _compy_out_reserve(32);
+    _compy_out_len += _compy_format_real(x, 1, p);
 }
 
 LFORTRAN_API void _lfortran_printf(const char* format, ...)
 {
     va_list args;
     va_start(args, format);
-    vfprintf(stdout, format, args);
-    fflush(stdout);
+    char *p = _compy_out_reserve(256);
+    size_t avail = COMPY_OUT_BUF_SIZE - _compy_out_len;
+    int n = vsnprintf(p, avail, format, args);
     va_end(args);
+    if (n < 0) return;
+    if ((size_t)n >= avail) {
+        // Did not fit: print it directly after what is buffered
+        _compy_flush();
+        va_start(args, format);
+        vfprintf(stdout, format, args);
+        va_end(args);
+    } else {
+        _compy_out_len += n;
+    }
+    if (_compy_out_tty == 1) _compy_flush();
 }
 
 LFORTRAN_API void _lfortran_complex_add_32(struct _lfortran_complex_32* a,
@@ -575,41 +1254,379 @@ LFORTRAN_API double_complex_t _lfortran_zatanh(double_complex_t x)
 }
 
 
-// strcat  --------------------------------------------------------------------
+// Strings  -------------------------------------------------------------------
+
+/*
+   A string is a `char*` to NUL-terminated characters that follow a header,
+   the generated code reads the length at `s - 8` and passes the `char*` to C
+   unchanged. The header says who may modify and free the characters:
+
+   cap >= 0: a buffer from `malloc` with room for `cap` characters. `owner`
+             is the address of the variable that owns it, only that variable
+             appends in place, reuses or frees the buffer; NULL when the
+             string is shared (an element of a list, a dict or a set)
+   cap == -1: static, a literal or one of the one-character strings
+   cap == -2: a temporary in the string arena
+
+   The arena is a stack of chunks. The generated code takes a mark when a
+   function or a loop iteration that creates temporaries starts and releases
+   it when it ends; values that outlive it (variables, container elements,
+   returned strings) are copied out of the arena first.
+*/
+
+typedef struct {
+    char **owner;
+    int64_t cap;
+    int64_t len;
+} _compy_str_header;
+
+#define COMPY_STR_HEADER(s) ((_compy_str_header*)(s) - 1)
+#define COMPY_STR_STATIC -1
+#define COMPY_STR_TEMP -2
+
+typedef struct _compy_arena_chunk {
+    struct _compy_arena_chunk *prev;
+    char *end;
+} _compy_arena_chunk;
+
+#define COMPY_ARENA_CHUNK_SIZE (64*1024)
+#define COMPY_ARENA_SPARE_MAX (16*1024*1024)
+
+static COMPY_THREAD_LOCAL _compy_arena_chunk *_compy_arena = NULL;
+static COMPY_THREAD_LOCAL char *_compy_arena_top = NULL;
+// The last released chunk is kept, so that a loop does not call `malloc`
+// in each iteration; a chunk of a large string (e.g. a file) is not kept
+static COMPY_THREAD_LOCAL _compy_arena_chunk *_compy_arena_spare = NULL;
+
+static void *_compy_arena_alloc(size_t n)
+{
+    n = (n + 15) & ~(size_t)15;
+    if (!_compy_arena || n > (size_t)(_compy_arena->end - _compy_arena_top)) {
+        size_t size = n + sizeof(_compy_arena_chunk);
+        if (size < COMPY_ARENA_CHUNK_SIZE) size = COMPY_ARENA_CHUNK_SIZE;
+        _compy_arena_chunk *c = _compy_arena_spare;
+        if (c && (size_t)(c->end - (char*)c) >= size) {
+            _compy_arena_spare = NULL;
+        } else {
+            c = (_compy_arena_chunk*)malloc(size);
+            c->end = (char*)c + size;
+        }
+        c->prev = _compy_arena;
+        _compy_arena = c;
+        _compy_arena_top = (char*)(c + 1);
+    }
+    void *p = _compy_arena_top;
+    _compy_arena_top += n;
+    return p;
+}
+
+LFORTRAN_API char* _lfortran_str_arena_mark()
+{
+    return _compy_arena_top;
+}
 
-LFORTRAN_API void _lfortran_strcat(char** s1, char** s2, char** dest)
+LFORTRAN_API void _lfortran_str_arena_release(char *mark)
 {
-    int cntr = 0;
-    char trmn = '\0';
-    int s1_len = strlen(*s1);
-    int s2_len = strlen(*s2);
-    int trmn_size = sizeof(trmn);
-    char* dest_char = (char*)malloc(s1_len+s2_len+trmn_size);
-    for (int i = 0; i < s1_len; i++) {
-        dest_char[cntr] = (*s1)[i];
-        cntr++;
+    while (_compy_arena && !((uintptr_t)mark >= (uintptr_t)(_compy_arena + 1)
+            && (uintptr_t)mark <= (uintptr_t)_compy_arena->end)) {
+        _compy_arena_chunk *c = _compy_arena;
+        _compy_arena = c->prev;
+        if (c->end - (char*)c > COMPY_ARENA_SPARE_MAX) {
+            free(c);
+        } else if (!_compy_arena_spare) {
+            _compy_arena_spare = c;
+        } else if (_compy_arena_spare->end - (char*)_compy_arena_spare
+                < c->end - (char*)c) {
+            free(_compy_arena_spare);
+            _compy_arena_spare = c;
+        } else {
+            free(c);
+        }
     }
-    for (int i = 0; i < s2_len; i++) {
-        dest_char[cntr] = (*s2)[i];
-        cntr++;
+    _compy_arena_top = _compy_arena ? mark : NULL;
+}
+
+static char *_compy_str_temp(int64_t len)
+{
+    _compy_str_header *h = (_compy_str_header*)_compy_arena_alloc(
+        sizeof(_compy_str_header) + len + 1);
+    h->owner = NULL;
+    h->cap = COMPY_STR_TEMP;
+    h->len = len;
+    char *s = (char*)(h + 1);
+    s[len] = '\0';
+    return s;
+}
+
+static char *_compy_str_heap(int64_t cap, int64_t len, char **owner)
+{
+    _compy_str_header *h = (_compy_str_header*)malloc(
+        sizeof(_compy_str_header) + cap + 1);
+    h->owner = owner;
+    h->cap = cap;
+    h->len = len;
+    char *s = (char*)(h + 1);
+    s[len] = '\0';
+    return s;
+}
+
+static struct {
+    _compy_str_header h;
+    char c[2];
+} _compy_str_empty = {{NULL, COMPY_STR_STATIC, 0}, {0, 0}}, _compy_str_chars[256];
+
+static int _compy_str_chars_init = 0;
+
+// The string of the single character `c`, these are static
+static char *_compy_str_char(unsigned char c)
+{
+    if (!_compy_str_chars_init) {
+        for (int i = 0; i < 256; i++) {
+            _compy_str_chars[i].h.owner = NULL;
+            _compy_str_chars[i].h.cap = COMPY_STR_STATIC;
+            _compy_str_chars[i].h.len = 1;
+            _compy_str_chars[i].c[0] = (char)i;
+            _compy_str_chars[i].c[1] = '\0';
+        }
+        _compy_str_chars_init = 1;
     }
-    dest_char[cntr] = trmn;
-    *dest = &(dest_char[0]);
+    return _compy_str_chars[c].c;
+}
+
+LFORTRAN_API char* _lfortran_str_concat(char* s1, char* s2)
+{
+    int64_t n1 = COMPY_STR_HEADER(s1)->len, n2 = COMPY_STR_HEADER(s2)->len;
+    char *s = _compy_str_temp(n1 + n2);
+    memcpy(s, s1, n1);
+    memcpy(s + n1, s2, n2);
+    return s;
 }
 
-LFORTRAN_API int _lfortran_str_len(char** s)
+LFORTRAN_API char* _lfortran_str_repeat(char* s, int32_t n)
 {
-    return strlen(*s);
+    int64_t len = COMPY_STR_HEADER(s)->len;
+    if (n <= 0 || len == 0) return _compy_str_empty.c;
+    char *r = _compy_str_temp(len * n);
+    for (int32_t i = 0; i < n; i++) {
+        memcpy(r + i*len, s, len);
+    }
+    return r;
+}
+
+LFORTRAN_API char* _lfortran_str_item(char* s, int32_t idx)
+{
+    int64_t len = COMPY_STR_HEADER(s)->len;
+    int64_t i = idx < 0 ? idx + len : idx;
+    if (i < 0 || i >= len) {
+        _lfortran_printf("IndexError: string index out of range\n");
+        exit(1);
+    }
+    return _compy_str_char(s[i]);
+}
+
+// `s[start:end:step]`, a bound that is not `present` is the default one
+LFORTRAN_API char* _lfortran_str_slice(char* s, int32_t start, int32_t end,
+    int32_t step, int32_t start_present, int32_t end_present)
+{
+    int64_t len = COMPY_STR_HEADER(s)->len;
+    if (step == 0) {
+        _lfortran_printf("ValueError: slice step cannot be zero\n");
+        exit(1);
+    }
+    int64_t lo, hi;
+    if (start_present) {
+        lo = start < 0 ? start + len : start;
+        if (lo < 0) lo = step < 0 ? -1 : 0;
+        if (lo >= len) lo = step < 0 ? len - 1 : len;
+    } else {
+        lo = step < 0 ? len - 1 : 0;
+    }
+    if (end_present) {
+        hi = end < 0 ? end + len : end;
+        if (hi < 0) hi = step < 0 ? -1 : 0;
+        if (hi >= len) hi = step < 0 ? len - 1 : len;
+    } else {
+        hi = step < 0 ? -1 : len;
+    }
+    int64_t n = 0;
+    if (step > 0 && hi > lo) n = (hi - lo + step - 1) / step;
+    if (step < 0 && lo > hi) n = (lo - hi - step - 1) / (-step);
+    if (n == 0) return _compy_str_empty.c;
+    if (n == 1) return _compy_str_char(s[lo]);
+    char *r = _compy_str_temp(n);
+    if (step == 1) {
+        memcpy(r, s + lo, n);
+    } else {
+        for (int64_t i = 0; i < n; i++) {
+            r[i] = s[lo + i*step];
+        }
+    }
+    return r;
+}
+
+// `*dest = *dest + src`, in place when `*dest` is owned by `dest`
+LFORTRAN_API void _lfortran_str_append(char** dest, char* src)
+{
+    char *s = *dest;
+    _compy_str_header *h = COMPY_STR_HEADER(s);
+    int64_t n1 = h->len, n2 = COMPY_STR_HEADER(src)->len;
+    if (n2 == 0) return;
+    if (h->owner == dest && h->cap >= n1 + n2) {
+        memcpy(s + n1, src, n2);
+    } else if (h->owner == dest) {
+        int64_t cap = 2*h->cap > n1 + n2 ? 2*h->cap : n1 + n2;
+        h = (_compy_str_header*)realloc(h, sizeof(_compy_str_header) + cap + 1);
+        if (src == s) src = (char*)(h + 1);
+        s = (char*)(h + 1);
+        h->cap = cap;
+        memcpy(s + n1, src, n2);
+        *dest = s;
+    } else {
+        int64_t cap = 2*(n1 + n2) > 15 ? 2*(n1 + n2) : 15;
+        char *r = _compy_str_heap(cap, n1 + n2, dest);
+        memcpy(r, s, n1);
+        memcpy(r + n1, src, n2);
+        *dest = r;
+        return;
+    }
+    h->len = n1 + n2;
+    s[n1 + n2] = '\0';
+}
+
+// `*dest = src`, the characters are copied into the buffer owned by `dest`
+// if it is large enough; static strings are not copied
+LFORTRAN_API void _lfortran_str_assign(char** dest, char* src)
+{
+    char *s = *dest;
+    if (s == src) return;
+    int64_t n = COMPY_STR_HEADER(src)->len;
+    if (s && COMPY_STR_HEADER(s)->owner == dest) {
+        _compy_str_header *h = COMPY_STR_HEADER(s);
+        if (h->cap >= n) {
+            memmove(s, src, n);
+            s[n] = '\0';
+            h->len = n;
+            return;
+        }
+        free(h);
+    }
+    if (COMPY_STR_HEADER(src)->cap == COMPY_STR_STATIC) {
+        *dest = src;
+        return;
+    }
+    char *r = _compy_str_heap(n, n, dest);
+    memcpy(r, src, n);
+    *dest = r;
+}
+
+// Initializes the variable `dest` to `n` spaces
+LFORTRAN_API void _lfortran_str_blank(char** dest, int32_t n)
+{
+    if (n < 0) n = 0;
+    char *r = _compy_str_heap(n, n, dest);
+    memset(r, ' ', n);
+    *dest = r;
+}
+
+// Frees the buffer of the variable `dest` when it owns it
+LFORTRAN_API void _lfortran_str_free(char** dest)
+{
+    if (*dest && COMPY_STR_HEADER(*dest)->owner == dest) {
+        free(COMPY_STR_HEADER(*dest));
+        *dest = _compy_str_empty.c;
+    }
+}
+
+// A copy of `s` that is not owned by any variable, for the elements of
+// lists, dicts, sets and tuples
+LFORTRAN_API char* _lfortran_str_persist(char* s)
+{
+    _compy_str_header *h = COMPY_STR_HEADER(s);
+    if (h->cap == COMPY_STR_STATIC) return s;
+    char *r = _compy_str_heap(h->len, h->len, NULL);
+    memcpy(r, s, h->len);
+    return r;
+}
+
+// A copy of `s` in the arena, for a string that is returned from a function
+// (after the function released its part of the arena)
+LFORTRAN_API char* _lfortran_str_temp(char* s)
+{
+    _compy_str_header *h = COMPY_STR_HEADER(s);
+    if (h->cap == COMPY_STR_STATIC) return s;
+    char *r = _compy_str_temp(h->len);
+    memcpy(r, s, h->len);
+    return r;
+}
+
+// A string from a C function, that does not have a header
+LFORTRAN_API char* _lfortran_str_from_cstr(const char* s)
+{
+    if (!s) return _compy_str_empty.c;
+    int64_t n = strlen(s);
+    char *r = _compy_str_temp(n);
+    memcpy(r, s, n);
+    return r;
+}
+
+// Compares the strings like `strcmp`, but the characters may contain NUL
+LFORTRAN_API int32_t _lfortran_str_compare(char* s1, char* s2)
+{
+    int64_t n1 = COMPY_STR_HEADER(s1)->len, n2 = COMPY_STR_HEADER(s2)->len;
+    int c = memcmp(s1, s2, n1 < n2 ? n1 : n2);
+    if (c != 0) return c;
+    return n1 < n2 ? -1 : (n1 > n2 ? 1 : 0);
 }
 
 LFORTRAN_API char* _lfortran_malloc(int size) {
     return (char*)malloc(size);
 }
 
+LFORTRAN_API char* _lfortran_realloc(char* ptr, int64_t size) {
+    return (char*)realloc(ptr, size);
+}
+
 LFORTRAN_API void _lfortran_free(char* ptr) {
     free((void*)ptr);
 }
 
+/*
+   The elements of a local array that is too large for the stack. They are
+   aligned to 64 bytes, a cache line and the widest vector register, and
+   from 2 MB on to 2 MB, so that the kernel can back them with huge pages.
+*/
+
+#define COMPY_HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
+LFORTRAN_API void* _lfortran_array_alloc(int64_t size)
+{
+    size_t align = size >= COMPY_HUGE_PAGE_SIZE ? COMPY_HUGE_PAGE_SIZE : 64;
+    if (size <= 0) size = 1;
+    void *p;
+#ifdef _WIN32
+    p = _aligned_malloc(size, align);
+#else
+    if (posix_memalign(&p, align, size) != 0) p = NULL;
+#endif
+    if (p == NULL) {
+        _lfortran_printf("Error: not enough memory for an array of %" PRId64 " bytes\n", size);
+        exit(1);
+    }
+#ifdef MADV_HUGEPAGE
+    if (align == COMPY_HUGE_PAGE_SIZE) madvise(p, size, MADV_HUGEPAGE);
+#endif
+    return p;
+}
+
+LFORTRAN_API void _lfortran_array_free(void* ptr)
+{
+#ifdef _WIN32
+    _aligned_free(ptr);
+#else
+    free(ptr);
+#endif
+}
+
 // size_plus_one is the size of the string including the null character
 LFORTRAN_API void _lfortran_string_init(int size_plus_one, char *s) {
     int size = size_plus_one-1;
@@ -619,6 +1636,25 @@ LFORTRAN_API void _lfortran_string_init(int size_plus_one, char *s) {
     s[size] = '\0';
 }
 
+// The hash of a string key of a dict or a set, the string is read 8 bytes
+// at a time; the generated code mixes the result further
+LFORTRAN_API int64_t _lfortran_str_hash(const char* s) {
+    size_t n = COMPY_STR_HEADER(s)->len;
+    uint64_t h = 0x9e3779b97f4a7c15ULL ^ n;
+    uint64_t w;
+    while (n >= 8) {
+        memcpy(&w, s, 8);
+        h = (h ^ w) * 0xff51afd7ed558ccdULL;
+        h ^= h >> 32;
+        s += 8;
+        n -= 8;
+    }
+    w = 0;
+    memcpy(&w, s, n);
+    h = (h ^ w) * 0xc4ceb9fe1a85ec53ULL;
+    return (int64_t)(h ^ (h >> 32));
+}
+
 // bit  ------------------------------------------------------------------------
 
 LFORTRAN_API int32_t _lfortran_iand32(int32_t x, int32_t y) {
@@ -826,46 +1862,370 @@ LFORTRAN_API void _lfortran_i64sys_clock(
 }
 
 LFORTRAN_API void _lfortran_sp_rand_num(float *x) {
-    srand(time(0));
-    *x = rand() / (float) RAND_MAX;
+    *x = COMPY_U64_TO_F32(_compy_rng_next());
 }
 
 LFORTRAN_API void _lfortran_dp_rand_num(double *x) {
-    srand(time(0));
-    *x = rand() / (double) RAND_MAX;
+    *x = COMPY_U64_TO_F64(_compy_rng_next());
+}
+
+// Files -----------------------------------------------------------------------
+
+/*
+   A file is a `_compy_file*` that the generated code holds as an `int64_t`.
+   Reads and writes go through the stdio buffer of `fp`, `_compy_readline`
+   reuses the `line` buffer of the file. Strings are returned in the string
+   arena, except for `_compy_mmap`, which returns the mapped file itself.
+   `_compy_close` sets `fp` to NULL and keeps the struct, so that a handle
+   used after it was closed is reported instead of read after it is freed.
+*/
+
+typedef struct {
+    FILE *fp;
+    char *line;
+    size_t line_cap;
+} _compy_file;
+
+static _compy_file *_compy_file_get(int64_t fd)
+{
+    _compy_file *f = (_compy_file*)fd;
+    if (f == NULL || f->fp == NULL) {
+        _lfortran_printf("ValueError: I/O operation on a closed file\n");
+        exit(1);
+    }
+    return f;
 }
 
 LFORTRAN_API int64_t _compy_open(char *path, char *flags)
 {
-    FILE *fd;
-    fd = fopen(path, flags);
-    if (!fd)
+    FILE *fp = fopen(path, flags);
+    if (!fp)
     {
-        printf("Error in opening the file!\n");
+        _lfortran_printf("Error in opening the file!\n");
         perror(path);
         exit(1);
     }
-    return (int64_t)fd;
+    _compy_file *f = (_compy_file*)malloc(sizeof(_compy_file));
+    f->fp = fp;
+    f->line = NULL;
+    f->line_cap = 0;
+    return (int64_t)f;
 }
 
+// Reads `n` bytes, or the rest of the file if `n < 0`; the result is shorter
+// at the end of the file
 LFORTRAN_API char* _compy_read(int64_t fd, int64_t n)
 {
-    char *c = (char *) calloc(n, sizeof(char));
-    if (fd < 0)
-    {
-        printf("Error in reading the file!\n");
+    FILE *fp = _compy_file_get(fd)->fp;
+    if (n < 0) {
+        long pos = ftell(fp);
+        if (pos >= 0 && fseek(fp, 0, SEEK_END) == 0) {
+            long end = ftell(fp);
+            fseek(fp, pos, SEEK_SET);
+            n = end > pos ? end - pos : 0;
+        } else {
+            // Not seekable, read it in chunks
+            size_t cap = 64*1024, len = 0, x;
+            char *buf = (char*)malloc(cap);
+            while ((x = fread(buf + len, 1, cap - len, fp)) > 0) {
+                len += x;
+                if (len == cap) {
+                    cap *= 2;
+                    buf = (char*)realloc(buf, cap);
+                }
+            }
+            char *s = _compy_str_temp(len);
+            memcpy(s, buf, len);
+            free(buf);
+            return s;
+        }
+    }
+    if (n == 0) return _compy_str_empty.c;
+    char *s = _compy_str_temp(n);
+    size_t x = fread(s, 1, n, fp);
+    COMPY_STR_HEADER(s)->len = x;
+    s[x] = '\0';
+    return s;
+}
+
+// The next line including its '\n', "" at the end of the file
+LFORTRAN_API char* _compy_readline(int64_t fd)
+{
+    _compy_file *f = _compy_file_get(fd);
+    int64_t len;
+#ifdef _WIN32
+    len = 0;
+    int c;
+    while ((c = getc(f->fp)) != EOF) {
+        if ((size_t)len + 1 >= f->line_cap) {
+            f->line_cap = f->line_cap ? 2*f->line_cap : 256;
+            f->line = (char*)realloc(f->line, f->line_cap);
+        }
+        f->line[len++] = (char)c;
+        if (c == '\n') break;
+    }
+#else
+    len = getline(&f->line, &f->line_cap, f->fp);
+#endif
+    if (len <= 0) return _compy_str_empty.c;
+    if (len == 1) return _compy_str_char(f->line[0]);
+    char *s = _compy_str_temp(len);
+    memcpy(s, f->line, len);
+    return s;
+}
+
+LFORTRAN_API void _compy_write(int64_t fd, char *s)
+{
+    FILE *fp = _compy_file_get(fd)->fp;
+    int64_t n = COMPY_STR_HEADER(s)->len;
+    if ((int64_t)fwrite(s, 1, n, fp) != n) {
+        _lfortran_printf("Error in writing the file!\n");
         exit(1);
     }
-    int x = fread(c, 1, n, (FILE*)fd);
-    c[x] = '\0';
-    return c;
 }
 
+// Binary arrays, `n` elements with a single `fread`/`fwrite`; `read_array`
+// returns the number of elements that were read
+
+#define COMPY_FILE_ARRAY(suffix, type) \
+LFORTRAN_API int64_t _compy_read_array_##suffix(int64_t fd, int64_t n, \
+    type *x) \
+{ \
+    return fread(x, sizeof(type), n, _compy_file_get(fd)->fp); \
+} \
+\
+LFORTRAN_API void _compy_write_array_##suffix(int64_t fd, int64_t n, \
+    type *x) \
+{ \
+    if ((int64_t)fwrite(x, sizeof(type), n, _compy_file_get(fd)->fp) != n) { \
+        _lfortran_printf("Error in writing the file!\n"); \
+        exit(1); \
+    } \
+}
+
+COMPY_FILE_ARRAY(f32, float)
+COMPY_FILE_ARRAY(f64, double)
+
 LFORTRAN_API void _compy_close(int64_t fd)
 {
-    if (fclose((FILE*)fd) != 0)
+    _compy_file *f = _compy_file_get(fd);
+    if (fclose(f->fp) != 0)
     {
-        printf("Error in closing the file!\n");
+        _lfortran_printf("Error in closing the file!\n");
+        exit(1);
+    }
+    f->fp = NULL;
+    free(f->line);
+    f->line = NULL;
+    f->line_cap = 0;
+}
+
+/*
+   `_compy_mmap` maps the file read-only after a page that holds the string
+   header, the pages after the end of the file read as zeros, which
+   terminates the string. The string is static: assigning it to a variable
+   does not copy it, so all variables that hold it see the file.
+*/
+
+LFORTRAN_API char* _compy_mmap(char *path)
+{
+#ifdef _WIN32
+    int64_t fd = _compy_open(path, "rb");
+    char *data = _compy_read(fd, -1);
+    _compy_close(fd);
+    int64_t n = COMPY_STR_HEADER(data)->len;
+    char *s = _compy_str_heap(n, n, NULL);
+    memcpy(s, data, n);
+    COMPY_STR_HEADER(s)->cap = COMPY_STR_STATIC;
+    return s;
+#else
+    int fd = open(path, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        _lfortran_printf("Error in opening the file!\n");
+        perror(path);
+        exit(1);
+    }
+    if (st.st_size == 0) {
+        close(fd);
+        return _compy_str_empty.c;
+    }
+    size_t page = sysconf(_SC_PAGESIZE);
+    size_t size = ((size_t)st.st_size + 1 + page - 1) / page * page;
+    char *base = (char*)mmap(NULL, page + size, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED || mmap(base + page, st.st_size, PROT_READ,
+            MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+        _lfortran_printf("Error in mapping the file!\n");
+        perror(path);
         exit(1);
     }
+    close(fd);
+    char *s = base + page;
+    _compy_str_header *h = COMPY_STR_HEADER(s);
+    h->owner = NULL;
+    h->cap = COMPY_STR_STATIC;
+    h->len = st.st_size;
+    mprotect(base, page, PROT_READ);
+    return s;
+#endif
+}
+
+// Unmaps the file, `s` becomes "": the page of the header and a page of
+// zeros stay mapped, so that the variables that hold `s` can still be freed
+LFORTRAN_API void _compy_munmap(char *s)
+{
+    _compy_str_header *h = COMPY_STR_HEADER(s);
+    if (h->len == 0) return;
+#ifdef _WIN32
+    // The file was read into memory, which is kept
+    h->len = 0;
+    s[0] = '\0';
+#else
+    size_t page = sysconf(_SC_PAGESIZE);
+    size_t size = ((size_t)h->len + 1 + page - 1) / page * page;
+    if (size > page) munmap(s + page, size - page);
+    mmap(s, page, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0);
+    mprotect(s - page, page, PROT_READ | PROT_WRITE);
+    h->len = 0;
+    mprotect(s - page, page, PROT_READ);
+#endif
 }
+
+/*
+   Arrays in the `.npy` format of NumPy: a header that describes the element
+   type and the shape, then the elements in C order. Only native byte order
+   is read and written.
+*/
+
+static const char *_compy_npy_descr(int32_t size)
+{
+    const uint16_t one = 1;
+    int little = *(const char*)&one == 1;
+    if (size == 8) return little ? "<f8" : ">f8";
+    return little ? "<f4" : ">f4";
+}
+
+// Reads the header of `fp`, returns the number of elements; the elements
+// must have `size` bytes unless it is 0
+static int64_t _compy_npy_header(FILE *fp, char *path, int32_t size)
+{
+    unsigned char pre[12];
+    if (fread(pre, 1, 10, fp) != 10 || memcmp(pre, "\x93NUMPY", 6) != 0) {
+        _lfortran_printf("ValueError: '%s' is not a .npy file\n", path);
+        exit(1);
+    }
+    size_t hlen = pre[8] | (pre[9] << 8);
+    if (pre[6] >= 2) {
+        if (fread(pre + 10, 1, 2, fp) != 2) hlen = 0;
+        hlen |= ((size_t)pre[10] << 16) | ((size_t)pre[11] << 24);
+    }
+    char *h = (char*)malloc(hlen + 1);
+    if (fread(h, 1, hlen, fp) != hlen) hlen = 0;
+    h[hlen] = '\0';
+    char *descr = strstr(h, "'descr'");
+    char *order = strstr(h, "'fortran_order'");
+    char *shape = strstr(h, "'shape'");
+    if (!descr || !order || !shape || !(shape = strchr(shape, '('))) {
+        _lfortran_printf("ValueError: '%s' is not a .npy file\n", path);
+        exit(1);
+    }
+    descr = strchr(descr + 7, '\'');
+    if (size != 0 && (!descr
+            || strncmp(descr + 1, _compy_npy_descr(size), 3) != 0)) {
+        _lfortran_printf("TypeError: '%s' does not contain %s elements\n",
+            path, _compy_npy_descr(size));
+        exit(1);
+    }
+    int64_t n = 1, ndim = 0;
+    char *p = shape + 1;
+    while (*p && *p != ')') {
+        if (*p >= '0' && *p <= '9') {
+            n *= strtoll(p, &p, 10);
+            ndim++;
+        } else {
+            p++;
+        }
+    }
+    if (ndim > 1 && strstr(order, "True")) {
+        _lfortran_printf("ValueError: '%s' is in Fortran order\n", path);
+        exit(1);
+    }
+    free(h);
+    return n;
+}
+
+// The number of elements of the `.npy` file
+LFORTRAN_API int64_t _compy_npy_len(char *path)
+{
+    FILE *fp = fopen(path, "rb");
+    if (!fp) {
+        _lfortran_printf("Error in opening the file!\n");
+        perror(path);
+        exit(1);
+    }
+    int64_t n = _compy_npy_header(fp, path, 0);
+    fclose(fp);
+    return n;
+}
+
+static void _compy_npy_load(char *path, int64_t n, int32_t size, void *x)
+{
+    FILE *fp = fopen(path, "rb");
+    if (!fp) {
+        _lfortran_printf("Error in opening the file!\n");
+        perror(path);
+        exit(1);
+    }
+    int64_t m = _compy_npy_header(fp, path, size);
+    if (m != n) {
+        _lfortran_printf("ValueError: '%s' has %" PRId64 " elements, "
+            "the array has %" PRId64 "\n", path, m, n);
+        exit(1);
+    }
+    if ((int64_t)fread(x, size, n, fp) != n) {
+        _lfortran_printf("Error in reading the file!\n");
+        exit(1);
+    }
+    fclose(fp);
+}
+
+static void _compy_npy_save(char *path, int64_t n, int32_t size, void *x)
+{
+    FILE *fp = fopen(path, "wb");
+    if (!fp) {
+        _lfortran_printf("Error in opening the file!\n");
+        perror(path);
+        exit(1);
+    }
+    char h[256];
+    int len = snprintf(h + 10, sizeof(h) - 10,
+        "{'descr': '%s', 'fortran_order': False, 'shape': (%" PRId64 ",), }",
+        _compy_npy_descr(size), n);
+    // The data starts at a multiple of 64 bytes, the header ends with '\n'
+    int total = (10 + len + 1 + 63) / 64 * 64;
+    memset(h + 10 + len, ' ', total - 10 - len - 1);
+    h[total - 1] = '\n';
+    memcpy(h, "\x93NUMPY\x01\x00", 8);
+    h[8] = (char)((total - 10) & 0xff);
+    h[9] = (char)((total - 10) >> 8);
+    if (fwrite(h, 1, total, fp) != (size_t)total
+            || (int64_t)fwrite(x, size, n, fp) != n || fclose(fp) != 0) {
+        _lfortran_printf("Error in writing the file!\n");
+        exit(1);
+    }
+}
+
+#define COMPY_NPY(suffix, type) \
+LFORTRAN_API void _compy_npy_load_##suffix(char *path, int64_t n, type *x) \
+{ \
+    _compy_npy_load(path, n, sizeof(type), x); \
+} \
+\
+LFORTRAN_API void _compy_npy_save_##suffix(char *path, int64_t n, type *x) \
+{ \
+    _compy_npy_save(path, n, sizeof(type), x); \
+}
+
+COMPY_NPY(f32, float)
+COMPY_NPY(f64, double)
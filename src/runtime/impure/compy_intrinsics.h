@@ -38,7 +38,19 @@ LFORTRAN_API void _lfortran_random_number(int n, double *v);
 LFORTRAN_API double _lfortran_random();
 LFORTRAN_API int _lfortran_randrange(int lower, int upper);
 LFORTRAN_API int _lfortran_random_int(int lower, int upper);
+LFORTRAN_API void _compy_random_seed(int64_t seed);
+LFORTRAN_API void _compy_random_fill_f64(int32_t n, double *v);
+LFORTRAN_API void _compy_random_fill_f32(int32_t n, float *v);
+LFORTRAN_API void _compy_random_fill_i32(int32_t n, int32_t *v,
+        int32_t lower, int32_t upper);
 LFORTRAN_API void _lfortran_printf(const char* format, ...);
+LFORTRAN_API void _compy_flush();
+LFORTRAN_API void _compy_write_char(int c);
+LFORTRAN_API void _compy_write_str(const char *s);
+LFORTRAN_API void _compy_write_i32(int32_t x);
+LFORTRAN_API void _compy_write_i64(int64_t x);
+LFORTRAN_API void _compy_write_f32(float x);
+LFORTRAN_API void _compy_write_f64(double x);
 
 LFORTRAN_API void _lfortran_complex_add_32(struct _lfortran_complex_32* a,
         struct _lfortran_complex_32* b, struct _lfortran_complex_32 *result);
@@ -134,11 +146,28 @@ LFORTRAN_API float _lfortran_satanh(float x);
 LFORTRAN_API double _lfortran_datanh(double x);
 LFORTRAN_API float_complex_t _lfortran_catanh(float_complex_t x);
 LFORTRAN_API double_complex_t _lfortran_zatanh(double_complex_t x);
-LFORTRAN_API void _lfortran_strcat(char** s1, char** s2, char** dest);
-LFORTRAN_API int _lfortran_str_len(char** s);
+LFORTRAN_API char* _lfortran_str_arena_mark();
+LFORTRAN_API void _lfortran_str_arena_release(char *mark);
+LFORTRAN_API char* _lfortran_str_concat(char* s1, char* s2);
+LFORTRAN_API char* _lfortran_str_repeat(char* s, int32_t n);
+LFORTRAN_API char* _lfortran_str_item(char* s, int32_t idx);
+LFORTRAN_API char* _lfortran_str_slice(char* s, int32_t start, int32_t end,
+    int32_t step, int32_t start_present, int32_t end_present);
+LFORTRAN_API void _lfortran_str_append(char** dest, char* src);
+LFORTRAN_API void _lfortran_str_assign(char** dest, char* src);
+LFORTRAN_API void _lfortran_str_blank(char** dest, int32_t n);
+LFORTRAN_API void _lfortran_str_free(char** dest);
+LFORTRAN_API char* _lfortran_str_persist(char* s);
+LFORTRAN_API char* _lfortran_str_temp(char* s);
+LFORTRAN_API char* _lfortran_str_from_cstr(const char* s);
+LFORTRAN_API int32_t _lfortran_str_compare(char* s1, char* s2);
 LFORTRAN_API char* _lfortran_malloc(int size);
+LFORTRAN_API char* _lfortran_realloc(char* ptr, int64_t size);
 LFORTRAN_API void _lfortran_free(char* ptr);
+LFORTRAN_API void* _lfortran_array_alloc(int64_t size);
+LFORTRAN_API void _lfortran_array_free(void* ptr);
 LFORTRAN_API void _lfortran_string_init(int size_plus_one, char *s);
+LFORTRAN_API int64_t _lfortran_str_hash(const char* s);
 LFORTRAN_API int32_t _lfortran_iand32(int32_t x, int32_t y);
 LFORTRAN_API int64_t _lfortran_iand64(int64_t x, int64_t y);
 LFORTRAN_API int32_t _lfortran_not32(int32_t x);
@@ -178,7 +207,20 @@ LFORTRAN_API void _lfortran_sp_rand_num(float *x);
 LFORTRAN_API void _lfortran_dp_rand_num(double *x);
 LFORTRAN_API int64_t _compy_open(char *path, char *flags);
 LFORTRAN_API char* _compy_read(int64_t fd, int64_t n);
+LFORTRAN_API char* _compy_readline(int64_t fd);
+LFORTRAN_API void _compy_write(int64_t fd, char *s);
+LFORTRAN_API int64_t _compy_read_array_f32(int64_t fd, int64_t n, float *x);
+LFORTRAN_API int64_t _compy_read_array_f64(int64_t fd, int64_t n, double *x);
+LFORTRAN_API void _compy_write_array_f32(int64_t fd, int64_t n, float *x);
+LFORTRAN_API void _compy_write_array_f64(int64_t fd, int64_t n, double *x);
 LFORTRAN_API void _compy_close(int64_t fd);
+LFORTRAN_API char* _compy_mmap(char *path);
+LFORTRAN_API void _compy_munmap(char *s);
+LFORTRAN_API int64_t _compy_npy_len(char *path);
+LFORTRAN_API void _compy_npy_load_f32(char *path, int64_t n, float *x);
+LFORTRAN_API void _compy_npy_load_f64(char *path, int64_t n, double *x);
+LFORTRAN_API void _compy_npy_save_f32(char *path, int64_t n, float *x);
+LFORTRAN_API void _compy_npy_save_f64(char *path, int64_t n, double *x);
 
 #ifdef __cplusplus
 }
@@ -5,7 +5,7 @@ import platform
 from typing import TypeVar
 
 __slots__ = ["i8", "i16", "i32", "i64", "f32", "f64", "c32", "c64",
-        "overload", "ccall", "TypeVar"]
+        "overload", "ccall", "restrict", "TypeVar"]
 
 # data-types
 
@@ -92,6 +92,14 @@ def overload(f):
     return overloaded_f
 
 
+def restrict(f):
+    """
+    Declares that the array arguments of `f` do not share elements, the
+    compiler assumes that a write to one of them does not change the others
+    """
+    return f
+
+
 def interface(f):
     def inner_func():
         raise Exception("Unexpected to be called by CPython")
@@ -1,4 +1,4 @@
-from ltypes import i32, f64, ccall
+from ltypes import i32, i64, f32, f64, ccall, overload
 
 e: f64 = 2.718281828459045235360287471352662497757
 eps: f64 = 1e-16
@@ -32,3 +32,50 @@ def randint(lower: i32, upper: i32) -> i32:
 @ccall
 def _lfortran_random_int(lower: i32, upper: i32) -> i32:
     pass
+
+@overload
+def seed(n: i64):
+    """
+    Initializes the random number generator of the calling thread, so that
+    it produces the same sequence of numbers on every run.
+    """
+    _compy_random_seed(n)
+
+@overload
+def seed(n: i32):
+    m: i64
+    m = n
+    _compy_random_seed(m)
+
+@ccall
+def _compy_random_seed(seed: i64):
+    pass
+
+@overload
+def fill(x: f64[:]):
+    """
+    Fills `x` with random floating point numbers in the range [0.0, 1.0)
+    """
+    _compy_random_fill_f64(len(x), x)
+
+@overload
+def fill(x: f32[:]):
+    _compy_random_fill_f32(len(x), x)
+
+@ccall
+def _compy_random_fill_f64(n: i32, x: f64[:]):
+    pass
+
+@ccall
+def _compy_random_fill_f32(n: i32, x: f32[:]):
+    pass
+
+def fill_int(x: i32[:], lower: i32, upper: i32):
+    """
+    Fills `x` with random integers N such that `lower <= N <= upper`
+    """
+    _compy_random_fill_i32(len(x), x, lower, upper)
+
+@ccall
+def _compy_random_fill_i32(n: i32, x: i32[:], lower: i32, upper: i32):
+    pass
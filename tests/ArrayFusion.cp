@@ -0,0 +1,34 @@
+from ltypes import i32, f64
+
+def main():
+    a: f64[6]
+    b: f64[6]
+    c: f64[8]
+    d: f64[6]
+    i: i32
+    for i in range(6):
+        a[i] = float(i) + 1.0
+        b[i] = 2.0 * float(i)
+        d[i] = 0.0
+    for i in range(8):
+        c[i] = float(i * i)
+
+    d = (a + b) * a - b / 2.0 + 1.0
+    print(d[0], d[1], d[5])
+    a = a * a[0] + a[1]
+    print(a[0], a[1], a[5])
+    b = b[5] - b
+    print(b[0], b[5])
+    c[1:6] = c[0:5] + 1.0
+    print(c[0], c[1], c[2], c[5], c[6])
+    c[0:5] = c[1:6] * 2.0
+    print(c[0], c[1], c[4], c[5])
+
+main()
+
+# Expected output:
+# 2.0 8.0 92.0
+# 3.0 4.0 8.0
+# 10.0 0.0
+# 0.0 1.0 2.0 17.0 36.0
+# 2.0 4.0 34.0 17.0
@@ -0,0 +1,74 @@
+from ltypes import i32, i64, f64
+from random import fill, fill_int
+from fileio import open, close, write_array, read_array, save_npy, load_npy
+
+def main():
+    x: f64[8]
+    i: i32
+    for i in range(8):
+        x[i] = -1.0
+    fill(x[::2])
+    n: i32
+    n = 0
+    for i in range(8):
+        if i % 2 == 0:
+            if x[i] >= 0.0 and x[i] < 1.0:
+                n += 1
+        else:
+            if x[i] == -1.0:
+                n += 1
+    print(n)
+
+    # Backwards, starting at the last element
+    for i in range(8):
+        x[i] = -1.0
+    fill(x[::-2])
+    n = 0
+    for i in range(8):
+        if i % 2 == 1:
+            if x[i] >= 0.0:
+                n += 1
+        else:
+            if x[i] == -1.0:
+                n += 1
+    print(n)
+
+    k: i32[9]
+    for i in range(9):
+        k[i] = i
+    fill_int(k[1::3], 100, 100)
+    print(k[0], k[1], k[2], k[3], k[4], k[5], k[6], k[7], k[8])
+
+    for i in range(8):
+        x[i] = float(i)
+    f: i64
+    f = open("_section_test.bin", "wb")
+    write_array(f, x[::2])
+    close(f)
+    y: f64[4]
+    f = open("_section_test.bin", "rb")
+    print(read_array(f, y))
+    close(f)
+    print(y[0], y[1], y[2], y[3])
+
+    save_npy("_section_test.npy", x[1::3])
+    z: f64[3]
+    load_npy("_section_test.npy", z)
+    print(z[0], z[1], z[2])
+
+    # The elements read by C are copied back into the section
+    for i in range(8):
+        x[i] = 0.0
+    load_npy("_section_test.npy", x[::3])
+    print(x[0], x[1], x[2], x[3], x[4], x[5], x[6], x[7])
+
+main()
+
+# Expected output:
+# 8
+# 8
+# 0 100 2 3 100 5 6 100 8
+# 4
+# 0.0 2.0 4.0 6.0
+# 1.0 4.0 7.0
+# 1.0 0.0 0.0 4.0 0.0 0.0 7.0 0.0
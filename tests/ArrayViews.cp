@@ -0,0 +1,55 @@
+from ltypes import i32, f64
+
+def total(x: f64[:]) -> f64:
+    s: f64
+    i: i32
+    s = 0.0
+    for i in range(len(x)):
+        s = s + x[i]
+    return s
+
+def scale(x: f64[:], c: f64):
+    i: i32
+    for i in range(len(x)):
+        x[i] = x[i] * c
+
+def main():
+    x: f64[10]
+    i: i32
+    lo: i32
+    m: i32
+    for i in range(10):
+        x[i] = float(i)
+    print(total(x), total(x[2:5]), total(x[::3]), total(x[::-1]))
+    print(len(x[1:9:2]), total(x[8:1:-2]), len(x[5:2]))
+    scale(x[::2], 10.0)
+    print(x[0], x[1], x[2], x[9])
+    scale(x[9:0:-3], -1.0)
+    print(x[0], x[3], x[6], x[9])
+
+
+    # Bounds only known at run time count from the end when negative and
+    # are clamped to the array
+    for i in range(10):
+        x[i] = float(i)
+    lo = 2
+    m = -2
+    print(total(x[2:m]), total(x[m:]), total(x[-lo:]), total(x[m::-1]))
+    print(len(x[0:100]), len(x[3:100:2]), len(x[-100:3]), total(x[100:-100:-3]))
+    m = 100
+    print(len(x[m:]), len(x[:m]), len(x[-m:]), len(x[m::-1]), len(x[-m::-1]))
+    scale(x[7:m], 2.0)
+    scale(x[-m:lo], -1.0)
+    print(x[0], x[1], x[2], x[6], x[7], x[9])
+
+main()
+
+# Expected output:
+# 45.0 9.0 18.0 45.0
+# 4 20.0 0
+# 0.0 1.0 20.0 9.0
+# 0.0 -3.0 -60.0 -9.0
+# 27.0 17.0 17.0 36.0
+# 10 4 3 18.0
+# 0 10 10 10 0
+# -0.0 -1.0 2.0 6.0 14.0 18.0
@@ -0,0 +1,45 @@
+from ltypes import i32, f64, restrict
+
+def total(x: f64[:]) -> f64:
+    i: i32
+    s: f64
+    s = 0.0
+    for i in range(len(x)):
+        s = s + x[i]
+    return s
+
+@restrict
+def scale(x: f64[:], y: f64[:], a: f64):
+    i: i32
+    for i in range(len(x)):
+        y[i] = a * x[i]
+
+def scaled_total(x: f64[:], y: f64[:], a: f64) -> f64:
+    scale(x, y, a)
+    return total(y)
+
+def main():
+    x: f64[10]
+    y: f64[10]
+    big: f64[20000]
+    i: i32
+    for i in range(10):
+        x[i] = float(i)
+        y[i] = 0.0
+    for i in range(20000):
+        big[i] = 1.0
+    print(total(x), total(big))
+    print(scaled_total(x, y, 2.0), y[9])
+    print(total(x[2:5]), total(x[::3]), total(x[::-1]))
+    scale(x[0:5], y[5:10], 3.0)
+    print(y[4], y[5], y[9])
+    print(scaled_total(big[0:100], big[100:200], 2.0))
+
+main()
+
+# Expected output:
+# 45.0 20000.0
+# 90.0 18.0
+# 9.0 18.0 45.0
+# 8.0 0.0 12.0
+# 200.0
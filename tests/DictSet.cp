@@ -0,0 +1,50 @@
+from ltypes import i32
+
+def count(words: list[str]) -> dict[str, i32]:
+    d: dict[str, i32]
+    i: i32
+    d = {}
+    for i in range(len(words)):
+        if words[i] in d:
+            d[words[i]] = d[words[i]] + 1
+        else:
+            d[words[i]] = 1
+    return d
+
+def main():
+    d: dict[i32, i32]
+    c: dict[str, i32]
+    s: set[i32]
+    i: i32
+    n: i32
+    d = {}
+    for i in range(1000):
+        d[i * 7] = i
+    print(len(d), d[0], d[693], d[6993])
+    for i in range(500):
+        d.pop(i * 14)
+    print(len(d), d[7], d.get(14, -1), d.get(21, -1))
+    d[14] = 99
+    print(len(d), d[14])
+    c = count(["a", "bb", "a", "ccc", "bb", "a"])
+    print(len(c), c["a"], c["bb"], c["ccc"])
+    s = {1, 2, 3}
+    for i in range(100):
+        s.add(i % 10)
+    print(len(s))
+    s.remove(5)
+    n = 0
+    for i in range(12):
+        if i in s:
+            n = n + 1
+    print(len(s), n)
+
+main()
+
+# Expected output:
+# 1000 0 99 999
+# 500 1 -1 3
+# 501 99
+# 3 3 2 1
+# 10
+# 9 9
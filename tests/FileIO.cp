@@ -0,0 +1,65 @@
+from ltypes import i32, i64, f64
+from fileio import open, close, read, readline, write, mmap, munmap, write_array, read_array
+
+def main():
+    f: i64
+    s: str
+    line: str
+    i: i32
+    n: i32
+    nl: str
+    nl = """
+"""
+    f = open("_fileio_test.txt", "w")
+    for i in range(3):
+        write(f, "line " + str(i) + nl)
+    write(f, "last")
+    close(f)
+
+    f = open("_fileio_test.txt", "r")
+    s = read(f)
+    close(f)
+    print(len(s), s[0:6])
+
+    f = open("_fileio_test.txt", "r")
+    print(read(f, 4), len(read(f, 3)))
+    line = readline(f)
+    print(len(line), line[0:4])
+    n = 0
+    line = readline(f)
+    while line != "":
+        n = n + 1
+        line = readline(f)
+    print(n)
+    close(f)
+
+    s = mmap("_fileio_test.txt")
+    print(len(s), s[len(s) - 4:])
+    munmap(s)
+
+    x: f64[5]
+    y: f64[5]
+    for i in range(5):
+        x[i] = float(i) * 1.5
+        y[i] = 0.0
+    f = open("_fileio_test.bin", "wb")
+    write_array(f, x)
+    close(f)
+    f = open("_fileio_test.bin", "rb")
+    print(read_array(f, y))
+    close(f)
+    print(y[0], y[1], y[4])
+    line = readline(f)
+    print("not reached")
+
+main()
+
+# Expected output:
+# 25 line 0
+# line 3
+# 7 line
+# 2
+# 25 last
+# 5
+# 0.0 1.5 6.0
+# ValueError: I/O operation on a closed file
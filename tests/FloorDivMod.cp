@@ -0,0 +1,44 @@
+from ltypes import i32, i64, f64
+
+def main():
+    a: i32
+    b: i32
+    a = 7
+    b = 2
+    print(a // b, a % b)
+    print(-a // b, -a % b)
+    print(a // -b, a % -b)
+    print(-a // -b, -a % -b)
+    a = 6
+    print(-a // b, -a % b)
+    c: i64
+    d: i64
+    c = -123456789
+    c = c * 1000000
+    d = 7
+    print(c // d, c % d)
+    x: f64
+    y: f64
+    x = 7.5
+    y = -2.0
+    print(x // y, x % y)
+    print(-x // 2.0, -x % 2.0)
+    b = -1
+    print(a // b, a % b)
+    b = 0
+    print(a // b)
+    print("not reached")
+
+main()
+
+# Expected output:
+# 3 1
+# -4 1
+# -4 -1
+# 3 -1
+# -3 0
+# -17636684142858 6
+# -4.0 -0.5
+# -4.0 0.5
+# -6 0
+# ZeroDivisionError: integer division or modulo by zero
@@ -0,0 +1,44 @@
+from ltypes import i32, f64
+
+def first_above(n: i32, limit: f64) -> i32:
+    x: f64[20000]
+    i: i32
+    for i in range(20000):
+        x[i] = float(i % n)
+    for i in range(20000):
+        if x[i] > limit:
+            return i
+    return -1
+
+def depth(k: i32) -> f64:
+    x: f64[10000]
+    i: i32
+    for i in range(10000):
+        x[i] = float(k)
+    if k == 0:
+        return x[9999]
+    return x[0] + depth(k - 1) + x[9999]
+
+def main():
+    a: f64[50000]
+    i: i32
+    s: f64
+    c: i32
+    c = 0
+    for i in range(2000):
+        c = c + first_above(100, float(i % 200))
+    print(c, first_above(10, 100.0))
+    print(depth(5))
+    for i in range(50000):
+        a[i] = 0.5
+    s = 0.0
+    for i in range(50000):
+        s = s + a[i]
+    print(s)
+
+main()
+
+# Expected output:
+# 48490 -1
+# 30.0
+# 25000.0
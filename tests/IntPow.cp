@@ -0,0 +1,25 @@
+from ltypes import i32, i64
+
+def main():
+    a: i32 = 5
+    b: i32 = 11
+    c: i64 = 3
+    d: i64 = 39
+    print(pow(a, b), pow(7, 9), a ** b)
+    print(c ** d, pow(c, d))
+    print(a ** 2, a ** 0, (-a) ** 3, (-1) ** b)
+    s: i64 = 0
+    i: i32
+    k: i64
+    for i in range(10):
+        k = i
+        s = s + k ** 3
+    print(s)
+
+main()
+
+# Expected output:
+# 48828125 40353607 48828125
+# 4052555153018976267 4052555153018976267
+# 25 1 -125 -1
+# 2025
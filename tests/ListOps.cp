@@ -0,0 +1,47 @@
+from ltypes import i32
+
+def total(x: list[i32]) -> i32:
+    s: i32
+    i: i32
+    s = 0
+    for i in range(len(x)):
+        s = s + x[i]
+    return s
+
+def main():
+    x: list[i32]
+    y: list[i32]
+    z: list[list[i32]]
+    i: i32
+    x = []
+    for i in range(5):
+        x.append(i * i)
+    print(len(x), x[0], x[4], x[-1], x[-5])
+    x.insert(0, 100)
+    x.insert(3, -7)
+    print(len(x), x[0], x[3], total(x))
+    print(x.pop(), x.pop(0), len(x))
+    x.remove(-7)
+    print(len(x), x[0], x[2])
+    x[-1] = 50
+    print(x[2], x[-1])
+    y = x + [8, 9]
+    print(len(y), y[3], y[4], total(y))
+    y[0] = y[-1]
+    print(y[0], y[4])
+    z = [[1, 2], [3, 4, 5]]
+    z[1].append(6)
+    z.append([7])
+    print(len(z), len(z[1]), z[1][3], z[2][0], total(z[0]))
+
+main()
+
+# Expected output:
+# 5 0 16 16 0
+# 7 100 -7 123
+# 16 100 5
+# 4 0 4
+# 4 50
+# 6 50 8 72
+# 9 8
+# 3 4 6 7 3
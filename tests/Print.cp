@@ -0,0 +1,36 @@
+from ltypes import i8, i16, i32, i64, f32, f64
+
+def f(n: i32) -> i32:
+    print("in f")
+    return n
+
+def main():
+    a: i8
+    b: i16
+    c: i64
+    a = -5
+    b = 300
+    c = 123456789
+    c = c * 1000
+    print(a, b, c, 42)
+    x: f64
+    y: f32
+    x = 1.0
+    x = x / 10.0
+    y = 2.5
+    print(x, y, 1.0, -3.25, x / 3.0, -0.0)
+    print("text", "", "end")
+    print(1, f(2), 3)
+    print()
+    print("a", "b")
+
+main()
+
+# Expected output:
+# -5 300 123456789000 42
+# 0.1 2.5 1.0 -3.25 0.03333333333333333 -0.0
+# text  end
+# in f
+# 1 2 3
+#
+# a b
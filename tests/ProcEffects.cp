@@ -0,0 +1,65 @@
+from ltypes import i32, f64, restrict
+
+@restrict
+def axpy(n: i32, a: f64, x: f64[:], y: f64[:]):
+    i: i32
+    for i in range(n):
+        y[i] = y[i] + a * x[i]
+
+def dot(n: i32, x: f64[:], y: f64[:]) -> f64:
+    i: i32
+    s: f64
+    s = 0.0
+    for i in range(n):
+        s = s + x[i] * y[i]
+    return s
+
+def square(x: f64) -> f64:
+    return x * x
+
+def bump(x: f64[:]):
+    x[0] = x[0] + 1.0
+
+def fact(n: i32) -> i32:
+    if n <= 1:
+        return 1
+    return n * fact(n - 1)
+
+def shift(n: i32, x: f64[:], y: f64[:]):
+    i: i32
+    for i in range(n):
+        y[i] = x[i] * 2.0
+
+def main():
+    x: f64[8]
+    y: f64[8]
+    i: i32
+    for i in range(8):
+        x[i] = float(i)
+        y[i] = 1.0
+    axpy(8, 0.5, x, y)
+    print(y[0], y[1], y[7])
+    print(dot(8, x, y))
+    s: f64
+    t: f64
+    s = 0.0
+    for i in range(8):
+        t = x[i]
+        s = s + square(t)
+    print(s)
+    bump(x)
+    bump(x)
+    print(x[0], dot(8, x, x))
+    print(fact(10))
+    shift(8, x, x)
+    print(x[0], x[1], x[7])
+
+main()
+
+# Expected output:
+# 1.0 1.5 4.5
+# 98.0
+# 140.0
+# 2.0 144.0
+# 3628800
+# 4.0 2.0 14.0
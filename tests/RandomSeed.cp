@@ -0,0 +1,55 @@
+from ltypes import i32, f64
+from random import randint, randrange, seed, fill, fill_int
+
+def main():
+    x: f64[100]
+    y: f64[100]
+    k: i32[100]
+    m: i32[100]
+    i1: i32
+    i2: i32
+    i: i32
+    same: i32
+    inrange: i32
+
+    seed(42)
+    i1 = randint(1, 6)
+    fill(x)
+    fill_int(k, -3, 3)
+    seed(42)
+    i2 = randint(1, 6)
+    fill(y)
+    fill_int(m, -3, 3)
+    print(i1 == i2, i1 >= 1 and i1 <= 6)
+
+    same = 0
+    inrange = 0
+    for i in range(100):
+        if x[i] == y[i] and k[i] == m[i]:
+            same = same + 1
+        if x[i] >= 0.0 and x[i] < 1.0 and k[i] >= -3 and k[i] <= 3:
+            inrange = inrange + 1
+    print(same, inrange)
+
+    seed(43)
+    fill(y)
+    same = 0
+    for i in range(100):
+        if x[i] == y[i]:
+            same = same + 1
+    print(same)
+
+    inrange = 0
+    for i in range(1000):
+        i1 = randrange(5, 8)
+        if i1 >= 5 and i1 < 8:
+            inrange = inrange + 1
+    print(inrange)
+
+main()
+
+# Expected output:
+# 1 1
+# 100 100
+# 0
+# 1000
@@ -0,0 +1,42 @@
+from ltypes import i32
+
+def join(x: list[str], sep: str) -> str:
+    r: str
+    i: i32
+    r = ""
+    for i in range(len(x)):
+        if i > 0:
+            r = r + sep
+        r = r + x[i]
+    return r
+
+def main():
+    s: str
+    t: str
+    i: i32
+    s = "Hello, World"
+    print(len(s), s[0], s[-1], s[7])
+    print(s[0:5], s[7:], s[:5], s[-5:])
+    print(s[::2], s[::-1], s[1:10:3])
+    print(s[5:2], s[100:], "|")
+    t = s[7:12] + "!" + s[:5]
+    print(t, len(t))
+    t = ""
+    for i in range(5):
+        t = t + s[i:i + 1] * 2
+    print(t)
+    print(join(["a", "bc", "def"], ", "))
+    if s == "Hello, World" and s != t and "abc" < "abd":
+        print("compare ok")
+
+main()
+
+# Expected output:
+# 12 H d W
+# Hello World Hello World
+# Hlo ol dlroW ,olleH eoW
+#   |
+# World!Hello 11
+# HHeelllloo
+# a, bc, def
+# compare ok
@@ -0,0 +1,43 @@
+from ltypes import i32, f64
+
+def divmod_(a: i32, b: i32) -> tuple[i32, i32]:
+    return (a // b, a % b)
+
+def stats(x: list[f64]) -> tuple[f64, f64, i32]:
+    lo: f64
+    hi: f64
+    i: i32
+    lo = x[0]
+    hi = x[0]
+    for i in range(len(x)):
+        if x[i] < lo:
+            lo = x[i]
+        if x[i] > hi:
+            hi = x[i]
+    return (lo, hi, len(x))
+
+def main():
+    t: tuple[i32, i32]
+    u: tuple[f64, f64, i32]
+    v: tuple[str, i32]
+    q: i32
+    r: i32
+    t = divmod_(17, 5)
+    print(t[0], t[1])
+    q, r = divmod_(-17, 5)
+    print(q, r)
+    u = stats([2.5, -1.0, 4.0])
+    print(u[0], u[1], u[2])
+    v = ("abc", 3)
+    print(v[0], v[1])
+    t = (t[1], t[0])
+    print(t[0], t[1])
+
+main()
+
+# Expected output:
+# 3 2
+# -4 3
+# -1.0 4.0 3
+# abc 3
+# 2 3